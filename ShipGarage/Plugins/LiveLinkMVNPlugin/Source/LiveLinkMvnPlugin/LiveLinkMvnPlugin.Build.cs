@@ -34,6 +34,7 @@ public class LiveLinkMvnPlugin : ModuleRules
 				"LiveLinkMessageBusFramework",
                 "LiveLink",
 				"LiveLinkComponents",
+				"LiveLinkSubjectUpdateRate",
 #if UE_5_0_OR_LATER
 				"LiveLinkAnimationCore",
 #endif
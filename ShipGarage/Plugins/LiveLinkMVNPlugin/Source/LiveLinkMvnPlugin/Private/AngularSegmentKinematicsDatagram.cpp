@@ -0,0 +1,84 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "AngularSegmentKinematicsDatagram.h"
+
+/*! \class AngularSegmentKinematicsDatagram
+  \brief an angular segment kinematics datagram (type 22)
+
+  Information about each segment is sent as follows.
+
+  4 bytes segment ID
+  16 bytes segment orientation quaternion (re, i, j, k)
+  12 bytes angular velocity in rad/s
+  12 bytes angular acceleration in rad/s2
+
+  Total: 44 bytes per segment
+
+  The coordinates use a Z-Up, right-handed coordinate system.
+ */
+
+/*! Constructor */
+AngularSegmentKinematicsDatagram::AngularSegmentKinematicsDatagram()
+	: Datagram()
+{
+	setType(SPAngularSegmentKinematics);
+
+	// the datagram is reused for every packet, so reserve for the largest item count once
+	m_data.reserve(SEGMENT_CAPACITY);
+}
+
+/*! Destructor */
+AngularSegmentKinematicsDatagram::~AngularSegmentKinematicsDatagram()
+{}
+
+/*! Deserialize the data from \a arr
+	The previous content is overwritten, the storage reserved in the constructor is kept.
+	\sa serializeData
+*/
+bool AngularSegmentKinematicsDatagram::deserializeData(Streamer &inputStreamer)
+{
+	Streamer* streamer = &inputStreamer;
+
+	m_data.clear();
+	if (!streamer->canRead(dataCount() * SEGMENT_SIZE))
+		return false;
+
+	for (int i = 0; i < dataCount(); i++)
+	{
+		m_data.emplace_back();
+		Kinematics& item = m_data.back();
+
+		// 4 bytes segment ID
+		streamer->read(item.segmentId);
+
+		// 16 bytes segment orientation quaternion (re, i, j, k)
+		for (int k = 0; k < 4; k++)
+			streamer->read(item.quatRotation[k]);
+
+		// 12 bytes angular velocity in rad/s
+		for (int k = 0; k < 3; k++)
+			streamer->read(item.angularVelocity[k]);
+
+		// 12 bytes angular acceleration in rad/s2
+		for (int k = 0; k < 3; k++)
+			streamer->read(item.angularAcceleration[k]);
+	}
+	return true;
+}
+
+/*! Print Data datagram in a formated why
+*/
+void AngularSegmentKinematicsDatagram::printData() const
+{
+	std::cout << "*********************** DATA CONTENT ***********************" <<  std::endl <<  std::endl;
+
+	for (int i = 0; i < (int)m_data.size(); i++)
+	{
+		const Kinematics& item = m_data.at(i);
+		std::cout << "Segment ID: " << item.segmentId << std::endl;
+		std::cout << "Quaternion Rotation: (" << item.quatRotation[0] << ", " << item.quatRotation[1] << ", " << item.quatRotation[2] << ", " << item.quatRotation[3] << ")" << std::endl;
+		std::cout << "Angular Velocity: (" << item.angularVelocity[0] << ", " << item.angularVelocity[1] << ", " << item.angularVelocity[2] << ")" << std::endl;
+		std::cout << "Angular Acceleration: (" << item.angularAcceleration[0] << ", " << item.angularAcceleration[1] << ", " << item.angularAcceleration[2] << ")" << std::endl;
+		std::cout << std::endl;
+	}
+}
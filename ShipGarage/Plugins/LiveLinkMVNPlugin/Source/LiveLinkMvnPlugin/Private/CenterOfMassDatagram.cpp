@@ -0,0 +1,78 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "CenterOfMassDatagram.h"
+
+/*! \class CenterOfMassDatagram
+  \brief a center of mass datagram (type 24)
+
+  The data part holds a single item.
+
+  12 bytes center of mass position in m
+  12 bytes center of mass velocity in m/s, since MVN 2019
+  12 bytes center of mass acceleration in m/s2, since MVN 2019
+
+  Total: 12 or 36 bytes
+
+  The coordinates use a Z-Up, right-handed coordinate system.
+ */
+
+/*! Constructor */
+CenterOfMassDatagram::CenterOfMassDatagram()
+	: Datagram()
+	, m_hasDerivatives(false)
+{
+	setType(SPCenterOfMass);
+
+	for (int k = 0; k < 3; k++)
+	{
+		m_position[k] = 0.f;
+		m_velocity[k] = 0.f;
+		m_acceleration[k] = 0.f;
+	}
+}
+
+/*! Destructor */
+CenterOfMassDatagram::~CenterOfMassDatagram()
+{}
+
+/*! Deserialize the data from \a arr
+	\sa serializeData
+*/
+bool CenterOfMassDatagram::deserializeData(Streamer &inputStreamer)
+{
+	Streamer* streamer = &inputStreamer;
+
+	if (!streamer->canRead(12))
+		return false;
+
+	for (int k = 0; k < 3; k++)
+		streamer->read(m_position[k]);
+
+	m_hasDerivatives = streamer->canRead(24);
+	for (int k = 0; k < 3; k++)
+	{
+		m_velocity[k] = 0.f;
+		if (m_hasDerivatives)
+			streamer->read(m_velocity[k]);
+	}
+	for (int k = 0; k < 3; k++)
+	{
+		m_acceleration[k] = 0.f;
+		if (m_hasDerivatives)
+			streamer->read(m_acceleration[k]);
+	}
+	return true;
+}
+
+/*! Print Data datagram in a formated why
+*/
+void CenterOfMassDatagram::printData() const
+{
+	std::cout << "*********************** DATA CONTENT ***********************" <<  std::endl <<  std::endl;
+	std::cout << "Position: (" << m_position[0] << ", " << m_position[1] << ", " << m_position[2] << ")" << std::endl;
+	if (m_hasDerivatives)
+	{
+		std::cout << "Velocity: (" << m_velocity[0] << ", " << m_velocity[1] << ", " << m_velocity[2] << ")" << std::endl;
+		std::cout << "Acceleration: (" << m_acceleration[0] << ", " << m_acceleration[1] << ", " << m_acceleration[2] << ")" << std::endl;
+	}
+}
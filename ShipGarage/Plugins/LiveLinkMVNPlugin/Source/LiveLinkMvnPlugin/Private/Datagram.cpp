@@ -15,7 +15,7 @@
 const float Datagram::EULERPOSITIONSCALE = 100.0;
 
 Datagram::Datagram() :
-		m_header("MXTP00")
+		m_type(SPPoseEuler)
 	,	m_sampleCounter(0)
 	,	m_frameTime(0)
 	,	m_avatarId(0)
@@ -26,7 +26,6 @@ Datagram::Datagram() :
 	,	m_fingerTrackingSegmentCount(0)
 	, m_dataSize(0)
 {
-	initMap(m_packetsName);
 }
 
 /*! Destructor */
@@ -40,51 +39,67 @@ int Datagram::getDataSize() const
 	return m_dataSize;
 }
 
+static int hexDigitValue(uint8_t c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+/*! The datagrams message type, read from the "MXTPxx" id string without copying it.
+	Returns -1 if the buffer does not start with a valid MVN header.
+*/
+int Datagram::messageType(const uint8_t* data, int32 size)
+{
+	if (data == nullptr || size < HEADER_SIZE)
+		return -1;
+
+	if (data[0] != 'M' || data[1] != 'X' || data[2] != 'T' || data[3] != 'P')
+		return -1;
+
+	// the 5th and 6th digits represent the code of the packet in hex
+	const int high = hexDigitValue(data[4]);
+	const int low = hexDigitValue(data[5]);
+	if (high < 0 || low < 0)
+		return -1;
+
+	return high * 16 + low;
+}
+
 /*! The datagrams message type */
 int Datagram::messageType(const TArray<uint8_t>& array)
 {
-	std::stringstream tp;
-	// extract the 5th and 6th digits that represent the code of the packet
-	tp << array[4] << array[5];
-	std::string type;
-	tp >> type;
-	// convert to hex
-	int sp = std::stoi(type,nullptr,16);
-	
-	return sp;
+	return messageType(array.GetData(), array.Num());
 }
 
 
 /*! The datagrams message type */
 int Datagram::messageType() const
 {
-	std::string header = m_header;
-	std::string type = header.substr(4, header.size()-4);
-	int sp = std::stoi (type,nullptr,16);
-
-	return sp;
+	return m_type;
 }
 
 /*! Set the type of the message */
 void Datagram::setType(StreamingProtocol proto)
 {
-	std::stringstream hexSS;
-	hexSS.width(2);
-	hexSS.fill('0');
-	hexSS << std::hex << proto;
-	m_header = "MXTP" +  hexSS.str();
+	m_type = proto;
 }
 
-/*! Deserializes the datagram from given byte array \a arr.
+/*! Deserializes the datagram in place from the \a size bytes at \a data.
+	No copy of the buffer is made, and the datagram reuses its own storage between calls.
 */
-bool Datagram::deserialize(const TArray<uint8_t>& arr)
+bool Datagram::deserialize(const uint8_t* data, int32 size)
 {
-	//UE_LOG(LogTemp, Warning, TEXT("Packet received"));
-	Streamer streamer(arr);
-	std::string messageType;
+	Streamer streamer(data, size);
+	if (!streamer.canRead(HEADER_SIZE))
+		return false;
 
 	// extract only the byte for the header (24 bytes)
-	streamer.read(messageType,6);		// 6 bytes
+	streamer.skip(6);					// 6 bytes, id string already checked by messageType
 	streamer.read(m_sampleCounter);		// 4 bytes
 	streamer.read(m_dgramCounter);		// 1 bytes
 	streamer.read(m_dataCount);			// 1 bytes
@@ -93,13 +108,19 @@ bool Datagram::deserialize(const TArray<uint8_t>& arr)
 	streamer.read(m_bodySegmentCount);              // 1 byte, introduced in MVN 2019 / 2018.3 beta
 	streamer.read(m_propCount);                     // 1 byte, introduced in MVN 2019 / 2018.3 beta
 	streamer.read(m_fingerTrackingSegmentCount);    // 1 byte, introduced in MVN 2019 / 2018.3 beta
-	std::string string = std::string();
-	streamer.read(string, 4);		// remove other 7 bytes
+	streamer.skip(4);					// reserved bytes
+
+	m_dataSize = streamer.remaining();
 
 	// deserialize the data part of the Packet
-	deserializeData(streamer);
+	return deserializeData(streamer);
+}
 
-	return true;
+/*! Deserializes the datagram from given byte array \a arr.
+*/
+bool Datagram::deserialize(const TArray<uint8_t>& arr)
+{
+	return deserialize(arr.GetData(), arr.Num());
 }
 
 void Datagram::printHeader() const
@@ -201,37 +222,30 @@ int32_t Datagram::frameTime() const
 	return m_frameTime;
 }
 
-/*! Map the StreamingProtocol names to a user friendly version
-*/
-void Datagram::initMap(std::map<int, std::string> &map)
-{
-	map[SPPoseEuler] = "Position + Orientation (Euler)";
-	map[SPPoseQuaternion] = "Position + Orientation (Quaternion)";
-	map[SPPosePositions] = "Virtual Optical Marker Set";
-	map[SPJackProcessSimulate] = "Siemens Tecnomatix";
-	map[SPPoseUnity3D] = "Unity 3D";
-
-	map[SPMetaMoreMeta] = "Character Meta Data";
-	map[SPMetaScaling] = "Scaling Data";
-
-	map[SPJointAngles] = "Joint Angles";
-	map[SPLinearSegmentKinematics] = "Linear Segment Kinematics";
-	map[SPAngularSegmentKinematics] = "Angular Segment Kinematics";
-	map[SPTrackerKinematics] = "Tracker Kinematics";
-	map[SPCenterOfMass] = "Center of Mass";
-	map[SPTimeCode] = "Time Code";
-}
-
 /*! Convert the StreamingProtocol to user frindly string name
 */
-std::string Datagram::decode(StreamingProtocol proto) const
+const char* Datagram::decode(StreamingProtocol proto)
 {
-	if(m_packetsName.find(proto) != m_packetsName.end())
+	switch (proto)
 	{
-		//element found;
-		return m_packetsName.find(proto)->second;
+		case SPPoseEuler:					return "Position + Orientation (Euler)";
+		case SPPoseQuaternion:				return "Position + Orientation (Quaternion)";
+		case SPPosePositions:				return "Virtual Optical Marker Set";
+		case SPJackProcessSimulate:			return "Siemens Tecnomatix";
+		case SPPoseUnity3D:					return "Unity 3D";
+
+		case SPMetaMoreMeta:				return "Character Meta Data";
+		case SPMetaScaling:					return "Scaling Data";
+
+		case SPJointAngles:					return "Joint Angles";
+		case SPLinearSegmentKinematics:		return "Linear Segment Kinematics";
+		case SPAngularSegmentKinematics:	return "Angular Segment Kinematics";
+		case SPTrackerKinematics:			return "Tracker Kinematics";
+		case SPCenterOfMass:				return "Center of Mass";
+		case SPTimeCode:					return "Time Code";
+
+		default:							return "";
 	}
-	return std::string();	
 }
 
 void Datagram::convertFromYupToZup(float *vector) const
@@ -0,0 +1,144 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "DatagramWriter.h"
+
+// byte offsets of the header fields, see Datagram::deserialize
+static const int OFFSET_SAMPLE_COUNTER = 6;
+static const int OFFSET_DATAGRAM_COUNTER = 10;
+static const int OFFSET_ITEM_COUNT = 11;
+
+static const uint8_t LAST_FRAGMENT_FLAG = 0x80;
+
+DatagramWriter::DatagramWriter(TArray<uint8_t>& out)
+	: m_out(out)
+{
+}
+
+/*! Append a int32_t as 4 bytes, most significant first */
+void DatagramWriter::write(int32_t value)
+{
+	const uint32_t bits = (uint32_t)value;
+	m_out.Add((uint8_t)(bits >> 24));
+	m_out.Add((uint8_t)(bits >> 16));
+	m_out.Add((uint8_t)(bits >> 8));
+	m_out.Add((uint8_t)bits);
+}
+
+void DatagramWriter::write(uint8_t value)
+{
+	m_out.Add(value);
+}
+
+/*! Append the bits of a float like a int32_t */
+void DatagramWriter::write(float value)
+{
+	int32_t bits;
+	FMemory::Memcpy(&bits, &value, sizeof(bits));
+	write(bits);
+}
+
+void DatagramWriter::writeChars(const char* text, int numChars)
+{
+	m_out.Append((const uint8_t*)text, numChars);
+}
+
+void DatagramWriter::writeHeader(StreamingProtocol proto, int32_t sampleCounter, uint8_t datagramCounter, uint8_t itemCount, int32_t frameTime,
+	uint8_t avatarId, uint8_t bodySegmentCount, uint8_t propCount, uint8_t fingerTrackingSegmentCount)
+{
+	static const char hexDigits[] = "0123456789ABCDEF";
+
+	writeChars("MXTP", 4);
+	write((uint8_t)hexDigits[(proto >> 4) & 0xF]);
+	write((uint8_t)hexDigits[proto & 0xF]);
+	write(sampleCounter);
+	write(datagramCounter);
+	write(itemCount);
+	write(frameTime);
+	write(avatarId);
+	write(bodySegmentCount);
+	write(propCount);
+	write(fingerTrackingSegmentCount);
+	m_out.AddZeroed(4);					// reserved bytes
+}
+
+void DatagramWriter::writeQuaternionSegment(int32_t segmentId, const float position[3], const float rotation[4])
+{
+	write(segmentId);
+	for (int k = 0; k < 3; k++)
+		write(position[k]);
+	for (int k = 0; k < 4; k++)
+		write(rotation[k]);
+}
+
+void DatagramWriter::writeScaleSegment(const char* segmentName, const float origin[3])
+{
+	const int nameLength = (int)FCStringAnsi::Strlen(segmentName);
+	write((int32_t)nameLength);
+	writeChars(segmentName, nameLength);
+	for (int k = 0; k < 3; k++)
+		write(origin[k]);
+}
+
+void DatagramWriter::writeMetaText(const char* text, int numChars)
+{
+	write((int32_t)numChars);
+	writeChars(text, numChars);
+}
+
+/*! Written as "HH:MM:SS.mmm", what TimeCodeDatagram reads */
+void DatagramWriter::writeTimeCode(int hours, int minutes, int seconds, int milliseconds)
+{
+	char text[16];
+	FCStringAnsi::Snprintf(text, sizeof(text), "%02d:%02d:%02d.%03d", hours % 100, minutes % 100, seconds % 100, milliseconds % 1000);
+	writeChars(text, 12);
+}
+
+void DatagramWriter::patchSampleCounter(uint8_t* datagram, int32_t sampleCounter)
+{
+	const uint32_t bits = (uint32_t)sampleCounter;
+	datagram[OFFSET_SAMPLE_COUNTER] = (uint8_t)(bits >> 24);
+	datagram[OFFSET_SAMPLE_COUNTER + 1] = (uint8_t)(bits >> 16);
+	datagram[OFFSET_SAMPLE_COUNTER + 2] = (uint8_t)(bits >> 8);
+	datagram[OFFSET_SAMPLE_COUNTER + 3] = (uint8_t)bits;
+}
+
+int DatagramWriter::fragment(const uint8_t* data, int32 size, int itemSize, int maxPacketSize, TArray<TArray<uint8_t>>& outPackets)
+{
+	const int headerSize = Datagram::HEADER_SIZE;
+	const int itemsPerPacket = itemSize > 0 ? (maxPacketSize - headerSize) / itemSize : 0;
+	const int itemCount = itemSize > 0 ? (size - headerSize) / itemSize : 0;
+	if (size <= maxPacketSize)
+	{
+		outPackets.SetNum(1, false);
+		outPackets[0].Reset();
+		outPackets[0].Append(data, size);
+		return 1;
+	}
+	if (itemsPerPacket <= 0)
+	{
+		outPackets.Reset();
+		return 0;
+	}
+
+	const int packetCount = (itemCount + itemsPerPacket - 1) / itemsPerPacket;
+	if (packetCount > 0x7F)
+	{
+		outPackets.Reset();
+		return 0;
+	}
+
+	outPackets.SetNum(packetCount, false);
+	for (int i = 0; i < packetCount; ++i)
+	{
+		const int firstItem = i * itemsPerPacket;
+		const int packetItems = FMath::Min(itemsPerPacket, itemCount - firstItem);
+
+		TArray<uint8_t>& packet = outPackets[i];
+		packet.Reset();
+		packet.Append(data, headerSize);
+		packet.Append(data + headerSize + firstItem * itemSize, packetItems * itemSize);
+		packet[OFFSET_DATAGRAM_COUNTER] = (uint8_t)i | (i == packetCount - 1 ? LAST_FRAGMENT_FLAG : 0);
+		packet[OFFSET_ITEM_COUNT] = (uint8_t)packetItems;
+	}
+	return packetCount;
+}
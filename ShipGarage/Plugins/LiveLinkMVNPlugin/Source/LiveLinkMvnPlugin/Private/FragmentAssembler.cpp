@@ -0,0 +1,281 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "FragmentAssembler.h"
+#include "Datagram.h"
+
+// byte offsets of the header fields, see Datagram::deserialize
+static const int OFFSET_TYPE = 4;
+static const int OFFSET_SAMPLE_COUNTER = 6;
+static const int OFFSET_DATAGRAM_COUNTER = 10;
+static const int OFFSET_ITEM_COUNT = 11;
+static const int OFFSET_AVATAR_ID = 16;
+
+static const uint8_t LAST_FRAGMENT_FLAG = 0x80;
+
+static int32_t readSampleCounter(const uint8_t* data)
+{
+	const uint8_t* p = data + OFFSET_SAMPLE_COUNTER;
+	return (int32_t)((uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3]);
+}
+
+FragmentAssembler::FragmentAssembler(int slotCount, int slotCapacity, double timeoutSeconds)
+	: m_slotCapacity(slotCapacity)
+	, m_timeout(timeoutSeconds)
+{
+	m_slots.SetNum(FMath::Max(1, slotCount));
+	for (Slot& slot : m_slots)
+	{
+		slot.payload.SetNumUninitialized(m_slotCapacity);
+	}
+	m_output.Reserve(Datagram::HEADER_SIZE + m_slotCapacity);
+}
+
+/*! Destructor */
+FragmentAssembler::~FragmentAssembler()
+{
+}
+
+bool FragmentAssembler::add(const uint8_t* data, int32 size, const FIPv4Endpoint& sender, int32 portIndex, double now, const uint8_t*& outData, int32& outSize)
+{
+	outData = nullptr;
+	outSize = 0;
+
+	if (data == nullptr || size < Datagram::HEADER_SIZE)
+	{
+		return false;
+	}
+
+	const uint8_t datagramCounter = data[OFFSET_DATAGRAM_COUNTER];
+	if (datagramCounter == LAST_FRAGMENT_FLAG)
+	{
+		// the usual case: the whole sample fits into one datagram
+		outData = data;
+		outSize = size;
+		return true;
+	}
+
+	m_fragmentsReceived.Increment();
+	expire(now);
+
+	const int index = datagramCounter & ~LAST_FRAGMENT_FLAG;
+	const bool isLast = (datagramCounter & LAST_FRAGMENT_FLAG) != 0;
+	const int32_t sampleCounter = readSampleCounter(data);
+	const int payloadSize = size - Datagram::HEADER_SIZE;
+
+	if (index >= MAX_FRAGMENTS || payloadSize > m_slotCapacity)
+	{
+		m_droppedFragments.Increment();
+		return false;
+	}
+
+	Slot* slot = findSlot(data, sampleCounter, sender, portIndex);
+	if (slot == nullptr)
+	{
+		slot = claimSlot(now);
+		slot->used = true;
+		slot->completed = false;
+		slot->sender = sender;
+		slot->portIndex = portIndex;
+		slot->messageType[0] = data[OFFSET_TYPE];
+		slot->messageType[1] = data[OFFSET_TYPE + 1];
+		slot->avatarId = data[OFFSET_AVATAR_ID];
+		slot->sampleCounter = sampleCounter;
+		slot->firstArrival = now;
+		slot->receivedMask = 0;
+		slot->lastIndex = -1;
+		slot->hasHeader = false;
+		slot->usedBytes = 0;
+		m_pendingSamples.Increment();
+	}
+	else if (slot->completed || (slot->receivedMask & (1u << index)) != 0)
+	{
+		// duplicate, or a late copy of a sample that was already delivered
+		m_droppedFragments.Increment();
+		return false;
+	}
+
+	if (slot->usedBytes + payloadSize > m_slotCapacity)
+	{
+		m_droppedFragments.Increment();
+		release(*slot, true);
+		return false;
+	}
+
+	FMemory::Memcpy(slot->payload.GetData() + slot->usedBytes, data + Datagram::HEADER_SIZE, payloadSize);
+	slot->fragmentOffset[index] = slot->usedBytes;
+	slot->fragmentSize[index] = payloadSize;
+	slot->fragmentItems[index] = data[OFFSET_ITEM_COUNT];
+	slot->usedBytes += payloadSize;
+	slot->receivedMask |= (1u << index);
+
+	if (index == 0 || !slot->hasHeader)
+	{
+		FMemory::Memcpy(slot->header, data, Datagram::HEADER_SIZE);
+		slot->hasHeader = true;
+	}
+
+	if (isLast)
+	{
+		slot->lastIndex = index;
+	}
+
+	if (slot->lastIndex < 0)
+	{
+		return false;
+	}
+
+	const uint32_t expectedMask = (slot->lastIndex == 31) ? 0xFFFFFFFFu : ((1u << (slot->lastIndex + 1)) - 1);
+	if ((slot->receivedMask & expectedMask) != expectedMask)
+	{
+		return false;
+	}
+
+	if (!join(*slot))
+	{
+		m_droppedFragments.Increment();
+		release(*slot, true);
+		return false;
+	}
+
+	// keep the key around so late duplicates are recognized, the slot is reused first
+	slot->completed = true;
+	m_pendingSamples.Decrement();
+	m_reassembledSamples.Increment();
+
+	outData = m_output.GetData();
+	outSize = m_output.Num();
+	return true;
+}
+
+void FragmentAssembler::expire(double now)
+{
+	for (Slot& slot : m_slots)
+	{
+		if (slot.used && !slot.completed && now - slot.firstArrival > m_timeout)
+		{
+			release(slot, true);
+		}
+	}
+}
+
+void FragmentAssembler::reset()
+{
+	for (Slot& slot : m_slots)
+	{
+		if (slot.used && !slot.completed)
+		{
+			m_pendingSamples.Decrement();
+		}
+		slot.used = false;
+		slot.completed = false;
+	}
+}
+
+FragmentAssembler::Stats FragmentAssembler::getStats() const
+{
+	Stats stats;
+	stats.fragmentsReceived = m_fragmentsReceived.GetValue();
+	stats.reassembledSamples = m_reassembledSamples.GetValue();
+	stats.droppedFragments = m_droppedFragments.GetValue();
+	stats.incompleteSamples = m_incompleteSamples.GetValue();
+	stats.pendingSamples = m_pendingSamples.GetValue();
+	return stats;
+}
+
+void FragmentAssembler::setTimeout(double timeoutSeconds)
+{
+	m_timeout = timeoutSeconds;
+}
+
+FragmentAssembler::Slot* FragmentAssembler::findSlot(const uint8_t* data, int32_t sampleCounter, const FIPv4Endpoint& sender, int32 portIndex)
+{
+	for (Slot& slot : m_slots)
+	{
+		if (slot.used
+			&& slot.sampleCounter == sampleCounter
+			&& slot.portIndex == portIndex
+			&& slot.sender == sender
+			&& slot.avatarId == data[OFFSET_AVATAR_ID]
+			&& slot.messageType[0] == data[OFFSET_TYPE]
+			&& slot.messageType[1] == data[OFFSET_TYPE + 1])
+		{
+			return &slot;
+		}
+	}
+	return nullptr;
+}
+
+/*! Find a slot for a new sample: a free one, else a completed one, else evict the oldest pending sample */
+FragmentAssembler::Slot* FragmentAssembler::claimSlot(double now)
+{
+	Slot* completed = nullptr;
+	Slot* oldest = nullptr;
+	for (Slot& slot : m_slots)
+	{
+		if (!slot.used)
+		{
+			return &slot;
+		}
+		if (slot.completed)
+		{
+			if (completed == nullptr || slot.firstArrival < completed->firstArrival)
+			{
+				completed = &slot;
+			}
+		}
+		else if (oldest == nullptr || slot.firstArrival < oldest->firstArrival)
+		{
+			oldest = &slot;
+		}
+	}
+
+	if (completed != nullptr)
+	{
+		completed->used = false;
+		return completed;
+	}
+
+	release(*oldest, true);
+	return oldest;
+}
+
+void FragmentAssembler::release(Slot& slot, bool countIncomplete)
+{
+	if (slot.used && !slot.completed)
+	{
+		m_pendingSamples.Decrement();
+		if (countIncomplete)
+		{
+			m_incompleteSamples.Increment();
+		}
+	}
+	slot.used = false;
+	slot.completed = false;
+}
+
+/*! Write the joined datagram: the first header, with the summed item count, followed by the payloads in fragment order */
+bool FragmentAssembler::join(Slot& slot)
+{
+	int itemCount = 0;
+	for (int i = 0; i <= slot.lastIndex; ++i)
+	{
+		itemCount += slot.fragmentItems[i];
+	}
+
+	// the joined datagram has to fit the 8 bit item count of the header
+	if (itemCount > 255)
+	{
+		return false;
+	}
+
+	m_output.Reset();
+	m_output.Append(slot.header, Datagram::HEADER_SIZE);
+	m_output[OFFSET_DATAGRAM_COUNTER] = LAST_FRAGMENT_FLAG;
+	m_output[OFFSET_ITEM_COUNT] = (uint8_t)itemCount;
+
+	for (int i = 0; i <= slot.lastIndex; ++i)
+	{
+		m_output.Append(slot.payload.GetData() + slot.fragmentOffset[i], slot.fragmentSize[i]);
+	}
+	return true;
+}
@@ -0,0 +1,77 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "JointAnglesDatagram.h"
+
+/*! \class JointAnglesDatagram
+  \brief a joint angle datagram (type 20)
+
+  Information about each joint is sent as follows.
+
+  4 bytes point ID of the parent segment connection, 256 * segment ID + point ID
+  4 bytes point ID of the child segment connection, 256 * segment ID + point ID
+  12 bytes rotation around x, y and z in degrees
+
+  Total: 20 bytes per joint
+
+  The angles are expressed in the ISB convention of each joint.
+ */
+
+/*! Constructor */
+JointAnglesDatagram::JointAnglesDatagram()
+	: Datagram()
+{
+	setType(SPJointAngles);
+
+	// the datagram is reused for every packet, so reserve for the largest item count once
+	m_data.reserve(JOINT_CAPACITY);
+}
+
+/*! Destructor */
+JointAnglesDatagram::~JointAnglesDatagram()
+{}
+
+/*! Deserialize the data from \a arr
+	The previous content is overwritten, the storage reserved in the constructor is kept.
+	\sa serializeData
+*/
+bool JointAnglesDatagram::deserializeData(Streamer &inputStreamer)
+{
+	Streamer* streamer = &inputStreamer;
+
+	m_data.clear();
+	if (!streamer->canRead(dataCount() * JOINT_SIZE))
+		return false;
+
+	for (int i = 0; i < dataCount(); i++)
+	{
+		m_data.emplace_back();
+		Joint& item = m_data.back();
+
+		// 4 bytes point ID of the parent segment connection, 256 * segment ID + point ID
+		streamer->read(item.parentConnection);
+
+		// 4 bytes point ID of the child segment connection, 256 * segment ID + point ID
+		streamer->read(item.childConnection);
+
+		// 12 bytes rotation around x, y and z in degrees
+		for (int k = 0; k < 3; k++)
+			streamer->read(item.rotation[k]);
+	}
+	return true;
+}
+
+/*! Print Data datagram in a formated why
+*/
+void JointAnglesDatagram::printData() const
+{
+	std::cout << "*********************** DATA CONTENT ***********************" <<  std::endl <<  std::endl;
+
+	for (int i = 0; i < (int)m_data.size(); i++)
+	{
+		const Joint& item = m_data.at(i);
+		std::cout << "Parent Connection: " << item.parentConnection << std::endl;
+		std::cout << "Child Connection: " << item.childConnection << std::endl;
+		std::cout << "Rotation: (" << item.rotation[0] << ", " << item.rotation[1] << ", " << item.rotation[2] << ")" << std::endl;
+		std::cout << std::endl;
+	}
+}
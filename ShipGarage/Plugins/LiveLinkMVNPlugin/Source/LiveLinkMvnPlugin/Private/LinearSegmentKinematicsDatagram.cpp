@@ -0,0 +1,84 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "LinearSegmentKinematicsDatagram.h"
+
+/*! \class LinearSegmentKinematicsDatagram
+  \brief a linear segment kinematics datagram (type 21)
+
+  Information about each segment is sent as follows.
+
+  4 bytes segment ID
+  12 bytes segment origin position in m
+  12 bytes velocity in m/s
+  12 bytes acceleration in m/s2
+
+  Total: 40 bytes per segment
+
+  The coordinates use a Z-Up, right-handed coordinate system.
+ */
+
+/*! Constructor */
+LinearSegmentKinematicsDatagram::LinearSegmentKinematicsDatagram()
+	: Datagram()
+{
+	setType(SPLinearSegmentKinematics);
+
+	// the datagram is reused for every packet, so reserve for the largest item count once
+	m_data.reserve(SEGMENT_CAPACITY);
+}
+
+/*! Destructor */
+LinearSegmentKinematicsDatagram::~LinearSegmentKinematicsDatagram()
+{}
+
+/*! Deserialize the data from \a arr
+	The previous content is overwritten, the storage reserved in the constructor is kept.
+	\sa serializeData
+*/
+bool LinearSegmentKinematicsDatagram::deserializeData(Streamer &inputStreamer)
+{
+	Streamer* streamer = &inputStreamer;
+
+	m_data.clear();
+	if (!streamer->canRead(dataCount() * SEGMENT_SIZE))
+		return false;
+
+	for (int i = 0; i < dataCount(); i++)
+	{
+		m_data.emplace_back();
+		Kinematics& item = m_data.back();
+
+		// 4 bytes segment ID
+		streamer->read(item.segmentId);
+
+		// 12 bytes segment origin position in m
+		for (int k = 0; k < 3; k++)
+			streamer->read(item.segmentPos[k]);
+
+		// 12 bytes velocity in m/s
+		for (int k = 0; k < 3; k++)
+			streamer->read(item.velocity[k]);
+
+		// 12 bytes acceleration in m/s2
+		for (int k = 0; k < 3; k++)
+			streamer->read(item.acceleration[k]);
+	}
+	return true;
+}
+
+/*! Print Data datagram in a formated why
+*/
+void LinearSegmentKinematicsDatagram::printData() const
+{
+	std::cout << "*********************** DATA CONTENT ***********************" <<  std::endl <<  std::endl;
+
+	for (int i = 0; i < (int)m_data.size(); i++)
+	{
+		const Kinematics& item = m_data.at(i);
+		std::cout << "Segment ID: " << item.segmentId << std::endl;
+		std::cout << "Position: (" << item.segmentPos[0] << ", " << item.segmentPos[1] << ", " << item.segmentPos[2] << ")" << std::endl;
+		std::cout << "Velocity: (" << item.velocity[0] << ", " << item.velocity[1] << ", " << item.velocity[2] << ")" << std::endl;
+		std::cout << "Acceleration: (" << item.acceleration[0] << ", " << item.acceleration[1] << ", " << item.acceleration[2] << ")" << std::endl;
+		std::cout << std::endl;
+	}
+}
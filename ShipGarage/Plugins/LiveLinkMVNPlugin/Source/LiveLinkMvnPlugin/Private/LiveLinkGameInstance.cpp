@@ -5,7 +5,6 @@
 #include "Features/IModularFeatures.h"
 #include "LiveLinkClient.h"
 #include "LiveLinkMvnSource.h"
-#include "..\Public\LiveLinkGameInstance.h"
 
 static ULiveLinkGameInstance* LLInstance;
 
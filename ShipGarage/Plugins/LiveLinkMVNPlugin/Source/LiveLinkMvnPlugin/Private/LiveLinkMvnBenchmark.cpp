@@ -0,0 +1,1186 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+// Micro benchmarks for the MVN receive path, run from the console:
+//   mvn.Bench.Decode [Packets] [Segments]
+//   mvn.Bench.Actors [MaxActors] [SamplesPerActor]
+//   mvn.Bench.SegmentKernel [Poses] [Segments]
+//   mvn.Bench.RemoteControlIdle [Sessions] [Seconds]
+//   mvn.Bench.ClockSync [DelayMs] [JitterMs] [Seconds]
+//   mvn.Bench.RemoteControlParse [Iterations] [PayloadFile]
+//   mvn.Bench.Replay CaptureFile [Passes]
+//   mvn.Bench.Prediction CaptureFile [HorizonMs...]
+//   mvn.Bench.LodResume [Seconds]
+//   mvn.Bench.RetargetBatch [Subjects] [CharactersPerSubject] [Segments] [Frames]
+//   mvn.Bench.RetargetParity [SkeletalMesh] [Subjects] [CharactersPerSubject] [Frames]
+
+#include "CoreMinimal.h"
+#include "Animation/Skeleton.h"
+#include "Async/ParallelFor.h"
+#include "BonePose.h"
+#include "Containers/Ticker.h"
+#include "Engine/SkeletalMesh.h"
+#include "Features/IModularFeatures.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "FastXml.h"
+#include "ILiveLinkClient.h"
+#include "ILiveLinkSource.h"
+#include "LiveLinkSourceSettings.h"
+#include "UObject/Package.h"
+
+#include "ParserManager.h"
+#include "QuaternionDatagram.h"
+#include "DatagramWriter.h"
+#include "LiveLinkMvnRetargetAsset.h"
+#include "LiveLinkMvnSource.h"
+#include "MvnAllocationCounter.h"
+#include "MvnCaptureFile.h"
+#include "MvnClockSync.h"
+#include "MvnMockServer.h"
+#include "MvnRemoteControlScheduler.h"
+#include "MvnRetargetScheduler.h"
+#include "MvnRemoteControlSession.h"
+#include "MvnRemoteControlSessionUtil.h"
+#include "MvnSegmentKernel.h"
+#include "MvnSubjectUpdatePolicy.h"
+#include "SegmentInformation.h"
+#include "Roles/LiveLinkAnimationRole.h"
+#include "Roles/LiveLinkAnimationTypes.h"
+
+namespace LiveLinkMvnBenchmark
+{
+	/** Allocations per call for the log, or a hint how to get them counted */
+	static FString FormatAllocationsPerCall(int64 Allocations, int64 Calls)
+	{
+		if (Allocations < 0)
+		{
+			return TEXT("? (start with -MvnCountAllocations)");
+		}
+		return FString::Printf(TEXT("%.3f"), Calls > 0 ? (double)Allocations / Calls : 0.0);
+	}
+
+	/** Build a single quaternion pose datagram (type 02) holding SegmentCount segments */
+	static void BuildQuaternionDatagram(TArray<uint8>& Out, int32 SampleCounter, uint8 AvatarId, int32 SegmentCount)
+	{
+		Out.Reset();
+		DatagramWriter Writer(Out);
+		// time code in ms at 240 Hz
+		Writer.writeHeader(SPPoseQuaternion, SampleCounter, 0x80, (uint8)SegmentCount, SampleCounter * 4, AvatarId,
+			(uint8)FMath::Min(SegmentCount, 23), 0, (uint8)FMath::Max(SegmentCount - 23, 0));
+
+		for (int32 Segment = 0; Segment < SegmentCount; ++Segment)
+		{
+			const FQuat Rot(FVector::UpVector, 0.001f * (SampleCounter + Segment));
+			const float Position[3] = { 0.01f * Segment, 0.02f * Segment, 1.0f };
+			const float Rotation[4] = { (float)Rot.W, (float)Rot.X, (float)Rot.Y, (float)Rot.Z };
+			Writer.writeQuaternionSegment(Segment + 1, Position, Rotation);
+		}
+	}
+
+	static void RunDecodeBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumPackets = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100000;
+		const int32 NumSegments = Args.Num() > 1 ? FMath::Clamp(FCString::Atoi(*Args[1]), 1, 255) : 67;
+
+		TArray<uint8> Packet;
+		BuildQuaternionDatagram(Packet, 0, 0, NumSegments);
+
+		ParserManager Parser;
+
+		// warm up, lets the parser reserve its storage
+		Parser.readDatagram(Packet.GetData(), Packet.Num());
+
+		int64 Decoded = 0;
+		FMvnAllocationCounter AllocationCounter;
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 i = 0; i < NumPackets; ++i)
+		{
+			Datagram* Dgram = Parser.readDatagram(Packet.GetData(), Packet.Num());
+			if (Dgram != nullptr)
+			{
+				Decoded += static_cast<QuaternionDatagram*>(Dgram)->m_data.size();
+			}
+		}
+		const uint64 EndCycles = FPlatformTime::Cycles64();
+		const int64 Allocations = AllocationCounter.GetAllocations();
+
+		const double Seconds = FPlatformTime::ToSeconds64(EndCycles - StartCycles);
+		const double NsPerSegment = Decoded > 0 ? Seconds * 1.0e9 / Decoded : 0.0;
+
+		UE_LOG(LogTemp, Display, TEXT("mvn.Bench.Decode: %d packets x %d segments, %s allocations/packet, %.2f ns/segment, %.2f us/packet"),
+			NumPackets, NumSegments, *FormatAllocationsPerCall(Allocations, NumPackets), NsPerSegment, Seconds * 1.0e6 / NumPackets);
+	}
+
+	/** Feed a source without client from a growing number of actors and report the cost per actor sample */
+	static void RunActorsBenchmark(const TArray<FString>& Args)
+	{
+		const int32 MaxActors = Args.Num() > 0 ? FMath::Clamp(FCString::Atoi(*Args[0]), 1, 1024) : 32;
+		const int32 NumSamples = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 2000;
+
+		// like a crowd capture: several MVN instances, each streaming a few avatars
+		static const int32 AvatarsPerSender = 4;
+
+		double BaseNsPerSample = 0.0;
+		for (int32 NumActors = 1; NumActors <= MaxActors; NumActors *= 2)
+		{
+			TSharedRef<FLiveLinkMvnSource> Source = MakeShared<FLiveLinkMvnSource>(0, false);
+
+			TArray<TArray<uint8>> Packets;
+			TArray<FIPv4Endpoint> Senders;
+			Packets.SetNum(NumActors);
+			for (int32 Actor = 0; Actor < NumActors; ++Actor)
+			{
+				BuildQuaternionDatagram(Packets[Actor], 0, (uint8)(Actor % AvatarsPerSender), 23);
+				Senders.Add(FIPv4Endpoint(FIPv4Address(192, 168, 0, (uint8)(1 + Actor / AvatarsPerSender)), 9763));
+			}
+
+			// warm up, creates the actors
+			for (int32 Actor = 0; Actor < NumActors; ++Actor)
+			{
+				Source->Recv(Packets[Actor].GetData(), Packets[Actor].Num(), Senders[Actor], FPlatformTime::Seconds());
+			}
+
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			for (int32 Sample = 1; Sample <= NumSamples; ++Sample)
+			{
+				const double Now = FPlatformTime::Seconds();
+				for (int32 Actor = 0; Actor < NumActors; ++Actor)
+				{
+					DatagramWriter::patchSampleCounter(Packets[Actor].GetData(), Sample);
+					Source->Recv(Packets[Actor].GetData(), Packets[Actor].Num(), Senders[Actor], Now);
+				}
+			}
+			const uint64 EndCycles = FPlatformTime::Cycles64();
+
+			const double NsPerSample = FPlatformTime::ToSeconds64(EndCycles - StartCycles) * 1.0e9 / ((double)NumSamples * NumActors);
+			if (NumActors == 1)
+			{
+				BaseNsPerSample = NsPerSample;
+			}
+
+			UE_LOG(LogTemp, Display, TEXT("mvn.Bench.Actors: %4d actors (%d senders), %8.1f ns/actor sample, %.2fx the single actor cost"),
+				Source->GetActorCount(), (NumActors + AvatarsPerSender - 1) / AvatarsPerSender, NsPerSample, BaseNsPerSample > 0.0 ? NsPerSample / BaseNsPerSample : 1.0);
+		}
+	}
+	/** Random segments of a quaternion datagram, rotations slightly off unit length like after float transport */
+	static void MakeRandomSegments(FRandomStream& Random, int32 NumSegments, std::vector<QuaternionDatagram::Kinematics>& Out)
+	{
+		Out.resize(NumSegments);
+		for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+		{
+			QuaternionDatagram::Kinematics& Kin = Out[Segment];
+			Kin.segmentId = Segment + 1;
+			Kin.sensorPos[0] = Random.FRandRange(-2.0f, 2.0f);
+			Kin.sensorPos[1] = Random.FRandRange(-2.0f, 2.0f);
+			Kin.sensorPos[2] = Random.FRandRange(0.0f, 2.0f);
+
+			const FQuat Rot(Random.GetUnitVector(), Random.FRandRange(-PI, PI));
+			const float Length = Random.FRandRange(0.999f, 1.001f);
+			Kin.quatRotation[0] = (float)(Rot.W * Length);
+			Kin.quatRotation[1] = (float)(Rot.X * Length);
+			Kin.quatRotation[2] = (float)(Rot.Y * Length);
+			Kin.quatRotation[3] = (float)(Rot.Z * Length);
+		}
+	}
+
+	/** A retarget plan shaped like a full body: MVN parents, a T-pose on most segments and a few pass through ones */
+	static void MakeRandomRetargetPlan(FRandomStream& Random, int32 NumSegments, FMvnRetargetKernelPlan& Plan)
+	{
+		Plan.Reset(NumSegments);
+		Plan.ForwardFix = FQuat(FVector::UpVector, -PI / 2.0f);
+		for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+		{
+			Plan.Tpose.SetQuat(Segment, FQuat(Random.GetUnitVector(), Random.FRandRange(-PI, PI)));
+			Plan.CombinedWorld[Segment] = Random.FRand() < 0.8f ? 1.0f : 0.0f;
+			if (Segment > 0)
+			{
+				const int32 MvnParent = SegmentInformation::parentIndex.IsValidIndex(Segment) ? SegmentInformation::parentIndex[Segment] : INDEX_NONE;
+				Plan.Parent[Segment] = (MvnParent >= 0 && MvnParent < Segment) ? MvnParent : Random.RandRange(0, Segment - 1);
+			}
+		}
+	}
+
+	/** Largest component difference of the first Num elements, relative for values above 1 */
+	static float MaxError(const FMvnSegmentSoA& A, const FMvnSegmentSoA& B, bool bHasW)
+	{
+		float Error = 0.0f;
+		for (int32 Index = 0; Index < A.Num(); ++Index)
+		{
+			Error = FMath::Max(Error, FMath::Abs(A.X[Index] - B.X[Index]) / FMath::Max(1.0f, FMath::Abs(B.X[Index])));
+			Error = FMath::Max(Error, FMath::Abs(A.Y[Index] - B.Y[Index]) / FMath::Max(1.0f, FMath::Abs(B.Y[Index])));
+			Error = FMath::Max(Error, FMath::Abs(A.Z[Index] - B.Z[Index]) / FMath::Max(1.0f, FMath::Abs(B.Z[Index])));
+			if (bHasW)
+			{
+				Error = FMath::Max(Error, FMath::Abs(A.W[Index] - B.W[Index]));
+			}
+		}
+		return Error;
+	}
+
+	/** Segments per microsecond of Kernel run NumPoses times */
+	template<typename KernelType>
+	static double MeasureSegmentsPerUs(int32 NumPoses, int32 NumSegments, KernelType&& Kernel)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 PoseIdx = 0; PoseIdx < NumPoses; ++PoseIdx)
+		{
+			Kernel();
+		}
+		const double Seconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+		return Seconds > 0.0 ? (double)NumPoses * NumSegments / (Seconds * 1.0e6) : 0.0;
+	}
+
+	/** Check the batched segment conversion and retarget against the scalar code and compare their throughput */
+	static void RunSegmentKernelBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumPoses = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 20000;
+		const int32 NumSegments = Args.Num() > 1 ? FMath::Clamp(FCString::Atoi(*Args[1]), 1, 255) : 67;
+
+		// float batch math against the engine's FQuat, well below what a retargeted pose can show
+		static const float Tolerance = 1.0e-5f;
+
+		FRandomStream Random(9763);
+		std::vector<QuaternionDatagram::Kinematics> Segments;
+		MakeRandomSegments(Random, NumSegments, Segments);
+		FMvnRetargetKernelPlan Plan;
+		MakeRandomRetargetPlan(Random, NumSegments, Plan);
+
+		FMvnSegmentSoA ScalarPositions, ScalarRotations, BatchPositions, BatchRotations;
+		MvnSegmentKernel::ConvertSegmentsScalar(Segments.data(), NumSegments, ScalarPositions, ScalarRotations);
+		MvnSegmentKernel::ConvertSegments(Segments.data(), NumSegments, BatchPositions, BatchRotations);
+		const float ConvertError = FMath::Max(MaxError(BatchPositions, ScalarPositions, false), MaxError(BatchRotations, ScalarRotations, true));
+
+		FMvnSegmentSoA ScalarWorld, ScalarLocal, BatchWorld, BatchLocal;
+		MvnSegmentKernel::RetargetSegmentsScalar(ScalarRotations, Plan, ScalarWorld, ScalarLocal);
+		MvnSegmentKernel::RetargetSegments(ScalarRotations, Plan, BatchWorld, BatchLocal);
+		const float RetargetError = FMath::Max(MaxError(BatchWorld, ScalarWorld, true), MaxError(BatchLocal, ScalarLocal, true));
+
+		const bool bPassed = ConvertError <= Tolerance && RetargetError <= Tolerance;
+		if (bPassed)
+		{
+			UE_LOG(LogTemp, Display, TEXT("mvn.Bench.SegmentKernel: batch matches scalar, max error convert %.2e, retarget %.2e"), ConvertError, RetargetError);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.SegmentKernel: batch differs from scalar, max error convert %.2e, retarget %.2e, tolerance %.2e"), ConvertError, RetargetError, Tolerance);
+		}
+
+		const double ConvertScalar = MeasureSegmentsPerUs(NumPoses, NumSegments, [&]() { MvnSegmentKernel::ConvertSegmentsScalar(Segments.data(), NumSegments, ScalarPositions, ScalarRotations); });
+		const double ConvertBatch = MeasureSegmentsPerUs(NumPoses, NumSegments, [&]() { MvnSegmentKernel::ConvertSegments(Segments.data(), NumSegments, BatchPositions, BatchRotations); });
+		const double RetargetScalar = MeasureSegmentsPerUs(NumPoses, NumSegments, [&]() { MvnSegmentKernel::RetargetSegmentsScalar(ScalarRotations, Plan, ScalarWorld, ScalarLocal); });
+		const double RetargetBatch = MeasureSegmentsPerUs(NumPoses, NumSegments, [&]() { MvnSegmentKernel::RetargetSegments(ScalarRotations, Plan, BatchWorld, BatchLocal); });
+
+		UE_LOG(LogTemp, Display, TEXT("mvn.Bench.SegmentKernel: %d poses x %d segments, convert %.1f -> %.1f segments/us, retarget %.1f -> %.1f segments/us (scalar -> batch)"),
+			NumPoses, NumSegments, ConvertScalar, ConvertBatch, RetargetScalar, RetargetBatch);
+	}
+
+	/** Idle remote control sessions towards a port nobody answers on, the scheduler should only wake for its polls */
+	static void RunRemoteControlIdleBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumSessions = Args.Num() > 0 ? FMath::Clamp(FCString::Atoi(*Args[0]), 1, 64) : 8;
+		const float Seconds = Args.Num() > 1 ? FMath::Clamp(FCString::Atof(*Args[1]), 1.0f, 60.0f) : 5.0f;
+
+		MvnRemoteControlScheduler Scheduler;
+		TArray<MvnRemoteControlSession*> Sessions;
+		for (int32 Index = 0; Index < NumSessions; ++Index)
+		{
+			MvnRemoteControlSession* Session = new MvnRemoteControlSession(FIPv4Address(127, 0, 0, 1), 6004 + Index, &Scheduler);
+			Scheduler.AddSession(Session);
+			Sessions.Add(Session);
+		}
+
+		const uint64 StartWakeCount = Scheduler.GetWakeCount();
+		const double StartTime = FPlatformTime::Seconds();
+		FPlatformProcess::Sleep(Seconds);
+		const double Elapsed = FPlatformTime::Seconds() - StartTime;
+		const uint64 WakeCount = Scheduler.GetWakeCount() - StartWakeCount;
+
+		for (MvnRemoteControlSession* Session : Sessions)
+		{
+			Scheduler.RemoveSession(Session);
+			delete Session;
+		}
+
+		// session status every 100 ms and the time sync every second, independent of the number of sessions. Nobody answers
+		// the clock sync, it stops after its first few exchanges
+		UE_LOG(LogTemp, Display, TEXT("mvn.Bench.RemoteControlIdle: %d sessions, %.1f scheduler wake ups/s (11 to 13 expected)"),
+			NumSessions, WakeCount / Elapsed);
+	}
+
+	/** Synchronize a remote control session with the mock server and compare the estimated clock with the mock's */
+	static void RunClockSyncBenchmark(const TArray<FString>& Args)
+	{
+		const double Delay = (Args.Num() > 0 ? FMath::Clamp(FCString::Atod(*Args[0]), 0.0, 200.0) : 5.0) / 1000.0;
+		const double Jitter = (Args.Num() > 1 ? FMath::Clamp(FCString::Atod(*Args[1]), 0.0, 100.0) : 2.0) / 1000.0;
+		const float Seconds = Args.Num() > 2 ? FMath::Clamp(FCString::Atof(*Args[2]), 1.0f, 120.0f) : 10.0f;
+
+		// a server clock around noon that gains 50 us per second
+		const double TrueDrift = 50.0e-6;
+		const double TrueOffset = 12.0 * 3600.0 + 0.123456 - FPlatformTime::Seconds() * (1.0 + TrueDrift);
+		const int32 Port = 6200;
+
+		IConsoleVariable* IntervalVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("mvn.RemoteControl.ClockSyncInterval"));
+		const float SavedInterval = IntervalVariable->GetFloat();
+		IntervalVariable->Set(0.05f);
+
+		// remote control only
+		FMvnMockServerSettings Settings;
+		Settings.PoseTarget.Port = 0;
+		Settings.RemoteControlPort = Port;
+		Settings.ClockOffset = TrueOffset;
+		Settings.ClockDrift = TrueDrift;
+		Settings.ResponseDelay = (float)Delay;
+		Settings.ResponseJitter = (float)Jitter;
+		Settings.Seed = 1234;
+		FMvnMockServer Server(Settings);
+		check(Server.IsRunning());
+		MvnRemoteControlScheduler Scheduler;
+		MvnRemoteControlSession* Session = new MvnRemoteControlSession(FIPv4Address(127, 0, 0, 1), Port, &Scheduler);
+		Scheduler.AddSession(Session);
+
+		FPlatformProcess::Sleep(Seconds);
+
+		const double Now = FPlatformTime::Seconds();
+		const FMvnClockSync& ClockSync = Session->GetClockSync();
+		const bool bValid = ClockSync.IsValid();
+		const double Error = ClockSync.GetOffset(Now) - (Server.ServerTime(Now) - Now);
+		const double Drift = ClockSync.GetDrift();
+		const double RoundTrip = ClockSync.GetRoundTrip();
+		const int32 NumExchanges = ClockSync.GetNumExchanges();
+
+		Scheduler.RemoveSession(Session);
+		delete Session;
+		IntervalVariable->Set(SavedInterval);
+
+		const double Tolerance = 0.001;
+		if (bValid && FMath::Abs(Error) < Tolerance)
+		{
+			UE_LOG(LogTemp, Display, TEXT("mvn.Bench.ClockSync: %d exchanges, delay %.1f ms jitter %.1f ms, shortest round trip %.3f ms, offset error %.1f us, drift %.1f ppm (%.1f ppm true)"),
+				NumExchanges, Delay * 1000.0, Jitter * 1000.0, RoundTrip * 1000.0, Error * 1.0e6, Drift * 1.0e6, TrueDrift * 1.0e6);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.ClockSync: %s after %d exchanges, offset error %.1f us, tolerance %.1f us"),
+				bValid ? TEXT("offset outside tolerance") : TEXT("no estimate"), NumExchanges, Error * 1.0e6, Tolerance * 1.0e6);
+		}
+	}
+
+	/** Attributes of the response element the way the remote control read them through FastXml before */
+	class FReferenceXmlCallback : public IFastXmlCallback
+	{
+	public:
+		TMap<FString, FString> Attributes;
+		FString Element;
+
+	private:
+		virtual bool ProcessXmlDeclaration(const TCHAR* ElementData, int32 XmlFileLineNumber) override { return true; }
+		virtual bool ProcessElement(const TCHAR* ElementName, const TCHAR* ElementData, int32 XmlFileLineNumber) override
+		{
+			++Level;
+			if (Level == 1)
+			{
+				Element = ElementName;
+			}
+			return true;
+		}
+		virtual bool ProcessAttribute(const TCHAR* AttributeName, const TCHAR* AttributeValue) override
+		{
+			if (Level == 1)
+			{
+				const FString Value = FString(AttributeValue).Replace(TEXT("&amp;"), TEXT("&"))
+					.Replace(TEXT("&quot;"), TEXT("\""))
+					.Replace(TEXT("&apos;"), TEXT("'"))
+					.Replace(TEXT("&lt;"), TEXT("<"))
+					.Replace(TEXT("&gt;"), TEXT(">"));
+				Attributes.Add(AttributeName, Value);
+			}
+			return true;
+		}
+		virtual bool ProcessClose(const TCHAR* Element) override { --Level; return true; }
+		virtual bool ProcessComment(const TCHAR* Comment) override { return true; }
+
+		int32 Level = 0;
+	};
+
+	static bool ParseReference(const TArray<uint8>& Payload, FReferenceXmlCallback& Callback)
+	{
+		FUTF8ToTCHAR Converted((const ANSICHAR*)Payload.GetData(), Payload.Num());
+		FString Xml(Converted.Length(), Converted.Get());
+		FText Error;
+		int32 ErrorLine = 0;
+		Callback.Attributes.Reset();
+		return FFastXml::ParseXmlFile(&Callback, nullptr, Xml.GetCharArray().GetData(), nullptr, false, false, Error, ErrorLine);
+	}
+
+	/** True if the decoded response holds what the reference parse found */
+	static bool MatchesReference(const MvnRemoteControlResponse& Response, const FReferenceXmlCallback& Reference)
+	{
+		auto StringMatches = [&Reference](const TCHAR* Key, const FString& Value, bool bHas)
+		{
+			const FString* Found = Reference.Attributes.Find(Key);
+			return Found ? (bHas && Found->Equals(Value, ESearchCase::CaseSensitive)) : !bHas;
+		};
+		auto BoolMatches = [&Reference](const TCHAR* Key, bool Value, bool bHas)
+		{
+			const FString* Found = Reference.Attributes.Find(Key);
+			return Found ? (bHas && Found->Equals(TEXT("true"), ESearchCase::IgnoreCase) == Value) : !bHas;
+		};
+
+		return MvnRemoteControlSessionUtil::GetMatchingMesssageCommand(*Reference.Element) == Response.m_Command
+			&& BoolMatches(TEXT("Result"), Response.m_bResult, Reference.Attributes.Contains(TEXT("Result")))
+			&& StringMatches(TEXT("SessionName"), Response.m_strSessionName, Response.Has(eMvnRemoteControlResponseField::SessionName))
+			&& StringMatches(TEXT("recordingTrial"), Response.m_strRecordingTrial, Response.Has(eMvnRemoteControlResponseField::RecordingTrial))
+			&& BoolMatches(TEXT("isRecording"), Response.m_bIsRecording, Response.Has(eMvnRemoteControlResponseField::IsRecording))
+			&& BoolMatches(TEXT("isPaused"), Response.m_bIsPaused, Response.Has(eMvnRemoteControlResponseField::IsPaused))
+			&& BoolMatches(TEXT("isLive"), Response.m_bIsLive, Response.Has(eMvnRemoteControlResponseField::IsLive));
+	}
+
+	/** Decode recorded SessionInfo and SessionStatus responses with the pull parser and with FastXml */
+	static void RunRemoteControlParseBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumIterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100000;
+
+		// one response per line, as captured from MVN; a few typical ones when no file is given
+		TArray<FString> Lines;
+		if (Args.Num() > 1 && !FFileHelper::LoadFileToStringArray(Lines, *Args[1]))
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.RemoteControlParse: can't read %s"), *Args[1]);
+			return;
+		}
+		if (Lines.Num() == 0)
+		{
+			Lines.Add(TEXT("<SessionInfoAck Result=\"true\" SessionName=\"Stage A &amp; B\" recordingTrial=\"Take_014\"/>"));
+			Lines.Add(TEXT("<SessionStatusAck Result=\"true\" isRecording=\"false\" isPaused=\"false\" isLive=\"true\"/>"));
+			Lines.Add(TEXT("<SessionStatusAck Result=\"true\" isRecording=\"true\" isPaused=\"false\" isLive=\"true\"/>"));
+			Lines.Add(TEXT("<?xml version=\"1.0\" encoding=\"UTF-8\"?><SessionStatusAck Result=\"true\" isRecording=\"true\" isPaused=\"true\" isLive=\"false\"></SessionStatusAck>"));
+		}
+
+		Lines.RemoveAll([](const FString& Line) { return Line.TrimStartAndEnd().IsEmpty(); });
+		if (Lines.Num() == 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.RemoteControlParse: no responses in %s"), *Args[1]);
+			return;
+		}
+
+		TArray<TArray<uint8>> Payloads;
+		for (const FString& Line : Lines)
+		{
+			FTCHARToUTF8 Converted(*Line);
+			Payloads.Emplace((const uint8*)Converted.Get(), Converted.Length());
+		}
+
+		MvnRemoteControlResponse Response;
+		FReferenceXmlCallback Reference;
+		int32 NumMismatches = 0;
+		for (int32 Index = 0; Index < Payloads.Num(); ++Index)
+		{
+			const bool bDecoded = MvnRemoteControlSessionUtil::ParseResponse(Payloads[Index].GetData(), Payloads[Index].Num(), Response);
+			if (!ParseReference(Payloads[Index], Reference) || !bDecoded || !MatchesReference(Response, Reference))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("mvn.Bench.RemoteControlParse: decoded differently: %s"), *Lines[Index]);
+				++NumMismatches;
+			}
+		}
+
+		const int64 NumResponses = (int64)NumIterations * Payloads.Num();
+		FMvnAllocationCounter AllocationCounter;
+		uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			for (const TArray<uint8>& Payload : Payloads)
+			{
+				MvnRemoteControlSessionUtil::ParseResponse(Payload.GetData(), Payload.Num(), Response);
+			}
+		}
+		const double PullSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+		const int64 PullAllocations = AllocationCounter.GetAllocations();
+
+		StartCycles = FPlatformTime::Cycles64();
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			for (const TArray<uint8>& Payload : Payloads)
+			{
+				ParseReference(Payload, Reference);
+			}
+		}
+		const double ReferenceSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+		const int64 ReferenceAllocations = PullAllocations >= 0 ? AllocationCounter.GetAllocations() - PullAllocations : -1;
+
+		UE_LOG(LogTemp, Display, TEXT("mvn.Bench.RemoteControlParse: %d responses x %d, pull parser %.1f ns %s allocations/response, FastXml %.1f ns %s allocations/response"),
+			Payloads.Num(), NumIterations, PullSeconds * 1.0e9 / NumResponses, *FormatAllocationsPerCall(PullAllocations, NumResponses),
+			ReferenceSeconds * 1.0e9 / NumResponses, *FormatAllocationsPerCall(ReferenceAllocations, NumResponses));
+		if (NumMismatches > 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.RemoteControlParse: %d of %d responses decoded differently from FastXml"), NumMismatches, Payloads.Num());
+		}
+	}
+
+	/** Value at Fraction (0..1) of sorted Values */
+	static double Percentile(const TArray<double>& Values, double Fraction)
+	{
+		return Values.Num() > 0 ? Values[FMath::Min((int32)(Fraction * Values.Num()), Values.Num() - 1)] : 0.0;
+	}
+
+	/** All datagrams of a capture, false if there are none */
+	static bool ReadCapture(const FString& Filename, TArray<FMvnCaptureRecord>& OutRecords)
+	{
+		FMvnCaptureReader Reader;
+		if (Reader.Open(Filename))
+		{
+			FMvnCaptureRecord Record;
+			while (Reader.ReadNext(Record))
+			{
+				OutRecords.Add(Record);
+			}
+		}
+		return OutRecords.Num() > 0;
+	}
+
+	/** Feed a capture through a source as fast as possible, the same datagrams at the same receive times every pass */
+	static void RunReplayBenchmark(const TArray<FString>& Args)
+	{
+		if (Args.Num() < 1)
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.Replay: no capture file given"));
+			return;
+		}
+		const int32 NumPasses = Args.Num() > 1 ? FMath::Clamp(FCString::Atoi(*Args[1]), 1, 1000) : 5;
+
+		TArray<FMvnCaptureRecord> Records;
+		if (!ReadCapture(Args[0], Records))
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.Replay: no datagrams in %s"), *Args[0]);
+			return;
+		}
+
+		// a pose is complete with the last fragment of its quaternion datagram
+		int64 PosesPerPass = 0;
+		for (const FMvnCaptureRecord& Record : Records)
+		{
+			const TArray<uint8>& Data = Record.Data;
+			if (Data.Num() >= 24 && Data[4] == '0' && Data[5] == '2' && (Data[10] & 0x80) != 0)
+			{
+				++PosesPerPass;
+			}
+		}
+
+		// receive times from a fixed base, the jitter buffers release the same poses every pass
+		const double BaseTime = 1000.0;
+		TArray<double> Latencies;
+		Latencies.Reserve(Records.Num() * NumPasses);
+		double BestSeconds = TNumericLimits<double>::Max();
+		int32 NumActors = 0;
+
+		// one warm up pass, then the measured ones, each on a new source so all start from the same state
+		for (int32 Pass = 0; Pass <= NumPasses; ++Pass)
+		{
+			TSharedRef<FLiveLinkMvnSource> Source = MakeShared<FLiveLinkMvnSource>(0, false);
+
+			const uint64 PassStartCycles = FPlatformTime::Cycles64();
+			for (const FMvnCaptureRecord& Record : Records)
+			{
+				const uint64 StartCycles = FPlatformTime::Cycles64();
+				Source->Recv(Record.Data.GetData(), Record.Data.Num(), Record.Sender, BaseTime + Record.Time, Record.PortIndex);
+				if (Pass > 0)
+				{
+					Latencies.Add(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles));
+				}
+			}
+			const double PassSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - PassStartCycles);
+
+			if (Pass > 0)
+			{
+				BestSeconds = FMath::Min(BestSeconds, PassSeconds);
+			}
+			NumActors = Source->GetActorCount();
+		}
+
+		Latencies.Sort();
+		const double CaptureSeconds = Records.Last().Time;
+		UE_LOG(LogTemp, Display, TEXT("mvn.Bench.Replay: %d datagrams, %lld poses of %d actors over %.1f s, best of %d passes %.0f poses/s (%.0fx real time), per datagram p50 %.2f us p99 %.2f us max %.2f us"),
+			Records.Num(), PosesPerPass, NumActors, CaptureSeconds, NumPasses, PosesPerPass / BestSeconds, CaptureSeconds / BestSeconds,
+			Percentile(Latencies, 0.5) * 1.0e6, Percentile(Latencies, 0.99) * 1.0e6, Latencies.Last() * 1.0e6);
+	}
+
+	/** Source fed directly by the prediction benchmark, with the predictors of its actors in reach */
+	class FPredictionBenchSource : public FLiveLinkMvnSource
+	{
+	public:
+		explicit FPredictionBenchSource(const FMvnPredictionSettings& InPrediction)
+			: FLiveLinkMvnSource(0, false)
+		{
+			Prediction = InPrediction;
+		}
+
+		FMvnPredictionError TakeError()
+		{
+			FMvnPredictionError Error;
+			for (const TUniquePtr<FMvnActor>& Actor : m_actors)
+			{
+				Error.Append(Actor->Predictor.TakeError());
+			}
+			return Error;
+		}
+	};
+
+	/** Replay a capture with each prediction horizon and method and report the error against the recorded future samples */
+	static void RunPredictionBenchmark(const TArray<FString>& Args)
+	{
+		if (Args.Num() < 1)
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.Prediction: no capture file given"));
+			return;
+		}
+
+		TArray<FMvnCaptureRecord> Records;
+		if (!ReadCapture(Args[0], Records))
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.Prediction: no datagrams in %s"), *Args[0]);
+			return;
+		}
+
+		TArray<double> HorizonsMs;
+		for (int32 ArgIndex = 1; ArgIndex < Args.Num(); ++ArgIndex)
+		{
+			HorizonsMs.Add(FMath::Clamp(FCString::Atod(*Args[ArgIndex]), 0.0, 100.0));
+		}
+		if (HorizonsMs.Num() == 0)
+		{
+			HorizonsMs = { 5.0, 10.0, 20.0, 33.0, 50.0 };
+		}
+
+		const double BaseTime = 1000.0;
+		for (const double HorizonMs : HorizonsMs)
+		{
+			for (const bool bUseKinematics : { true, false })
+			{
+				FMvnPredictionSettings Settings;
+				Settings.Horizon = HorizonMs / 1000.0;
+				Settings.bUseKinematics = bUseKinematics;
+
+				TSharedRef<FPredictionBenchSource> Source = MakeShared<FPredictionBenchSource>(Settings);
+				for (const FMvnCaptureRecord& Record : Records)
+				{
+					Source->Recv(Record.Data.GetData(), Record.Data.Num(), Record.Sender, BaseTime + Record.Time, Record.PortIndex);
+				}
+
+				// without kinematics in the capture both methods fall back to finite differences
+				const FMvnPredictionError Error = Source->TakeError();
+				UE_LOG(LogTemp, Display, TEXT("mvn.Bench.Prediction: %5.1f ms %-11s %d poses, position %.2f cm (max %.2f), rotation %.2f deg (max %.2f)"),
+					HorizonMs, bUseKinematics ? TEXT("kinematics") : TEXT("differences"), Error.Count,
+					Error.PositionMean, Error.PositionMax, Error.RotationMean, Error.RotationMax);
+			}
+		}
+	}
+
+	/**
+	 * Walk a performer out of a camera's view until its subject pauses and back in, rating it the way the
+	 * policy rates a character whose bounds follow the pushed pose, and check it comes back to full rate
+	 */
+	static void RunLodResumeCheck(const TArray<FString>& Args)
+	{
+		const float Seconds = Args.Num() > 0 ? FMath::Clamp(FCString::Atof(*Args[0]), 1.0f, 60.0f) : 8.0f;
+
+		// camera at the origin looking along X with a 90 degree view, performer 1 m in radius walking at 1.5 m/s:
+		// in view for 2 s, out of view for Seconds, then straight back in
+		const FName SubjectName(TEXT("MvnLodResumeCheck"));
+		const TArray<FVector> ViewLocations = { FVector::ZeroVector };
+		const float DeltaSeconds = 1.0f / 60.0f;
+		const float Speed = 150.0f;
+		const float Radius = 100.0f;
+		auto PerformerAt = [Seconds, Speed](double Time)
+		{
+			const double Turn = 2.0 + Seconds / 2.0;
+			return FVector(400.0 - Speed * (Time < Turn ? Time : 2.0 * Turn - Time), 200.0, 0.0);
+		};
+		auto InView = [Radius](const FVector& Location)
+		{
+			return Location.X + Radius > FMath::Abs(Location.Y);
+		};
+
+		FMvnSubjectUpdatePolicy& Policy = FMvnSubjectUpdatePolicy::getInstance();
+		FVector Pushed = PerformerAt(0.0);
+		double LastRendered = 0.0;
+		double BackInView = -1.0;
+		double BackToFull = -1.0;
+		bool bPaused = false;
+		int32 PausedPushes = 0;
+		const double BaseTime = 1000.0;
+		for (int32 Frame = 0; Frame * DeltaSeconds < Seconds + 7.0f && BackToFull < 0.0; ++Frame)
+		{
+			const double Time = Frame * DeltaSeconds;
+
+			// the renderer only sees the pose last pushed
+			if (InView(Pushed))
+			{
+				LastRendered = Time;
+			}
+			const EMvnSubjectUpdateRate Rate = FMvnSubjectUpdatePolicy::RateView(FBoxSphereBounds(Pushed, FVector(Radius), Radius),
+				(float)(Time - LastRendered), DeltaSeconds, ViewLocations);
+			Policy.SetOverride(SubjectName, Rate);
+			Policy.UpdateRates();
+
+			const FVector Performer = PerformerAt(Time);
+			if (BackInView < 0.0 && bPaused && InView(Performer))
+			{
+				BackInView = Time;
+			}
+			if (bPaused && Rate == EMvnSubjectUpdateRate::Full)
+			{
+				BackToFull = Time;
+			}
+			bPaused |= Rate == EMvnSubjectUpdateRate::Paused;
+
+			if (Policy.ShouldPush(SubjectName, BaseTime + Time))
+			{
+				Pushed = Performer;
+				if (Rate == EMvnSubjectUpdateRate::Paused)
+				{
+					++PausedPushes;
+				}
+			}
+		}
+
+		Policy.ClearOverride(SubjectName);
+		Policy.UpdateRates();
+
+		// the next paused push brings the bounds into view, the frame after they are rendered
+		const double Tolerance = FMvnSubjectUpdatePolicy::GetPausedInterval() + 2.0 * DeltaSeconds;
+		if (!bPaused)
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.LodResume: the subject never paused in %.1f s out of view"), Seconds);
+		}
+		else if (BackToFull < 0.0 || BackInView < 0.0 || BackToFull - BackInView > Tolerance)
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.LodResume: the paused subject didn't come back to full rate within %.2f s of its performer coming into view"), Tolerance);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Display, TEXT("mvn.Bench.LodResume: %d pushes while paused, back to full rate %.2f s after coming into view"), PausedPushes, BackToFull - BackInView);
+		}
+	}
+
+	/** Kernel state of one retargeted character, like a ULiveLinkMvnRetargetAsset keeps it */
+	struct FBenchCharacter
+	{
+		FMvnRetargetKernelPlan Plan;
+		FMvnSegmentSoA Rotations;
+		FMvnSegmentSoA World;
+		FMvnSegmentSoA Local;
+
+		void Retarget(const FLiveLinkAnimationFrameData& FrameData)
+		{
+			Rotations.SetNum(Plan.Num());
+			for (int32 Segment = 0; Segment < Plan.Num(); ++Segment)
+			{
+				Rotations.SetQuat(Segment, Segment < FrameData.Transforms.Num() ? FrameData.Transforms[Segment].GetRotation() : FQuat::Identity);
+			}
+			MvnSegmentKernel::RetargetSegments(Rotations, Plan, World, Local);
+		}
+	};
+
+	/**
+	 * Retarget the characters of a crowd every frame, one after the other as the anim nodes did and in one ParallelFor
+	 * task per subject as FMvnRetargetScheduler does, and compare the frame times with the budget at 120 fps
+	 */
+	static void RunRetargetBatchBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumSubjects = Args.Num() > 0 ? FMath::Clamp(FCString::Atoi(*Args[0]), 1, 256) : 15;
+		const int32 CharactersPerSubject = Args.Num() > 1 ? FMath::Clamp(FCString::Atoi(*Args[1]), 1, 16) : 1;
+		const int32 NumSegments = Args.Num() > 2 ? FMath::Clamp(FCString::Atoi(*Args[2]), 1, 255) : 67;
+		const int32 NumFrames = Args.Num() > 3 ? FMath::Max(1, FCString::Atoi(*Args[3])) : 1200;
+
+		static const double FrameBudget = 1.0 / 120.0;
+
+		FRandomStream Random(9763);
+		TArray<FLiveLinkAnimationFrameData> SubjectFrames;
+		SubjectFrames.SetNum(NumSubjects);
+		TArray<TArray<FBenchCharacter>> Characters;
+		Characters.SetNum(NumSubjects);
+		for (int32 Subject = 0; Subject < NumSubjects; ++Subject)
+		{
+			SubjectFrames[Subject].Transforms.SetNum(NumSegments);
+			Characters[Subject].SetNum(CharactersPerSubject);
+			for (FBenchCharacter& Character : Characters[Subject])
+			{
+				MakeRandomRetargetPlan(Random, NumSegments, Character.Plan);
+			}
+		}
+
+		// a new pose for every subject each frame, as the Live Link client evaluates them
+		auto UpdateFrames = [&](int32 Frame)
+		{
+			for (int32 Subject = 0; Subject < NumSubjects; ++Subject)
+			{
+				FLiveLinkAnimationFrameData& FrameData = SubjectFrames[Subject];
+				FrameData.WorldTime = FLiveLinkWorldTime(Frame / 120.0);
+				for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+				{
+					FrameData.Transforms[Segment].SetRotation(FQuat(FVector::UpVector, 0.01f * (Frame + Subject + Segment)));
+				}
+			}
+		};
+
+		auto MeasureFrames = [&](bool bBatch, double& OutMean, double& OutWorst)
+		{
+			double Total = 0.0;
+			OutWorst = 0.0;
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				UpdateFrames(Frame);
+				const uint64 StartCycles = FPlatformTime::Cycles64();
+				if (bBatch)
+				{
+					ParallelFor(NumSubjects, [&](int32 Subject)
+					{
+						for (FBenchCharacter& Character : Characters[Subject])
+						{
+							Character.Retarget(SubjectFrames[Subject]);
+						}
+					});
+				}
+				else
+				{
+					for (int32 Subject = 0; Subject < NumSubjects; ++Subject)
+					{
+						for (FBenchCharacter& Character : Characters[Subject])
+						{
+							Character.Retarget(SubjectFrames[Subject]);
+						}
+					}
+				}
+				const double Seconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+				Total += Seconds;
+				OutWorst = FMath::Max(OutWorst, Seconds);
+			}
+			OutMean = Total / NumFrames;
+		};
+
+		double SerialMean, SerialWorst, BatchMean, BatchWorst;
+		MeasureFrames(false, SerialMean, SerialWorst);
+		MeasureFrames(true, BatchMean, BatchWorst);
+
+		UE_LOG(LogTemp, Display, TEXT("mvn.Bench.RetargetBatch: %d subjects x %d characters x %d segments, %d frames, serial %.3f ms (worst %.3f), batch %.3f ms (worst %.3f), %.1f%% of the 120 fps frame budget"),
+			NumSubjects, CharactersPerSubject, NumSegments, NumFrames, SerialMean * 1.0e3, SerialWorst * 1.0e3, BatchMean * 1.0e3, BatchWorst * 1.0e3,
+			BatchMean / FrameBudget * 100.0);
+		if (BatchWorst > FrameBudget)
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.RetargetBatch: the slowest batch took %.3f ms, longer than a whole frame at 120 fps"), BatchWorst * 1.0e3);
+		}
+	}
+
+	/** Source the parity check pushes its subjects through, it streams nothing itself */
+	class FBenchLiveLinkSource : public ILiveLinkSource
+	{
+	public:
+		virtual void ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid) override {}
+		virtual bool IsSourceStillValid() const override { return true; }
+		virtual bool RequestSourceShutdown() override { return true; }
+		virtual FText GetSourceType() const override { return FText::FromString(TEXT("MVN retarget parity check")); }
+		virtual FText GetSourceMachineName() const override { return FText::GetEmpty(); }
+		virtual FText GetSourceStatus() const override { return FText::GetEmpty(); }
+	};
+
+	/**
+	 * State of a running parity check. Every character has a scheduled asset, batched by FMvnRetargetScheduler under
+	 * its subject, and a reference asset no scheduler knows the subject of, which retargets during the evaluation
+	 * exactly as every asset does with mvn.Retarget.Batch 0
+	 */
+	struct FRetargetParityCheck
+	{
+		ILiveLinkClient* Client = nullptr;
+		FGuid SourceGuid;
+		TArray<FLiveLinkSubjectName> Subjects;
+		int32 NumBones = 0;
+		int32 CharactersPerSubject = 0;
+		int32 NumFrames = 0;
+
+		// character Subject * CharactersPerSubject + Index of each
+		TArray<ULiveLinkMvnRetargetAsset*> ScheduledAssets;
+		TArray<ULiveLinkMvnRetargetAsset*> ReferenceAssets;
+		FBoneContainer BoneContainer;
+
+		int32 Frame = 0;
+		int32 ComparedPoses = 0;
+		int32 MismatchedPoses = 0;
+		int32 UnpreparedPoses = 0;
+		int32 MissingFrames = 0;
+		float MaxTranslationError = 0.f;
+		float MaxRotationError = 0.f;
+	};
+
+	/** A new pose for every subject of Check, with every segment turning */
+	static void PushParityFrames(FRetargetParityCheck& Check)
+	{
+		for (int32 Subject = 0; Subject < Check.Subjects.Num(); ++Subject)
+		{
+			FLiveLinkFrameDataStruct FrameData(FLiveLinkAnimationFrameData::StaticStruct());
+			FLiveLinkAnimationFrameData& AnimFrameData = *FrameData.Cast<FLiveLinkAnimationFrameData>();
+			AnimFrameData.WorldTime = FLiveLinkWorldTime(FPlatformTime::Seconds());
+			AnimFrameData.Transforms.Add(FTransform::Identity);
+			for (int32 Segment = 1; Segment < Check.NumBones; ++Segment)
+			{
+				const FVector Axis = FVector(FMath::Sin(Segment + Subject), FMath::Cos(Segment), 1.0f).GetSafeNormal();
+				const FQuat Rotation(Axis, 0.02f * (Check.Frame + Segment) + 0.3f * Subject);
+				AnimFrameData.Transforms.Add(FTransform(Rotation, FVector(0.0f, 0.0f, 10.0f * Segment)));
+			}
+			Check.Client->PushSubjectFrameData_AnyThread(FLiveLinkSubjectKey(Check.SourceGuid, Check.Subjects[Subject]), MoveTemp(FrameData));
+		}
+	}
+
+	/** Compare the poses of the scheduled and reference assets of every character, once per engine frame */
+	static bool TickRetargetParityCheck(float DeltaTime, TSharedRef<FRetargetParityCheck> CheckRef)
+	{
+		FRetargetParityCheck& Check = *CheckRef;
+
+		// the frames pushed last tick are in the client's snapshot of this one. A ticking world prepared the
+		// batch already, without one it is prepared here
+		if (Check.Frame > 0)
+		{
+			FMvnRetargetScheduler::getInstance().PrepareFrame();
+
+			FMemMark Mark(FMemStack::Get());
+			FCompactPose ScheduledPose;
+			FCompactPose ReferencePose;
+			ScheduledPose.SetBoneContainer(&Check.BoneContainer);
+			ReferencePose.SetBoneContainer(&Check.BoneContainer);
+
+			for (int32 Subject = 0; Subject < Check.Subjects.Num(); ++Subject)
+			{
+				FLiveLinkSubjectFrameData SubjectFrame;
+				if (!Check.Client->EvaluateFrame_AnyThread(Check.Subjects[Subject], ULiveLinkAnimationRole::StaticClass(), SubjectFrame))
+				{
+					++Check.MissingFrames;
+					continue;
+				}
+				const FLiveLinkSkeletonStaticData* StaticData = SubjectFrame.StaticData.Cast<FLiveLinkSkeletonStaticData>();
+				const FLiveLinkAnimationFrameData* FrameData = SubjectFrame.FrameData.Cast<FLiveLinkAnimationFrameData>();
+				if (StaticData == nullptr || FrameData == nullptr)
+				{
+					++Check.MissingFrames;
+					continue;
+				}
+
+				for (int32 Index = 0; Index < Check.CharactersPerSubject; ++Index)
+				{
+					const int32 Character = Subject * Check.CharactersPerSubject + Index;
+					ULiveLinkMvnRetargetAsset* Scheduled = Check.ScheduledAssets[Character];
+
+					// the first evaluation builds the plan the batch needs, from the next frame on it is prepared
+					if (Check.Frame > 2 && !Scheduled->IsPreparedFrame(*FrameData))
+					{
+						++Check.UnpreparedPoses;
+					}
+
+					ScheduledPose.ResetToRefPose();
+					ReferencePose.ResetToRefPose();
+					Scheduled->BuildPoseFromAnimationData(DeltaTime, StaticData, FrameData, ScheduledPose);
+					Check.ReferenceAssets[Character]->BuildPoseFromAnimationData(DeltaTime, StaticData, FrameData, ReferencePose);
+
+					bool bMismatched = false;
+					for (const FCompactPoseBoneIndex BoneIndex : ScheduledPose.ForEachBoneIndex())
+					{
+						const FTransform& A = ScheduledPose[BoneIndex];
+						const FTransform& B = ReferencePose[BoneIndex];
+						const float TranslationError = (float)(A.GetTranslation() - B.GetTranslation()).Size();
+						const float RotationError = FMath::RadiansToDegrees((float)A.GetRotation().AngularDistance(B.GetRotation()));
+						Check.MaxTranslationError = FMath::Max(Check.MaxTranslationError, TranslationError);
+						Check.MaxRotationError = FMath::Max(Check.MaxRotationError, RotationError);
+						bMismatched |= !(TranslationError <= KINDA_SMALL_NUMBER && RotationError <= KINDA_SMALL_NUMBER);
+					}
+					++Check.ComparedPoses;
+					Check.MismatchedPoses += bMismatched ? 1 : 0;
+				}
+			}
+		}
+
+		if (Check.Frame < Check.NumFrames)
+		{
+			PushParityFrames(Check);
+			++Check.Frame;
+			return true;
+		}
+
+		Check.Client->RemoveSource(Check.SourceGuid);
+		for (ULiveLinkMvnRetargetAsset* Asset : Check.ScheduledAssets)
+		{
+			FMvnRetargetScheduler::getInstance().Unregister(Asset);
+			Asset->RemoveFromRoot();
+		}
+		for (ULiveLinkMvnRetargetAsset* Asset : Check.ReferenceAssets)
+		{
+			FMvnRetargetScheduler::getInstance().Unregister(Asset);
+			Asset->RemoveFromRoot();
+		}
+
+		const int32 NumCharacters = Check.ScheduledAssets.Num();
+		if (Check.ComparedPoses == 0 || Check.MissingFrames > 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.RetargetParity: the Live Link client had no frame for %d of %d subject evaluations"),
+				Check.MissingFrames, Check.Subjects.Num() * Check.NumFrames);
+		}
+		else if (Check.MismatchedPoses > 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.RetargetParity: %d of %d scheduled poses differ from retargeting during the evaluation, by up to %.4f cm and %.4f deg"),
+				Check.MismatchedPoses, Check.ComparedPoses, Check.MaxTranslationError, Check.MaxRotationError);
+		}
+		else if (Check.UnpreparedPoses > 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.RetargetParity: the poses match, but the scheduler didn't prepare %d of %d evaluations"),
+				Check.UnpreparedPoses, FMath::Max(Check.NumFrames - 2, 0) * NumCharacters);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Display, TEXT("mvn.Bench.RetargetParity: %d subjects x %d characters, %d poses, scheduled and evaluation retarget match (max %.6f cm, %.6f deg)"),
+				Check.Subjects.Num(), Check.CharactersPerSubject, Check.ComparedPoses, Check.MaxTranslationError, Check.MaxRotationError);
+		}
+		return false;
+	}
+
+	/**
+	 * Push subjects through a Live Link source and retarget their frames to a skeletal mesh with real retarget assets,
+	 * batched by FMvnRetargetScheduler::PrepareFrame and on their own, and check both give the same poses
+	 */
+	static void RunRetargetParityCheck(const TArray<FString>& Args)
+	{
+		const FString MeshPath = Args.Num() > 0 ? Args[0] : TEXT("/Game/Mannequin/Character/Mesh/SK_Mannequin.SK_Mannequin");
+		const int32 NumSubjects = Args.Num() > 1 ? FMath::Clamp(FCString::Atoi(*Args[1]), 1, 64) : 4;
+		const int32 CharactersPerSubject = Args.Num() > 2 ? FMath::Clamp(FCString::Atoi(*Args[2]), 1, 16) : 2;
+		const int32 NumFrames = Args.Num() > 3 ? FMath::Max(4, FCString::Atoi(*Args[3])) : 120;
+
+		const IConsoleVariable* BatchVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("mvn.Retarget.Batch"));
+		if (BatchVariable == nullptr || BatchVariable->GetInt() == 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.RetargetParity: needs mvn.Retarget.Batch 1"));
+			return;
+		}
+
+		USkeletalMesh* Mesh = LoadObject<USkeletalMesh>(nullptr, *MeshPath);
+		if (Mesh == nullptr || Mesh->GetSkeleton() == nullptr)
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.RetargetParity: can't load the skeletal mesh %s"), *MeshPath);
+			return;
+		}
+
+		IModularFeatures& ModularFeatures = IModularFeatures::Get();
+		if (!ModularFeatures.IsModularFeatureAvailable(ILiveLinkClient::ModularFeatureName))
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Bench.RetargetParity: no Live Link client"));
+			return;
+		}
+
+		TSharedRef<FRetargetParityCheck> Check = MakeShared<FRetargetParityCheck>();
+		Check->Client = &ModularFeatures.GetModularFeature<ILiveLinkClient>(ILiveLinkClient::ModularFeatureName);
+		Check->CharactersPerSubject = CharactersPerSubject;
+		Check->NumFrames = NumFrames;
+
+		// every bone of the mesh, the compact pose is the whole reference skeleton
+		TArray<FBoneIndexType> RequiredBones;
+		for (int32 Bone = 0; Bone < Mesh->GetRefSkeleton().GetNum(); ++Bone)
+		{
+			RequiredBones.Add((FBoneIndexType)Bone);
+		}
+		Check->BoneContainer.InitializeTo(RequiredBones, FCurveEvaluationOption(false), *Mesh);
+
+		// evaluated to the frame pushed last, not interpolated between frames
+		Check->SourceGuid = Check->Client->AddSource(MakeShared<FBenchLiveLinkSource>());
+		if (ULiveLinkSourceSettings* Settings = Check->Client->GetSourceSettings(Check->SourceGuid))
+		{
+			Settings->Mode = ELiveLinkSourceMode::Latest;
+		}
+
+		// the root and the body segments, as MVN streams them without props and fingers
+		Check->NumBones = FMath::Min(24, SegmentInformation::SegmentBoneNames.Num());
+		for (int32 Subject = 0; Subject < NumSubjects; ++Subject)
+		{
+			const FLiveLinkSubjectName SubjectName(*FString::Printf(TEXT("MvnRetargetParity%d"), Subject));
+			Check->Subjects.Add(SubjectName);
+
+			FLiveLinkStaticDataStruct StaticData(FLiveLinkSkeletonStaticData::StaticStruct());
+			FLiveLinkSkeletonStaticData& Skeleton = *StaticData.Cast<FLiveLinkSkeletonStaticData>();
+			for (int32 Bone = 0; Bone < Check->NumBones; ++Bone)
+			{
+				Skeleton.BoneNames.Add(SegmentInformation::SegmentBoneNames[Bone]);
+				Skeleton.BoneParents.Add(SegmentInformation::parentIndex[Bone]);
+			}
+			Check->Client->PushSubjectStaticData_AnyThread(FLiveLinkSubjectKey(Check->SourceGuid, SubjectName), ULiveLinkAnimationRole::StaticClass(), MoveTemp(StaticData));
+
+			for (int32 Index = 0; Index < CharactersPerSubject; ++Index)
+			{
+				ULiveLinkMvnRetargetAsset* Scheduled = NewObject<ULiveLinkMvnRetargetAsset>(GetTransientPackage());
+				Scheduled->AddToRoot();
+				Scheduled->SetSkeleton(Mesh->GetSkeleton());
+				Scheduled->ScheduleForSubject(SubjectName);
+				Check->ScheduledAssets.Add(Scheduled);
+
+				ULiveLinkMvnRetargetAsset* Reference = NewObject<ULiveLinkMvnRetargetAsset>(GetTransientPackage());
+				Reference->AddToRoot();
+				Reference->SetSkeleton(Mesh->GetSkeleton());
+				Check->ReferenceAssets.Add(Reference);
+			}
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("mvn.Bench.RetargetParity: retargeting %d subjects x %d characters to %s over %d frames"),
+			NumSubjects, CharactersPerSubject, *Mesh->GetName(), NumFrames);
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&TickRetargetParityCheck, Check));
+	}
+}
+
+static FAutoConsoleCommand MvnBenchDecodeCommand(
+	TEXT("mvn.Bench.Decode"),
+	TEXT("Decode synthetic MVN quaternion datagrams and report allocations per packet, counted when started with -MvnCountAllocations, and ns per segment. Args: [Packets] [Segments]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnBenchmark::RunDecodeBenchmark));
+
+static FAutoConsoleCommand MvnBenchActorsCommand(
+	TEXT("mvn.Bench.Actors"),
+	TEXT("Feed a source from 1 up to MaxActors synthetic actors over several senders and report the cost per actor sample. Args: [MaxActors] [SamplesPerActor]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnBenchmark::RunActorsBenchmark));
+
+static FAutoConsoleCommand MvnBenchSegmentKernelCommand(
+	TEXT("mvn.Bench.SegmentKernel"),
+	TEXT("Check the batched segment conversion and retarget against the scalar code and report both in segments per microsecond. Args: [Poses] [Segments]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnBenchmark::RunSegmentKernelBenchmark));
+
+static FAutoConsoleCommand MvnBenchRemoteControlIdleCommand(
+	TEXT("mvn.Bench.RemoteControlIdle"),
+	TEXT("Run idle remote control sessions on one scheduler and report how often its thread wakes up. Args: [Sessions] [Seconds]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnBenchmark::RunRemoteControlIdleBenchmark));
+
+static FAutoConsoleCommand MvnBenchClockSyncCommand(
+	TEXT("mvn.Bench.ClockSync"),
+	TEXT("Synchronize a remote control session with a loopback mock server whose replies are delayed and check the estimated clock offset. Args: [DelayMs] [JitterMs] [Seconds]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnBenchmark::RunClockSyncBenchmark));
+
+static FAutoConsoleCommand MvnBenchRemoteControlParseCommand(
+	TEXT("mvn.Bench.RemoteControlParse"),
+	TEXT("Decode recorded remote control responses with the pull parser and with FastXml, check they agree and report ns and allocations per response, counted when started with -MvnCountAllocations. Args: [Iterations] [PayloadFile, one response per line]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnBenchmark::RunRemoteControlParseBenchmark));
+
+static FAutoConsoleCommand MvnBenchReplayCommand(
+	TEXT("mvn.Bench.Replay"),
+	TEXT("Decode, retarget and publish a capture as fast as possible and report poses per second and the decode latency percentiles per datagram. Args: CaptureFile [Passes]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnBenchmark::RunReplayBenchmark));
+
+static FAutoConsoleCommand MvnBenchPredictionCommand(
+	TEXT("mvn.Bench.Prediction"),
+	TEXT("Replay a capture with each prediction horizon, from the streamed kinematics and from finite differences, and report the error against the samples that arrived for the predicted time. Args: CaptureFile [HorizonMs...]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnBenchmark::RunPredictionBenchmark));
+
+static FAutoConsoleCommand MvnBenchLodResumeCommand(
+	TEXT("mvn.Bench.LodResume"),
+	TEXT("Walk a simulated performer out of view until its subject pauses and back in, and check the subject returns to full rate. Args: [Seconds out of view]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnBenchmark::RunLodResumeCheck));
+
+static FAutoConsoleCommand MvnBenchRetargetBatchCommand(
+	TEXT("mvn.Bench.RetargetBatch"),
+	TEXT("Retarget a crowd of characters every frame serially and in one parallel batch per subject, and report the frame times against the budget at 120 fps. Args: [Subjects] [CharactersPerSubject] [Segments] [Frames]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnBenchmark::RunRetargetBatchBenchmark));
+
+static FAutoConsoleCommand MvnBenchRetargetParityCommand(
+	TEXT("mvn.Bench.RetargetParity"),
+	TEXT("Retarget Live Link subjects to a skeletal mesh with retarget assets batched by the scheduler and with assets retargeting during the evaluation as with mvn.Retarget.Batch 0, over several engine frames, and check the poses match. Args: [SkeletalMesh] [Subjects] [CharactersPerSubject] [Frames]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnBenchmark::RunRetargetParityCheck));
@@ -1,79 +1,221 @@
 #include "LiveLinkMvnMetadataService.h"
+#include "Misc/ScopeLock.h"
 
 #define LOCTEXT_NAMESPACE "FLiveLinkMvnMetadataService"
 
-FLiveLinkMvnMetadataService& FLiveLinkMvnMetadataService::getInstance() 
+FLiveLinkMvnMetadataService& FLiveLinkMvnMetadataService::getInstance()
 {
 	static FLiveLinkMvnMetadataService instance;
 	return instance;
 }
 
 FLiveLinkMvnMetadataService::FLiveLinkMvnMetadataService()
+	: Current(new FSnapshot())
+	, ActiveReaders(0)
 {
 
 }
 
+FLiveLinkMvnMetadataService::~FLiveLinkMvnMetadataService()
+{
+	delete Current.load();
+	for (FSnapshot* Snapshot : Retired)
+	{
+		delete Snapshot;
+	}
+}
+
+FLiveLinkMvnMetadataService::FReadScope::FReadScope(const FLiveLinkMvnMetadataService& InService)
+	: Service(InService)
+{
+	// counted in before loading, a writer that replaces this snapshot afterwards sees the count and keeps it
+	Service.ActiveReaders.fetch_add(1);
+	Snapshot = Service.Current.load();
+}
+
+FLiveLinkMvnMetadataService::FReadScope::~FReadScope()
+{
+	Service.ActiveReaders.fetch_sub(1);
+}
+
+const FLiveLinkMvnMetadataService::FSubjectMetadata* FLiveLinkMvnMetadataService::Find(const FSnapshot& Snapshot, FGuid SourceId, const FLiveLinkSubjectName& AvatarId)
+{
+	const FSubjectMetadataRef* Subject = Snapshot.Subjects.Find(FLiveLinkSubjectKey(SourceId, AvatarId));
+	return Subject != nullptr ? &Subject->Get() : nullptr;
+}
+
 void FLiveLinkMvnMetadataService::SetSegmentNames(FGuid SourceId, const FLiveLinkSubjectName& AvatarId, const TArray<FString>& SegmentNames)
 {
-	TArray<FText> TextNames;
-	for (auto Name : SegmentNames)
+	auto NamesMatch = [&SegmentNames](const FSubjectMetadata* Existing)
 	{
-		TextNames.Add(FText::AsCultureInvariant(Name));
+		if (Existing == nullptr || Existing->SegmentNames.Num() != SegmentNames.Num())
+		{
+			return false;
+		}
+		for (int32 Index = 0; Index < SegmentNames.Num(); ++Index)
+		{
+			if (!Existing->SegmentNames[Index].ToString().Equals(SegmentNames[Index], ESearchCase::CaseSensitive))
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+
+	// MVN repeats the scale datagram, it rarely changes
+	{
+		FReadScope Read(*this);
+		if (NamesMatch(Find(Read.Get(), SourceId, AvatarId)))
+		{
+			return;
+		}
+	}
+
+	FScopeLock Lock(&WriteLock);
+
+	// writers hold the lock, the current snapshot can't be replaced under them
+	const FSubjectMetadata* Existing = Find(*Current.load(), SourceId, AvatarId);
+	if (NamesMatch(Existing))
+	{
+		return;
 	}
 
-	EnsureMetadata(SourceId, AvatarId);
-	Metadata[SourceId][AvatarId].SegmentNames = TextNames;
+	FSubjectMetadata Updated = Existing != nullptr ? *Existing : FSubjectMetadata();
+	Updated.SegmentNames.Reset(SegmentNames.Num());
+	for (const FString& Name : SegmentNames)
+	{
+		Updated.SegmentNames.Add(FText::AsCultureInvariant(Name));
+	}
+	PublishSubject(FLiveLinkSubjectKey(SourceId, AvatarId), MoveTemp(Updated));
 }
 
 void FLiveLinkMvnMetadataService::SetSegmentCount(FGuid SourceId, const FLiveLinkSubjectName& AvatarId, int SegmentsCount)
 {
-	EnsureMetadata(SourceId, AvatarId);
-	Metadata[SourceId][AvatarId].SegmentsCount = SegmentsCount;
+	{
+		FReadScope Read(*this);
+		const FSubjectMetadata* Existing = Find(Read.Get(), SourceId, AvatarId);
+		if (Existing != nullptr && Existing->SegmentsCount == SegmentsCount)
+		{
+			return;
+		}
+	}
+
+	FScopeLock Lock(&WriteLock);
+
+	const FSubjectMetadata* Existing = Find(*Current.load(), SourceId, AvatarId);
+	if (Existing != nullptr && Existing->SegmentsCount == SegmentsCount)
+	{
+		return;
+	}
+
+	FSubjectMetadata Updated = Existing != nullptr ? *Existing : FSubjectMetadata();
+	Updated.SegmentsCount = SegmentsCount;
+	PublishSubject(FLiveLinkSubjectKey(SourceId, AvatarId), MoveTemp(Updated));
+}
+
+void FLiveLinkMvnMetadataService::RemoveSubject(FGuid SourceId, const FLiveLinkSubjectName& AvatarId)
+{
+	{
+		FReadScope Read(*this);
+		if (Find(Read.Get(), SourceId, AvatarId) == nullptr)
+		{
+			return;
+		}
+	}
+
+	FScopeLock Lock(&WriteLock);
+
+	const FSnapshot& Snapshot = *Current.load();
+	const FLiveLinkSubjectKey Key(SourceId, AvatarId);
+	if (!Snapshot.Subjects.Contains(Key))
+	{
+		return;
+	}
+
+	FSnapshot* NewSnapshot = new FSnapshot(Snapshot);
+	NewSnapshot->Version = Snapshot.Version + 1;
+	NewSnapshot->Subjects.Remove(Key);
+	Publish(NewSnapshot);
 }
 
-int32 FLiveLinkMvnMetadataService::GetSegmentsCount(FGuid SourceId, const FLiveLinkSubjectName& AvatarId)
+void FLiveLinkMvnMetadataService::RemoveSource(FGuid SourceId)
 {
-	if (!HasSegmentNames(SourceId, AvatarId))
+	FScopeLock Lock(&WriteLock);
+
+	const FSnapshot& Snapshot = *Current.load();
+	FSnapshot* NewSnapshot = nullptr;
+	for (const TPair<FLiveLinkSubjectKey, FSubjectMetadataRef>& Subject : Snapshot.Subjects)
 	{
-		return 0;
+		if (Subject.Key.Source == SourceId)
+		{
+			if (NewSnapshot == nullptr)
+			{
+				NewSnapshot = new FSnapshot(Snapshot);
+				NewSnapshot->Version = Snapshot.Version + 1;
+			}
+			NewSnapshot->Subjects.Remove(Subject.Key);
+		}
+	}
+
+	if (NewSnapshot != nullptr)
+	{
+		Publish(NewSnapshot);
 	}
-	return Metadata[SourceId][AvatarId].SegmentsCount;
+}
 
+int32 FLiveLinkMvnMetadataService::GetSegmentsCount(FGuid SourceId, const FLiveLinkSubjectName& AvatarId) const
+{
+	FReadScope Read(*this);
+	const FSubjectMetadata* Subject = Find(Read.Get(), SourceId, AvatarId);
+	return Subject != nullptr ? Subject->SegmentsCount : 0;
 }
 
 bool FLiveLinkMvnMetadataService::GetSegmentNames(FGuid SourceId, const FLiveLinkSubjectName& AvatarId, TArray<FText>& OutSegmentNames) const
 {
-	if (!HasSegmentNames(SourceId, AvatarId))
+	FReadScope Read(*this);
+	const FSubjectMetadata* Subject = Find(Read.Get(), SourceId, AvatarId);
+	if (Subject == nullptr)
 	{
 		return false;
 	}
-	OutSegmentNames.Append(Metadata[SourceId][AvatarId].SegmentNames);
+	OutSegmentNames.Append(Subject->SegmentNames);
 	return true;
 }
 
 bool FLiveLinkMvnMetadataService::HasSegmentNames(FGuid SourceId, const FLiveLinkSubjectName& AvatarId) const
 {
-	return Metadata.Contains(SourceId) && Metadata[SourceId].Contains(AvatarId);
+	FReadScope Read(*this);
+	return Find(Read.Get(), SourceId, AvatarId) != nullptr;
+}
+
+int32 FLiveLinkMvnMetadataService::GetVersion() const
+{
+	FReadScope Read(*this);
+	return Read.Get().Version;
+}
+
+void FLiveLinkMvnMetadataService::PublishSubject(const FLiveLinkSubjectKey& Key, FSubjectMetadata&& Subject)
+{
+	const FSnapshot& Snapshot = *Current.load();
+	FSnapshot* NewSnapshot = new FSnapshot(Snapshot);
+	NewSnapshot->Version = Snapshot.Version + 1;
+	NewSnapshot->Subjects.Add(Key, MakeShared<const FSubjectMetadata, ESPMode::ThreadSafe>(MoveTemp(Subject)));
+	Publish(NewSnapshot);
 }
 
-void FLiveLinkMvnMetadataService::EnsureMetadata(FGuid SourceId, const FLiveLinkSubjectName& AvatarId)
+void FLiveLinkMvnMetadataService::Publish(FSnapshot* NewSnapshot)
 {
-	if (Metadata.Contains(SourceId))
+	Retired.Add(Current.exchange(NewSnapshot));
+
+	// a reader that could still hold a replaced snapshot counted itself in before the exchange
+	if (ActiveReaders.load() == 0)
 	{
-		FSourceMetadata& Existing = Metadata[SourceId];
-		if (!Existing.Contains(AvatarId))
+		for (FSnapshot* Snapshot : Retired)
 		{
-			FSubjectMetadata NewSubjectMetadata;
-			Existing.Add(AvatarId, NewSubjectMetadata);
+			delete Snapshot;
 		}
-	}
-	else
-	{
-		FSourceMetadata NewSourceMetadata;
-		FSubjectMetadata NewSubjectMetadata;
-		NewSourceMetadata.Add(AvatarId, NewSubjectMetadata);
-		Metadata.Add(SourceId, NewSourceMetadata);
+		Retired.Reset();
 	}
 }
 
-#undef LOCTEXT_NAMESPACE
\ No newline at end of file
+#undef LOCTEXT_NAMESPACE
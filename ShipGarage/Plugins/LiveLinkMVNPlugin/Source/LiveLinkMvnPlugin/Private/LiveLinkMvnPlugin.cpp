@@ -2,7 +2,11 @@
 
 #include "LiveLinkMvnPlugin.h"
 
+#include "MvnAllocationCounter.h"
 #include "MvnRemoteControlSession.h"
+#include "MvnTposeCache.h"
+#include "MvnRetargetScheduler.h"
+#include "MvnSubjectUpdatePolicy.h"
 
 #define LOCTEXT_NAMESPACE "FLiveLinkMvnPluginModule"
 
@@ -10,12 +14,19 @@
 
 void FLiveLinkMvnPluginModule::StartupModule()
 {
+	FMvnAllocationCounter::InstallIfRequested();
+	FMvnTposeCache::getInstance().Initialize();
+	FMvnSubjectUpdatePolicy::getInstance().Initialize();
+	FMvnRetargetScheduler::getInstance().Initialize();
 }
 
 void FLiveLinkMvnPluginModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FMvnRetargetScheduler::getInstance().Shutdown();
+	FMvnSubjectUpdatePolicy::getInstance().Shutdown();
+	FMvnTposeCache::getInstance().Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,235 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "LiveLinkMvnReplaySource.h"
+#include "Features/IModularFeatures.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "LiveLinkClient.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	/** Header fields of a datagram, see Datagram::deserialize */
+	const int32 HeaderSize = 24;
+	const int32 SampleCounterOffset = 6;
+	const int32 FrameTimeOffset = 12;
+
+	int32 ReadInt32(const uint8* Data)
+	{
+		return (int32)((uint32)Data[0] << 24 | (uint32)Data[1] << 16 | (uint32)Data[2] << 8 | (uint32)Data[3]);
+	}
+
+	void WriteInt32(uint8* Data, int32 Value)
+	{
+		Data[0] = (uint8)(Value >> 24);
+		Data[1] = (uint8)(Value >> 16);
+		Data[2] = (uint8)(Value >> 8);
+		Data[3] = (uint8)Value;
+	}
+
+	bool IsMvnDatagram(const TArray<uint8>& Data)
+	{
+		return Data.Num() >= HeaderSize && FMemory::Memcmp(Data.GetData(), "MXTP", 4) == 0;
+	}
+}
+
+FLiveLinkMvnReplaySource::FLiveLinkMvnReplaySource(const FString& InFilename, float InSpeed, bool bInLoop)
+	: FLiveLinkMvnSource(0, false)
+	, Filename(InFilename)
+	, Speed(InSpeed)
+	, bLoop(bInLoop)
+{
+}
+
+FLiveLinkMvnReplaySource::~FLiveLinkMvnReplaySource()
+{
+	// Run reads the capture, stop it before the reader goes
+	Stop();
+	if (Thread != nullptr)
+	{
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+void FLiveLinkMvnReplaySource::InitializeSettings( ULiveLinkSourceSettings* Settings )
+{
+	ULiveLinkMvnReplaySourceSettings* pSet = Cast<ULiveLinkMvnReplaySourceSettings>( Settings );
+	if ( pSet == nullptr )
+	{
+		return;
+	}
+
+	// a source created with a file keeps it, a source restored from a preset takes the saved one
+	if ( Filename.IsEmpty() )
+	{
+		Filename = pSet->CaptureFile.FilePath;
+		Speed = pSet->ReplaySpeed;
+		bLoop = pSet->bLoop;
+	}
+	pSet->CaptureFile.FilePath = Filename;
+	pSet->ReplaySpeed = Speed;
+	pSet->bLoop = bLoop;
+
+	ApplySettings( pSet );
+
+	SourceMachineName = FText::FromString( FPaths::GetCleanFilename( Filename ) );
+	if ( !Reader.Open( Filename ) )
+	{
+		UE_LOG( LogTemp, Error, TEXT( "MVN replay: can't read capture %s" ), *Filename );
+		SourceStatus = FText::FromString( TEXT( "Can't read capture" ) );
+		return;
+	}
+
+	// subjects are named like those of the live source
+	port = Reader.GetLocalPort();
+	pSet->PortNumber = port;
+	AdditionalPorts = Reader.GetAdditionalPorts();
+	pSet->AdditionalPorts = AdditionalPorts;
+	SourceStatus = FText::FromString( Speed > 0.f ? FString::Printf( TEXT( "Replaying at %.2gx" ), Speed ) : FString( TEXT( "Replaying as fast as possible" ) ) );
+
+	Start();
+}
+
+TSubclassOf<ULiveLinkSourceSettings> FLiveLinkMvnReplaySource::GetSettingsClass() const
+{
+	return ULiveLinkMvnReplaySourceSettings::StaticClass();
+}
+
+bool FLiveLinkMvnReplaySource::IsSourceStillValid() const
+{
+	// stays valid after the capture ended, the subjects keep their last pose
+	return Thread != nullptr;
+}
+
+uint32 FLiveLinkMvnReplaySource::Run()
+{
+	FMvnCaptureRecord Record;
+	double PassStart = FPlatformTime::Seconds();
+
+	// a looped pass continues the sample counters and stream time of the previous one,
+	// so the jitter buffers don't take the repeated samples for duplicates
+	int32 CounterOffset = 0;
+	int32 FrameTimeOffset = 0;
+	int32 FirstCounter = 0, LastCounter = 0, FirstFrameTime = 0, LastFrameTime = 0;
+	bool bHasCounter = false;
+	double LastRecordTime = 0.0;
+
+	while (!Stopping)
+	{
+		if (bPredictionChanged)
+		{
+			UpdatePrediction();
+		}
+
+		if (!Reader.ReadNext(Record))
+		{
+			if (!bLoop || !bHasCounter)
+			{
+				break;
+			}
+
+			const int32 NumSamples = LastCounter - FirstCounter + 1;
+			const int32 FrameInterval = NumSamples > 1 ? (LastFrameTime - FirstFrameTime) / (NumSamples - 1) : 0;
+			CounterOffset += NumSamples;
+			FrameTimeOffset += LastFrameTime - FirstFrameTime + FrameInterval;
+			PassStart += (LastRecordTime + FrameInterval / 1000.0) / FMath::Max(Speed, 1.e-3f);
+			bHasCounter = false;
+
+			Reader.Rewind();
+			continue;
+		}
+
+		if (IsMvnDatagram(Record.Data))
+		{
+			uint8* Header = Record.Data.GetData();
+			const int32 Counter = ReadInt32(Header + SampleCounterOffset);
+			const int32 FrameTime = ReadInt32(Header + FrameTimeOffset);
+			if (!bHasCounter)
+			{
+				FirstCounter = LastCounter = Counter;
+				FirstFrameTime = LastFrameTime = FrameTime;
+				bHasCounter = true;
+			}
+			LastCounter = FMath::Max(LastCounter, Counter);
+			LastFrameTime = FMath::Max(LastFrameTime, FrameTime);
+
+			if (CounterOffset != 0)
+			{
+				WriteInt32(Header + SampleCounterOffset, Counter + CounterOffset);
+				WriteInt32(Header + FrameTimeOffset, FrameTime + FrameTimeOffset);
+			}
+		}
+		LastRecordTime = Record.Time;
+
+		// wait for the recorded arrival, in short steps so Stop is noticed
+		if (Speed > 0.f)
+		{
+			const double DueTime = PassStart + Record.Time / Speed;
+			for (double Wait = DueTime - FPlatformTime::Seconds(); Wait > 0.0 && !Stopping; Wait = DueTime - FPlatformTime::Seconds())
+			{
+				FPlatformProcess::SleepNoStats((float)FMath::Min(Wait, WaitTime.GetTotalSeconds()));
+			}
+		}
+
+		const double Now = FPlatformTime::Seconds();
+		Recv(Record.Data.GetData(), Record.Data.Num(), Record.Sender, Now, Record.PortIndex);
+		for (const TUniquePtr<FMvnActor>& Actor : m_actors)
+		{
+			ReleaseDuePoses(*Actor, Now);
+		}
+		UpdateSubjects(Now);
+		UpdateTelemetry(Now);
+	}
+
+	// publish what the jitter buffers still hold
+	const double End = FPlatformTime::Seconds() + JitterBufferLatency;
+	Parser->fragmentAssembler().expire(End);
+	for (const TUniquePtr<FMvnActor>& Actor : m_actors)
+	{
+		ReleaseDuePoses(*Actor, End);
+	}
+	return 0;
+}
+
+namespace LiveLinkMvnReplay
+{
+	/** Sources added by mvn.Replay.Start */
+	static TArray<FGuid> Sources;
+
+	static void Start(const TArray<FString>& Args)
+	{
+		if (Args.Num() < 1)
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Replay.Start: no capture file given"));
+			return;
+		}
+		const float Speed = Args.Num() > 1 ? FMath::Max(FCString::Atof(*Args[1]), 0.f) : 1.f;
+		const bool bLoop = Args.Num() > 2 ? FCString::ToBool(*Args[2]) : true;
+
+		FLiveLinkClient& Client = IModularFeatures::Get().GetModularFeature<FLiveLinkClient>(FLiveLinkClient::ModularFeatureName);
+		Sources.Add(Client.AddSource(MakeShared<FLiveLinkMvnReplaySource>(Args[0], Speed, bLoop)));
+	}
+
+	static void Stop(const TArray<FString>& Args)
+	{
+		FLiveLinkClient& Client = IModularFeatures::Get().GetModularFeature<FLiveLinkClient>(FLiveLinkClient::ModularFeatureName);
+		for (const FGuid& Source : Sources)
+		{
+			Client.RemoveSource(Source);
+		}
+		Sources.Reset();
+	}
+}
+
+static FAutoConsoleCommand MvnReplayStartCommand(
+	TEXT("mvn.Replay.Start"),
+	TEXT("Replay an MVN capture as a Live Link source. Args: CaptureFile [Speed, 0 as fast as possible] [Loop]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnReplay::Start));
+
+static FAutoConsoleCommand MvnReplayStopCommand(
+	TEXT("mvn.Replay.Stop"),
+	TEXT("Remove the sources added by mvn.Replay.Start"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnReplay::Stop));
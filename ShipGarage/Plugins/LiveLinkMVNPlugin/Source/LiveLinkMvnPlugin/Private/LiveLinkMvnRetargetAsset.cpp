@@ -12,6 +12,7 @@
 #include "Engine/SkeletalMesh.h"
 
 #include "SegmentInformation.h"
+#include "MvnRetargetScheduler.h"
 #include "Misc/PackageName.h"
 #include "Misc/Paths.h"
 
@@ -121,7 +122,6 @@ std::map<EXsensMapping, FName> ULiveLinkMvnRetargetAsset::s_bones_map_xsens{ {EX
 
 ULiveLinkMvnRetargetAsset::ULiveLinkMvnRetargetAsset(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer),
-	m_retarget(100),
 	m_doLog(false)
 {
 
@@ -174,6 +174,12 @@ void ULiveLinkMvnRetargetAsset::BeginDestroy()
 	}
 #endif
 
+	if (m_bScheduled)
+	{
+		FMvnRetargetScheduler::getInstance().Unregister(this);
+		m_bScheduled = false;
+	}
+
 	Super::BeginDestroy();
 }
 
@@ -218,39 +224,18 @@ void ULiveLinkMvnRetargetAsset::PostEditChangeProperty(FPropertyChangedEvent& Pr
 			m_remapping_convention = EXsensRetargetNamingConvention::Manual;
 		}
 	}
+
+	InvalidateBoneMappingPlan();
 }
 
 void ULiveLinkMvnRetargetAsset::OnBlueprintClassCompiled( UBlueprint* TargetBlueprint )
 {
 	AddBoneNamesToRemapTable();
+	InvalidateBoneMappingPlan();
 }
 
 #endif // WITH_EDITOR
 
-TArray<FName> ULiveLinkMvnRetargetAsset::PopulateBoneNames(const FLiveLinkSkeletonStaticData* InSkeletonData)
-{
-	const auto& source_bone_names = InSkeletonData->GetBoneNames();
-
-	TArray<FName> transformed_bone_names;
-	transformed_bone_names.Reserve(source_bone_names.Num() + 4);
-
-	//todo: BoneNameMap is never emptied
-	for(const auto& bone_name : source_bone_names)
-	{
-		FName* TargetBoneName = BoneNameMap.Find(bone_name);
-		if(TargetBoneName == nullptr)
-		{
-			FName new_name = GetRemappedBoneName(bone_name);
-			transformed_bone_names.Add(new_name);
-			BoneNameMap.Add(bone_name, new_name);
-		}
-		else
-			transformed_bone_names.Add(*TargetBoneName);
-	}
-
-	return transformed_bone_names;
-}
-
 float ULiveLinkMvnRetargetAsset::calculateVectorScale(FVector xsensVec, FVector unrealVec)
 {
 	float xsensLength = xsensVec.Size();
@@ -269,20 +254,209 @@ inline FQuat isRotationFromVecToVec(FVector a, FVector b)
 
 #define MYLOG(a, ...) if (m_doLog) UE_LOG(LogTemp, Warning, TEXT(a), __VA_ARGS__)
 
-void ULiveLinkMvnRetargetAsset::calculateTposeValues(FCompactPose OutPose, const FLiveLinkSkeletonStaticData& InSkeletonData, const FLiveLinkAnimationFrameData& InFrameData, FBlendedCurve& OutCurve)
+bool ULiveLinkMvnRetargetAsset::UpdateBoneMappingPlan(const FLiveLinkSkeletonStaticData& InSkeletonData, const FBoneContainer& BoneContainer)
 {
-	bool logValid = false;
-	std::map<int, int> parentOverride;
+	FBoneMappingPlan& Plan = m_boneMappingPlan;
+	const TArray<FName>& SourceBoneNames = InSkeletonData.GetBoneNames();
+
+	if(Plan.bValid
+		&& Plan.Skeleton == BoneContainer.GetSkeletonAsset()
+		&& Plan.NumCompactBones == BoneContainer.GetCompactPoseNumBones()
+#if ENGINE_MAJOR_VERSION >= 5
+		&& Plan.BoneContainerSerial == BoneContainer.GetSerialNumber()
+#endif
+		&& Plan.SourceBoneNames == SourceBoneNames)
+	{
+		return false;
+	}
+
+	const FReferenceSkeleton& RefSkeleton = BoneContainer.GetReferenceSkeleton();
+	static const FName PelvisName("Pelvis");
+	static const FName PlaceholderNames[] = { FName("p1"), FName("p2"), FName("p3"), FName("p4") };
+
+	TArray<FName> TransformedBoneNames;
+	TransformedBoneNames.Reserve(SourceBoneNames.Num());
+	for(const FName& SourceBoneName : SourceBoneNames)
+	{
+		TransformedBoneNames.Add(GetRemappedBoneName(SourceBoneName));
+	}
 
-	auto TransformedBoneNames = PopulateBoneNames(&InSkeletonData);
+	// segment whose rotation the children of an unmapped segment use instead
+	TArray<int32> ParentOverride;
+	ParentOverride.Init(INDEX_NONE, SourceBoneNames.Num());
+
+	Plan.Segments.Reset(SourceBoneNames.Num());
+	for(int32 i = 0; i < SourceBoneNames.Num(); ++i)
+	{
+		const FName BoneName = TransformedBoneNames[i];
+		FSegmentRetargetPlan& Segment = Plan.Segments.AddDefaulted_GetRef();
+
+		Segment.RefBoneIndex = RefSkeleton.FindBoneIndex(BoneName);
+		int32 MeshIndex = BoneContainer.GetPoseBoneIndexForBoneName(BoneName);
+		if(MeshIndex != INDEX_NONE)
+		{
+			Segment.CompactBoneIndex = BoneContainer.MakeCompactPoseIndex(FMeshPoseBoneIndex(MeshIndex)).GetInt();
+		}
+
+		if(SourceBoneNames[i] == PelvisName && BoneName != NAME_None)
+		{
+			Segment.Kind = ESegmentRetarget::Pelvis;
+		}
+		else if(i > 23 && i < 29 && SourceBoneNames[i].ToString().Contains("Prop"))
+		{
+			Segment.Kind = ESegmentRetarget::Prop;
+			if(Segment.RefBoneIndex >= 0)
+			{
+				// if the parent bone is not mapped to a segment find the parent of the parent
+				int32 parentBoneIndex = RefSkeleton.GetParentIndex(Segment.RefBoneIndex);
+				while(parentBoneIndex >= 0)
+				{
+					int32 MappedIndex = TransformedBoneNames.Find(RefSkeleton.GetBoneName(parentBoneIndex));
+					if(MappedIndex != INDEX_NONE)
+					{
+						int32 parent = SegmentInformation::SegmentBoneNames.Find(SourceBoneNames[MappedIndex]);
+						Segment.ParentSegment = (parent >= 0 && parent < i) ? parent : INDEX_NONE;
+						break;
+					}
+					parentBoneIndex = RefSkeleton.GetParentIndex(parentBoneIndex);
+				}
+			}
+		}
+		else if(i > 0)
+		{
+			if(!SegmentInformation::parentIndex.IsValidIndex(i))
+			{
+				Segment.Kind = ESegmentRetarget::Ignored;
+			}
+			else if(BoneName == NAME_None)
+			{
+				//if an Xsens bone is not mapped to a bone from the current character find a parent that is for the child to use
+				Segment.Kind = ESegmentRetarget::Unmapped;
+
+				int32 parent = SegmentInformation::parentIndex[i];
+				int32 cur = parent;
+				FName parentBoneName = GetRemappedBoneName(SegmentInformation::SegmentBoneNames[parent]);
+				while(parentBoneName == NAME_None)
+				{
+					cur = parent;
+					parent = SegmentInformation::parentIndex[parent];
+					if(parent < 0)
+					{
+						break;
+					}
+					parentBoneName = GetRemappedBoneName(SegmentInformation::SegmentBoneNames[parent]);
+				}
+				ParentOverride[i] = cur;
+			}
+			else if(BoneName == PlaceholderNames[0] || BoneName == PlaceholderNames[1] || BoneName == PlaceholderNames[2] || BoneName == PlaceholderNames[3])
+			{
+				Segment.Kind = ESegmentRetarget::Ignored;
+			}
+			else
+			{
+				Segment.Kind = ESegmentRetarget::Bone;
+
+				//xsens parent, if it is not mapped override it with a parent that is
+				int32 parent = SegmentInformation::parentIndex[i];
+				if(ParentOverride.IsValidIndex(parent) && ParentOverride[parent] != INDEX_NONE)
+				{
+					parent = ParentOverride[parent];
+				}
+				Segment.ParentSegment = parent;
+			}
+		}
+
+		MYLOG("%d %s -> %s, kind = %d, bone index = %d, parent = %d", i, *SourceBoneNames[i].ToString(), *BoneName.ToString(), (int32)Segment.Kind, Segment.RefBoneIndex, Segment.ParentSegment);
+	}
+
+	Plan.SourceBoneNames = SourceBoneNames;
+	Plan.Skeleton = BoneContainer.GetSkeletonAsset();
+	Plan.NumCompactBones = BoneContainer.GetCompactPoseNumBones();
+#if ENGINE_MAJOR_VERSION >= 5
+	Plan.BoneContainerSerial = BoneContainer.GetSerialNumber();
+#endif
+	Plan.bValid = true;
+	return true;
+}
+
+void ULiveLinkMvnRetargetAsset::InvalidateBoneMappingPlan()
+{
+	m_boneMappingPlan.bValid = false;
+}
+
+void ULiveLinkMvnRetargetAsset::UpdateTposeBasis(const FCompactPose& InPose)
+{
+	const FBoneContainer& BoneContainer = InPose.GetBoneContainer();
+
+	TArray<int32> SegmentBoneIndices;
+	SegmentBoneIndices.Reserve(m_boneMappingPlan.Segments.Num());
+	for(const FSegmentRetargetPlan& Segment : m_boneMappingPlan.Segments)
+	{
+		SegmentBoneIndices.Add(Segment.RefBoneIndex);
+	}
+
+	m_tposeBasisGeneration = FMvnTposeCache::getInstance().GetGeneration();
+	m_tposeBasis = FMvnTposeCache::getInstance().FindOrAdd(BoneContainer.GetSkeletalMeshAsset(), BoneContainer.GetSkeletonAsset(), TPoseAnimation,
+		BoneContainer.GetCompactPoseNumBones(), SegmentBoneIndices,
+		[this, &InPose](FMvnTposeBasis& OutBasis)
+		{
+			calculateTposeValues(InPose, OutBasis);
+		});
+
+	// per segment constants of the retarget kernel, segments the T-pose doesn't cover pass their rotation through
+	const int32 NumSegments = m_boneMappingPlan.Segments.Num();
+	m_bKernelValid = false;
+
+	// the segments may have changed, a blend from the old pose would index past them
+	m_lastPose.Reset();
+	m_blendFrom.Reset();
+	m_blendStart = 0.0;
+	m_blendDuration = 0.0;
+	m_kernelPlan.Reset(NumSegments);
+	m_kernelPlan.ForwardFix = FQuat(FVector::UpVector, IsForwardY ? -PI / 2.0f : 0);
+	m_segmentKinds.SetNum(NumSegments);
+
+	for(int32 i = 0; i < NumSegments; ++i)
+	{
+		const FSegmentRetargetPlan& Segment = m_boneMappingPlan.Segments[i];
+		ESegmentRetarget Kind = Segment.Kind;
+		if((Kind == ESegmentRetarget::Pelvis && !m_tposeBasis->World.IsValidIndex(Segment.RefBoneIndex))
+			|| (Kind == ESegmentRetarget::Prop && (Segment.RefBoneIndex < 0 || Segment.ParentSegment == INDEX_NONE))
+			|| (Kind == ESegmentRetarget::Bone && Segment.RefBoneIndex < 0))
+		{
+			Kind = ESegmentRetarget::Root;
+		}
+		m_segmentKinds[i] = Kind;
+
+		if(Kind == ESegmentRetarget::Pelvis || Kind == ESegmentRetarget::Prop || Kind == ESegmentRetarget::Bone)
+		{
+			//combine the mvn and tpose rotation
+			m_kernelPlan.Tpose.SetQuat(i, m_tposeBasis->MvnToUnreal[i].GetRotation());
+		}
+		if(Kind == ESegmentRetarget::Pelvis || Kind == ESegmentRetarget::Bone)
+		{
+			m_kernelPlan.CombinedWorld[i] = 1.0f;
+		}
+		if(Kind == ESegmentRetarget::Prop || Kind == ESegmentRetarget::Bone)
+		{
+			// remove the rotation of the parent from the segment rotation before applying
+			m_kernelPlan.Parent[i] = Segment.ParentSegment;
+		}
+	}
+}
+
+void ULiveLinkMvnRetargetAsset::calculateTposeValues(FCompactPose OutPose, FMvnTposeBasis& OutBasis)
+{
+	const FReferenceSkeleton& RefSkeleton = OutPose.GetBoneContainer().GetReferenceSkeleton();
 
 	//get reference pose values
-	TArray<FTransform> TPose = OutPose.GetBoneContainer().GetReferenceSkeleton().GetRefBonePose();
+	TArray<FTransform> TPose = RefSkeleton.GetRefBonePose();
 	if(TPoseAnimation)
 	{
 		MYLOG("TPoseAnimation %p", TPoseAnimation);
 		//when upgrading from UE4.23 to 4.26 api changed for GetAnimationPose
 		//TPoseAnimation->GetAnimationPose(OutPose, OutCurve, FAnimExtractContext(0, true));
+		FBlendedCurve OutCurve;
 #if ENGINE_MAJOR_VERSION >= 5
 		UE::Anim::FStackAttributeContainer attributes;
 #else
@@ -292,47 +466,40 @@ void ULiveLinkMvnRetargetAsset::calculateTposeValues(FCompactPose OutPose, const
         TPoseAnimation->GetAnimationPose(outAnimationPoseData, FAnimExtractContext( 0, true ));
 		TPose = OutPose.GetBones();
 	}
-	FVector uniformScale = OutPose.GetBoneContainer().GetReferenceSkeleton().GetRefBonePose()[0].GetScale3D();
+	FVector uniformScale = RefSkeleton.GetRefBonePose()[0].GetScale3D();
+
 	//calculate the character tpose rotation and position in world space
-	if(m_tposeWorld.Num() != 0 && m_tposeWorld.Num() != TPose.Num())
-		return;
-	m_tposeWorld = TPose;
+	TArray<FTransform>& TposeWorld = OutBasis.World;
+	TposeWorld = TPose;
 	for (int32 i = 0; i < TPose.Num(); ++i)
 	{
-		if (m_tposeWorld.IsValidIndex(i))
+		int parentBoneIndex = RefSkeleton.GetParentIndex(i);
+		if (TposeWorld.IsValidIndex(parentBoneIndex))
 		{
-			int parentBoneIndex = OutPose.GetBoneContainer().GetReferenceSkeleton().GetParentIndex(i);
-			if (m_tposeWorld.IsValidIndex(parentBoneIndex))
-			{
-				m_tposeWorld[i].SetRotation(m_tposeWorld[parentBoneIndex].GetRotation() * TPose[i].GetRotation());
-				m_tposeWorld[i].SetTranslation(m_tposeWorld[parentBoneIndex].GetRotation().RotateVector(TPose[i].GetTranslation() * uniformScale) + m_tposeWorld[parentBoneIndex].GetTranslation());
-			}
+			TposeWorld[i].SetRotation(TposeWorld[parentBoneIndex].GetRotation() * TPose[i].GetRotation());
+			TposeWorld[i].SetTranslation(TposeWorld[parentBoneIndex].GetRotation().RotateVector(TPose[i].GetTranslation() * uniformScale) + TposeWorld[parentBoneIndex].GetTranslation());
 		}
 	}
 
-	m_mvnToUnrealTpose.SetNum(InFrameData.Transforms.Num());
-	for(int32 i = 0; i < InFrameData.Transforms.Num(); ++i)
+	TArray<FTransform>& MvnToUnrealTpose = OutBasis.MvnToUnreal;
+	MvnToUnrealTpose.SetNum(m_boneMappingPlan.Segments.Num());
+	for(int32 i = 0; i < m_boneMappingPlan.Segments.Num(); ++i)
 	{
-		FName BoneName = TransformedBoneNames[i];
-		auto boneIndex = OutPose.GetBoneContainer().GetReferenceSkeleton().FindBoneIndex(BoneName);
-		if(m_tposeWorld.IsValidIndex(boneIndex))
+		auto boneIndex = m_boneMappingPlan.Segments[i].RefBoneIndex;
+		if(TposeWorld.IsValidIndex(boneIndex))
 		{
-			auto parentBoneIndex = OutPose.GetBoneContainer().GetReferenceSkeleton().GetParentIndex(boneIndex);
-			m_mvnToUnrealTpose[i].SetRotation(m_tposeWorld[boneIndex].GetRotation());
-
-			FVector xsensVec;
-			FVector tposeVec;
+			auto parentBoneIndex = RefSkeleton.GetParentIndex(boneIndex);
+			MvnToUnrealTpose[i].SetRotation(TposeWorld[boneIndex].GetRotation());
 
-			if(i > 0 && m_tposeWorld.IsValidIndex(parentBoneIndex))
+			if(i > 0 && TposeWorld.IsValidIndex(parentBoneIndex))
 			{
-				m_mvnToUnrealTpose[i].SetTranslation(TPose[boneIndex].GetTranslation());
+				MvnToUnrealTpose[i].SetTranslation(TPose[boneIndex].GetTranslation());
 			}
 			else
 			{
-				tposeVec = m_tposeWorld[boneIndex].GetTranslation();
-				m_mvnToUnrealTpose[i].SetTranslation(tposeVec);
+				MvnToUnrealTpose[i].SetTranslation(TposeWorld[boneIndex].GetTranslation());
 			}
-			MYLOG("m_mvnToUnrealTpose (%f,%f,%f)", m_mvnToUnrealTpose[i].GetTranslation()[0], m_mvnToUnrealTpose[i].GetTranslation()[1], m_mvnToUnrealTpose[i].GetTranslation()[2]);
+			MYLOG("MvnToUnrealTpose (%f,%f,%f)", MvnToUnrealTpose[i].GetTranslation()[0], MvnToUnrealTpose[i].GetTranslation()[1], MvnToUnrealTpose[i].GetTranslation()[2]);
 		}
 	}
 }
@@ -364,6 +531,7 @@ void ULiveLinkMvnRetargetAsset::SetSkeleton(USkeleton* Skeleton)
 {
 	m_skeleton = Skeleton;
 	AddBoneNamesToRemapTable();
+	InvalidateBoneMappingPlan();
 }
 
 //todo: unused
@@ -389,197 +557,164 @@ void ULiveLinkMvnRetargetAsset::BuildPoseFromAnimationData(float DeltaTime, cons
 	MYLOG("*********************************************");
 	MYLOG("Building for %p", this);
 
-	bool logValid = false;
-	std::map<int, int> parentOverride;
+	if(UpdateBoneMappingPlan(*InSkeletonData, OutPose.GetBoneContainer()) || !m_tposeBasis.IsValid()
+		|| m_tposeBasisGeneration != FMvnTposeCache::getInstance().GetGeneration())
+	{
+		UpdateTposeBasis(OutPose);
+	}
+	const TArray<FTransform>& TposeWorld = m_tposeBasis->World;
+	const TArray<FTransform>& MvnToUnrealTpose = m_tposeBasis->MvnToUnreal;
 
-	auto TransformedBoneNames = PopulateBoneNames(InSkeletonData);
+	const TArray<FTransform>& RefBonePose = OutPose.GetBoneContainer().GetReferenceSkeleton().GetRefBonePose();
+	FVector uniformScale = RefBonePose[0].GetScale3D();
 
-	FVector uniformScale = OutPose.GetBoneContainer().GetReferenceSkeleton().GetRefBonePose()[0].GetScale3D();
+	const int32 NumSegments = FMath::Min(InFrameData->Transforms.Num(), m_kernelPlan.Num());
 
-	if(m_retarget++ >= 100 || (InFrameData->Transforms.Num() != m_mvnToUnrealTpose.Num()))
+	if(!m_bScheduled)
 	{
-		FBlendedCurve OutCurve;
-		calculateTposeValues(OutPose, *InSkeletonData, *InFrameData, OutCurve);
-		m_retarget = 0;
+		FMvnRetargetScheduler::getInstance().Register(this);
+		m_bScheduled = true;
 	}
 
-	TArray<FTransform> SegData;
-	for(int32 i = 0; i < InFrameData->Transforms.Num(); ++i)
+	// the rotations of this very frame may be retargeted already, by the scheduler's batch or by an earlier
+	// evaluation of a subject that pushed nothing new since
+	bool bRetargeted = m_bKernelValid;
+	if(bRetargeted && !IsPreparedFrame(*InFrameData))
 	{
-		FName BoneName = TransformedBoneNames[i];
-
-		FTransform BoneTransform = InFrameData->Transforms[i];
-		int parent = 0;
-		SegData.Add(BoneTransform);
-		const FName MapBoneName = *BoneNameMap.FindKey(BoneName);
+		for(int32 i = 0; bRetargeted && i < m_kernelPlan.Num(); ++i)
+		{
+			const FQuat Rotation = i < NumSegments ? InFrameData->Transforms[i].GetRotation() : FQuat::Identity;
+			bRetargeted = m_kernelRotations.X[i] == (float)Rotation.X && m_kernelRotations.Y[i] == (float)Rotation.Y
+				&& m_kernelRotations.Z[i] == (float)Rotation.Z && m_kernelRotations.W[i] == (float)Rotation.W;
+		}
+	}
 
-		float fFwdFixAngle = IsForwardY ? -PI / 2.0f : 0;
-		FQuat fwdYRotation( FVector::UpVector, fFwdFixAngle );
-		FQuat currRot = BoneTransform.GetRotation();
-		currRot = currRot * fwdYRotation;
-		BoneTransform.SetRotation(currRot);
+	if(!bRetargeted)
+	{
+		RetargetRotations(*InFrameData);
+	}
+	else if(m_bKernelApplied && m_updateRate != EMvnSubjectUpdateRate::Full)
+	{
+		FMvnSubjectUpdatePolicy::getInstance().AddSkippedRetargets(1);
+	}
 
-		//set translation and rotation for the pelvis
-		if(MapBoneName == "Pelvis")
+	// a throttled subject moves a whole update interval at once, or more coming back from a pause:
+	// blend over to its new frame from the pose shown, and keep blending while one is running
+	const double Now = FPlatformTime::Seconds();
+	const double BlendElapsed = Now - m_blendStart;
+	if(!m_bKernelApplied)
+	{
+		const bool bBlending = BlendElapsed < m_blendDuration;
+		if((m_updateRate != EMvnSubjectUpdateRate::Full || m_bThrottledAtLastFrame || bBlending) && m_lastPose.Num() == NumSegments)
 		{
-			auto boneIndex = OutPose.GetBoneContainer().GetReferenceSkeleton().FindBoneIndex(BoneName);
-			MYLOG("%d Bone index = %d", i, boneIndex);
-			if(boneIndex >= 0)
-			{
-				//scale the pelvis to the correct height with the Xsens data and Unreal skeleton
-				float scale = calculateVectorScale(BoneTransform.GetScale3D(), m_tposeWorld[boneIndex].GetTranslation());
-				if(isinf(scale))
-					scale = calculateVectorScale(OutPose.GetBoneContainer().GetReferenceSkeleton().GetRefBonePose()[boneIndex].GetTranslation(), m_tposeWorld[boneIndex].GetTranslation());
-				//Calculate the pelvis rotation using the mvn and tpose rotation
-				SegData[i].SetRotation(BoneTransform.GetRotation() * m_mvnToUnrealTpose[i].GetRotation());
-				//scale the position so the pelvis is at the correct height
-				SegData[i].SetTranslation(BoneTransform.GetTranslation() * scale);
-				SegData[i].SetScale3D(uniformScale);
-				MYLOG("final dpos (%f,%f,%f)", SegData[i].GetTranslation()[0], SegData[i].GetTranslation()[1], SegData[i].GetTranslation()[2]);
-				BoneTransform = SegData[i];
-			}
+			m_blendFrom = m_lastPose;
+			m_blendDuration = bBlending ? m_blendDuration - BlendElapsed : FMath::Min(Now - m_lastFrameTime, FMvnSubjectUpdatePolicy::GetMaxBlendTime());
+			m_blendStart = Now;
 		}
-		else if(i > 23 && i < 29 && MapBoneName.ToString().Contains("Prop"))
-		{
-			MYLOG("Prop");
-			//for all props
-			auto boneIndex = OutPose.GetBoneContainer().GetReferenceSkeleton().FindBoneIndex(BoneName);
-			if(boneIndex >= 0)
-			{
-				//find the parent bone
-				auto parentBoneIndex = OutPose.GetBoneContainer().GetReferenceSkeleton().GetParentIndex(boneIndex);
-				FName parentBoneName = OutPose.GetBoneContainer().GetReferenceSkeleton().GetBoneName(parentBoneIndex);
+		m_bThrottledAtLastFrame = m_updateRate != EMvnSubjectUpdateRate::Full;
+		m_lastFrameTime = Now;
+		m_bKernelApplied = true;
+	}
+	const float BlendAlpha = m_blendDuration > 0.0 ? (float)FMath::Clamp((Now - m_blendStart) / m_blendDuration, 0.0, 1.0) : 1.f;
+	m_lastPose.SetNum(NumSegments);
 
-				const FName* TargetBoneName = BoneNameMap.FindKey(parentBoneName);
-				// if the parent is not in the BoneNameMap (retargeted) find the parent of the parent
-				while(!TargetBoneName && parentBoneIndex >= 0)
-				{
-					parentBoneIndex = OutPose.GetBoneContainer().GetReferenceSkeleton().GetParentIndex(parentBoneIndex);
-					if(parentBoneIndex >= 0)
-					{
-						parentBoneName = OutPose.GetBoneContainer().GetReferenceSkeleton().GetBoneName(parentBoneIndex);
-						TargetBoneName = BoneNameMap.FindKey(parentBoneName);
-					}
-				}
-				if(parentBoneIndex >= 0)
-				{
-					parent = SegmentInformation::SegmentBoneNames.Find(*TargetBoneName);
-					FQuat drot = BoneTransform.GetRotation() * m_mvnToUnrealTpose[i].GetRotation();
-					drot = SegData[parent].GetRotation().Inverse() * drot;
-					BoneTransform.SetRotation(drot);
-					BoneTransform.SetTranslation(m_mvnToUnrealTpose[i].GetTranslation());
-					BoneTransform.SetScale3D(OutPose.GetBoneContainer().GetReferenceSkeleton().GetRefBonePose()[boneIndex].GetScale3D());
-				}
-			}
+	for(int32 i = 0; i < NumSegments; ++i)
+	{
+		const FSegmentRetargetPlan& Segment = m_boneMappingPlan.Segments[i];
+		if(Segment.CompactBoneIndex == INDEX_NONE)
+		{
+			continue;
 		}
-		else if(i > 0)
+
+		const FTransform& SegmentTransform = InFrameData->Transforms[i];
+		const int32 boneIndex = Segment.RefBoneIndex;
+		FTransform BoneTransform(m_kernelLocal.GetQuat(i), SegmentTransform.GetTranslation(), SegmentTransform.GetScale3D());
+
+		switch(m_segmentKinds[i])
 		{
-			//if an Xsens bone is not mapped to a bone from the current character find a parent that is for the child to use
-			if(BoneName == "None")
+		case ESegmentRetarget::Pelvis:
 			{
-				parent = SegmentInformation::parentIndex[i];
-				int cur = parent;
-				FName parentBoneName = *BoneNameMap.Find(SegmentInformation::SegmentBoneNames[parent]);
-				while(parentBoneName == "None")
-				{
-					cur = parent;
-					parent = SegmentInformation::parentIndex[parent];
-					if ( parent < 0 )
-					{
-						break;
-					}
-					parentBoneName = *BoneNameMap.Find(SegmentInformation::SegmentBoneNames[parent]);
-				}
-				auto parentBoneIndex = OutPose.GetBoneContainer().GetReferenceSkeleton().FindBoneIndex(parentBoneName);
-
-				parentOverride[i] = cur;
+				//scale the pelvis to the correct height with the Xsens data and Unreal skeleton
+				float scale = calculateVectorScale(SegmentTransform.GetScale3D(), TposeWorld[boneIndex].GetTranslation());
+				if(isinf(scale))
+					scale = calculateVectorScale(RefBonePose[boneIndex].GetTranslation(), TposeWorld[boneIndex].GetTranslation());
+				//scale the position so the pelvis is at the correct height
+				BoneTransform.SetTranslation(SegmentTransform.GetTranslation() * scale);
+				BoneTransform.SetScale3D(uniformScale);
+				MYLOG("final dpos (%f,%f,%f)", BoneTransform.GetTranslation()[0], BoneTransform.GetTranslation()[1], BoneTransform.GetTranslation()[2]);
 			}
-			else if(BoneName != "p1" && BoneName != "p2" && BoneName != "p3" && BoneName != "p4" && m_mvnToUnrealTpose.Num() > i)
-			{
-				//xsens parent
-				parent = SegmentInformation::parentIndex[i];// -1] + 1;
-				//character bone index
-				auto boneIndex = OutPose.GetBoneContainer().GetReferenceSkeleton().FindBoneIndex(BoneName);
-				if(boneIndex >= 0)
-				{
-					//character parent bone index
-					auto parentBoneIndex = OutPose.GetBoneContainer().GetReferenceSkeleton().GetParentIndex(boneIndex);
-					MYLOG("%d Bone index = %d, parent = %d, parentBoneIndex = %d", i, boneIndex, parent, parentBoneIndex);
-
-					//if parent is not mapped override it with a parent that is
-					auto it = parentOverride.find(parent);
-					if(it != parentOverride.end())
-					{
-						parent = it->second;
-						MYLOG("%d Overriding parent index with %d", i, parent);
-					}
+			break;
 
-					MYLOG("Xsens Tpose pos (%f,%f,%f), parent Tpose pos (%f,%f,%f)",
-						BoneTransform.GetScale3D()[0], BoneTransform.GetScale3D()[1], BoneTransform.GetScale3D()[2],
-						InFrameData->Transforms[parent].GetScale3D()[0], InFrameData->Transforms[parent].GetScale3D()[1], InFrameData->Transforms[parent].GetScale3D()[2]);
+		case ESegmentRetarget::Prop:
+		case ESegmentRetarget::Bone:
+			BoneTransform.SetTranslation(MvnToUnrealTpose[i].GetTranslation());
+			BoneTransform.SetScale3D(RefBonePose[boneIndex].GetScale3D());
+			break;
 
-					//combine the tpose and mvn rotation
-					FQuat drot = BoneTransform.GetRotation() * m_mvnToUnrealTpose[i].GetRotation();
-					SegData[i].SetRotation(drot);
-					// remove the rotation of the parent from the current segment rotation before applying
-					drot = SegData[parent].GetRotation().Inverse() * drot;
-
-					BoneTransform.SetRotation(drot);
-					BoneTransform.SetTranslation(m_mvnToUnrealTpose[i].GetTranslation());
-					BoneTransform.SetScale3D(OutPose.GetBoneContainer().GetReferenceSkeleton().GetRefBonePose()[boneIndex].GetScale3D());
-				}
-				else
-				{
-					MYLOG("%d Bone index = %d, parent = %d", i, boneIndex, parent);
-				}
-			}
+		default:
+			break;
 		}
-		else
+
+		if(BlendAlpha < 1.f && i < m_blendFrom.Num())
 		{
-			auto boneIndex = OutPose.GetBoneContainer().GetReferenceSkeleton().FindBoneIndex(BoneName);
-			MYLOG("%d Bone index = %d", i, boneIndex);
-			if(boneIndex >= 0 && m_tposeWorld.Num() > 0)
-			{
-				MYLOG("Tpose pos (%f,%f,%f) ori (%f,%f,%f,%f)",
-					m_tposeWorld[boneIndex].GetTranslation()[0], m_tposeWorld[boneIndex].GetTranslation()[1], m_tposeWorld[boneIndex].GetTranslation()[2],
-					m_tposeWorld[boneIndex].GetRotation().W, m_tposeWorld[boneIndex].GetRotation().X, m_tposeWorld[boneIndex].GetRotation().Y, m_tposeWorld[boneIndex].GetRotation().Z);
-			}
+			FTransform Blended;
+			Blended.Blend(m_blendFrom[i], BoneTransform, BlendAlpha);
+			BoneTransform = Blended;
 		}
 
-		int32 MeshIndex = OutPose.GetBoneContainer().GetPoseBoneIndexForBoneName(BoneName);
+		m_lastPose[i] = BoneTransform;
+		OutPose[FCompactPoseBoneIndex(Segment.CompactBoneIndex)] = BoneTransform;
+	}
+}
 
-		if(MeshIndex != INDEX_NONE)
-		{
-			FCompactPoseBoneIndex CPIndex = OutPose.GetBoneContainer().MakeCompactPoseIndex(FMeshPoseBoneIndex(MeshIndex));
-			if(CPIndex != INDEX_NONE)
-			{
-				OutPose[CPIndex] = BoneTransform;
-			}
-		}
+void ULiveLinkMvnRetargetAsset::RetargetRotations(const FLiveLinkAnimationFrameData& InFrameData)
+{
+	const int32 NumSegments = FMath::Min(InFrameData.Transforms.Num(), m_kernelPlan.Num());
+
+	// rotations of all segments in one batch, segments missing from the frame stay at identity
+	m_kernelRotations.SetNum(m_kernelPlan.Num());
+	for(int32 i = 0; i < m_kernelPlan.Num(); ++i)
+	{
+		m_kernelRotations.SetQuat(i, i < NumSegments ? InFrameData.Transforms[i].GetRotation() : FQuat::Identity);
 	}
+	MvnSegmentKernel::RetargetSegments(m_kernelRotations, m_kernelPlan, m_kernelWorld, m_kernelLocal);
+	m_bKernelValid = true;
+	m_bKernelApplied = false;
+	m_preparedFrameCounter = 0;
+}
 
-	//todo: the following code does absolutelynothing, CurveNameMap is useless
-	const TArray<FName>& SourceCurveNames = InSkeletonData->PropertyNames;
-	TArray<FName, TMemStackAllocator<>> TransformedCurveNames;
-	TransformedCurveNames.Reserve(SourceCurveNames.Num());
+bool ULiveLinkMvnRetargetAsset::IsPreparedFrame(const FLiveLinkAnimationFrameData& InFrameData) const
+{
+	return m_preparedFrameCounter == GFrameCounter && InFrameData.WorldTime.GetOffsettedTime() == m_preparedWorldTime
+		&& InFrameData.Transforms.Num() == m_preparedNumTransforms
+		&& (m_preparedNumTransforms == 0 || InFrameData.Transforms[0].Equals(m_preparedRoot, 0.0f));
+}
 
-	for(const FName& SrcCurveName : SourceCurveNames)
+void ULiveLinkMvnRetargetAsset::PrepareRetarget(const FLiveLinkAnimationFrameData& InFrameData)
+{
+	// the plan and T-pose are only built during evaluation, when the pose to retarget to is known
+	if(!m_boneMappingPlan.bValid || !m_tposeBasis.IsValid())
 	{
-		FName* TargetCurveName = CurveNameMap.Find(SrcCurveName);
-		if(TargetCurveName == nullptr)
-		{
-			FName NewName = SrcCurveName;
-			TransformedCurveNames.Add(NewName);
-			CurveNameMap.Add(SrcCurveName, NewName);
-		}
-		else
-		{
-			TransformedCurveNames.Add(*TargetCurveName);
-		}
+		return;
 	}
 
-	if(logValid)
-		m_doLog = false;
+	RetargetRotations(InFrameData);
+
+	m_preparedFrameCounter = GFrameCounter;
+	m_preparedWorldTime = InFrameData.WorldTime.GetOffsettedTime();
+	m_preparedNumTransforms = InFrameData.Transforms.Num();
+	m_preparedRoot = m_preparedNumTransforms > 0 ? InFrameData.Transforms[0] : FTransform::Identity;
+}
+
+void ULiveLinkMvnRetargetAsset::ScheduleForSubject(const FLiveLinkSubjectName& SubjectName)
+{
+	FMvnRetargetScheduler& Scheduler = FMvnRetargetScheduler::getInstance();
+	if(m_bScheduled)
+	{
+		Scheduler.Unregister(this);
+	}
+	Scheduler.Register(this, SubjectName);
+	m_bScheduled = true;
 }
 
 void ULiveLinkMvnRetargetAsset::BuildPoseAndCurveFromBaseData(float DeltaTime, const FLiveLinkBaseStaticData* InBaseStaticData, const FLiveLinkBaseFrameData* InBaseFrameData, FCompactPose& OutPose, FBlendedCurve& OutCurve)
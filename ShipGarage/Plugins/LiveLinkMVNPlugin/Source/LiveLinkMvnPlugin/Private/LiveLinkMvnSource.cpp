@@ -11,12 +11,41 @@
 #include "LiveLinkClient.h"
 #include "MvnRemoteControlManager.h"
 #include "LiveLinkMvnMetadataService.h"
+#include "MvnSubjectUpdatePolicy.h"
 #include "LiveLinkSourceSettings.h"
+#include "TimeCodeDatagram.h"
+#include "CenterOfMassDatagram.h"
+#include "LinearSegmentKinematicsDatagram.h"
+#include "AngularSegmentKinematicsDatagram.h"
+#include "JointAnglesDatagram.h"
+#include "TrackerKinematicsDatagram.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/Paths.h"
 
 
 #pragma optimize("", off)
 
 
+namespace
+{
+	// every source alive, for the capture console commands
+	TArray<FLiveLinkMvnSource*> GMvnSources;
+	FCriticalSection GMvnSourcesLock;
+
+	FMvnPredictionSettings GetPredictionSettings( const ULiveLinkMvnSourceSettings* Settings )
+	{
+		FMvnPredictionSettings Prediction;
+		Prediction.Horizon = FMath::Max( Settings->PredictionHorizonMs, 0.f ) / 1000.0;
+		for ( const TPair<FName, float>& SubjectHorizon : Settings->SubjectPredictionHorizonsMs )
+		{
+			Prediction.SubjectHorizons.Add( SubjectHorizon.Key, FMath::Max( SubjectHorizon.Value, 0.f ) / 1000.0 );
+		}
+		Prediction.bUseKinematics = Settings->bPredictFromKinematics;
+		return Prediction;
+	}
+}
 
 // ctor setup the socket for the given port and start the listener thread if isRunning is true
 FLiveLinkMvnSource::FLiveLinkMvnSource(int _port, bool isRunning)
@@ -26,18 +55,39 @@ FLiveLinkMvnSource::FLiveLinkMvnSource(int _port, bool isRunning)
 , Stopping(false)
 , Thread(nullptr)
 , WaitTime(FTimespan::FromMilliseconds(100))
+, ReceiveBufferSize(1024 * 1024)
+, ReceiveBatchSize(16)
+, ReceiveRingDepth(32)
+, bKernelReceiveTimestamps(true)
+, PushMode(EMvnFramePushMode::Immediate)
+, TimecodeFrameRate(60, 1)
+, bStreamKinematics(false)
+, ReceiveWorkers(1)
+, DataEvent(nullptr)
+, FrameCounter(0)
+, JitterBufferFrames(0)
+, JitterBufferLatency(0.0)
+, ActorTimeout(30.0)
+, Parser(new ParserManager())
+, TelemetryWindowStart(0.0)
+, WindowPackets(0)
+, WindowBytes(0)
+, WindowRingDepthMax(0)
+, NextSubjectCheck(0.0)
 {
-	FMemory::Memset(CurrentSkeletonSegmentCount, 0, sizeof(CurrentSkeletonSegmentCount));
-
-	// Size our LastPoses array
-	m_lastPoses.SetNum(XS_MAX_ACTORS_NUM);
-
+	FScopeLock Lock(&GMvnSourcesLock);
+	GMvnSources.Add(this);
 }
 
 FLiveLinkMvnSource::~FLiveLinkMvnSource()
 {
 	UE_LOG(LogTemp, Warning, TEXT("FLiveLinkMvnSource dtor"));
 
+	{
+		FScopeLock Lock(&GMvnSourcesLock);
+		GMvnSources.Remove(this);
+	}
+
 	Stop();
 	if (Thread != nullptr)
 	{
@@ -47,31 +97,410 @@ FLiveLinkMvnSource::~FLiveLinkMvnSource()
 		Thread = nullptr;
 	}
 
-	if (Socket != nullptr)
+	// the workers receive from the sockets, they go first
+	Workers.Reset();
+	BatchReceiver.Reset();
+	if (DataEvent != nullptr)
 	{
-		Socket->Close();
-		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		FPlatformProcess::ReturnSynchEventToPool(DataEvent);
+		DataEvent = nullptr;
 	}
 
-	if ( MvnRemoteControlManager::GetInstance() )
+	CaptureWriter.Close();
+
+	if (SourceGuid.IsValid())
 	{
-		MvnRemoteControlManager::GetInstance()->RemoveReservedPort( port );
+		FLiveLinkMvnMetadataService::getInstance().RemoveSource(SourceGuid);
+	}
+
+	// take this source out of the stat group
+	DEC_DWORD_STAT_BY(STAT_MvnActors, LastTelemetry.Actors.Num());
+	DEC_DWORD_STAT_BY(STAT_MvnLost, LastTelemetry.Lost);
+	DEC_DWORD_STAT_BY(STAT_MvnDuplicates, LastTelemetry.Duplicates);
+	DEC_DWORD_STAT_BY(STAT_MvnReordered, LastTelemetry.Reordered);
+	DEC_DWORD_STAT_BY(STAT_MvnFragmentsOutstanding, LastTelemetry.FragmentsOutstanding);
+	DEC_DWORD_STAT_BY(STAT_MvnOverflows, LastTelemetry.RingOverflows + FMath::Max<int64>(LastTelemetry.SocketDrops, 0));
+	DEC_DWORD_STAT_BY(STAT_MvnJitterDepth, LastTelemetry.JitterDepth);
+
+	for (FSocket* ListenSocket : Sockets)
+	{
+		ListenSocket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(ListenSocket);
+	}
+
+	if (Socket != nullptr)
+	{
+		Socket = nullptr;
+
+		// only a source that listened reserved its ports
+		if ( MvnRemoteControlManager::GetInstance() )
+		{
+			for (int32 PortIndex = 0; PortIndex <= AdditionalPorts.Num(); ++PortIndex)
+			{
+				MvnRemoteControlManager::GetInstance()->RemoveReservedPort( GetListenPort(PortIndex) );
+			}
+		}
 	}
 	//remove client
 }
 
-FName FLiveLinkMvnSource::GetSubjectName(int AvatarId, int PortNum) const
+FName FLiveLinkMvnSource::GetSubjectName(const FMvnActor& Actor) const
+{
+	FString AvatarName = Actor.Name;
+	if (AvatarName.IsEmpty())
+	{
+		AvatarName = FString::FromInt(1 + Actor.AvatarId);
+	}
+	FString SubjectName = FString::FromInt(GetListenPort(Actor.PortIndex)) + FString("-") + AvatarName;
+
+	// the first MVN instance keeps the plain name, so single sender setups see no change. The others are told
+	// apart by address, not by the port they send from, which changes whenever MVN restarts
+	if (Actor.SenderIndex > 0)
+	{
+		const FMvnSender& Sender = m_senders[Actor.SenderIndex];
+		SubjectName += FString(" (") + Sender.Endpoint.Address.ToString();
+		if (Sender.AddressSlot > 0)
+		{
+			SubjectName += FString(" #") + FString::FromInt(1 + Sender.AddressSlot);
+		}
+		SubjectName += FString(")");
+	}
+	return FName(*SubjectName);
+}
+
+int32 FLiveLinkMvnSource::GetActorCount() const
 {
-	FString AvatarName = FString("");
-	if (m_AvatarNames.Contains(AvatarId))
+	FScopeLock Lock(&m_actorsLock);
+	return m_actors.Num();
+}
+
+namespace
+{
+	uint64 GetEndpointKey(const FIPv4Endpoint& EndPt)
 	{
-		AvatarName = m_AvatarNames[AvatarId];
+		return ((uint64)EndPt.Address.Value << 16) | EndPt.Port;
 	}
-	if (AvatarName.IsEmpty())
+
+	uint64 GetActorKey(int32 SenderIndex, int32 PortIndex, int32 avatarId)
+	{
+		return ((uint64)SenderIndex << 16) | ((uint64)(uint8)PortIndex << 8) | (uint8)avatarId;
+	}
+}
+
+// MVN instance sending from EndPt. A restarted instance sends from a new port: it takes over the slot of a sender
+// on the same address that went silent, so its avatars keep their actors and subjects. Called on the receiver thread only
+int32 FLiveLinkMvnSource::FindOrAddSender(const FIPv4Endpoint& EndPt, double ReceiveTime)
+{
+	const uint64 Key = GetEndpointKey(EndPt);
+	const int32* Found = m_senderIndex.Find(Key);
+	int32 SenderIndex = Found != nullptr ? *Found : INDEX_NONE;
+	if (SenderIndex == INDEX_NONE)
+	{
+		int32 AddressSlot = 0;
+		for (int32 Index = 0; Index < m_senders.Num(); ++Index)
+		{
+			const FMvnSender& Sender = m_senders[Index];
+			if (Sender.Endpoint.Address != EndPt.Address)
+			{
+				continue;
+			}
+			if (ReceiveTime - Sender.LastReceiveTime > SenderIdleTime)
+			{
+				SenderIndex = Index;
+				break;
+			}
+			AddressSlot = FMath::Max(AddressSlot, Sender.AddressSlot + 1);
+		}
+
+		if (SenderIndex == INDEX_NONE)
+		{
+			SenderIndex = m_senders.AddDefaulted();
+			m_senders[SenderIndex].AddressSlot = AddressSlot;
+		}
+		else
+		{
+			// a new stream, its clock starts over
+			m_senderIndex.Remove(GetEndpointKey(m_senders[SenderIndex].Endpoint));
+			m_senders[SenderIndex].bHasStreamClock = false;
+		}
+		m_senders[SenderIndex].Endpoint = EndPt;
+		m_senderIndex.Add(Key, SenderIndex);
+	}
+
+	m_senders[SenderIndex].LastReceiveTime = ReceiveTime;
+	return SenderIndex;
+}
+
+// Actor of avatarId streamed by the sender to the port of PortIndex, created on its first datagram. Called on the receiver thread only
+FMvnActor& FLiveLinkMvnSource::FindOrAddActor(int32 SenderIndex, int32 PortIndex, int32 avatarId)
+{
+	const uint64 Key = GetActorKey(SenderIndex, PortIndex, avatarId);
+	if (const int32* Index = m_actorIndex.Find(Key))
+	{
+		return *m_actors[*Index];
+	}
+
+	TUniquePtr<FMvnActor> NewActor = MakeUnique<FMvnActor>(avatarId, SenderIndex, PortIndex);
+	NewActor->JitterBuffer.Configure(JitterBufferFrames, JitterBufferLatency);
+	NewActor->SubjectName = GetSubjectName(*NewActor);
+	NewActor->Predictor.Configure(Prediction.GetHorizon(NewActor->SubjectName), Prediction.bUseKinematics);
+	FMvnActor& Actor = *NewActor;
+
+	FScopeLock Lock(&m_actorsLock);
+	m_actorIndex.Add(Key, m_actors.Add(MoveTemp(NewActor)));
+	return Actor;
+}
+
+// Remove the actors silent for ActorTimeout with their subjects, so a stream that ended leaves no frozen subject behind.
+// Called on the receiver thread only
+void FLiveLinkMvnSource::ExpireActors(double Now)
+{
+	if (ActorTimeout <= 0.0)
+	{
+		return;
+	}
+
+	bool bRemoved = false;
+	for (int32 Index = m_actors.Num() - 1; Index >= 0; --Index)
+	{
+		const FMvnActor& Actor = *m_actors[Index];
+		if (Now - Actor.LastReceiveTime < ActorTimeout)
+		{
+			continue;
+		}
+
+		// held across the removal so a coalesced push can't recreate the subject
+		FScopeLock Lock(&m_actorsLock);
+
+		// static data is pushed before the first pose, an actor that never got one still has its subject.
+		// No client when fed directly, as in the benchmarks
+		if (Client != nullptr && (Actor.CurrentSkeletonSegmentCount > 0 || Actor.bHasPose))
+		{
+			Client->RemoveSubject_AnyThread(FLiveLinkSubjectKey(SourceGuid, Actor.SubjectName));
+		}
+		FLiveLinkMvnMetadataService::getInstance().RemoveSubject(SourceGuid, FLiveLinkSubjectName(Actor.SubjectName));
+
+		m_actors.RemoveAt(Index);
+		bRemoved = true;
+	}
+
+	if (bRemoved)
+	{
+		m_actorIndex.Reset();
+		for (int32 Index = 0; Index < m_actors.Num(); ++Index)
+		{
+			const FMvnActor& Actor = *m_actors[Index];
+			m_actorIndex.Add(GetActorKey(Actor.SenderIndex, Actor.PortIndex, Actor.AvatarId), Index);
+		}
+	}
+}
+
+const TArray<FLiveLinkMvnSource*>& FLiveLinkMvnSource::GetSources(FCriticalSection*& OutLock)
+{
+	OutLock = &GMvnSourcesLock;
+	return GMvnSources;
+}
+
+void FLiveLinkMvnSource::StartCapture(const FString& Filename)
+{
+	FString NewFilename = Filename;
+	if (NewFilename.IsEmpty())
+	{
+		NewFilename = FPaths::ProjectSavedDir() / TEXT("MvnCaptures") / FString::Printf(TEXT("MVN_%d_%s.mvncap"), port, *FDateTime::Now().ToString());
+	}
+
+	FScopeLock Lock(&m_captureLock);
+	PendingCaptureFilename = NewFilename;
+	bCaptureChanged = true;
+}
+
+void FLiveLinkMvnSource::StopCapture()
+{
+	FScopeLock Lock(&m_captureLock);
+	PendingCaptureFilename.Reset();
+	bCaptureChanged = true;
+}
+
+// Open or close the capture the game thread asked for, the writer is only touched by the receiver thread
+void FLiveLinkMvnSource::UpdateCapture()
+{
+	FString Filename;
+	{
+		FScopeLock Lock(&m_captureLock);
+		Filename = PendingCaptureFilename;
+		bCaptureChanged = false;
+	}
+
+	if (CaptureWriter.IsOpen())
+	{
+		CaptureWriter.Close();
+		UE_LOG(LogTemp, Log, TEXT("MVN capture on port %d stopped, %lld datagrams, %lld bytes"), port, CaptureWriter.GetNumRecords(), CaptureWriter.GetNumBytes());
+	}
+
+	if (!Filename.IsEmpty())
+	{
+		IFileManager::Get().MakeDirectory(*FPaths::GetPath(Filename), true);
+		if (CaptureWriter.Open(Filename, port, AdditionalPorts))
+		{
+			UE_LOG(LogTemp, Log, TEXT("MVN capture on port %d to %s"), port, *Filename);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("MVN capture on port %d: can't write %s"), port, *Filename);
+		}
+	}
+	bCapturing = CaptureWriter.IsOpen();
+}
+
+void FLiveLinkMvnSource::SetPrediction(const FMvnPredictionSettings& NewPrediction)
+{
+	FScopeLock Lock(&m_predictionLock);
+	PendingPrediction = NewPrediction;
+	bPredictionChanged = true;
+}
+
+// Take over the prediction settings the game thread left, the predictors are only touched by the receiver thread
+void FLiveLinkMvnSource::UpdatePrediction()
+{
+	{
+		FScopeLock Lock(&m_predictionLock);
+		Prediction = PendingPrediction;
+		bPredictionChanged = false;
+	}
+
+	for (const TUniquePtr<FMvnActor>& Actor : m_actors)
+	{
+		Actor->Predictor.Configure(Prediction.GetHorizon(Actor->SubjectName), Prediction.bUseKinematics);
+	}
+}
+
+FMvnSourceTelemetry FLiveLinkMvnSource::GetTelemetry() const
+{
+	FScopeLock Lock(&m_telemetryLock);
+	return Telemetry;
+}
+
+// Turn the counters of the window into rates and totals, publish them to the stat group, Insights and the source status
+void FLiveLinkMvnSource::UpdateTelemetry(double Now)
+{
+	if (TelemetryWindowStart == 0.0)
+	{
+		TelemetryWindowStart = Now;
+		return;
+	}
+	const double WindowSeconds = Now - TelemetryWindowStart;
+	if (WindowSeconds < 1.0)
+	{
+		return;
+	}
+
+	FMvnSourceTelemetry NewTelemetry;
+	NewTelemetry.Port = port;
+	NewTelemetry.WindowSeconds = WindowSeconds;
+	NewTelemetry.PacketsPerSecond = (float)(WindowPackets / WindowSeconds);
+	NewTelemetry.BytesPerSecond = (float)(WindowBytes / WindowSeconds);
+
+	const FragmentAssembler::Stats FragmentStats = Parser->fragmentAssembler().getStats();
+	NewTelemetry.FragmentsOutstanding = FragmentStats.pendingSamples;
+	NewTelemetry.IncompleteSamples = FragmentStats.incompleteSamples;
+	NewTelemetry.RingOverflows = BatchReceiver.IsValid() ? BatchReceiver->GetRingOverflows() : 0;
+	for (const TUniquePtr<FMvnReceiveWorker>& Worker : Workers)
 	{
-		AvatarName = FString::FromInt(1 + AvatarId);
+		NewTelemetry.RingOverflows += Worker->GetRingOverflows();
 	}
-	return FName(*(FString::FromInt(PortNum) + FString("-") + AvatarName));
+	NewTelemetry.SocketDrops = -1;
+	if (Socket != nullptr)
+	{
+		for (int32 PortIndex = 0; PortIndex <= AdditionalPorts.Num(); ++PortIndex)
+		{
+			const int64 PortDrops = MvnTelemetry::ReadSocketDrops(GetListenPort(PortIndex));
+			if (PortDrops >= 0)
+			{
+				NewTelemetry.SocketDrops = FMath::Max<int64>(NewTelemetry.SocketDrops, 0) + PortDrops;
+			}
+		}
+	}
+	NewTelemetry.RingDepthMax = WindowRingDepthMax;
+	NewTelemetry.DecodeMean = WindowDecodeTime.GetMean();
+	NewTelemetry.DecodeP99 = WindowDecodeTime.GetPercentile(0.99);
+	NewTelemetry.DecodeMax = WindowDecodeTime.Max;
+
+	double LatencySum = 0.0;
+	int64 LatencyCount = 0;
+	NewTelemetry.Actors.Reserve(m_actors.Num());
+	for (const TUniquePtr<FMvnActor>& Actor : m_actors)
+	{
+		FMvnActorTelemetry& ActorTelemetry = NewTelemetry.Actors.AddDefaulted_GetRef();
+		ActorTelemetry.SubjectName = Actor->SubjectName;
+		ActorTelemetry.SamplesPerSecond = (float)(Actor->WindowSamples / WindowSeconds);
+		Actor->WindowSamples = 0;
+
+		const FMvnJitterBufferStats JitterStats = Actor->JitterBuffer.GetStats();
+		ActorTelemetry.Lost = JitterStats.Lost;
+		ActorTelemetry.Duplicates = JitterStats.Duplicates;
+		ActorTelemetry.Late = JitterStats.Late;
+		ActorTelemetry.Buffered = JitterStats.Buffered;
+		ActorTelemetry.Reordered = Actor->Reordered;
+
+		const int64 Pushes = Actor->PushLatency.Take(ActorTelemetry.LatencyMean, ActorTelemetry.LatencyMax);
+		ActorTelemetry.PushesPerSecond = (float)(Pushes / WindowSeconds);
+
+		ActorTelemetry.PredictionHorizon = Actor->Predictor.GetHorizon();
+		ActorTelemetry.PredictionError = Actor->Predictor.TakeError();
+		NewTelemetry.PredictionError.Append(ActorTelemetry.PredictionError);
+
+		NewTelemetry.Lost += ActorTelemetry.Lost;
+		NewTelemetry.Duplicates += ActorTelemetry.Duplicates;
+		NewTelemetry.Reordered += ActorTelemetry.Reordered;
+		NewTelemetry.JitterDepth += ActorTelemetry.Buffered;
+		NewTelemetry.LatencyMax = FMath::Max(NewTelemetry.LatencyMax, ActorTelemetry.LatencyMax);
+		LatencySum += ActorTelemetry.LatencyMean * Pushes;
+		LatencyCount += Pushes;
+	}
+	NewTelemetry.LatencyMean = LatencyCount > 0 ? LatencySum / LatencyCount : 0.0;
+
+	// the stat group sums all sources, each moves it by its own change
+	INC_DWORD_STAT_BY(STAT_MvnActors, NewTelemetry.Actors.Num() - LastTelemetry.Actors.Num());
+	INC_DWORD_STAT_BY(STAT_MvnLost, NewTelemetry.Lost - LastTelemetry.Lost);
+	INC_DWORD_STAT_BY(STAT_MvnDuplicates, NewTelemetry.Duplicates - LastTelemetry.Duplicates);
+	INC_DWORD_STAT_BY(STAT_MvnReordered, NewTelemetry.Reordered - LastTelemetry.Reordered);
+	INC_DWORD_STAT_BY(STAT_MvnFragmentsOutstanding, NewTelemetry.FragmentsOutstanding - LastTelemetry.FragmentsOutstanding);
+	INC_DWORD_STAT_BY(STAT_MvnOverflows, NewTelemetry.RingOverflows + FMath::Max<int64>(NewTelemetry.SocketDrops, 0)
+		- LastTelemetry.RingOverflows - FMath::Max<int64>(LastTelemetry.SocketDrops, 0));
+	INC_DWORD_STAT_BY(STAT_MvnJitterDepth, NewTelemetry.JitterDepth - LastTelemetry.JitterDepth);
+
+	TraceCounters.Set(NewTelemetry);
+
+	const FString Status = NewTelemetry.ToStatusString();
+	{
+		FScopeLock Lock(&m_telemetryLock);
+		Telemetry = NewTelemetry;
+		TelemetryStatus = Status;
+	}
+	bTelemetryChanged = true;
+	LastTelemetry = MoveTemp(NewTelemetry);
+
+	TelemetryWindowStart = Now;
+	WindowPackets = 0;
+	WindowBytes = 0;
+	WindowRingDepthMax = 0;
+	WindowDecodeTime.Reset();
+}
+
+FragmentAssembler::Stats FLiveLinkMvnSource::GetFragmentStats() const
+{
+	return Parser->fragmentAssembler().getStats();
+}
+
+FMvnJitterBufferStats FLiveLinkMvnSource::GetJitterStats() const
+{
+	FMvnJitterBufferStats Stats;
+	FScopeLock Lock(&m_actorsLock);
+	for (const TUniquePtr<FMvnActor>& Actor : m_actors)
+	{
+		Stats += Actor->JitterBuffer.GetStats();
+	}
+	return Stats;
 }
 
 void FLiveLinkMvnSource::ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid)
@@ -87,6 +516,29 @@ bool FLiveLinkMvnSource::IsSourceStillValid() const
 	return bIsSourceValid;
 }
 
+// Called on the game thread every engine tick
+void FLiveLinkMvnSource::Update()
+{
+	if (bTelemetryChanged)
+	{
+		bTelemetryChanged = false;
+		FScopeLock Lock(&m_telemetryLock);
+		SourceStatus = FText::FromString(TelemetryStatus);
+	}
+
+	if (PushMode != EMvnFramePushMode::CoalescePerTick)
+	{
+		return;
+	}
+
+	// only the newest pose of each avatar is pushed, older ones were overwritten in the triple buffer
+	FScopeLock Lock(&m_actorsLock);
+	for (const TUniquePtr<FMvnActor>& Actor : m_actors)
+	{
+		Send(*Actor);
+	}
+}
+
 bool FLiveLinkMvnSource::RequestSourceShutdown()
 {
 	Stop();
@@ -98,29 +550,38 @@ bool FLiveLinkMvnSource::RequestSourceShutdown()
 void FLiveLinkMvnSource::ClearSubject()
 {
 	//release client
-	for (int avatarId=0; avatarId < XS_MAX_ACTORS_NUM; ++avatarId)
+	FScopeLock Lock(&m_actorsLock);
+	for (const TUniquePtr<FMvnActor>& Actor : m_actors)
 	{
-		m_critical.Lock();
-		if (m_lastPoses[avatarId].IsValid())
+		if (Actor->CurrentSkeletonSegmentCount > 0 || Actor->bHasPose)
 		{
-			m_critical.Unlock();
 			FLiveLinkSubjectKey SubjectKey;
 			SubjectKey.Source = SourceGuid;
-			SubjectKey.SubjectName = GetSubjectName(avatarId, port);
+			SubjectKey.SubjectName = Actor->SubjectName;
 			Client->RemoveSubject_AnyThread(SubjectKey);
 		}
-		else
-			m_critical.Unlock();
 	}
 }
 
-void FLiveLinkMvnSource::updateRefSkeleton(int avatarId, int numOfSegments)
+// Create the subject of Actor with a skeleton of numOfSegments, or replace its skeleton. Receiver thread only
+void FLiveLinkMvnSource::updateRefSkeleton(FMvnActor& Actor, int numOfSegments)
 {
 	const int32 RequiredBoneCount = numOfSegments + 1;
-	if (CurrentSkeletonSegmentCount[avatarId] != RequiredBoneCount && SourceGuid.IsValid())
+	Actor.CurrentSkeletonSegmentCount = RequiredBoneCount;
+
+	const FName SubjectName = Actor.SubjectName;
+	FLiveLinkMvnMetadataService::getInstance().SetSegmentCount(SourceGuid, FLiveLinkSubjectName(SubjectName), numOfSegments);
+
+	// no client when fed directly, as in the benchmarks
+	if (Client != nullptr && SourceGuid.IsValid())
 	{
 		FLiveLinkStaticDataStruct StaticData(FLiveLinkSkeletonStaticData::StaticStruct());;
 		FLiveLinkSkeletonStaticData& NewSkeleton = *StaticData.Cast<FLiveLinkSkeletonStaticData>();
+		if (bStreamKinematics)
+		{
+			NewSkeleton.PropertyNames = FMvnKinematicsProperties::GetNames();
+			Actor.JointTrackers.AppendNames(NewSkeleton.PropertyNames, Actor.SegmentNames);
+		}
 		NewSkeleton.BoneNames.Reserve(RequiredBoneCount);
 		NewSkeleton.BoneParents.Reserve(RequiredBoneCount);
 		for (int32 i = 0; i < RequiredBoneCount; ++i)
@@ -129,28 +590,16 @@ void FLiveLinkMvnSource::updateRefSkeleton(int avatarId, int numOfSegments)
 			NewSkeleton.BoneParents.Add(SegmentInformation::parentIndex[i]);
 		}
 
-		CurrentSkeletonSegmentCount[avatarId] = RequiredBoneCount;
-
-		const FName SubjectName = GetSubjectName(avatarId, port);
-		if (SourceGuid.IsValid())
+		FLiveLinkSubjectKey SubjectKey(SourceGuid, SubjectName);
+		// fix for duplicated sources issue XUU-90
+		//if ( Client->GetSubjectSettings( SubjectKey ) == nullptr )
+		{
+			Client->PushSubjectStaticData_AnyThread( SubjectKey, ULiveLinkAnimationRole::StaticClass(), MoveTemp( StaticData ) );
+		}
+		//else
 		{
-			FLiveLinkSubjectKey SubjectKey(SourceGuid, SubjectName);
 			// fix for duplicated sources issue XUU-90
-			//if ( Client->GetSubjectSettings( SubjectKey ) == nullptr )
-			{
-				Client->PushSubjectStaticData_AnyThread( SubjectKey, ULiveLinkAnimationRole::StaticClass(), MoveTemp( StaticData ) );
-			}
-			//else
-			{
-				// fix for duplicated sources issue XUU-90
-				//UE_LOG( LogTemp, Warning, TEXT( "detected reading source %s " ), *SubjectKey.SubjectName.ToString() );
-			}
-			
-
-			if (!m_AvatarNames.Contains(avatarId))
-			{
-				m_AvatarNames.Add(avatarId, FString::FromInt(1 + avatarId));
-			}
+			//UE_LOG( LogTemp, Warning, TEXT( "detected reading source %s " ), *SubjectKey.SubjectName.ToString() );
 		}
 	}
 }
@@ -162,54 +611,143 @@ void FLiveLinkMvnSource::Start()
 	ThreadName.AppendInt(FAsyncThreadIndex::GetNext());
 
 	Thread = FRunnableThread::Create(this, *ThreadName, 128 * 1024, TPri_AboveNormal, FPlatformAffinity::GetPoolThreadMask());
+
+	for (int32 WorkerIndex = 0; WorkerIndex < Workers.Num(); ++WorkerIndex)
+	{
+		Workers[WorkerIndex]->Start(FString::Printf(TEXT("%s Worker %d"), *ThreadName, WorkerIndex));
+	}
 }
 
 void FLiveLinkMvnSource::Stop()
 {
 	Stopping = true;
+
+	for (const TUniquePtr<FMvnReceiveWorker>& Worker : Workers)
+	{
+		Worker->Stop();
+	}
+	if (DataEvent != nullptr)
+	{
+		DataEvent->Trigger();
+	}
 }
 
 uint32 FLiveLinkMvnSource::Run()
 {
-	TSharedRef<FInternetAddr> Sender = SocketSubsystem->CreateInternetAddr();
-
 	while (!Stopping)
 	{
-		if (!Socket->Wait(ESocketWaitConditions::WaitForRead, WaitTime))
+		if (bCaptureChanged)
 		{
-			continue;
+			UpdateCapture();
 		}
 
-		uint32 Size;
+		if (bPredictionChanged)
+		{
+			UpdatePrediction();
+		}
 
-		while (Socket->HasPendingData(Size))
+		const bool bReceived = Workers.Num() > 0 ? ReceiveFromWorkers() : ReceiveFromSocket();
+		if (!bReceived)
 		{
-			FArrayReaderPtr Reader = MakeShareable(new FArrayReader(true));
-			Reader->SetNumUninitialized(FMath::Min(Size, 65507u));
+			// nothing arrived, give up on samples whose fragments went missing
+			Parser->fragmentAssembler().expire(FPlatformTime::Seconds());
 
-			int32 Read = 0;
+			// a quiet moment, get the capture to disk
+			CaptureWriter.Flush();
+		}
 
-			if (Socket->RecvFrom(Reader->GetData(), Reader->Num(), Read, *Sender))
-			{
-				Reader->RemoveAt(Read, Reader->Num() - Read, false);
-				Recv(Reader, FIPv4Endpoint(Sender));
-			}
+		// samples held back by the jitter buffer become due over time, not only when new ones arrive
+		const double Now = FPlatformTime::Seconds();
+		for (const TUniquePtr<FMvnActor>& Actor : m_actors)
+		{
+			ReleaseDuePoses(*Actor, Now);
 		}
+		UpdateSubjects(Now);
+		UpdateTelemetry(Now);
 	}
+
+	CaptureWriter.Close();
+	bCapturing = false;
 	return 0;
 }
 
+bool FLiveLinkMvnSource::ReceiveFromSocket()
+{
+	if (!Socket->Wait(ESocketWaitConditions::WaitForRead, WaitTime))
+	{
+		return false;
+	}
+
+	// drain everything queued on the socket, one batch at a time
+	while (!Stopping && BatchReceiver->ReceiveBatch(*PacketRing) > 0)
+	{
+		DecodeRing(*PacketRing);
+	}
+	return true;
+}
+
+bool FLiveLinkMvnSource::ReceiveFromWorkers()
+{
+	// a worker raises the event after filling its ring, datagrams that came in while
+	// the rings were decoded left it raised and are picked up on the next call
+	DataEvent->Wait(WaitTime);
+
+	// a sender streams to one socket, so the datagrams of each sender stay in order
+	bool bReceived = false;
+	for (const TUniquePtr<FMvnReceiveWorker>& Worker : Workers)
+	{
+		if (DecodeRing(Worker->GetRing()))
+		{
+			Worker->NotifyRingDrained();
+			bReceived = true;
+		}
+	}
+	return bReceived;
+}
+
+bool FLiveLinkMvnSource::DecodeRing(FMvnPacketRing& Ring)
+{
+	WindowRingDepthMax = FMath::Max(WindowRingDepthMax, Ring.Num());
+
+	bool bDecoded = false;
+	while (FMvnPacketSlot* Slot = Ring.PeekRead())
+	{
+		if (CaptureWriter.IsOpen())
+		{
+			CaptureWriter.Write(Slot->GetData(), Slot->Size, Slot->Sender, Slot->ReceiveTime, Slot->PortIndex);
+		}
+		Recv(Slot->GetData(), Slot->Size, Slot->Sender, Slot->ReceiveTime, Slot->PortIndex);
+		Ring.ReleaseRead();
+		bDecoded = true;
+	}
+	return bDecoded;
+}
+
 // Receiver thread runs until Stop() is called or source removed
 void FLiveLinkMvnSource::Recv(const FArrayReaderPtr& ArrayReaderPtr, const FIPv4Endpoint& EndPt)
 {
-	TArray<uint8_t> RawData;
-	uint32 DataReceivedNum = ArrayReaderPtr->Num();
+	Recv(ArrayReaderPtr->GetData(), ArrayReaderPtr->Num(), EndPt, FPlatformTime::Seconds());
+}
 
-	RawData.Append(ArrayReaderPtr->GetData(), DataReceivedNum);
+void FLiveLinkMvnSource::Recv(const uint8* Data, int32 Size, const FIPv4Endpoint& EndPt, double ReceiveTime, int32 PortIndex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MvnDecode);
+	INC_DWORD_STAT(STAT_MvnPackets);
+	INC_DWORD_STAT_BY(STAT_MvnBytes, Size);
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	Decode(Data, Size, EndPt, ReceiveTime, PortIndex);
+	WindowDecodeTime.Add(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles));
+	++WindowPackets;
+	WindowBytes += Size;
+}
 
-	if (RawData.Num() > 0)
+void FLiveLinkMvnSource::Decode(const uint8* Data, int32 Size, const FIPv4Endpoint& EndPt, double ReceiveTime, int32 PortIndex)
+{
+	if (Size > 0)
 	{
-		std::unique_ptr<Datagram> d(Parser->readDatagram(RawData));
+		// decoded in place, the datagram is owned and reused by the parser
+		Datagram* d = Parser->readDatagram(Data, Size, EndPt, PortIndex, ReceiveTime);
 
 		if (d != nullptr)
 		{
@@ -218,29 +756,81 @@ void FLiveLinkMvnSource::Recv(const FArrayReaderPtr& ArrayReaderPtr, const FIPv4
 			unsigned int propCount = d->propCount();
 			unsigned int fingerSegCount = d->fingerTrackingSegmentCount();
 
+			const int32 SenderIndex = FindOrAddSender(EndPt, ReceiveTime);
+			FMvnActor& Actor = FindOrAddActor(SenderIndex, PortIndex, avatarId);
+			FMvnSender& Sender = m_senders[SenderIndex];
+			Actor.LastReceiveTime = ReceiveTime;
+
 			StreamingProtocol proto = (StreamingProtocol)d->messageType();
-			MvnTPose& tPose = m_atposesPos[avatarId];
+			MvnTPose& tPose = Actor.TPose;
 			if (proto == StreamingProtocol::SPPoseQuaternion)
 			{
-				TSharedPtr<Pose, ESPMode::ThreadSafe> NewPose(new Pose());
+				// make room first, a full jitter buffer always has a due sample
+				ReleaseDuePoses(Actor, ReceiveTime);
 
-				QuaternionDatagram *q = static_cast<QuaternionDatagram *>(d.get());
+				const int32 SampleCounter = d->sampleCounter();
+				// far behind is MVN restarting the stream, like the jitter buffer takes it
+				if (Actor.bHasSampleCounter && SampleCounter < Actor.NewestSampleCounter && Actor.NewestSampleCounter - SampleCounter < 1000)
+				{
+					++Actor.Reordered;
+				}
+				else
+				{
+					Actor.NewestSampleCounter = SampleCounter;
+					Actor.bHasSampleCounter = true;
+				}
+
+				// decoded in place into the jitter buffer, duplicates and late samples are dropped
+				Pose* NewPose = Actor.JitterBuffer.Insert(d->sampleCounter(), ReceiveTime);
+				if (NewPose == nullptr)
+				{
+					return;
+				}
+
+				QuaternionDatagram *q = static_cast<QuaternionDatagram *>(d);
 
 				bool haveFingers = (fingerSegCount > 0);
 				int firstFinger = (haveFingers ? SegData::Prop1 + propCount : q->m_data.size());
 
 				if (haveFingers)
-					NewPose->Segments.resize(SegData::XS_SEG_NUM_FINGERS);
+					NewPose->Reset(SegData::XS_SEG_NUM_FINGERS);
 				else
-					NewPose->Segments.resize(q->m_data.size());
+					NewPose->Reset(FMath::Min((int)q->m_data.size(), (int)SegData::XS_SEG_NUM_FINGERS));
 
 				NewPose->AvatarId = avatarId;
 				NewPose->FrameId = FrameCounter++;
+				NewPose->SampleCounter = d->sampleCounter();
+				NewPose->WorldTime = StreamToWorldTime(Sender, d->frameTime(), ReceiveTime);
+				NewPose->ReceiveTime = ReceiveTime;
+				NewPose->bHasSceneTime = Actor.bHasTimecode;
+				if (NewPose->bHasSceneTime)
+				{
+					// extrapolate from the last time code, MVN may send it before or after the pose
+					const double timecodeSeconds = Actor.TimecodeSeconds + (d->frameTime() - Actor.TimecodeFrameTime) / 1000.0;
+					NewPose->SceneTime = FQualifiedFrameTime(TimecodeFrameRate.AsFrameTime(timecodeSeconds), TimecodeFrameRate);
+
+					// with a synchronized server clock the time code maps to local time without the network delay
+					const FMvnClockSync* ClockSync = FindClockSync(Sender);
+					if (ClockSync != nullptr && ClockSync->IsValid())
+					{
+						NewPose->WorldTime = ClockSync->ServerToLocal(timecodeSeconds, ReceiveTime);
+					}
+				}
+				if (bStreamKinematics)
+				{
+					// the kinematics datagrams of a sample may arrive after its pose, these can be the previous sample's
+					NewPose->Kinematics = Actor.Kinematics;
+					NewPose->JointTrackers = Actor.JointTrackers;
+				}
+
+				MvnSegmentKernel::ConvertSegments(q->m_data.data(), (int32)q->m_data.size(), ConvertedPositions, ConvertedRotations);
 
 				for (int s = 0; s < (int)q->m_data.size(); s++)
 				{
 					int segmentId = q->m_data[s].segmentId;
 					int segmentIndex = segmentId - 1;
+					if (!NewPose->Segments.IsValidIndex(segmentIndex))
+						continue;
 					SegData* seg = &NewPose->Segments[segmentIndex];
 
 					if (s >= firstFinger)
@@ -253,29 +843,66 @@ void FLiveLinkMvnSource::Recv(const FArrayReaderPtr& ArrayReaderPtr, const FIPv4
 								NewPose->Segments[segmentIndex].Set(kin, t);
 						}
 						segmentIndex = s + SegData::XS_SEG_NUM - firstFinger;
+						if (!NewPose->Segments.IsValidIndex(segmentIndex))
+							continue;
 						seg = &NewPose->Segments[segmentIndex];
 					}
 					if (tPose.Num() > s)
-						seg->Set(q->m_data[s], segmentIndex, tPose[s]);
+						seg->Set(ConvertedPositions, ConvertedRotations, s, tPose[s]);
 					else
-						seg->Set(q->m_data[s], segmentIndex);
+						seg->Set(ConvertedPositions, ConvertedRotations, s);
 				}
 
-				FLiveLinkSubjectName SubjectName = FLiveLinkSubjectName(GetSubjectName(avatarId, port));
-				FLiveLinkMvnMetadataService::getInstance().SetSegmentCount(SourceGuid, SubjectName, NewPose->Segments.size());
+				// the layout only changes with the MVN configuration or a rename, the subject is set up before the pose goes out
+				if (Actor.CurrentSkeletonSegmentCount != NewPose->Segments.Num() + 1)
+				{
+					updateRefSkeleton(Actor, NewPose->Segments.Num());
+				}
 
-				updateRefSkeleton(avatarId, NewPose->Segments.size());
-				m_critical.Lock();
-				// Pointer swap
-				m_lastPoses[avatarId] = NewPose;
-				m_critical.Unlock();
+				++Actor.WindowSamples;
+				ReleaseDuePoses(Actor, ReceiveTime);
+			}
+			else if (proto == SPTimeCode)
+			{
+				TimeCodeDatagram* q = static_cast<TimeCodeDatagram*>(d);
+				Actor.TimecodeSeconds = q->seconds();
+				Actor.TimecodeFrameTime = d->frameTime();
+				Actor.bHasTimecode = true;
+			}
+			else if (proto == SPCenterOfMass)
+			{
+				Actor.Kinematics.SetCenterOfMass(*static_cast<CenterOfMassDatagram*>(d));
+			}
+			else if (proto == SPLinearSegmentKinematics)
+			{
+				Actor.Kinematics.SetLinear(*static_cast<LinearSegmentKinematicsDatagram*>(d));
+			}
+			else if (proto == SPAngularSegmentKinematics)
+			{
+				Actor.Kinematics.SetAngular(*static_cast<AngularSegmentKinematicsDatagram*>(d));
+			}
+			else if (proto == SPJointAngles)
+			{
+				// other joints than the property names were built for, set the subject up again with the next pose
+				if (Actor.JointTrackers.SetJointAngles(*static_cast<JointAnglesDatagram*>(d)) && bStreamKinematics)
+				{
+					Actor.CurrentSkeletonSegmentCount = 0;
+				}
+			}
+			else if (proto == SPTrackerKinematics)
+			{
+				if (Actor.JointTrackers.SetTrackers(*static_cast<TrackerKinematicsDatagram*>(d)) && bStreamKinematics)
+				{
+					Actor.CurrentSkeletonSegmentCount = 0;
+				}
 			}
 			else if (proto == SPMetaScaling)
 			{
-				ScaleDatagram *q = static_cast<ScaleDatagram *>(d.get());
+				ScaleDatagram *q = static_cast<ScaleDatagram *>(d);
 				if (!q->m_data.empty())
 				{
 					TArray<FString> segmentNames;
+					TArray<FName> segmentFNames;
 
 					if (tPose.Num() != q->m_data.size())
 					{
@@ -285,96 +912,236 @@ void FLiveLinkMvnSource::Recv(const FArrayReaderPtr& ArrayReaderPtr, const FIPv4
 					{
 						tPose[s] = FVector(q->m_data[s].segmentOriginPos[0] * 100, -q->m_data[s].segmentOriginPos[1] * 100, q->m_data[s].segmentOriginPos[2] * 100);
 						segmentNames.Add(FString(q->m_data[s].segmentName.c_str()));
+						segmentFNames.Add(FName(*segmentNames.Last()));
 					}
 
-					FLiveLinkSubjectName SubjectName = FLiveLinkSubjectName(GetSubjectName(avatarId, port));
+					// the joint and tracker properties are named after the segments
+					if (Actor.SegmentNames != segmentFNames)
+					{
+						Actor.SegmentNames = MoveTemp(segmentFNames);
+						if (bStreamKinematics && Actor.JointTrackers.Num() > 0)
+						{
+							Actor.CurrentSkeletonSegmentCount = 0;
+						}
+					}
+
+					FLiveLinkSubjectName SubjectName = FLiveLinkSubjectName(Actor.SubjectName);
 					FLiveLinkMvnMetadataService::getInstance().SetSegmentNames(SourceGuid, SubjectName, segmentNames);
 				}
 			}
 			else if (proto == SPMetaMoreMeta)
 			{
-				MetaDatagram* q = static_cast<MetaDatagram*>(d.get());
+				MetaDatagram* q = static_cast<MetaDatagram*>(d);
 				if (!q->m_Name.empty())
 				{
-					bool IsNewSubject = false;
 					FString NewSubjectName = FString(q->m_Name.c_str());
-					if (!m_AvatarNames.Contains(avatarId))
-					{
-						m_AvatarNames.Add(avatarId, FString(""));
-						IsNewSubject = true;
-					}
-					else
-					{
-						IsNewSubject = m_AvatarNames[avatarId] != NewSubjectName;
-					}
-					if (IsNewSubject)
+					if (Actor.Name != NewSubjectName)
 					{
-						FLiveLinkSubjectKey SubjectKey;
-						SubjectKey.Source = SourceGuid;
-						SubjectKey.SubjectName = GetSubjectName(avatarId, port);
-						if (Client->GetSubjectSettings(SubjectKey) != nullptr)
-						{
-							Client->RemoveSubject_AnyThread(SubjectKey);
-						}
-						else
-						{
-							m_SubjectsToDelete.Add(SubjectKey);
-						}
-						CurrentSkeletonSegmentCount[avatarId] = 0; // to force subject update
-
-						m_AvatarNames[avatarId] = NewSubjectName;
+						RenameSubject(Actor, NewSubjectName);
 					}
 				}
 			}
-			DeleteDelayedSubjects();
-			AsyncTask(ENamedThreads::GameThread, [this, avatarId]() { Send(avatarId); });
 		}
 	}
 }
 
-void FLiveLinkMvnSource::Send(int avatarId)
+// Publish the samples of Actor the jitter buffer releases at Now, in sample counter order
+void FLiveLinkMvnSource::ReleaseDuePoses(FMvnActor& Actor, double Now)
+{
+	while (const Pose* DuePose = Actor.JitterBuffer.PeekDue(Now))
+	{
+		// publish, the reader picks up the newest pose on its next swap
+		Actor.LastPose.GetWriteBuffer() = *DuePose;
+		if (Actor.Predictor.IsEnabled())
+		{
+			Actor.Predictor.Predict(Actor.LastPose.GetWriteBuffer());
+		}
+		Actor.LastPose.SwapWriteBuffers();
+		Actor.bHasPose = true;
+		Actor.JitterBuffer.Pop();
+
+		if (PushMode == EMvnFramePushMode::Immediate)
+		{
+			// Live Link accepts frames from any thread, no need to go through the game thread
+			Send(Actor);
+		}
+	}
+}
+
+// Map the stream time of a sample (ms) to FPlatformTime::Seconds(), free of the network jitter of ReceiveTime
+double FLiveLinkMvnSource::StreamToWorldTime(FMvnSender& Sender, int32 frameTime, double ReceiveTime)
+{
+	const double streamSeconds = frameTime / 1000.0;
+	const double offset = ReceiveTime - streamSeconds;
+	const int64 bucket = (int64)(ReceiveTime / FMvnSender::StreamClockBucketSeconds);
+
+	// start over when the stream clock jumps, otherwise move the window up to the bucket of this arrival
+	if (!Sender.bHasStreamClock || offset - Sender.StreamClockOffset > 1.0)
+	{
+		for (double& BucketOffset : Sender.StreamClockBucketOffsets)
+		{
+			BucketOffset = TNumericLimits<double>::Max();
+		}
+		Sender.StreamClockBucket = bucket;
+		Sender.bHasStreamClock = true;
+	}
+	for (; Sender.StreamClockBucket < bucket; ++Sender.StreamClockBucket)
+	{
+		if (bucket - Sender.StreamClockBucket > FMvnSender::StreamClockBuckets)
+		{
+			Sender.StreamClockBucket = bucket - FMvnSender::StreamClockBuckets;
+		}
+		Sender.StreamClockBucketOffsets[(Sender.StreamClockBucket + 1) % FMvnSender::StreamClockBuckets] = TNumericLimits<double>::Max();
+	}
+
+	// the fastest arrival is the one least delayed by the network, arrivals stamped before the window don't count
+	if (Sender.StreamClockBucket - bucket < FMvnSender::StreamClockBuckets)
+	{
+		double& BucketOffset = Sender.StreamClockBucketOffsets[bucket % FMvnSender::StreamClockBuckets];
+		BucketOffset = FMath::Min(BucketOffset, offset);
+	}
+
+	Sender.StreamClockOffset = TNumericLimits<double>::Max();
+	for (const double BucketOffset : Sender.StreamClockBucketOffsets)
+	{
+		Sender.StreamClockOffset = FMath::Min(Sender.StreamClockOffset, BucketOffset);
+	}
+	return streamSeconds + Sender.StreamClockOffset;
+}
+
+// The clock estimate of the remote control session to the sender, looked up again when sessions change
+const FMvnClockSync* FLiveLinkMvnSource::FindClockSync(FMvnSender& Sender)
+{
+	FMvnClockSyncRegistry& Registry = FMvnClockSyncRegistry::getInstance();
+	const int32 Generation = Registry.GetGeneration();
+	if (Sender.ClockSyncGeneration != Generation)
+	{
+		Sender.ClockSync = Registry.Find(Sender.Endpoint.Address);
+		Sender.ClockSyncGeneration = Generation;
+	}
+	return Sender.ClockSync.Get();
+}
+
+void FLiveLinkMvnSource::Send(FMvnActor& Actor)
 {
 	// Early exit if no Client or not running
 	if (Stopping || Client == nullptr)
 		return;
 
+	SCOPE_CYCLE_COUNTER(STAT_MvnPush);
+
+	// nothing new since the last push
+	TTripleBuffer<Pose>& PoseBuffer = Actor.LastPose;
+	if (!Actor.bHasPose || !PoseBuffer.IsDirty())
+		return;
+
+	// read once, RenameSubject replaces it under m_actorsLock while a coalesced push holds that lock
+	const FName SubjectName = Actor.SubjectName;
+
+	// a throttled subject leaves the newest pose in the buffer for a later push
+	if (!FMvnSubjectUpdatePolicy::getInstance().ShouldPush(SubjectName, FPlatformTime::Seconds()))
+		return;
+	PoseBuffer.SwapReadBuffers();
+	const Pose* LatestPose = &PoseBuffer.Read();
+
 	//build up Subject data
-	const FName SubjectName = GetSubjectName(avatarId, port);
 	FLiveLinkSubjectKey SubjectKey(SourceGuid, SubjectName);
 
 	FLiveLinkFrameDataStruct FrameData(FLiveLinkAnimationFrameData::StaticStruct());
 	FLiveLinkAnimationFrameData& AnimFrameData = *FrameData.Cast<FLiveLinkAnimationFrameData>();
 	TArray<FTransform>& Transforms = AnimFrameData.Transforms;
 
+	// stamp with the stream's own clock and time code so Live Link can buffer and interpolate
+	AnimFrameData.WorldTime = FLiveLinkWorldTime(LatestPose->WorldTime);
+	if (LatestPose->bHasSceneTime)
+	{
+		AnimFrameData.MetaData.SceneTime = LatestPose->SceneTime;
+	}
+
 	// Reserve space for all segments + root
-	Transforms.Reserve(1 + SegData::XS_SEG_NUM);
+	Transforms.Reserve(1 + LatestPose->Segments.Num());
 
 	// add Root first
 	Transforms.Add(FTransform::Identity);
 
-	m_critical.Lock();
-	TSharedPtr<Pose, ESPMode::ThreadSafe> LatestPose = m_lastPoses[avatarId];
-	m_critical.Unlock();
+	for(const SegData& Segment : LatestPose->Segments)
+	{
+		Transforms.Add(Segment.Transform);
+	}
 
-	if (!LatestPose.IsValid())
-		return;
+	if (bStreamKinematics)
+	{
+		AnimFrameData.PropertyValues.Reserve(FMvnKinematicsProperties::Count + LatestPose->JointTrackers.Num());
+		AnimFrameData.PropertyValues.Append(LatestPose->Kinematics.Values, FMvnKinematicsProperties::Count);
+		LatestPose->JointTrackers.AppendValues(AnimFrameData.PropertyValues);
+	}
+
+	//direct communication with client, a subject that went missing is set up again by UpdateSubjects
+	Client->PushSubjectFrameData_AnyThread(SubjectKey, MoveTemp(FrameData));
+	Actor.PushLatency.Add(FPlatformTime::Seconds() - LatestPose->ReceiveTime);
+}
+
+// The MVN name of an avatar changed, its subject is replaced by one under the new name. Receiver thread only
+void FLiveLinkMvnSource::RenameSubject(FMvnActor& Actor, const FString& NewName)
+{
+	// the game thread pushes coalesced poses under this lock, it must neither read the name while it changes
+	// nor push under the old name once that subject is removed
+	FScopeLock Lock(&m_actorsLock);
+
+	FLiveLinkSubjectKey SubjectKey;
+	SubjectKey.Source = SourceGuid;
+	SubjectKey.SubjectName = Actor.SubjectName;
+	// no client when fed directly, as in the benchmarks
+	if (Client != nullptr)
+	{
+		if (Client->GetSubjectSettings(SubjectKey) != nullptr)
+		{
+			Client->RemoveSubject_AnyThread(SubjectKey);
+		}
+		else
+		{
+			m_SubjectsToDelete.Add(SubjectKey);
+		}
+	}
+	Actor.CurrentSkeletonSegmentCount = 0; // to force subject update
+	FLiveLinkMvnMetadataService::getInstance().RemoveSubject(SourceGuid, SubjectKey.SubjectName);
+
+	Actor.Name = NewName;
+	Actor.SubjectName = GetSubjectName(Actor);
 
-	for(auto & Segment : LatestPose->Segments)
+	// the horizon can be set per subject name
+	const double Horizon = Prediction.GetHorizon(Actor.SubjectName);
+	if (Horizon != Actor.Predictor.GetHorizon())
 	{
-		SegData* seg = &Segment;
-		Transforms.Add(seg->Transform);
+		Actor.Predictor.Configure(Horizon, Prediction.bUseKinematics);
 	}
+}
 
-	//direct communication with client
-	// if subject is missing, force its static data update (can happen after multiple source sending to the same port)
-	if (Client->GetSubjectSettings(SubjectKey) == nullptr)
+// Subject housekeeping the pose path leaves alone, called from the receive loop every SubjectCheckInterval
+void FLiveLinkMvnSource::UpdateSubjects(double Now)
+{
+	if (Now < NextSubjectCheck)
 	{
-		CurrentSkeletonSegmentCount[avatarId] = 0;
+		return;
 	}
-	Client->PushSubjectFrameData_AnyThread(SubjectKey, MoveTemp(FrameData));
-	if (!m_AvatarNames.Contains(avatarId))
+	NextSubjectCheck = Now + SubjectCheckInterval;
+
+	ExpireActors(Now);
+
+	if (Client == nullptr || !SourceGuid.IsValid())
 	{
-		m_AvatarNames.Add(avatarId, FString::FromInt(1 + avatarId));
+		return;
+	}
+
+	DeleteDelayedSubjects();
+
+	// if a subject is missing, push its static data again (can happen after multiple source sending to the same port)
+	for (const TUniquePtr<FMvnActor>& Actor : m_actors)
+	{
+		if (Actor->CurrentSkeletonSegmentCount > 0 && Client->GetSubjectSettings(FLiveLinkSubjectKey(SourceGuid, Actor->SubjectName)) == nullptr)
+		{
+			updateRefSkeleton(*Actor, Actor->CurrentSkeletonSegmentCount - 1);
+		}
 	}
 }
 
@@ -391,6 +1158,141 @@ void FLiveLinkMvnSource::DeleteDelayedSubjects()
 	}
 }
 
+void FLiveLinkMvnSource::ApplySettings( ULiveLinkMvnSourceSettings* pSet )
+{
+	PushMode = pSet->PushMode;
+	TimecodeFrameRate = pSet->TimecodeFrameRate;
+	bStreamKinematics = pSet->bStreamKinematics;
+
+	// actors are created with these once their first datagram arrives
+	JitterBufferFrames = pSet->JitterBufferFrames;
+	JitterBufferLatency = FMath::Max( pSet->JitterBufferLatencyMs, 0.f ) / 1000.0;
+	ActorTimeout = FMath::Max( pSet->SubjectTimeout, 0.f );
+	if ( JitterBufferLatency > 0.0 )
+	{
+		// wake up often enough to release held back samples on time
+		WaitTime = FTimespan::FromSeconds( FMath::Clamp( JitterBufferLatency / 4.0, 0.001, 0.1 ) );
+	}
+
+	ReceiveBufferSize = FMath::Max( pSet->ReceiveBufferSize, 64 * 1024 );
+	ReceiveBatchSize = FMath::Clamp( pSet->ReceiveBatchSize, 1, 256 );
+	ReceiveRingDepth = FMath::Clamp( pSet->ReceiveRingDepth, 1, 1024 );
+	bKernelReceiveTimestamps = pSet->bKernelReceiveTimestamps;
+	ReceiveWorkers = FMath::Clamp( pSet->ReceiveWorkers, 1, 16 );
+
+	AdditionalPorts.Reset();
+	for ( int32 AdditionalPort : pSet->AdditionalPorts )
+	{
+		if ( AdditionalPort > 0 && AdditionalPort <= 65535 && AdditionalPort != port && AdditionalPorts.Num() + 1 < MaxPorts )
+		{
+			AdditionalPorts.AddUnique( AdditionalPort );
+		}
+	}
+
+	ListenAddresses.Reset();
+	for ( const FString& Address : pSet->ListenAddresses )
+	{
+		FIPv4Address ListenAddress;
+		if ( FIPv4Address::Parse( Address, ListenAddress ) )
+		{
+			ListenAddresses.AddUnique( ListenAddress );
+		}
+		else
+		{
+			UE_LOG( LogTemp, Warning, TEXT( "MVN source on port %d: %s is not an IPv4 address" ), port, *Address );
+		}
+	}
+
+	SetPrediction( GetPredictionSettings( pSet ) );
+}
+
+void FLiveLinkMvnSource::CreateSockets()
+{
+	SocketSubsystem = ISocketSubsystem::Get( PLATFORM_SOCKETSUBSYSTEM );
+
+	TArray<FIPv4Address> Addresses = ListenAddresses;
+	if ( Addresses.Num() == 0 )
+	{
+		Addresses.Add( FIPv4Address::Any );
+	}
+	const int32 NumEndpoints = Addresses.Num() * ( 1 + AdditionalPorts.Num() );
+
+	// AsReusable sets SO_REUSEPORT on Linux, the kernel then spreads the senders of a port over its sockets
+	int32 SocketsPerEndpoint = 1;
+#if PLATFORM_LINUX
+	SocketsPerEndpoint = FMath::Max( 1, ReceiveWorkers / NumEndpoints );
+#endif
+
+	TArray<int32> SocketPortIndices;
+	for ( int32 PortIndex = 0; PortIndex <= AdditionalPorts.Num(); ++PortIndex )
+	{
+		for ( const FIPv4Address& Address : Addresses )
+		{
+			const FIPv4Endpoint Endpoint( Address, GetListenPort( PortIndex ) );
+			for ( int32 Copy = 0; Copy < SocketsPerEndpoint; ++Copy )
+			{
+				FSocket* NewSocket = FUdpSocketBuilder( TEXT( "MVNSOCKET" ) )
+					.AsNonBlocking()
+					.AsReusable()
+					.BoundToEndpoint( Endpoint )
+					.WithReceiveBufferSize( ReceiveBufferSize );
+
+				if ( NewSocket == nullptr )
+				{
+					UE_LOG( LogTemp, Error, TEXT( "MVN source on port %d: can't listen on %s" ), port, *Endpoint.ToString() );
+					continue;
+				}
+				check( NewSocket->GetSocketType() == SOCKTYPE_Datagram );
+				Sockets.Add( NewSocket );
+				SocketPortIndices.Add( PortIndex );
+			}
+		}
+	}
+
+	if ( Sockets.Num() == 0 )
+	{
+		return;
+	}
+	Socket = Sockets[0];
+
+	// the ring must hold at least one full batch
+	const int32 RingDepth = FMath::Max( ReceiveRingDepth, ReceiveBatchSize );
+	if ( Sockets.Num() == 1 )
+	{
+		// SO_TIMESTAMPNS on Linux, not supported elsewhere
+		const bool bKernelTimestamps = bKernelReceiveTimestamps && Socket->SetRetrieveTimestamp( true );
+
+		// one socket, the receiver thread receives and decodes itself
+		PacketRing = MakeUnique<FMvnPacketRing>( RingDepth, MaxPacketSize );
+		BatchReceiver = MakeUnique<FMvnBatchReceiver>( Socket, SocketSubsystem, ReceiveBatchSize, MaxPacketSize, bKernelTimestamps );
+		UE_LOG( LogTemp, Log, TEXT( "MVN receiver on port %d: batch %d, ring %d, %s, %s" ), port, ReceiveBatchSize, PacketRing->GetDepth(),
+			BatchReceiver->UsesRecvMulti() ? TEXT( "multi receive" ) : TEXT( "single receive" ),
+			BatchReceiver->UsesKernelTimestamps() ? TEXT( "kernel timestamps" ) : TEXT( "read timestamps" ) );
+	}
+	else
+	{
+		// a worker per socket, each blocks on its own: UE has no wait on several sockets, and taking turns
+		// waiting on them would wake the workers all the time while nothing arrives
+		DataEvent = FPlatformProcess::GetSynchEventFromPool( false );
+		for ( int32 SocketIndex = 0; SocketIndex < Sockets.Num(); ++SocketIndex )
+		{
+			const bool bKernelTimestamps = bKernelReceiveTimestamps && Sockets[SocketIndex]->SetRetrieveTimestamp( true );
+			Workers.Add( MakeUnique<FMvnReceiveWorker>( Sockets[SocketIndex], SocketSubsystem, ReceiveBatchSize, SocketPortIndices[SocketIndex], bKernelTimestamps,
+				RingDepth, MaxPacketSize, DataEvent, WaitTime ) );
+		}
+		UE_LOG( LogTemp, Log, TEXT( "MVN receiver on port %d: %d ports, %d sockets, %d workers, batch %d, ring %d" ), port, 1 + AdditionalPorts.Num(),
+			Sockets.Num(), Workers.Num(), ReceiveBatchSize, Workers[0]->GetRing().GetDepth() );
+	}
+
+	if ( MvnRemoteControlManager::GetInstance() )
+	{
+		for ( int32 PortIndex = 0; PortIndex <= AdditionalPorts.Num(); ++PortIndex )
+		{
+			MvnRemoteControlManager::GetInstance()->AddReservedPort( GetListenPort( PortIndex ) );
+		}
+	}
+}
+
 void FLiveLinkMvnSource::InitializeSettings( ULiveLinkSourceSettings* Settings )
 {
 	if ( Settings )
@@ -406,26 +1308,16 @@ void FLiveLinkMvnSource::InitializeSettings( ULiveLinkSourceSettings* Settings )
 		}
 
 		pSet->PortNumber = port;
+		ApplySettings( pSet );
 
 		if ( port != 0 )
 		{
-			//setup socket
-			FIPv4Endpoint Endpoint( FIPv4Address::Any, port );
-			int32 BufferSize = 1024 * 1024;
-
-			Socket = FUdpSocketBuilder( TEXT( "MVNSOCKET" ) )
-				.AsNonBlocking()
-				.AsReusable()
-				.BoundToEndpoint( Endpoint )
-				.WithReceiveBufferSize( BufferSize );
-
+			CreateSockets();
 			check( Socket != nullptr );
-			check( Socket->GetSocketType() == SOCKTYPE_Datagram );
 
-			SocketSubsystem = ISocketSubsystem::Get( PLATFORM_SOCKETSUBSYSTEM );
-			if ( MvnRemoteControlManager::GetInstance() )
+			if ( pSet->bCaptureDatagrams )
 			{
-				MvnRemoteControlManager::GetInstance()->AddReservedPort( port );
+				StartCapture();
 			}
 
 			Start();
@@ -437,11 +1329,118 @@ void FLiveLinkMvnSource::InitializeSettings( ULiveLinkSourceSettings* Settings )
 
 void FLiveLinkMvnSource::OnSettingsChanged( ULiveLinkSourceSettings* Settings, const FPropertyChangedEvent& PropertyChangedEvent )
 {
+	ULiveLinkMvnSourceSettings* pSet = Cast<ULiveLinkMvnSourceSettings>( Settings );
+	if ( pSet && PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED( ULiveLinkMvnSourceSettings, bCaptureDatagrams ) )
+	{
+		if ( pSet->bCaptureDatagrams )
+		{
+			StartCapture();
+		}
+		else
+		{
+			StopCapture();
+		}
+	}
 
+	const FName MemberName = PropertyChangedEvent.GetMemberPropertyName();
+	if ( pSet && ( MemberName == GET_MEMBER_NAME_CHECKED( ULiveLinkMvnSourceSettings, PredictionHorizonMs )
+		|| MemberName == GET_MEMBER_NAME_CHECKED( ULiveLinkMvnSourceSettings, SubjectPredictionHorizonsMs )
+		|| MemberName == GET_MEMBER_NAME_CHECKED( ULiveLinkMvnSourceSettings, bPredictFromKinematics ) ) )
+	{
+		SetPrediction( GetPredictionSettings( pSet ) );
+	}
 }
 
 TSubclassOf<ULiveLinkSourceSettings> FLiveLinkMvnSource::GetSettingsClass() const
 {
 	return ULiveLinkMvnSourceSettings::StaticClass();
 }
-#pragma optimize("", on)
\ No newline at end of file
+#pragma optimize("", on)
+namespace LiveLinkMvnCapture
+{
+	/** Run Function on the sources listening on Port, or on all of them for port 0 */
+	template<typename FunctionType>
+	static int32 ForEachSource(int32 Port, FunctionType&& Function)
+	{
+		FCriticalSection* Lock = nullptr;
+		const TArray<FLiveLinkMvnSource*>& Sources = FLiveLinkMvnSource::GetSources(Lock);
+		FScopeLock ScopeLock(Lock);
+
+		int32 NumSources = 0;
+		for (FLiveLinkMvnSource* Source : Sources)
+		{
+			if (Source->IsListening() && (Port == 0 || Source->GetPort() == Port))
+			{
+				Function(*Source);
+				++NumSources;
+			}
+		}
+		return NumSources;
+	}
+
+	static void Start(const TArray<FString>& Args)
+	{
+		const int32 Port = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 0;
+		const FString Filename = Args.Num() > 1 ? Args[1] : FString();
+		if (Port == 0 && !Filename.IsEmpty())
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Capture.Start: a file name needs a port"));
+			return;
+		}
+		if (ForEachSource(Port, [&Filename](FLiveLinkMvnSource& Source) { Source.StartCapture(Filename); }) == 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("mvn.Capture.Start: no MVN source listening%s"), Port != 0 ? *FString::Printf(TEXT(" on port %d"), Port) : TEXT(""));
+		}
+	}
+
+	static void Stop(const TArray<FString>& Args)
+	{
+		const int32 Port = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 0;
+		ForEachSource(Port, [](FLiveLinkMvnSource& Source) { Source.StopCapture(); });
+	}
+}
+
+static FAutoConsoleCommand MvnCaptureStartCommand(
+	TEXT("mvn.Capture.Start"),
+	TEXT("Record the datagrams MVN sources receive. Args: [Port, 0 for all sources] [File, default Saved/MvnCaptures]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnCapture::Start));
+
+static FAutoConsoleCommand MvnCaptureStopCommand(
+	TEXT("mvn.Capture.Stop"),
+	TEXT("Stop recording. Args: [Port, 0 for all sources]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnCapture::Stop));
+
+namespace LiveLinkMvnTelemetry
+{
+	static void LogStats(const TArray<FString>& Args)
+	{
+		FCriticalSection* Lock = nullptr;
+		const TArray<FLiveLinkMvnSource*>& Sources = FLiveLinkMvnSource::GetSources(Lock);
+		FScopeLock ScopeLock(Lock);
+
+		for (const FLiveLinkMvnSource* Source : Sources)
+		{
+			const FMvnSourceTelemetry Telemetry = Source->GetTelemetry();
+			UE_LOG(LogTemp, Display, TEXT("MVN %d: %s"), Source->GetPort(), *Telemetry.ToStatusString());
+			UE_LOG(LogTemp, Display, TEXT("    ring depth max %d, ring overflows %lld, socket drops %lld, incomplete samples %d, decode mean %.1f us max %.1f us"),
+				Telemetry.RingDepthMax, Telemetry.RingOverflows, Telemetry.SocketDrops, Telemetry.IncompleteSamples, Telemetry.DecodeMean * 1.0e6, Telemetry.DecodeMax * 1.0e6);
+			for (const FMvnActorTelemetry& Actor : Telemetry.Actors)
+			{
+				UE_LOG(LogTemp, Display, TEXT("    %s: %.1f samples/s, %.1f pushes/s, lost %d, dup %d, reordered %d, late %d, buffered %d, latency %.2f ms (max %.2f)"),
+					*Actor.SubjectName.ToString(), Actor.SamplesPerSecond, Actor.PushesPerSecond, Actor.Lost, Actor.Duplicates, Actor.Reordered, Actor.Late,
+					Actor.Buffered, Actor.LatencyMean * 1.0e3, Actor.LatencyMax * 1.0e3);
+				if (Actor.PredictionHorizon > 0.0)
+				{
+					UE_LOG(LogTemp, Display, TEXT("        predicted %.1f ms ahead, error %.2f cm (max %.2f) %.2f deg (max %.2f) over %d poses"),
+						Actor.PredictionHorizon * 1.0e3, Actor.PredictionError.PositionMean, Actor.PredictionError.PositionMax,
+						Actor.PredictionError.RotationMean, Actor.PredictionError.RotationMax, Actor.PredictionError.Count);
+				}
+			}
+		}
+	}
+}
+
+static FAutoConsoleCommand MvnStatsCommand(
+	TEXT("mvn.Stats"),
+	TEXT("Log the telemetry of the last second of every MVN source and its actors"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LiveLinkMvnTelemetry::LogStats));
@@ -2,6 +2,8 @@
 
 #include "MetaDatagram.h"
 
+#include <algorithm>
+
  /*! Constructor */
 MetaDatagram::MetaDatagram()
 	: Datagram()
@@ -16,26 +18,38 @@ MetaDatagram::~MetaDatagram()
 }
 
 /*! Deserialize the data from \a arr
+	The text is searched in place in the received buffer, only the name is copied out.
 	\sa serializeData
 */
-void MetaDatagram::deserializeData(Streamer& inputStreamer)
+bool MetaDatagram::deserializeData(Streamer& inputStreamer)
 {
 	Streamer* streamer = &inputStreamer;
 
+	// the datagram is reused for every meta packet, one without a name must not keep the previous avatar's
+	m_Name.clear();
+
+	if (!streamer->canRead(4))
+		return false;
+
 	int textLength;
 	streamer->read(textLength);
+	if (!streamer->canRead(textLength))
+		return false;
 
-	std::string text;
-	streamer->read(text, textLength);
+	const char* text = streamer->readChars(textLength);
+	const char* textEnd = text + textLength;
 
 	// since we're interested only in the name, no need to parse the whole string
-	static const std::string nameTag = "name:";
-	size_t foundPos = text.find(nameTag);
-	if (foundPos != std::string::npos)
+	static const char nameTag[] = "name:";
+	static const int nameTagLength = sizeof(nameTag) - 1;
+	const char* found = std::search(text, textEnd, nameTag, nameTag + nameTagLength);
+	if (found != textEnd)
 	{
-		size_t endPos = text.find("\n", foundPos);
-		m_Name = text.substr(foundPos + nameTag.length(), endPos - foundPos - nameTag.length());
+		const char* nameBegin = found + nameTagLength;
+		const char* nameEnd = std::find(nameBegin, textEnd, '\n');
+		m_Name.assign(nameBegin, nameEnd);
 	}
+	return true;
 }
 
 /*! Print Data datagram in a formated why
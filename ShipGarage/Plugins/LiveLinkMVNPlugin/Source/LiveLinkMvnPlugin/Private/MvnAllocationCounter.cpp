@@ -0,0 +1,159 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnAllocationCounter.h"
+#include "HAL/MemoryBase.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+namespace
+{
+	/** Count of the calling thread's innermost counter, null while it has none */
+	thread_local int64* ThreadAllocations = nullptr;
+
+	/** Forwards the whole FMalloc interface to the allocator it wraps, counting Malloc and Realloc */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+
+		explicit FCountingMalloc(FMalloc* InInner)
+			: Inner(InInner)
+		{
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountCall();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountCall();
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			CountCall();
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			CountCall();
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override
+		{
+			Inner->Free(Original);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			return Inner->QuantizeSize(Count, Alignment);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return Inner->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual void Trim(bool bTrimThreadCaches) override
+		{
+			Inner->Trim(bTrimThreadCaches);
+		}
+
+		virtual void SetupTLSCachesOnCurrentThread() override
+		{
+			Inner->SetupTLSCachesOnCurrentThread();
+		}
+
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+		{
+			Inner->ClearAndDisableTLSCachesOnCurrentThread();
+		}
+
+		virtual void InitializeStatsMetadata() override
+		{
+			Inner->InitializeStatsMetadata();
+		}
+
+		virtual void UpdateStats() override
+		{
+			Inner->UpdateStats();
+		}
+
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override
+		{
+			Inner->GetAllocatorStats(OutStats);
+		}
+
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override
+		{
+			Inner->DumpAllocatorStats(Ar);
+		}
+
+		virtual bool IsInternallyThreadSafe() const override
+		{
+			return Inner->IsInternallyThreadSafe();
+		}
+
+		virtual bool ValidateHeap() override
+		{
+			return Inner->ValidateHeap();
+		}
+
+		virtual bool Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar) override
+		{
+			return Inner->Exec(InWorld, Cmd, Ar);
+		}
+
+		virtual const TCHAR* GetDescriptiveName() override
+		{
+			return Inner->GetDescriptiveName();
+		}
+
+	private:
+
+		void CountCall()
+		{
+			if (int64* Allocations = ThreadAllocations)
+			{
+				++*Allocations;
+			}
+		}
+
+		FMalloc* Inner;
+	};
+
+	bool bInstalled = false;
+}
+
+void FMvnAllocationCounter::InstallIfRequested()
+{
+	if (!bInstalled && FParse::Param(FCommandLine::Get(), TEXT("MvnCountAllocations")))
+	{
+		// never deleted, threads may be inside it whenever it goes
+		GMalloc = new FCountingMalloc(GMalloc);
+		bInstalled = true;
+		UE_LOG(LogTemp, Log, TEXT("MVN allocation counting enabled"));
+	}
+}
+
+bool FMvnAllocationCounter::IsInstalled()
+{
+	return bInstalled;
+}
+
+FMvnAllocationCounter::FMvnAllocationCounter()
+	: Allocations(0)
+	, Outer(ThreadAllocations)
+{
+	ThreadAllocations = &Allocations;
+}
+
+FMvnAllocationCounter::~FMvnAllocationCounter()
+{
+	ThreadAllocations = Outer;
+}
@@ -0,0 +1,111 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnBatchReceiver.h"
+#include "MvnPacketRing.h"
+#include "IPAddress.h"
+
+FMvnBatchReceiver::FMvnBatchReceiver(FSocket* InSocket, ISocketSubsystem* InSocketSubsystem, int32 InBatchSize, int32 InMaxPacketSize, bool bInKernelTimestamps, int32 InPortIndex)
+	: Socket(InSocket)
+	, SocketSubsystem(InSocketSubsystem)
+	, BatchSize(FMath::Max(1, InBatchSize))
+	, PortIndex(InPortIndex)
+	, SenderAddr(InSocketSubsystem->CreateInternetAddr())
+{
+	// the kernel's receive time only comes with multi receive, a batch of one still gets it
+	if ((BatchSize > 1 || bInKernelTimestamps) && SocketSubsystem->IsSocketRecvMultiSupported())
+	{
+		RecvMulti = SocketSubsystem->CreateRecvMulti(BatchSize, InMaxPacketSize, bInKernelTimestamps ? ERecvMultiFlags::RetrieveTimestamps : ERecvMultiFlags::None);
+		bKernelTimestamps = bInKernelTimestamps && RecvMulti.IsValid();
+	}
+}
+
+FMvnBatchReceiver::~FMvnBatchReceiver()
+{
+}
+
+int32 FMvnBatchReceiver::ReceiveBatch(FMvnPacketRing& Ring)
+{
+	if (RecvMulti.IsValid())
+	{
+		return ReceiveMulti(Ring);
+	}
+	return ReceiveSingle(Ring);
+}
+
+int32 FMvnBatchReceiver::ReceiveMulti(FMvnPacketRing& Ring)
+{
+	if (!Socket->RecvMulti(*RecvMulti))
+	{
+		return 0;
+	}
+
+	const double ReceiveTime = FPlatformTime::Seconds();
+	const int32 NumPackets = RecvMulti->GetNumPackets();
+	int32 Received = 0;
+
+	for (int32 PacketIdx = 0; PacketIdx < NumPackets; ++PacketIdx)
+	{
+		FMvnPacketSlot* Slot = Ring.AcquireWrite();
+		if (Slot == nullptr)
+		{
+			// the consumer fell behind, the remaining datagrams of this batch are lost
+			RingOverflows += NumPackets - PacketIdx;
+			break;
+		}
+
+		uint8* PacketData = nullptr;
+		int32 PacketSize = 0;
+		RecvMulti->GetPacket(PacketIdx, PacketData, PacketSize);
+		RecvMulti->GetSource(PacketIdx, *SenderAddr);
+
+		Slot->Size = FMath::Min(PacketSize, Slot->Buffer.Num());
+		FMemory::Memcpy(Slot->Buffer.GetData(), PacketData, Slot->Size);
+		Slot->Sender = FIPv4Endpoint(SenderAddr);
+		Slot->ReceiveTime = ReceiveTime;
+		Slot->PortIndex = PortIndex;
+		if (bKernelTimestamps)
+		{
+			FPacketTimestamp Timestamp;
+			RecvMulti->GetPacketTimestamp(PacketIdx, Timestamp);
+			const double KernelTime = SocketSubsystem->TranslatePacketTimestamp(Timestamp);
+
+			// a datagram queued before timestamps were enabled carries none, keep the time it was read then
+			if (KernelTime > 0.0 && KernelTime <= ReceiveTime)
+			{
+				Slot->ReceiveTime = KernelTime;
+			}
+		}
+		Ring.CommitWrite();
+		++Received;
+	}
+	return Received;
+}
+
+int32 FMvnBatchReceiver::ReceiveSingle(FMvnPacketRing& Ring)
+{
+	int32 Received = 0;
+
+	while (Received < BatchSize)
+	{
+		FMvnPacketSlot* Slot = Ring.AcquireWrite();
+		if (Slot == nullptr)
+		{
+			break;
+		}
+
+		// the socket is non blocking, RecvFrom fails once the queue is empty
+		int32 Read = 0;
+		if (!Socket->RecvFrom(Slot->Buffer.GetData(), Slot->Buffer.Num(), Read, *SenderAddr) || Read <= 0)
+		{
+			break;
+		}
+
+		Slot->Size = Read;
+		Slot->Sender = FIPv4Endpoint(SenderAddr);
+		Slot->ReceiveTime = FPlatformTime::Seconds();
+		Slot->PortIndex = PortIndex;
+		Ring.CommitWrite();
+		++Received;
+	}
+	return Received;
+}
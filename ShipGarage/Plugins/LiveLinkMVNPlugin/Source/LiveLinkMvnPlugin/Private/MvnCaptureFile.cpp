@@ -0,0 +1,202 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnCaptureFile.h"
+#include "HAL/PlatformFileManager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+namespace
+{
+	/** Write out once this much is buffered */
+	const int32 FlushSize = 64 * 1024;
+
+	void AppendUInt32(TArray<uint8>& Out, uint32 Value)
+	{
+		Out.Add((uint8)Value);
+		Out.Add((uint8)(Value >> 8));
+		Out.Add((uint8)(Value >> 16));
+		Out.Add((uint8)(Value >> 24));
+	}
+
+	uint32 ReadUInt32(const uint8* Data)
+	{
+		return (uint32)Data[0] | (uint32)Data[1] << 8 | (uint32)Data[2] << 16 | (uint32)Data[3] << 24;
+	}
+}
+
+FMvnCaptureWriter::FMvnCaptureWriter()
+{
+}
+
+FMvnCaptureWriter::~FMvnCaptureWriter()
+{
+	Close();
+}
+
+bool FMvnCaptureWriter::Open(const FString& Filename, int32 LocalPort, const TArray<int32>& AdditionalPorts)
+{
+	Close();
+
+	File = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Filename);
+	if (File == nullptr)
+	{
+		return false;
+	}
+
+	Buffer.Reset(FlushSize * 2);
+	AppendUInt32(Buffer, MvnCaptureFile::Magic);
+	AppendUInt32(Buffer, MvnCaptureFile::Version);
+	AppendUInt32(Buffer, (uint32)LocalPort);
+	const int32 NumAdditionalPorts = FMath::Min(AdditionalPorts.Num(), MvnCaptureFile::MaxAdditionalPorts);
+	AppendUInt32(Buffer, (uint32)NumAdditionalPorts);
+	for (int32 Index = 0; Index < NumAdditionalPorts; ++Index)
+	{
+		AppendUInt32(Buffer, (uint32)AdditionalPorts[Index]);
+	}
+	FirstTime = -1.0;
+	NumRecords = 0;
+	NumBytes = 0;
+	return true;
+}
+
+void FMvnCaptureWriter::Close()
+{
+	if (File != nullptr)
+	{
+		Flush();
+		delete File;
+		File = nullptr;
+	}
+}
+
+void FMvnCaptureWriter::Write(const uint8* Data, int32 Size, const FIPv4Endpoint& Sender, double ReceiveTime, int32 PortIndex)
+{
+	if (File == nullptr || Size <= 0 || Size > MvnCaptureFile::MaxDatagramSize)
+	{
+		return;
+	}
+
+	if (FirstTime < 0.0)
+	{
+		FirstTime = ReceiveTime;
+	}
+	const double Time = ReceiveTime - FirstTime;
+	uint64 TimeBits;
+	FMemory::Memcpy(&TimeBits, &Time, sizeof(TimeBits));
+
+	AppendUInt32(Buffer, (uint32)TimeBits);
+	AppendUInt32(Buffer, (uint32)(TimeBits >> 32));
+	AppendUInt32(Buffer, Sender.Address.Value);
+	Buffer.Add((uint8)Sender.Port);
+	Buffer.Add((uint8)(Sender.Port >> 8));
+	Buffer.Add((uint8)Size);
+	Buffer.Add((uint8)(Size >> 8));
+	Buffer.Add((uint8)PortIndex);
+	Buffer.Add((uint8)(PortIndex >> 8));
+	Buffer.Append(Data, Size);
+
+	++NumRecords;
+	NumBytes += MvnCaptureFile::RecordHeaderSize + Size;
+
+	if (Buffer.Num() >= FlushSize)
+	{
+		Flush();
+	}
+}
+
+void FMvnCaptureWriter::Flush()
+{
+	if (File != nullptr && Buffer.Num() > 0)
+	{
+		File->Write(Buffer.GetData(), Buffer.Num());
+		File->Flush();
+		Buffer.Reset();
+	}
+}
+
+FMvnCaptureReader::FMvnCaptureReader()
+{
+}
+
+FMvnCaptureReader::~FMvnCaptureReader()
+{
+	Close();
+}
+
+bool FMvnCaptureReader::Open(const FString& Filename)
+{
+	Close();
+
+	File = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Filename);
+	if (File == nullptr)
+	{
+		return false;
+	}
+
+	uint8 Header[MvnCaptureFile::FileHeaderSize];
+	if (!File->Read(Header, sizeof(Header)) || ReadUInt32(Header) != MvnCaptureFile::Magic)
+	{
+		Close();
+		return false;
+	}
+	const uint32 Version = ReadUInt32(Header + 4);
+	if (Version != MvnCaptureFile::Version)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("MVN capture %s is version %u, only version %u is read"), *Filename, Version, MvnCaptureFile::Version);
+		Close();
+		return false;
+	}
+	LocalPort = (int32)ReadUInt32(Header + 8);
+
+	const uint32 NumAdditionalPorts = ReadUInt32(Header + 12);
+	if (NumAdditionalPorts > (uint32)MvnCaptureFile::MaxAdditionalPorts)
+	{
+		Close();
+		return false;
+	}
+	AdditionalPorts.Reset(NumAdditionalPorts);
+	for (uint32 Index = 0; Index < NumAdditionalPorts; ++Index)
+	{
+		uint8 Port[4];
+		if (!File->Read(Port, sizeof(Port)))
+		{
+			Close();
+			return false;
+		}
+		AdditionalPorts.Add((int32)ReadUInt32(Port));
+	}
+	RecordsOffset = MvnCaptureFile::FileHeaderSize + NumAdditionalPorts * 4;
+	return true;
+}
+
+void FMvnCaptureReader::Close()
+{
+	delete File;
+	File = nullptr;
+}
+
+bool FMvnCaptureReader::ReadNext(FMvnCaptureRecord& Record)
+{
+	uint8 Header[MvnCaptureFile::RecordHeaderSize];
+	if (File == nullptr || !File->Read(Header, sizeof(Header)))
+	{
+		return false;
+	}
+
+	const uint64 TimeBits = (uint64)ReadUInt32(Header) | (uint64)ReadUInt32(Header + 4) << 32;
+	FMemory::Memcpy(&Record.Time, &TimeBits, sizeof(Record.Time));
+	Record.Sender.Address.Value = ReadUInt32(Header + 8);
+	Record.Sender.Port = (uint16)(Header[12] | Header[13] << 8);
+
+	const int32 Size = Header[14] | Header[15] << 8;
+	Record.PortIndex = Header[16] | Header[17] << 8;
+	Record.Data.SetNumUninitialized(Size, false);
+	return File->Read(Record.Data.GetData(), Size);
+}
+
+void FMvnCaptureReader::Rewind()
+{
+	if (File != nullptr)
+	{
+		File->Seek(RecordsOffset);
+	}
+}
@@ -0,0 +1,225 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnClockSync.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	/** An offset this far from the estimate on a short round trip means the server clock was set */
+	const double ClockJumpThreshold = 0.1;
+
+	/** The drift is only estimated from exchanges spread over at least this many seconds */
+	const double MinDriftSpan = 2.0;
+}
+
+FMvnClockSync::FMvnClockSync()
+{
+	Reset();
+}
+
+void FMvnClockSync::Reset()
+{
+	FScopeLock ScopeLock(&Lock);
+	Exchanges.Reset(MaxExchanges);
+	NextExchange = 0;
+	NumAdded = 0;
+	FitTime = 0.0;
+	FitOffset = 0.0;
+	FitDrift = 0.0;
+	MinRoundTrip = 0.0;
+	bValid = false;
+}
+
+void FMvnClockSync::AddExchange(double LocalSend, double ServerReceive, double ServerSend, double LocalReceive)
+{
+	FExchange Exchange;
+	Exchange.LocalTime = (LocalSend + LocalReceive) * 0.5;
+	Exchange.Offset = ((ServerReceive - LocalSend) + (ServerSend - LocalReceive)) * 0.5;
+	Exchange.RoundTrip = (LocalReceive - LocalSend) - (ServerSend - ServerReceive);
+	if (Exchange.RoundTrip < 0.0)
+	{
+		return;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+
+	if (Exchanges.Num() > 0)
+	{
+		// the server time of day wraps at midnight, keep the offset continuous
+		const double Expected = bValid ? OffsetAt(Exchange.LocalTime) : Exchanges[(NextExchange + MaxExchanges - 1) % MaxExchanges].Offset;
+		if (Exchange.Offset - Expected > SecondsPerDay * 0.5)
+		{
+			Exchange.Offset -= SecondsPerDay;
+		}
+		else if (Exchange.Offset - Expected < -SecondsPerDay * 0.5)
+		{
+			Exchange.Offset += SecondsPerDay;
+		}
+
+		if (bValid && Exchange.RoundTrip < ClockJumpThreshold && FMath::Abs(Exchange.Offset - Expected) > ClockJumpThreshold)
+		{
+			Exchanges.Reset(MaxExchanges);
+			NextExchange = 0;
+			bValid = false;
+		}
+	}
+
+	if (Exchanges.Num() < MaxExchanges)
+	{
+		Exchanges.Add(Exchange);
+	}
+	else
+	{
+		Exchanges[NextExchange] = Exchange;
+	}
+	NextExchange = (NextExchange + 1) % MaxExchanges;
+	++NumAdded;
+
+	Refit();
+}
+
+void FMvnClockSync::Refit()
+{
+	const int32 Num = Exchanges.Num();
+	if (Num < MinExchanges)
+	{
+		bValid = false;
+		return;
+	}
+
+	// the shortest quarter of the round trips, at least MinExchanges of them
+	TArray<double, TInlineAllocator<MaxExchanges>> RoundTrips;
+	for (const FExchange& Exchange : Exchanges)
+	{
+		RoundTrips.Add(Exchange.RoundTrip);
+	}
+	RoundTrips.Sort();
+	MinRoundTrip = RoundTrips[0];
+	const double MaxRoundTrip = RoundTrips[FMath::Clamp(Num / 4, MinExchanges - 1, Num - 1)];
+
+	int32 NumUsed = 0;
+	double SumTime = 0.0;
+	double SumOffset = 0.0;
+	double FirstTime = TNumericLimits<double>::Max();
+	double LastTime = TNumericLimits<double>::Lowest();
+	for (const FExchange& Exchange : Exchanges)
+	{
+		if (Exchange.RoundTrip <= MaxRoundTrip)
+		{
+			++NumUsed;
+			SumTime += Exchange.LocalTime;
+			SumOffset += Exchange.Offset;
+			FirstTime = FMath::Min(FirstTime, Exchange.LocalTime);
+			LastTime = FMath::Max(LastTime, Exchange.LocalTime);
+		}
+	}
+
+	FitTime = SumTime / NumUsed;
+	FitOffset = SumOffset / NumUsed;
+	FitDrift = 0.0;
+
+	// least squares slope of the offset over time
+	if (NumUsed >= MinExchanges && LastTime - FirstTime >= MinDriftSpan)
+	{
+		double SumTimeTime = 0.0;
+		double SumTimeOffset = 0.0;
+		for (const FExchange& Exchange : Exchanges)
+		{
+			if (Exchange.RoundTrip <= MaxRoundTrip)
+			{
+				const double Time = Exchange.LocalTime - FitTime;
+				SumTimeTime += Time * Time;
+				SumTimeOffset += Time * (Exchange.Offset - FitOffset);
+			}
+		}
+		if (SumTimeTime > 0.0)
+		{
+			FitDrift = SumTimeOffset / SumTimeTime;
+		}
+	}
+
+	bValid = true;
+}
+
+bool FMvnClockSync::IsValid() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return bValid;
+}
+
+double FMvnClockSync::LocalToServer(double LocalTime) const
+{
+	FScopeLock ScopeLock(&Lock);
+	return LocalTime + OffsetAt(LocalTime);
+}
+
+double FMvnClockSync::ServerToLocal(double ServerTime, double LocalHint) const
+{
+	FScopeLock ScopeLock(&Lock);
+
+	double LocalTime = ServerTime - OffsetAt(LocalHint);
+	const double Days = FMath::RoundToDouble((LocalHint - LocalTime) / SecondsPerDay);
+	LocalTime += Days * SecondsPerDay;
+
+	// once more at the found time, for the drift since the hint
+	return ServerTime + Days * SecondsPerDay - OffsetAt(LocalTime);
+}
+
+double FMvnClockSync::GetOffset(double LocalTime) const
+{
+	FScopeLock ScopeLock(&Lock);
+	return OffsetAt(LocalTime);
+}
+
+double FMvnClockSync::GetDrift() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return FitDrift;
+}
+
+double FMvnClockSync::GetRoundTrip() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return MinRoundTrip;
+}
+
+int32 FMvnClockSync::GetNumExchanges() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return NumAdded;
+}
+
+FMvnClockSyncRegistry& FMvnClockSyncRegistry::getInstance()
+{
+	static FMvnClockSyncRegistry instance;
+	return instance;
+}
+
+FMvnClockSyncRegistry::FMvnClockSyncRegistry()
+{
+}
+
+void FMvnClockSyncRegistry::Register(const FIPv4Address& Address, const FClockSyncPtr& ClockSync)
+{
+	FScopeLock ScopeLock(&Lock);
+	Entries.Add(Address, ClockSync);
+	Generation.Increment();
+}
+
+void FMvnClockSyncRegistry::Unregister(const FIPv4Address& Address, const FClockSyncPtr& ClockSync)
+{
+	FScopeLock ScopeLock(&Lock);
+	const FClockSyncPtr* Found = Entries.Find(Address);
+	if (Found != nullptr && *Found == ClockSync)
+	{
+		Entries.Remove(Address);
+		Generation.Increment();
+	}
+}
+
+FMvnClockSyncRegistry::FClockSyncPtr FMvnClockSyncRegistry::Find(const FIPv4Address& Address) const
+{
+	FScopeLock ScopeLock(&Lock);
+	const FClockSyncPtr* Found = Entries.Find(Address);
+	return Found != nullptr ? *Found : FClockSyncPtr();
+}
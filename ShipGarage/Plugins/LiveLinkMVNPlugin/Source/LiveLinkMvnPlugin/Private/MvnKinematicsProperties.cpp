@@ -0,0 +1,214 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnKinematicsProperties.h"
+#include "CenterOfMassDatagram.h"
+#include "LinearSegmentKinematicsDatagram.h"
+#include "AngularSegmentKinematicsDatagram.h"
+#include "JointAnglesDatagram.h"
+#include "TrackerKinematicsDatagram.h"
+#include "SegmentInformation.h"
+
+namespace
+{
+	// MVN is Z-Up right-handed in meters, flip Y and scale to cm like SegData::Set does for positions
+	void SetLinearVector(float* Out, const float* In)
+	{
+		Out[0] = In[0] * 100.f;
+		Out[1] = -In[1] * 100.f;
+		Out[2] = In[2] * 100.f;
+	}
+
+	// rotations change handedness with the Y flip, so X and Z turn around instead
+	void SetAngularVector(float* Out, const float* In)
+	{
+		Out[0] = FMath::RadiansToDegrees(-In[0]);
+		Out[1] = FMath::RadiansToDegrees(In[1]);
+		Out[2] = FMath::RadiansToDegrees(-In[2]);
+	}
+
+	FString GetSegmentName(int32 SegmentId, const TArray<FName>& SegmentNames)
+	{
+		const int32 SegmentIndex = SegmentId - 1;
+		if (SegmentNames.IsValidIndex(SegmentIndex) && !SegmentNames[SegmentIndex].IsNone())
+		{
+			return SegmentNames[SegmentIndex].ToString();
+		}
+		// SegmentBoneNames starts with the root
+		if (SegmentInformation::SegmentBoneNames.IsValidIndex(SegmentId) && SegmentId > 0)
+		{
+			return SegmentInformation::SegmentBoneNames[SegmentId].ToString();
+		}
+		return FString::Printf(TEXT("Segment%d"), SegmentId);
+	}
+}
+
+void FMvnKinematicsProperties::Reset()
+{
+	FMemory::Memzero(Values, sizeof(Values));
+	bHasLinear = false;
+	bHasAngular = false;
+}
+
+void FMvnKinematicsProperties::SetCenterOfMass(const CenterOfMassDatagram& Datagram)
+{
+	float* Out = Values + CenterOfMassOffset;
+	SetLinearVector(Out, Datagram.m_position);
+	SetLinearVector(Out + 3, Datagram.m_velocity);
+	SetLinearVector(Out + 6, Datagram.m_acceleration);
+}
+
+void FMvnKinematicsProperties::SetLinear(const LinearSegmentKinematicsDatagram& Datagram)
+{
+	for (const LinearSegmentKinematicsDatagram::Kinematics& Kinematics : Datagram.m_data)
+	{
+		const int32 SegmentIndex = Kinematics.segmentId - 1;
+		if (SegmentIndex >= 0 && SegmentIndex < NumBodySegments)
+		{
+			float* Out = Values + LinearOffset + SegmentIndex * 6;
+			SetLinearVector(Out, Kinematics.velocity);
+			SetLinearVector(Out + 3, Kinematics.acceleration);
+		}
+	}
+	bHasLinear = true;
+}
+
+void FMvnKinematicsProperties::SetAngular(const AngularSegmentKinematicsDatagram& Datagram)
+{
+	for (const AngularSegmentKinematicsDatagram::Kinematics& Kinematics : Datagram.m_data)
+	{
+		const int32 SegmentIndex = Kinematics.segmentId - 1;
+		if (SegmentIndex >= 0 && SegmentIndex < NumBodySegments)
+		{
+			float* Out = Values + AngularOffset + SegmentIndex * 6;
+			SetAngularVector(Out, Kinematics.angularVelocity);
+			SetAngularVector(Out + 3, Kinematics.angularAcceleration);
+		}
+	}
+	bHasAngular = true;
+}
+
+const TArray<FName>& FMvnKinematicsProperties::GetNames()
+{
+	static const TArray<FName> Names = []()
+	{
+		TArray<FName> Result;
+		Result.Reserve(Count);
+
+		static const TCHAR* Axes[] = { TEXT("X"), TEXT("Y"), TEXT("Z") };
+		auto AddVector = [&Result](const FString& Prefix)
+		{
+			for (const TCHAR* Axis : Axes)
+			{
+				Result.Add(FName(*(Prefix + Axis)));
+			}
+		};
+
+		AddVector(TEXT("CoM_Pos"));
+		AddVector(TEXT("CoM_Vel"));
+		AddVector(TEXT("CoM_Acc"));
+		for (int32 SegmentIndex = 0; SegmentIndex < NumBodySegments; ++SegmentIndex)
+		{
+			// SegmentBoneNames starts with the root
+			const FString Segment = SegmentInformation::SegmentBoneNames[SegmentIndex + 1].ToString();
+			AddVector(Segment + TEXT("_LinVel"));
+			AddVector(Segment + TEXT("_LinAcc"));
+		}
+		for (int32 SegmentIndex = 0; SegmentIndex < NumBodySegments; ++SegmentIndex)
+		{
+			const FString Segment = SegmentInformation::SegmentBoneNames[SegmentIndex + 1].ToString();
+			AddVector(Segment + TEXT("_AngVel"));
+			AddVector(Segment + TEXT("_AngAcc"));
+		}
+
+		check(Result.Num() == Count);
+		return Result;
+	}();
+	return Names;
+}
+
+void FMvnJointTrackerProperties::Reset()
+{
+	NumJoints = 0;
+	NumTrackers = 0;
+}
+
+bool FMvnJointTrackerProperties::SetJointAngles(const JointAnglesDatagram& Datagram)
+{
+	const int32 Num = FMath::Min((int32)Datagram.m_data.size(), MaxJoints);
+	bool bLayoutChanged = Num != NumJoints;
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		const JointAnglesDatagram::Joint& Joint = Datagram.m_data[Index];
+		bLayoutChanged |= JointConnections[Index][0] != Joint.parentConnection || JointConnections[Index][1] != Joint.childConnection;
+		JointConnections[Index][0] = Joint.parentConnection;
+		JointConnections[Index][1] = Joint.childConnection;
+		FMemory::Memcpy(JointValues + Index * ValuesPerJoint, Joint.rotation, sizeof(Joint.rotation));
+	}
+	NumJoints = Num;
+	return bLayoutChanged;
+}
+
+bool FMvnJointTrackerProperties::SetTrackers(const TrackerKinematicsDatagram& Datagram)
+{
+	const int32 Num = FMath::Min((int32)Datagram.m_data.size(), MaxTrackers);
+	bool bLayoutChanged = Num != NumTrackers;
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		const TrackerKinematicsDatagram::Kinematics& Tracker = Datagram.m_data[Index];
+		bLayoutChanged |= TrackerSegments[Index] != Tracker.segmentId;
+		TrackerSegments[Index] = Tracker.segmentId;
+
+		// MVN sends re, i, j, k, converted like SegData::Set converts the segment rotations
+		float* Out = TrackerValues + Index * ValuesPerTracker;
+		const FQuat Rotation = FQuat(-Tracker.quatRotation[1], Tracker.quatRotation[2], -Tracker.quatRotation[3], Tracker.quatRotation[0]).GetNormalized();
+		Out[0] = (float)Rotation.X;
+		Out[1] = (float)Rotation.Y;
+		Out[2] = (float)Rotation.Z;
+		Out[3] = (float)Rotation.W;
+		SetLinearVector(Out + 4, Tracker.freeAcceleration);
+
+		// arbitrary units, only the axes are flipped
+		Out[7] = Tracker.magneticField[0];
+		Out[8] = -Tracker.magneticField[1];
+		Out[9] = Tracker.magneticField[2];
+	}
+	NumTrackers = Num;
+	return bLayoutChanged;
+}
+
+void FMvnJointTrackerProperties::AppendValues(TArray<float>& Out) const
+{
+	Out.Append(JointValues, NumJoints * ValuesPerJoint);
+	Out.Append(TrackerValues, NumTrackers * ValuesPerTracker);
+}
+
+void FMvnJointTrackerProperties::AppendNames(TArray<FName>& Out, const TArray<FName>& SegmentNames) const
+{
+	Out.Reserve(Out.Num() + Num());
+
+	static const TCHAR* Axes[] = { TEXT("X"), TEXT("Y"), TEXT("Z") };
+	for (int32 Index = 0; Index < NumJoints; ++Index)
+	{
+		// a joint connects a point of its parent segment to one of its child segment
+		const FString Joint = GetSegmentName(JointConnections[Index][0] / 256, SegmentNames) + TEXT("_")
+			+ GetSegmentName(JointConnections[Index][1] / 256, SegmentNames) + TEXT("_Joint");
+		for (const TCHAR* Axis : Axes)
+		{
+			Out.Add(FName(*(Joint + Axis)));
+		}
+	}
+
+	static const TCHAR* TrackerSuffixes[] = {
+		TEXT("_TrackerQuatX"), TEXT("_TrackerQuatY"), TEXT("_TrackerQuatZ"), TEXT("_TrackerQuatW"),
+		TEXT("_TrackerAccX"), TEXT("_TrackerAccY"), TEXT("_TrackerAccZ"),
+		TEXT("_TrackerMagX"), TEXT("_TrackerMagY"), TEXT("_TrackerMagZ") };
+	static_assert(UE_ARRAY_COUNT(TrackerSuffixes) == ValuesPerTracker, "a name per tracker value");
+	for (int32 Index = 0; Index < NumTrackers; ++Index)
+	{
+		const FString Segment = GetSegmentName(TrackerSegments[Index], SegmentNames);
+		for (const TCHAR* Suffix : TrackerSuffixes)
+		{
+			Out.Add(FName(*(Segment + Suffix)));
+		}
+	}
+}
@@ -0,0 +1,42 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnLatencyHistogram.h"
+
+void FMvnLatencyHistogram::Reset()
+{
+	FMemory::Memzero(Buckets);
+	Count = 0;
+	Sum = 0.0;
+	Max = 0.0;
+}
+
+void FMvnLatencyHistogram::Add(double Seconds)
+{
+	const uint64 Microseconds = (uint64)FMath::Max(Seconds * 1.0e6, 0.0);
+	const int32 Bucket = Microseconds > 1 ? FMath::Min((int32)FMath::FloorLog2_64(Microseconds), NumBuckets - 1) : 0;
+
+	++Buckets[Bucket];
+	++Count;
+	Sum += Seconds;
+	Max = FMath::Max(Max, Seconds);
+}
+
+double FMvnLatencyHistogram::GetPercentile(double Fraction) const
+{
+	if (Count == 0)
+	{
+		return 0.0;
+	}
+
+	const uint32 Target = (uint32)FMath::CeilToDouble(FMath::Clamp(Fraction, 0.0, 1.0) * Count);
+	uint32 Seen = 0;
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+	{
+		Seen += Buckets[Bucket];
+		if (Seen >= Target && Seen > 0)
+		{
+			return FMath::Min(GetBucketLimit(Bucket), Max);
+		}
+	}
+	return Max;
+}
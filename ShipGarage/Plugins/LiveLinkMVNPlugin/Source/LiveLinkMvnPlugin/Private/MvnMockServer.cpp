@@ -0,0 +1,595 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnMockServer.h"
+#include "Common/UdpSocketBuilder.h"
+#include "DatagramWriter.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Parse.h"
+#include "MvnCaptureFile.h"
+#include "MvnXmlPullParser.h"
+#include "SegmentInformation.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+namespace
+{
+	/** Requests of MvnRemoteControlSessionUtil and the attributes the mock reads */
+	enum ERequestName : int32
+	{
+		IdentifyReqName,
+		CaptureNameName,
+		CaptureStartName,
+		CaptureStopName,
+		SessionInfoReqName,
+		SessionStatusReqName,
+		TimeSyncName,
+		ClockSyncReqName,
+		NameName,
+		TakeName,
+		ValueAttributeName,
+		IdAttributeName,
+		T0AttributeName,
+		RequestNameCount
+	};
+
+	const ANSICHAR* const RequestNames[] =
+	{
+		"IdentifyReq",
+		"CaptureName",
+		"CaptureStart",
+		"CaptureStop",
+		"SessionInfoReq",
+		"SessionStatusReq",
+		"TimeSync",
+		"ClockSyncReq",
+		"Name",
+		"Take",
+		"VALUE",
+		"Id",
+		"T0",
+	};
+	static_assert(UE_ARRAY_COUNT(RequestNames) == RequestNameCount, "a name for every id");
+
+	const FMvnXmlNameTable& GetRequestNameTable()
+	{
+		static const FMvnXmlNameTable NameTable(MakeArrayView(RequestNames));
+		return NameTable;
+	}
+
+	/** Segment index in SegmentInformation of the i-th segment of a datagram */
+	int32 GetSegmentInformationIndex(int32 Segment, int32 NumBodySegments, int32 NumProps)
+	{
+		if (Segment < NumBodySegments)
+		{
+			return Segment + 1;
+		}
+		if (Segment < NumBodySegments + NumProps)
+		{
+			return 24 + Segment - NumBodySegments;
+		}
+		return 28 + Segment - NumBodySegments - NumProps;
+	}
+}
+
+FMvnMockServerSettings::FMvnMockServerSettings()
+{
+	// a server clock that shows the local time of day
+	const FDateTime Now = FDateTime::Now();
+	ClockOffset = Now.GetTimeOfDay().GetTotalSeconds() - FPlatformTime::Seconds();
+}
+
+void FMvnMockServerSettings::Parse(const TCHAR* Params)
+{
+	FString Target;
+	if (FParse::Value(Params, TEXT("Target="), Target))
+	{
+		FIPv4Endpoint::Parse(Target, PoseTarget);
+	}
+	FParse::Value(Params, TEXT("Rate="), Rate);
+	FParse::Value(Params, TEXT("Actors="), NumActors);
+	FParse::Value(Params, TEXT("Segments="), NumBodySegments);
+	FParse::Value(Params, TEXT("Props="), NumProps);
+	FParse::Value(Params, TEXT("Fingers="), NumFingerSegments);
+	FParse::Value(Params, TEXT("MaxPacket="), MaxPacketSize);
+	FParse::Bool(Params, TEXT("TimeCode="), bSendTimeCode);
+	FParse::Value(Params, TEXT("Replay="), ReplayFile);
+	FParse::Value(Params, TEXT("Speed="), ReplaySpeed);
+	FParse::Value(Params, TEXT("Loss="), LossRate);
+	FParse::Value(Params, TEXT("Reorder="), ReorderRate);
+	FParse::Value(Params, TEXT("RemoteControlPort="), RemoteControlPort);
+	FParse::Value(Params, TEXT("Seed="), Seed);
+
+	float Milliseconds;
+	if (FParse::Value(Params, TEXT("JitterMs="), Milliseconds))
+	{
+		Jitter = Milliseconds / 1000.0f;
+	}
+	if (FParse::Value(Params, TEXT("DelayMs="), Milliseconds))
+	{
+		ResponseDelay = Milliseconds / 1000.0f;
+	}
+	if (FParse::Value(Params, TEXT("ResponseJitterMs="), Milliseconds))
+	{
+		ResponseJitter = Milliseconds / 1000.0f;
+	}
+
+	Rate = FMath::Clamp(Rate, 1.0f, 1000.0f);
+	NumActors = FMath::Clamp(NumActors, 1, 255);
+	NumBodySegments = FMath::Clamp(NumBodySegments, 1, 23);
+	NumProps = FMath::Clamp(NumProps, 0, 4);
+	NumFingerSegments = NumFingerSegments > 0 ? 40 : 0;
+	MaxPacketSize = FMath::Clamp(MaxPacketSize, 128, 65000);
+	LossRate = FMath::Clamp(LossRate, 0.0f, 1.0f);
+	ReorderRate = FMath::Clamp(ReorderRate, 0.0f, 1.0f);
+}
+
+FMvnMockServer::FMvnMockServer(const FMvnMockServerSettings& InSettings)
+	: Settings(InSettings)
+	, Period(1.0 / InSettings.Rate)
+	, Random(InSettings.Seed)
+	, ResponseRandom(InSettings.Seed + 1)
+	, SessionName(TEXT("Mock Session"))
+{
+	const int32 NumSegments = Settings.NumBodySegments + Settings.NumProps + Settings.NumFingerSegments;
+	for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+	{
+		SegmentNames.Add(SegmentInformation::SegmentBoneNames[GetSegmentInformationIndex(Segment, Settings.NumBodySegments, Settings.NumProps)].ToString());
+	}
+
+	if (!Settings.ReplayFile.IsEmpty())
+	{
+		FMvnCaptureReader Reader;
+		if (!Reader.Open(Settings.ReplayFile))
+		{
+			UE_LOG(LogTemp, Error, TEXT("MvnMockServer: can't read capture %s"), *Settings.ReplayFile);
+			return;
+		}
+		FMvnCaptureRecord Record;
+		while (Reader.ReadNext(Record))
+		{
+			ReplayTimes.Add(Record.Time);
+			ReplayData.Add(Record.Data);
+		}
+		if (ReplayData.Num() == 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("MvnMockServer: capture %s is empty"), *Settings.ReplayFile);
+			return;
+		}
+	}
+
+	if (Settings.PoseTarget.Port != 0)
+	{
+		PoseSocket = FUdpSocketBuilder(TEXT("MvnMockServerPoses"))
+			.AsNonBlocking()
+			.WithSendBufferSize(4 * 1024 * 1024);
+		if (PoseSocket == nullptr)
+		{
+			UE_LOG(LogTemp, Error, TEXT("MvnMockServer: can't open the pose socket"));
+			return;
+		}
+		PoseTargetAddr = Settings.PoseTarget.ToInternetAddr();
+	}
+
+	if (Settings.RemoteControlPort != 0)
+	{
+		RemoteControlSocket = FUdpSocketBuilder(TEXT("MvnMockServerRemoteControl"))
+			.AsBlocking()
+			.BoundToPort(Settings.RemoteControlPort);
+		if (RemoteControlSocket == nullptr)
+		{
+			UE_LOG(LogTemp, Error, TEXT("MvnMockServer: can't listen for remote control on port %d"), Settings.RemoteControlPort);
+			return;
+		}
+		RemoteControlReceiver = new FUdpSocketReceiver(RemoteControlSocket, FTimespan::FromMilliseconds(100), TEXT("MVN Mock Server Remote Control"));
+		RemoteControlReceiver->OnDataReceived().BindRaw(this, &FMvnMockServer::OnRemoteControlRequest);
+		RemoteControlReceiver->Start();
+	}
+
+	if (PoseSocket != nullptr)
+	{
+		Thread = FRunnableThread::Create(this, TEXT("MVN Mock Server"), 128 * 1024, TPri_AboveNormal);
+	}
+	bRunning = true;
+}
+
+FMvnMockServer::~FMvnMockServer()
+{
+	Stop();
+	if (Thread != nullptr)
+	{
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	delete RemoteControlReceiver;
+	RemoteControlReceiver = nullptr;
+
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	if (RemoteControlSocket != nullptr)
+	{
+		SocketSubsystem->DestroySocket(RemoteControlSocket);
+		RemoteControlSocket = nullptr;
+	}
+	if (PoseSocket != nullptr)
+	{
+		SocketSubsystem->DestroySocket(PoseSocket);
+		PoseSocket = nullptr;
+	}
+}
+
+FMvnMockServer::FStats FMvnMockServer::GetStats() const
+{
+	FStats Stats;
+	Stats.SamplesSent = SamplesSent.GetValue();
+	Stats.PacketsSent = PacketsSent.GetValue();
+	Stats.BytesSent = BytesSent.GetValue();
+	Stats.PacketsDropped = PacketsDropped.GetValue();
+	Stats.PacketsReordered = PacketsReordered.GetValue();
+	Stats.RequestsAnswered = RequestsAnswered.GetValue();
+	return Stats;
+}
+
+double FMvnMockServer::ServerTime(double LocalTime) const
+{
+	return Settings.ClockOffset + LocalTime * (1.0 + Settings.ClockDrift);
+}
+
+uint32 FMvnMockServer::Run()
+{
+	const bool bReplay = ReplayData.Num() > 0;
+	const double StartTime = FPlatformTime::Seconds();
+	double NextSampleTime = StartTime;
+	double NextMetaTime = StartTime;
+	int32 SampleCounter = 0;
+	int32 ReplayIndex = 0;
+	double ReplayStart = StartTime;
+
+	while (!bStopping)
+	{
+		double Now = FPlatformTime::Seconds();
+
+		if (bReplay)
+		{
+			// at the recorded timing, or everything right away
+			while (!bStopping && (Settings.ReplaySpeed <= 0.0f || ReplayStart + ReplayTimes[ReplayIndex] / Settings.ReplaySpeed <= Now))
+			{
+				const TArray<uint8>& Data = ReplayData[ReplayIndex];
+				QueuePacket(Data.GetData(), Data.Num(), Now);
+				SamplesSent.Increment();
+
+				if (++ReplayIndex == ReplayData.Num())
+				{
+					// loop, shifted by one sample so the last and first sample don't coincide
+					ReplayIndex = 0;
+					ReplayStart = Now + Period;
+				}
+				if (Settings.ReplaySpeed <= 0.0f)
+				{
+					SendDuePackets(Now);
+					Now = FPlatformTime::Seconds();
+				}
+			}
+			NextSampleTime = Settings.ReplaySpeed > 0.0f ? ReplayStart + ReplayTimes[ReplayIndex] / Settings.ReplaySpeed : Now;
+		}
+		else if (Now >= NextSampleTime)
+		{
+			const bool bSendMeta = Now >= NextMetaTime;
+			if (bSendMeta)
+			{
+				NextMetaTime += 1.0;
+			}
+			for (int32 Actor = 0; Actor < Settings.NumActors; ++Actor)
+			{
+				SendSyntheticSample(Actor, SampleCounter, NextSampleTime - StartTime, bSendMeta);
+			}
+			++SampleCounter;
+			NextSampleTime += Period;
+
+			// don't try to catch up after a long stall
+			if (NextSampleTime < Now - 0.1)
+			{
+				NextSampleTime = Now + Period;
+			}
+		}
+
+		const double NextPacketTime = SendDuePackets(FPlatformTime::Seconds());
+		const double WaitTime = FMath::Min(NextSampleTime, NextPacketTime) - FPlatformTime::Seconds();
+		if (WaitTime > 0.002)
+		{
+			FPlatformProcess::SleepNoStats((float)(WaitTime - 0.001));
+		}
+		else if (WaitTime > 0.0)
+		{
+			FPlatformProcess::SleepNoStats(0.0f);
+		}
+	}
+	return 0;
+}
+
+void FMvnMockServer::Stop()
+{
+	bStopping = true;
+}
+
+void FMvnMockServer::SendSyntheticSample(int32 Actor, int32 SampleCounter, double SampleTime, bool bSendMeta)
+{
+	const double Now = FPlatformTime::Seconds();
+	const int32 FrameTime = (int32)(SampleTime * 1000.0);
+	const uint8 AvatarId = (uint8)Actor;
+	const uint8 NumBody = (uint8)Settings.NumBodySegments;
+	const uint8 NumProps = (uint8)Settings.NumProps;
+	const uint8 NumFingers = (uint8)Settings.NumFingerSegments;
+	const int32 NumSegments = SegmentNames.Num();
+
+	if (bSendMeta)
+	{
+		// name first, the source names the subject after it
+		const FTCHARToUTF8 Meta(*FString::Printf(TEXT("name:Mock Actor %d\n"), Actor + 1));
+		Scratch.Reset();
+		DatagramWriter MetaWriter(Scratch);
+		MetaWriter.writeHeader(SPMetaMoreMeta, SampleCounter, 0x80, 0, FrameTime, AvatarId, NumBody, NumProps, NumFingers);
+		MetaWriter.writeMetaText(Meta.Get(), Meta.Length());
+		QueuePacket(Scratch.GetData(), Scratch.Num(), Now);
+
+		Scratch.Reset();
+		DatagramWriter ScaleWriter(Scratch);
+		ScaleWriter.writeHeader(SPMetaScaling, SampleCounter, 0x80, (uint8)NumSegments, FrameTime, AvatarId, NumBody, NumProps, NumFingers);
+		ScaleWriter.write((int32_t)NumSegments);
+		for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+		{
+			// a T-pose stacked along the up axis, enough for a skeleton
+			const float Origin[3] = { 0.0f, 0.0f, 0.05f * Segment };
+			ScaleWriter.writeScaleSegment(TCHAR_TO_ANSI(*SegmentNames[Segment]), Origin);
+		}
+		QueuePacket(Scratch.GetData(), Scratch.Num(), Now);
+	}
+
+	if (Settings.bSendTimeCode)
+	{
+		const double ServerSeconds = FMath::Fmod(ServerTime(Now), 86400.0);
+		const int32 Milliseconds = (int32)(ServerSeconds * 1000.0);
+		Scratch.Reset();
+		DatagramWriter TimeCodeWriter(Scratch);
+		TimeCodeWriter.writeHeader(SPTimeCode, SampleCounter, 0x80, 0, FrameTime, AvatarId, NumBody, NumProps, NumFingers);
+		TimeCodeWriter.writeTimeCode(Milliseconds / 3600000, (Milliseconds / 60000) % 60, (Milliseconds / 1000) % 60, Milliseconds % 1000);
+		QueuePacket(Scratch.GetData(), Scratch.Num(), Now);
+	}
+
+	// every segment swings around its own axis, the pelvis walks a circle; actors stand a meter apart
+	Scratch.Reset();
+	DatagramWriter PoseWriter(Scratch);
+	PoseWriter.writeHeader(SPPoseQuaternion, SampleCounter, 0x80, (uint8)NumSegments, FrameTime, AvatarId, NumBody, NumProps, NumFingers);
+	const float Time = (float)SampleTime;
+	for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+	{
+		const float Phase = 0.7f * Segment + 1.3f * Actor;
+		FVector Position(1.0f * Actor, 0.0f, 0.05f * Segment + 0.9f);
+		if (Segment == 0)
+		{
+			Position.X += 0.5f * FMath::Cos(0.5f * Time);
+			Position.Y += 0.5f * FMath::Sin(0.5f * Time);
+		}
+		const FVector Axis = FVector(FMath::Sin(Phase), FMath::Cos(Phase), 0.5f).GetSafeNormal();
+		const FQuat Rotation(Axis, 0.3f * FMath::Sin(2.0f * Time + Phase));
+
+		const float PositionData[3] = { (float)Position.X, (float)Position.Y, (float)Position.Z };
+		const float RotationData[4] = { (float)Rotation.W, (float)Rotation.X, (float)Rotation.Y, (float)Rotation.Z };
+		PoseWriter.writeQuaternionSegment(Segment + 1, PositionData, RotationData);
+	}
+
+	if (DatagramWriter::fragment(Scratch.GetData(), Scratch.Num(), DatagramWriter::QUATERNION_SEGMENT_SIZE, Settings.MaxPacketSize, Fragments) > 0)
+	{
+		for (const TArray<uint8>& Fragment : Fragments)
+		{
+			QueuePacket(Fragment.GetData(), Fragment.Num(), Now);
+		}
+	}
+	SamplesSent.Increment();
+}
+
+void FMvnMockServer::QueuePacket(const uint8* Data, int32 Size, double Now)
+{
+	if (Settings.LossRate > 0.0f && Random.FRand() < Settings.LossRate)
+	{
+		PacketsDropped.Increment();
+		return;
+	}
+
+	double SendTime = Now + Random.FRand() * Settings.Jitter;
+	if (Settings.ReorderRate > 0.0f && Random.FRand() < Settings.ReorderRate)
+	{
+		// after the packets of the next sample
+		SendTime += 1.5 * Period;
+		PacketsReordered.Increment();
+	}
+
+	FPendingPacket Packet;
+	Packet.SendTime = SendTime;
+	if (FreeBuffers.Num() > 0)
+	{
+		Packet.Data = FreeBuffers.Pop(false);
+		Packet.Data.Reset();
+	}
+	Packet.Data.Append(Data, Size);
+
+	// in send time order, equal times keep their queue order
+	int32 Index = Pending.Num();
+	while (Index > 0 && Pending[Index - 1].SendTime > SendTime)
+	{
+		--Index;
+	}
+	Pending.Insert(MoveTemp(Packet), Index);
+}
+
+double FMvnMockServer::SendDuePackets(double Now)
+{
+	int32 NumDue = 0;
+	while (NumDue < Pending.Num() && Pending[NumDue].SendTime <= Now)
+	{
+		FPendingPacket& Packet = Pending[NumDue];
+		int32 NumSent = 0;
+		if (PoseSocket->SendTo(Packet.Data.GetData(), Packet.Data.Num(), NumSent, *PoseTargetAddr))
+		{
+			PacketsSent.Increment();
+			BytesSent.Add(NumSent);
+		}
+		FreeBuffers.Add(MoveTemp(Packet.Data));
+		++NumDue;
+	}
+	Pending.RemoveAt(0, NumDue, false);
+
+	return Pending.Num() > 0 ? Pending[0].SendTime : TNumericLimits<double>::Max();
+}
+
+void FMvnMockServer::OnRemoteControlRequest(const FArrayReaderPtr& Data, const FIPv4Endpoint& Sender)
+{
+	// half the delay each way, the jitter is drawn per direction
+	const double ArrivalDelay = Settings.ResponseDelay * 0.5 + ResponseRandom.FRand() * Settings.ResponseJitter;
+	if (ArrivalDelay > 0.0)
+	{
+		FPlatformProcess::Sleep((float)ArrivalDelay);
+	}
+	const double ServerReceive = ServerTime(FPlatformTime::Seconds());
+
+	FMvnXmlPullParser Parser(Data->GetData(), Data->Num(), GetRequestNameTable());
+	int32 Request = INDEX_NONE;
+	FString RequestId;
+	FString LocalSend;
+	FString CaptureName;
+	int32 CaptureTake = INDEX_NONE;
+	int32 Element = INDEX_NONE;
+	for (FMvnXmlPullParser::EToken Token = Parser.Next(); Token != FMvnXmlPullParser::EToken::End && Token != FMvnXmlPullParser::EToken::Error; Token = Parser.Next())
+	{
+		if (Token == FMvnXmlPullParser::EToken::StartElement)
+		{
+			Element = Parser.GetNameId();
+			if (Parser.GetDepth() == 1)
+			{
+				Request = Element;
+			}
+		}
+		else if (Token == FMvnXmlPullParser::EToken::Attribute)
+		{
+			const int32 Attribute = Parser.GetNameId();
+			if (Element == ClockSyncReqName && Attribute == IdAttributeName)
+			{
+				Parser.GetValueAsString(RequestId);
+			}
+			else if (Element == ClockSyncReqName && Attribute == T0AttributeName)
+			{
+				Parser.GetValueAsString(LocalSend);
+			}
+			else if (Element == NameName && Attribute == ValueAttributeName)
+			{
+				Parser.GetValueAsString(CaptureName);
+			}
+			else if (Element == TakeName && Attribute == ValueAttributeName)
+			{
+				CaptureTake = (int32)Parser.GetValueAsUInt();
+			}
+		}
+	}
+
+	FString Response;
+	switch (Request)
+	{
+	case IdentifyReqName:
+		Response = TEXT("<IdentifyAck Result=\"true\"/>");
+		break;
+	case CaptureNameName:
+		SessionName = CaptureName.IsEmpty() ? SessionName : CaptureName;
+		Take = CaptureTake != INDEX_NONE ? CaptureTake : Take;
+		Response = TEXT("<CaptureNameAck Result=\"true\" Success=\"true\"/>");
+		break;
+	case CaptureStartName:
+		Response = bRecording ? TEXT("<CaptureStartAck Result=\"false\" Reason=\"Already recording\"/>") : TEXT("<CaptureStartAck Result=\"true\"/>");
+		bRecording = true;
+		break;
+	case CaptureStopName:
+		Response = bRecording ? TEXT("<CaptureStopAck Result=\"true\"/>") : TEXT("<CaptureStopAck Result=\"false\" Reason=\"Not recording\"/>");
+		if (bRecording)
+		{
+			bRecording = false;
+			++Take;
+		}
+		break;
+	case SessionInfoReqName:
+		Response = FString::Printf(TEXT("<SessionInfoAck Result=\"true\" SessionName=\"%s\" recordingTrial=\"Take_%03d\"/>"), *SessionName.Replace(TEXT("&"), TEXT("&amp;")).Replace(TEXT("\""), TEXT("&quot;")), Take);
+		break;
+	case SessionStatusReqName:
+		Response = FString::Printf(TEXT("<SessionStatusAck Result=\"true\" isRecording=\"%s\" isPaused=\"false\" isLive=\"true\"/>"), bRecording ? TEXT("true") : TEXT("false"));
+		break;
+	case ClockSyncReqName:
+		if (!LocalSend.IsEmpty())
+		{
+			const double ServerSend = ServerTime(FPlatformTime::Seconds());
+			Response = FString::Printf(TEXT("<ClockSyncAck Id=\"%s\" T0=\"%s\" T1=\"%.9f\" T2=\"%.9f\"/>"), *RequestId, *LocalSend, ServerReceive, ServerSend);
+		}
+		break;
+	default:
+		// time sync is not answered
+		break;
+	}
+
+	if (Response.IsEmpty())
+	{
+		return;
+	}
+
+	const double ReturnDelay = Settings.ResponseDelay * 0.5 + ResponseRandom.FRand() * Settings.ResponseJitter;
+	if (ReturnDelay > 0.0)
+	{
+		FPlatformProcess::Sleep((float)ReturnDelay);
+	}
+
+	const FTCHARToUTF8 Converted(*Response);
+	int32 NumSent = 0;
+	RemoteControlSocket->SendTo((const uint8*)Converted.Get(), Converted.Length(), NumSent, *Sender.ToInternetAddr());
+	RequestsAnswered.Increment();
+}
+
+namespace MvnMockServerCommands
+{
+	static TUniquePtr<FMvnMockServer> Server;
+
+	static void Start(const TArray<FString>& Args)
+	{
+		FMvnMockServerSettings Settings;
+		Settings.Parse(*FString::Join(Args, TEXT(" ")));
+
+		Server.Reset();
+		Server = MakeUnique<FMvnMockServer>(Settings);
+		if (!Server->IsRunning())
+		{
+			Server.Reset();
+			return;
+		}
+		UE_LOG(LogTemp, Display, TEXT("MvnMockServer: %d actors at %.0f Hz to %s%s"), Settings.NumActors, Settings.Rate, *Settings.PoseTarget.ToString(),
+			Settings.RemoteControlPort != 0 ? *FString::Printf(TEXT(", remote control on port %d"), Settings.RemoteControlPort) : TEXT(""));
+	}
+
+	static void Stop(const TArray<FString>& Args)
+	{
+		if (Server.IsValid())
+		{
+			const FMvnMockServer::FStats Stats = Server->GetStats();
+			UE_LOG(LogTemp, Display, TEXT("MvnMockServer: sent %lld samples in %lld packets (%lld bytes), dropped %lld, reordered %lld, answered %lld requests"),
+				Stats.SamplesSent, Stats.PacketsSent, Stats.BytesSent, Stats.PacketsDropped, Stats.PacketsReordered, Stats.RequestsAnswered);
+			Server.Reset();
+		}
+	}
+}
+
+static FAutoConsoleCommand MvnMockServerStartCommand(
+	TEXT("mvn.MockServer.Start"),
+	TEXT("Start a mock MVN server in this process. Args: Target=127.0.0.1:9763 Rate=60 Actors=1 Segments=23 Props=0 Fingers=0 MaxPacket=1400 TimeCode=true Replay=<capture> Speed=1 Loss=0 Reorder=0 JitterMs=0 RemoteControlPort=0 DelayMs=0 ResponseJitterMs=0 Seed=1"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&MvnMockServerCommands::Start));
+
+static FAutoConsoleCommand MvnMockServerStopCommand(
+	TEXT("mvn.MockServer.Stop"),
+	TEXT("Stop the mock MVN server and log what it sent"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&MvnMockServerCommands::Stop));
@@ -0,0 +1,53 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnPacketRing.h"
+
+FMvnPacketRing::FMvnPacketRing(int32 InDepth, int32 InMaxPacketSize)
+	: MaxPacketSize(InMaxPacketSize)
+	, WritePosition(0)
+	, ReadPosition(0)
+{
+	// a power of two depth keeps the slot index continuous when the positions wrap around
+	Slots.SetNum(FMath::RoundUpToPowerOfTwo(FMath::Max(1, InDepth)));
+	for (FMvnPacketSlot& Slot : Slots)
+	{
+		Slot.Buffer.SetNumUninitialized(MaxPacketSize);
+	}
+}
+
+FMvnPacketSlot* FMvnPacketRing::AcquireWrite()
+{
+	const uint32 Write = WritePosition.load(std::memory_order_relaxed);
+	const uint32 Read = ReadPosition.load(std::memory_order_acquire);
+	if (Write - Read >= (uint32)Slots.Num())
+	{
+		return nullptr;
+	}
+	return &Slots[Write % Slots.Num()];
+}
+
+void FMvnPacketRing::CommitWrite()
+{
+	WritePosition.fetch_add(1, std::memory_order_release);
+}
+
+FMvnPacketSlot* FMvnPacketRing::PeekRead()
+{
+	const uint32 Read = ReadPosition.load(std::memory_order_relaxed);
+	const uint32 Write = WritePosition.load(std::memory_order_acquire);
+	if (Read == Write)
+	{
+		return nullptr;
+	}
+	return &Slots[Read % Slots.Num()];
+}
+
+void FMvnPacketRing::ReleaseRead()
+{
+	ReadPosition.fetch_add(1, std::memory_order_release);
+}
+
+int32 FMvnPacketRing::Num() const
+{
+	return (int32)(WritePosition.load(std::memory_order_acquire) - ReadPosition.load(std::memory_order_acquire));
+}
@@ -0,0 +1,207 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnPosePredictor.h"
+#include "LiveLinkMvnSource.h"
+
+namespace
+{
+	FVector GetKinematicsVector(const FMvnKinematicsProperties& Kinematics, int32 Offset)
+	{
+		return FVector(Kinematics.Values[Offset], Kinematics.Values[Offset + 1], Kinematics.Values[Offset + 2]);
+	}
+
+	// turn Rotation by AngularVelocity (rad/s, global) over Seconds
+	FQuat Rotate(const FQuat& Rotation, const FVector& AngularVelocity, double Seconds)
+	{
+		const double Speed = AngularVelocity.Size();
+		if (Speed * Seconds < KINDA_SMALL_NUMBER)
+		{
+			return Rotation;
+		}
+		return (FQuat(AngularVelocity / Speed, Speed * Seconds) * Rotation).GetNormalized();
+	}
+}
+
+void FMvnPredictionError::Append(const FMvnPredictionError& Other)
+{
+	if (Other.Count == 0)
+	{
+		return;
+	}
+	const int32 Total = Count + Other.Count;
+	PositionMean = (PositionMean * Count + Other.PositionMean * Other.Count) / Total;
+	RotationMean = (RotationMean * Count + Other.RotationMean * Other.Count) / Total;
+	PositionMax = FMath::Max(PositionMax, Other.PositionMax);
+	RotationMax = FMath::Max(RotationMax, Other.RotationMax);
+	Count = Total;
+}
+
+void FMvnPosePredictor::Configure(double InHorizon, bool bInUseKinematics)
+{
+	Horizon = FMath::Max(InHorizon, 0.0);
+	bUseKinematics = bInUseKinematics;
+	Reset();
+
+	if (IsEnabled())
+	{
+		PreviousTransforms.Reserve(SegData::XS_SEG_NUM_FINGERS);
+		Pending.SetNum(MaxPending);
+	}
+	else
+	{
+		PreviousTransforms.Empty();
+		Pending.Empty();
+	}
+}
+
+void FMvnPosePredictor::Reset()
+{
+	PreviousTransforms.Reset();
+	bHasPrevious = false;
+	PendingStart = 0;
+	PendingNum = 0;
+}
+
+void FMvnPosePredictor::Predict(Pose& InOutPose)
+{
+	const double SampleTime = InOutPose.WorldTime;
+	const int32 NumSegments = InOutPose.Segments.Num();
+
+	// the stream clock went back, MVN restarted
+	if (bHasPrevious && SampleTime < PreviousTime)
+	{
+		Reset();
+	}
+
+	if (bHasPrevious)
+	{
+		Measure(InOutPose, SampleTime);
+	}
+
+	const double Interval = SampleTime - PreviousTime;
+	const bool bCanDifference = bHasPrevious && PreviousTransforms.Num() == NumSegments && Interval > 0.0 && Interval < MaxDifferenceInterval;
+	const FMvnKinematicsProperties& Kinematics = InOutPose.Kinematics;
+	const bool bLinearKinematics = bUseKinematics && Kinematics.bHasLinear;
+	const bool bAngularKinematics = bUseKinematics && Kinematics.bHasAngular;
+
+	PreviousTransforms.SetNum(NumSegments, false);
+	for (int32 SegmentIndex = 0; SegmentIndex < NumSegments; ++SegmentIndex)
+	{
+		FTransform& Transform = InOutPose.Segments[SegmentIndex].Transform;
+		const FTransform Sample = Transform;
+		const bool bBodySegment = SegmentIndex < FMvnKinematicsProperties::NumBodySegments;
+
+		FVector Velocity = FVector::ZeroVector;
+		FVector Acceleration = FVector::ZeroVector;
+		if (bBodySegment && bLinearKinematics)
+		{
+			const int32 Offset = FMvnKinematicsProperties::LinearOffset + SegmentIndex * 6;
+			Velocity = GetKinematicsVector(Kinematics, Offset);
+			Acceleration = GetKinematicsVector(Kinematics, Offset + 3);
+		}
+		else if (bCanDifference)
+		{
+			Velocity = (Sample.GetLocation() - PreviousTransforms[SegmentIndex].GetLocation()) / Interval;
+		}
+
+		FVector AngularVelocity = FVector::ZeroVector;
+		if (bBodySegment && bAngularKinematics)
+		{
+			// the properties hold degrees, like Live Link shows them
+			AngularVelocity = FVector::DegreesToRadians(GetKinematicsVector(Kinematics, FMvnKinematicsProperties::AngularOffset + SegmentIndex * 6));
+		}
+		else if (bCanDifference)
+		{
+			FQuat Delta = Sample.GetRotation() * PreviousTransforms[SegmentIndex].GetRotation().Inverse();
+			Delta.EnforceShortestArcWith(FQuat::Identity);
+			AngularVelocity = Delta.GetRotationAxis() * (Delta.GetAngle() / Interval);
+		}
+
+		Transform.SetLocation(Sample.GetLocation() + Velocity * Horizon + Acceleration * (0.5 * Horizon * Horizon));
+		Transform.SetRotation(Rotate(Sample.GetRotation(), AngularVelocity, Horizon));
+		PreviousTransforms[SegmentIndex] = Sample;
+	}
+
+	// keep the prediction for the sample of its time, dropping the oldest if that one never came
+	if (PendingNum == MaxPending)
+	{
+		PendingStart = (PendingStart + 1) % MaxPending;
+		--PendingNum;
+	}
+	FPrediction& Prediction = Pending[(PendingStart + PendingNum) % MaxPending];
+	++PendingNum;
+	Prediction.TargetTime = SampleTime + Horizon;
+	Prediction.NumSegments = FMath::Min(NumSegments, (int32)FMvnKinematicsProperties::NumBodySegments);
+	for (int32 SegmentIndex = 0; SegmentIndex < Prediction.NumSegments; ++SegmentIndex)
+	{
+		const FTransform& Transform = InOutPose.Segments[SegmentIndex].Transform;
+		Prediction.Positions[SegmentIndex] = Transform.GetLocation();
+		Prediction.Rotations[SegmentIndex] = Transform.GetRotation();
+	}
+
+	InOutPose.WorldTime = SampleTime + Horizon;
+	PreviousTime = SampleTime;
+	bHasPrevious = true;
+}
+
+void FMvnPosePredictor::Measure(const Pose& Actual, double SampleTime)
+{
+	const double Interval = SampleTime - PreviousTime;
+
+	while (PendingNum > 0)
+	{
+		const FPrediction& Prediction = Pending[PendingStart];
+		if (Prediction.TargetTime > SampleTime)
+		{
+			break;
+		}
+		PendingStart = (PendingStart + 1) % MaxPending;
+		--PendingNum;
+
+		// the actual pose at the target time, between the previous sample and this one
+		const int32 NumSegments = FMath::Min(Prediction.NumSegments, Actual.Segments.Num());
+		if (NumSegments == 0 || PreviousTransforms.Num() < NumSegments)
+		{
+			continue;
+		}
+		const double Alpha = Interval > 0.0 ? FMath::Clamp((Prediction.TargetTime - PreviousTime) / Interval, 0.0, 1.0) : 1.0;
+
+		double PositionError = 0.0;
+		double RotationError = 0.0;
+		for (int32 SegmentIndex = 0; SegmentIndex < NumSegments; ++SegmentIndex)
+		{
+			const FTransform& Previous = PreviousTransforms[SegmentIndex];
+			const FTransform& Next = Actual.Segments[SegmentIndex].Transform;
+			const FVector Position = FMath::Lerp(Previous.GetLocation(), Next.GetLocation(), Alpha);
+			const FQuat Rotation = FQuat::Slerp(Previous.GetRotation(), Next.GetRotation(), Alpha);
+
+			const double SegmentPositionError = FVector::Dist(Position, Prediction.Positions[SegmentIndex]);
+			const double SegmentRotationError = FMath::RadiansToDegrees(Rotation.AngularDistance(Prediction.Rotations[SegmentIndex]));
+			PositionError += SegmentPositionError;
+			RotationError += SegmentRotationError;
+			PositionErrorMax = FMath::Max(PositionErrorMax, SegmentPositionError);
+			RotationErrorMax = FMath::Max(RotationErrorMax, SegmentRotationError);
+		}
+
+		PositionErrorSum += PositionError / NumSegments;
+		RotationErrorSum += RotationError / NumSegments;
+		++ErrorCount;
+	}
+}
+
+FMvnPredictionError FMvnPosePredictor::TakeError()
+{
+	FMvnPredictionError Error;
+	Error.Count = ErrorCount;
+	Error.PositionMean = ErrorCount > 0 ? PositionErrorSum / ErrorCount : 0.0;
+	Error.PositionMax = PositionErrorMax;
+	Error.RotationMean = ErrorCount > 0 ? RotationErrorSum / ErrorCount : 0.0;
+	Error.RotationMax = RotationErrorMax;
+
+	ErrorCount = 0;
+	PositionErrorSum = 0.0;
+	PositionErrorMax = 0.0;
+	RotationErrorSum = 0.0;
+	RotationErrorMax = 0.0;
+	return Error;
+}
@@ -0,0 +1,83 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnReceiveWorker.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Sockets.h"
+
+FMvnReceiveWorker::FMvnReceiveWorker(FSocket* InSocket, ISocketSubsystem* SocketSubsystem, int32 BatchSize, int32 PortIndex, bool bKernelTimestamps,
+	int32 InRingDepth, int32 InMaxPacketSize, FEvent* InDataEvent, FTimespan InWaitTime)
+	: Ring(InRingDepth, InMaxPacketSize)
+	, Socket(InSocket)
+	, Receiver(InSocket, SocketSubsystem, BatchSize, InMaxPacketSize, bKernelTimestamps, PortIndex)
+	, DataEvent(InDataEvent)
+	, WaitTime(InWaitTime)
+	, SpaceEvent(FPlatformProcess::GetSynchEventFromPool(false))
+	, Thread(nullptr)
+	, bStopping(false)
+	, RingOverflows(0)
+{
+}
+
+FMvnReceiveWorker::~FMvnReceiveWorker()
+{
+	Stop();
+	if (Thread != nullptr)
+	{
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+	FPlatformProcess::ReturnSynchEventToPool(SpaceEvent);
+	SpaceEvent = nullptr;
+}
+
+void FMvnReceiveWorker::Start(const FString& ThreadName)
+{
+	Thread = FRunnableThread::Create(this, *ThreadName, 128 * 1024, TPri_AboveNormal, FPlatformAffinity::GetPoolThreadMask());
+}
+
+void FMvnReceiveWorker::Stop()
+{
+	bStopping = true;
+	SpaceEvent->Trigger();
+}
+
+void FMvnReceiveWorker::NotifyRingDrained()
+{
+	SpaceEvent->Trigger();
+}
+
+uint32 FMvnReceiveWorker::Run()
+{
+	while (!bStopping)
+	{
+		if (Ring.Num() >= Ring.GetDepth())
+		{
+			// the socket would report data the ring has no room for, sleep until the source's thread caught up
+			SpaceEvent->Wait(WaitTime);
+		}
+		else if (Socket->Wait(ESocketWaitConditions::WaitForRead, WaitTime))
+		{
+			Drain();
+		}
+	}
+	return 0;
+}
+
+bool FMvnReceiveWorker::Drain()
+{
+	bool bReceived = false;
+	while (!bStopping && Receiver.ReceiveBatch(Ring) > 0)
+	{
+		bReceived = true;
+	}
+
+	if (bReceived)
+	{
+		RingOverflows.store(Receiver.GetRingOverflows(), std::memory_order_relaxed);
+		DataEvent->Trigger();
+	}
+	return bReceived;
+}
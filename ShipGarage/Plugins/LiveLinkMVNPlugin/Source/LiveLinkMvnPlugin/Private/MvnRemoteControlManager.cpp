@@ -2,9 +2,26 @@
 
 #include "MvnRemoteControlManager.h"
 #include "MvnRemoteControlSession.h"
+#include "MvnRemoteControlScheduler.h"
+#include "MvnRemoteControlSessionUtil.h"
+#include "HAL/IConsoleManager.h"
 
 MvnRemoteControlManager* MvnRemoteControlManager::s_pInstance = nullptr;
 
+static void LogRemoteControlStats( const TArray< FString >& _Args )
+{
+    MvnRemoteControlManager* pManager = MvnRemoteControlManager::GetInstance();
+    if ( pManager )
+    {
+        pManager->LogCommandStats( _Args.Num() > 0 && _Args[ 0 ] == TEXT( "reset" ) );
+    }
+}
+
+static FAutoConsoleCommand CmdRemoteControlStats(
+    TEXT( "mvn.RemoteControl.Stats" ),
+    TEXT( "Log sent, answered, timed out and dropped requests and response latencies per session and command. 'reset' starts counting again." ),
+    FConsoleCommandWithArgsDelegate::CreateStatic( &LogRemoteControlStats ) );
+
 void UMvnRemoteControlManager::StartRecording( float _fTimeOffsetInSeconds )
 {
 	MvnRemoteControlManager* pManager = MvnRemoteControlManager::GetInstance();
@@ -27,6 +44,7 @@ void UMvnRemoteControlManager::StopRecording( float _fTimeOffsetInSeconds )
 MvnRemoteControlManager::MvnRemoteControlManager()
 {
     s_pInstance = this;
+    m_pScheduler = new MvnRemoteControlScheduler();
     /// reserve capture port 
     AddReservedPort( 9763 );
 }
@@ -35,15 +53,25 @@ MvnRemoteControlManager::~MvnRemoteControlManager()
 {
     for ( int32 i = 0; i < Sessions.Num(); i++ )
     {
+        m_pScheduler->RemoveSession( Sessions[ i ] );
         delete Sessions[ i ];
     }
     Sessions.Empty();
+
+    delete m_pScheduler;
+    m_pScheduler = nullptr;
+
+    if ( s_pInstance == this )
+    {
+        s_pInstance = nullptr;
+    }
 }
 
 MvnRemoteControlSession* MvnRemoteControlManager::CreateSession( const FIPv4Address& _ipAddress, int _iPort )
 {
-    MvnRemoteControlSession* pNewSession = new MvnRemoteControlSession( _ipAddress, _iPort );
+    MvnRemoteControlSession* pNewSession = new MvnRemoteControlSession( _ipAddress, _iPort, m_pScheduler );
     Sessions.Add( pNewSession );
+    m_pScheduler->AddSession( pNewSession );
     return pNewSession;
 }
 
@@ -65,12 +93,15 @@ void MvnRemoteControlManager::DestroySession( MvnRemoteControlSession* _pSession
     if ( Sessions.Contains( _pSession ) )
     {
         Sessions.Remove( _pSession );
+        m_pScheduler->RemoveSession( _pSession );
         delete _pSession;
     }
 }
 
 void MvnRemoteControlManager::CaptureStartAll( double _dTimeOffsetInSeconds )
 {
+    // all sessions get the command in the same scheduler pass
+    MvnRemoteControlScheduler::ScopedBatch Batch( *m_pScheduler );
     for ( int i = 0; i < Sessions.Num(); i++ )
     {
         Sessions[ i ]->CaptureStart( _dTimeOffsetInSeconds );
@@ -79,6 +110,7 @@ void MvnRemoteControlManager::CaptureStartAll( double _dTimeOffsetInSeconds )
 
 void MvnRemoteControlManager::CaptureStopAll( double _dTimeOffsetInSeconds )
 {
+    MvnRemoteControlScheduler::ScopedBatch Batch( *m_pScheduler );
     for ( int i = 0; i < Sessions.Num(); i++ )
     {
         Sessions[ i ]->CaptureStop( _dTimeOffsetInSeconds );
@@ -125,6 +157,36 @@ bool MvnRemoteControlManager::IsPortReserved( int32 _iPort )
     return m_aReservedPorts.Contains( _iPort );
 }
 
+void MvnRemoteControlManager::LogCommandStats( bool _bReset )
+{
+    for ( MvnRemoteControlSession* pSession : Sessions )
+    {
+        UE_LOG( LogTemp, Log, TEXT( "MVN remote control %s (%s)" ), *pSession->GetIPAddressAndPort(), *pSession->GetSessionName() );
+        for ( int32 i = 0; i < MvnRemoteControlMessageCommandCount; i++ )
+        {
+            const eMvnRemoteControlMessageCommand Command = (eMvnRemoteControlMessageCommand)i;
+            MvnRemoteControlCommandStats Stats;
+            pSession->GetCommandStats( Command, Stats );
+            if ( Stats.m_uiSent == 0 && Stats.m_uiDropped == 0 )
+            {
+                continue;
+            }
+            UE_LOG( LogTemp, Log, TEXT( "    %-14s sent %u answered %u timed out %u dropped %u, latency mean %.2f p50 %.2f p99 %.2f max %.2f ms" ),
+                MvnRemoteControlSessionUtil::GetCommandName( Command ), Stats.m_uiSent, Stats.m_uiAnswered, Stats.m_uiTimedOut, Stats.m_uiDropped,
+                Stats.m_Latency.GetMean() * 1000.0, Stats.m_Latency.GetPercentile( 0.5 ) * 1000.0, Stats.m_Latency.GetPercentile( 0.99 ) * 1000.0, Stats.m_Latency.Max * 1000.0 );
+        }
+        if ( _bReset )
+        {
+            pSession->ResetCommandStats();
+        }
+    }
+}
+
+MvnRemoteControlScheduler* MvnRemoteControlManager::GetScheduler()
+{
+    return m_pScheduler;
+}
+
 MvnRemoteControlManager* MvnRemoteControlManager::GetInstance()
 {
     return s_pInstance;
@@ -0,0 +1,143 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnRemoteControlScheduler.h"
+#include "MvnRemoteControlSession.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTLS.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+    /** how long before a time sync deadline the thread stops sleeping, covers the wait's timer resolution */
+    const FTimespan TimeSyncLead = FTimespan::FromMilliseconds( 3.0 );
+
+    /** upper bound of one sleep, also used when there are no sessions */
+    const uint32 MaxWaitMilliseconds = 1000;
+}
+
+MvnRemoteControlScheduler::MvnRemoteControlScheduler()
+{
+    m_pWakeEvent = FPlatformProcess::GetSynchEventFromPool( false );
+
+    FString strThreadName = "MVN UDP Remote Control ";
+    strThreadName.AppendInt( FAsyncThreadIndex::GetNext() );
+
+    m_pThread = FRunnableThread::Create( this, *strThreadName, 128 * 1024, TPri_AboveNormal, FPlatformAffinity::GetPoolThreadMask() );
+}
+
+MvnRemoteControlScheduler::~MvnRemoteControlScheduler()
+{
+    Stop();
+    if ( m_pThread != nullptr )
+    {
+        m_pThread->WaitForCompletion();
+        delete m_pThread;
+        m_pThread = nullptr;
+    }
+
+    FPlatformProcess::ReturnSynchEventToPool( m_pWakeEvent );
+    m_pWakeEvent = nullptr;
+}
+
+void MvnRemoteControlScheduler::AddSession( MvnRemoteControlSession* _pSession )
+{
+    {
+        FScopeLock Lock( &m_SessionsCriticalSection );
+        m_apSessions.AddUnique( _pSession );
+    }
+    Wake();
+}
+
+void MvnRemoteControlScheduler::RemoveSession( MvnRemoteControlSession* _pSession )
+{
+    // the thread holds the lock while it updates, so once we have it the session is no longer in use
+    FScopeLock Lock( &m_SessionsCriticalSection );
+    m_apSessions.Remove( _pSession );
+}
+
+void MvnRemoteControlScheduler::Wake()
+{
+    // the thread sends its own requests before it sleeps again
+    if ( FPlatformTLS::GetCurrentThreadId() != m_uiThreadId )
+    {
+        m_pWakeEvent->Trigger();
+    }
+}
+
+MvnRemoteControlScheduler::ScopedBatch::ScopedBatch( MvnRemoteControlScheduler& _Scheduler )
+    : m_Scheduler( _Scheduler )
+{
+    m_Scheduler.m_SessionsCriticalSection.Lock();
+}
+
+MvnRemoteControlScheduler::ScopedBatch::~ScopedBatch()
+{
+    m_Scheduler.m_SessionsCriticalSection.Unlock();
+    m_Scheduler.Wake();
+}
+
+uint64 MvnRemoteControlScheduler::GetWakeCount() const
+{
+    return m_uiWakeCount;
+}
+
+uint32 MvnRemoteControlScheduler::Run()
+{
+    m_uiThreadId = FPlatformTLS::GetCurrentThreadId();
+
+    while ( !m_bStopping )
+    {
+        FDateTime dtNextPollTime = FDateTime::MaxValue();
+        FDateTime dtNextTimeSyncTime = FDateTime::MaxValue();
+        {
+            FScopeLock Lock( &m_SessionsCriticalSection );
+
+            // queued commands of all sessions first, a batch reaches every session within one pass
+            for ( MvnRemoteControlSession* pSession : m_apSessions )
+            {
+                pSession->SendQueuedCommands();
+            }
+
+            const FDateTime dtNow = FDateTime::Now();
+            for ( MvnRemoteControlSession* pSession : m_apSessions )
+            {
+                pSession->Update( dtNow );
+                dtNextPollTime = FMath::Min( dtNextPollTime, pSession->GetNextPollTime() );
+                dtNextTimeSyncTime = FMath::Min( dtNextTimeSyncTime, pSession->GetNextTimeSyncTime() );
+            }
+        }
+
+        // sleep until the next poll, or until just before the next time sync
+        const FDateTime dtWakeTime = FMath::Min( dtNextPollTime, dtNextTimeSyncTime == FDateTime::MaxValue() ? dtNextTimeSyncTime : dtNextTimeSyncTime - TimeSyncLead );
+        const double dWaitMilliseconds = ( dtWakeTime - FDateTime::Now() ).GetTotalMilliseconds();
+        if ( dWaitMilliseconds > 0.0 )
+        {
+            m_pWakeEvent->Wait( (uint32)FMath::Min( FMath::CeilToDouble( dWaitMilliseconds ), (double)MaxWaitMilliseconds ) );
+        }
+
+        // the time sync has to leave on the second, yield for the remaining moment instead of sleeping past it
+        while ( !m_bStopping && dtNextTimeSyncTime != FDateTime::MaxValue() )
+        {
+            const FTimespan toTimeSync = dtNextTimeSyncTime - FDateTime::Now();
+            if ( toTimeSync <= FTimespan::Zero() || toTimeSync > TimeSyncLead )
+            {
+                break;
+            }
+            FPlatformProcess::SleepNoStats( 0.0f );
+        }
+
+        m_uiWakeCount++;
+    }
+    return 0;
+}
+
+void MvnRemoteControlScheduler::Stop()
+{
+    m_bStopping = true;
+    if ( m_pWakeEvent != nullptr )
+    {
+        m_pWakeEvent->Trigger();
+    }
+}
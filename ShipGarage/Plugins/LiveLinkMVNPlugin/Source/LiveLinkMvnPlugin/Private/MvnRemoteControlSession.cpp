@@ -3,17 +3,59 @@
 #include "MvnRemoteControlSession.h"
 #include <Serialization/ArrayWriter.h>
 #include "MvnRemoteControlSessionUtil.h"
+#include "MvnRemoteControlScheduler.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/IConsoleManager.h"
 
 
 uint32 MvnRemoteControlSession::s_uiID = 0;
 
+static TAutoConsoleVariable<float> CVarMvnClockSyncInterval(
+    TEXT( "mvn.RemoteControl.ClockSyncInterval" ),
+    0.5f,
+    TEXT( "Seconds between clock sync exchanges with each MVN remote control session." ) );
 
-// ctor setup the socket for the given port and start the listener thread if isRunning is true
-MvnRemoteControlSession::MvnRemoteControlSession( const FIPv4Address& _destIPAddress, int _iDestPort ) :
-m_WaitTime( FTimespan::FromMilliseconds( 100 ) )
+
+namespace
+{
+    /** how often session info is requested */
+    const FTimespan SessionInfoInterval = FTimespan::FromSeconds( 1.0 );
+
+    /** how often session status is requested */
+    const FTimespan SessionStatusInterval = FTimespan::FromMilliseconds( 100.0 );
+
+    /** a time sync request that leaves later than this after the second is skipped */
+    const FTimespan TimeSyncTolerance = FTimespan::FromMilliseconds( 2.0 );
+
+    /** a request without response after this many seconds is counted as timed out */
+    const double ResponseTimeout = 2.0;
+
+    /** clock sync exchanges a server that never answered gets, before the session falls back to the time of day */
+    const int32 MaxUnansweredClockSyncs = 5;
+
+    FDateTime GetNextSecond( const FDateTime& _dtTime )
+    {
+        FDateTime dtOnTheSecond( _dtTime.GetYear(), _dtTime.GetMonth(), _dtTime.GetDay(), _dtTime.GetHour(), _dtTime.GetMinute(), _dtTime.GetSecond() );
+        return dtOnTheSecond + FTimespan::FromSeconds( 1.0 );
+    }
+}
+
+
+// ctor setup the socket for the given port, the scheduler sends and processes, a receiver thread waits for responses
+MvnRemoteControlSession::MvnRemoteControlSession( const FIPv4Address& _destIPAddress, int _iDestPort, MvnRemoteControlScheduler* _pScheduler ) :
+m_pScheduler( _pScheduler )
+, m_WaitTime( FTimespan::FromMilliseconds( 100 ) )
 , m_iDestPort( _iDestPort )
 , m_DestIPAddress( _destIPAddress )
 {
+    check( m_pScheduler != nullptr );
+
+    for ( MvnRemoteControlMessage& Request : m_aRequestPool )
+    {
+        m_FreeRequests.Enqueue( &Request );
+    }
+    m_aPendingRequests.Reserve( CommandQueueCapacity );
+
     //setup socket
     // listener port has to be unique per instance
     int iListenerPort = 8008 + s_uiID;
@@ -34,6 +76,7 @@ m_WaitTime( FTimespan::FromMilliseconds( 100 ) )
 
     
     m_pSocketSubsystem = ISocketSubsystem::Get( PLATFORM_SOCKETSUBSYSTEM );
+    m_pDestination = m_pSocketSubsystem->CreateInternetAddr();
 
     m_uiID = s_uiID;
     m_strTake = FString::Printf( TEXT( "001" ) );
@@ -41,8 +84,23 @@ m_WaitTime( FTimespan::FromMilliseconds( 100 ) )
 
     s_uiID++;
 
+    // polls start on the next second, like the time sync
+    FDateTime dtNextSecond = GetNextSecond( FDateTime::Now() );
+    m_NextSessionInfoRequestTime = dtNextSecond;
+    m_NextSessionStatusRequestTime = dtNextSecond;
+    m_NextSyncTimeRequestTime = dtNextSecond;
+    m_NextClockSyncRequestTime = FDateTime::Now();
+
+    m_pClockSync = MakeShared< FMvnClockSync, ESPMode::ThreadSafe >();
+    FMvnClockSyncRegistry::getInstance().Register( m_DestIPAddress, m_pClockSync );
+
     RequestSessionInfo();
-    Start();
+
+    FString strThreadName = "MVN UDP Remote Control Receiver ";
+    strThreadName.AppendInt( m_uiID );
+    m_pReceiver = new FUdpSocketReceiver( m_pSocket, m_WaitTime, *strThreadName );
+    m_pReceiver->OnDataReceived().BindRaw( this, &MvnRemoteControlSession::OnDataReceived );
+    m_pReceiver->Start();
 }
 
 MvnRemoteControlSession::~MvnRemoteControlSession()
@@ -53,187 +111,259 @@ MvnRemoteControlSession::~MvnRemoteControlSession()
         CaptureStop( 0.0 );
     }
 
-    /// send all pending messages
-    if ( m_CommandsCriticalSection.TryLock() )
+    /// send all pending messages, the scheduler no longer serves this session
+    SendQueuedCommands();
+
+    if ( m_pReceiver != nullptr )
     {
-        TSharedRef<FInternetAddr> Destination = m_pSocketSubsystem->CreateInternetAddr();
-        Destination->SetIp( m_DestIPAddress.Value );
-        Destination->SetPort( m_iDestPort );
+        // stops and joins the receiver thread
+        delete m_pReceiver;
+        m_pReceiver = nullptr;
+    }
 
-        if ( m_apCommandsQueue.Num() > 0 )
+    if ( m_pSocket != nullptr )
+    {
+        m_pSocket->Close();
+        ISocketSubsystem::Get( PLATFORM_SOCKETSUBSYSTEM )->DestroySocket( m_pSocket );
+    }
+
+    FMvnClockSyncRegistry::getInstance().Unregister( m_DestIPAddress, m_pClockSync );
+}
+
+void MvnRemoteControlSession::Update( const FDateTime& _dtNow )
+{
+    MvnReceivedDatagram Received;
+    while ( m_ReceivedQueue.Dequeue( Received ) )
+    {
+        ProcessDatagram( Received.m_pData, Received.m_dReceiveTime );
+    }
+    ExpirePendingRequests( FPlatformTime::Seconds() );
+
+    if ( m_bTimeSyncEnabled )
+    {
+        if ( _dtNow >= m_NextSyncTimeRequestTime )
         {
-            MvnRemoteControlMessage* pCommand = m_apCommandsQueue[ 0 ];
-            SendCommand( pCommand, *Destination );
-            m_apCommandsQueue.Remove( pCommand );
-            delete pCommand;
+            FTimespan toSecond = _dtNow - m_NextSyncTimeRequestTime;
+            if ( toSecond < TimeSyncTolerance )
+            {
+                // should send on the second
+                RequestTimeSync();
+            }
+            else
+            {
+                UE_LOG( LogTemp, Warning, TEXT( "time out of sync by %f milliseconds, skipping sync" ), toSecond.GetTotalMilliseconds() );
+            }
+            m_NextSyncTimeRequestTime = GetNextSecond( _dtNow );
         }
-        m_CommandsCriticalSection.Unlock();
+    }
+    else
+    {
+        // keep the deadline current, so enabling it again syncs on the next second
+        m_NextSyncTimeRequestTime = GetNextSecond( _dtNow );
     }
 
-    Stop();
-    if ( m_pThread != nullptr )
+    if ( _dtNow >= m_NextSessionInfoRequestTime )
     {
-        //todo fix live link
-        m_pThread->WaitForCompletion();
-        delete m_pThread;
-        m_pThread = nullptr;
+        m_NextSessionInfoRequestTime = _dtNow + SessionInfoInterval;
+        RequestSessionInfo();
     }
 
-    if ( m_pSocket != nullptr )
+    if ( _dtNow >= m_NextSessionStatusRequestTime )
     {
-        m_pSocket->Close();
-        ISocketSubsystem::Get( PLATFORM_SOCKETSUBSYSTEM )->DestroySocket( m_pSocket );
+        m_NextSessionStatusRequestTime = _dtNow + SessionStatusInterval;
+        RequestSessionStatus();
     }
-}
 
+    SendQueuedCommands();
 
-// FRunnable interface
-void MvnRemoteControlSession::Start()
-{
-    m_strThreadName = "MVN UDP Remote Control ";
-    m_strThreadName.AppendInt( FAsyncThreadIndex::GetNext() );
+    // after the queued commands, so the exchange is not delayed by them
+    if ( IsClockSyncActive() && _dtNow >= m_NextClockSyncRequestTime )
+    {
+        m_NextClockSyncRequestTime = _dtNow + FTimespan::FromSeconds( FMath::Max( CVarMvnClockSyncInterval.GetValueOnAnyThread(), 0.01f ) );
+        SendClockSyncRequest();
+    }
+}
 
-    m_pThread = FRunnableThread::Create( this, *m_strThreadName, 128 * 1024, TPri_AboveNormal, FPlatformAffinity::GetPoolThreadMask() );
+FDateTime MvnRemoteControlSession::GetNextPollTime() const
+{
+    FDateTime dtNext = FMath::Min( m_NextSessionInfoRequestTime, m_NextSessionStatusRequestTime );
+    if ( IsClockSyncActive() )
+    {
+        dtNext = FMath::Min( dtNext, m_NextClockSyncRequestTime );
+    }
+    return dtNext;
 }
 
-uint32 MvnRemoteControlSession::Run()
+bool MvnRemoteControlSession::IsClockSyncActive() const
 {
-    TSharedRef<FInternetAddr> Sender = m_pSocketSubsystem->CreateInternetAddr();
-    TSharedRef<FInternetAddr> Destination = m_pSocketSubsystem->CreateInternetAddr();
-    Destination->SetIp( m_DestIPAddress.Value );
-    Destination->SetPort( m_iDestPort );
+    // servers without clock sync never answer, their capture time codes keep using the local time of day
+    return m_bClockSyncAnswered || m_UnansweredClockSyncs.GetValue() < MaxUnansweredClockSyncs;
+}
 
-    FDateTime dtStartTime = FDateTime::Now();
-    FDateTime dtStartTimeOnTheSecond( dtStartTime.GetYear(), dtStartTime.GetMonth(), dtStartTime.GetDay(), dtStartTime.GetHour(), dtStartTime.GetMinute(), dtStartTime.GetSecond() );
+FDateTime MvnRemoteControlSession::GetNextTimeSyncTime() const
+{
+    return m_bTimeSyncEnabled ? m_NextSyncTimeRequestTime : FDateTime::MaxValue();
+}
 
-    m_LastSessionInfoRequestTime   = dtStartTimeOnTheSecond;
-    m_LastSessionStatusRequestTime = dtStartTimeOnTheSecond;
-    m_LastSyncTimeRequestTime = dtStartTimeOnTheSecond;
+void MvnRemoteControlSession::SendQueuedCommands()
+{
+    m_pDestination->SetIp( m_DestIPAddress.Value );
+    m_pDestination->SetPort( m_iDestPort );
 
+    MvnRemoteControlMessage* pCommand = nullptr;
+    while ( m_CommandQueue.Dequeue( pCommand ) )
+    {
+        SendRequest( pCommand );
+        ReleaseRequest( pCommand );
+    }
+}
 
-    
-    float fSessionInfoInterval = 1.0f;
-    float fSessionStatusInterval = 0.1f;
-    // less than one second to ensure we send exactly on the second
-    float fTimeSyncInterval = 0.9f;
+void MvnRemoteControlSession::SendRequest( MvnRemoteControlMessage* _pRequest )
+{
+    const double dSendTime = FPlatformTime::Seconds();
+    if ( !SendCommand( _pRequest, *m_pDestination ) )
+    {
+        return;
+    }
 
-    while ( !m_bStopping )
     {
-        ESocketConnectionState state =  m_pSocket->GetConnectionState();
-        uint32 Size;
+        FScopeLock Lock( &m_StatsCriticalSection );
+        m_aCommandStats[ (int32)_pRequest->m_Command ].m_uiSent++;
+    }
 
-        uint32 uiActiveDestIP = 0;
-        int32 iActiveDestPort = 0;
-        Destination->GetIp( uiActiveDestIP );
-        Destination->GetPort( iActiveDestPort );
+    if ( MvnRemoteControlSessionUtil::ExpectsResponse( _pRequest->m_Command ) )
+    {
+        MvnPendingRequest& Pending = m_aPendingRequests.AddDefaulted_GetRef();
+        Pending.m_uiRequestId = _pRequest->m_uiRequestId;
+        Pending.m_Command = _pRequest->m_Command;
+        Pending.m_dSendTime = dSendTime;
+    }
+}
 
-        if ( iActiveDestPort != m_iDestPort )
-        {
-            Destination->SetPort( m_iDestPort );
-        }
+MvnRemoteControlMessage* MvnRemoteControlSession::AcquireRequest( eMvnRemoteControlMessageCommand _command )
+{
+    MvnRemoteControlMessage* pRequest = nullptr;
+    if ( !m_FreeRequests.Dequeue( pRequest ) )
+    {
+        UE_LOG( LogTemp, Warning, TEXT( "MvnRemoteControlSession %s: command queue full, dropping command %d" ), *m_strIPAddress, (int32)_command );
+        FScopeLock Lock( &m_StatsCriticalSection );
+        m_aCommandStats[ (int32)_command ].m_uiDropped++;
+        return nullptr;
+    }
+    return pRequest;
+}
 
-        if ( uiActiveDestIP != m_DestIPAddress.Value )
-        {
-            Destination->SetIp( m_DestIPAddress.Value );
-        }
+void MvnRemoteControlSession::ReleaseRequest( MvnRemoteControlMessage* _pRequest )
+{
+    _pRequest->Reset();
+    m_FreeRequests.Enqueue( _pRequest );
+}
 
-        Destination->SetIp( m_DestIPAddress.Value );
-        Destination->SetPort( m_iDestPort );
+void MvnRemoteControlSession::CorrelateResponse( const MvnRemoteControlResponse& _Response, double _dReceiveTime )
+{
+    // MVN acknowledges in order, so without an id the oldest request of the command is the one answered
+    int32 iIndex = INDEX_NONE;
+    if ( _Response.Has( eMvnRemoteControlResponseField::RequestId ) )
+    {
+        const uint32 uiRequestId = _Response.m_uiRequestId;
+        iIndex = m_aPendingRequests.IndexOfByPredicate( [uiRequestId]( const MvnPendingRequest& Pending ) { return Pending.m_uiRequestId == uiRequestId; } );
+    }
+    else
+    {
+        const eMvnRemoteControlMessageCommand Command = _Response.m_Command;
+        iIndex = m_aPendingRequests.IndexOfByPredicate( [Command]( const MvnPendingRequest& Pending ) { return Pending.m_Command == Command; } );
+    }
 
-        if ( m_CommandsCriticalSection.TryLock() )
+    if ( iIndex != INDEX_NONE )
+    {
+        const MvnPendingRequest& Pending = m_aPendingRequests[ iIndex ];
         {
-            if ( m_apCommandsQueue.Num() > 0 )
-            {
-                MvnRemoteControlMessage* pCommand = m_apCommandsQueue[ 0 ];
-                SendCommand( pCommand, *Destination );
-                m_apCommandsQueue.Remove(pCommand);
-                delete pCommand;
-            }
-            m_CommandsCriticalSection.Unlock();
+            FScopeLock Lock( &m_StatsCriticalSection );
+            MvnRemoteControlCommandStats& Stats = m_aCommandStats[ (int32)Pending.m_Command ];
+            Stats.m_uiAnswered++;
+            Stats.m_Latency.Add( _dReceiveTime - Pending.m_dSendTime );
         }
+        m_aPendingRequests.RemoveAt( iIndex, 1, false );
+    }
+}
 
-        FDateTime dtNow = FDateTime::Now();
-        FDateTime dtNowOnTheSecond( dtNow.GetYear(), dtNow.GetMonth(), dtNow.GetDay(), dtNow.GetHour(), dtNow.GetMinute(), dtNow.GetSecond() );
-
-        FTimespan sessionInfoDiff   = dtNow - m_LastSessionInfoRequestTime;
-        FTimespan sessionStatusDiff = dtNow - m_LastSessionStatusRequestTime;
-        FTimespan syncTimeDiff = dtNowOnTheSecond - m_LastSyncTimeRequestTime;
+void MvnRemoteControlSession::ExpirePendingRequests( double _dNow )
+{
+    // in send order, the oldest are first
+    int32 iExpired = 0;
+    while ( iExpired < m_aPendingRequests.Num() && _dNow - m_aPendingRequests[ iExpired ].m_dSendTime > ResponseTimeout )
+    {
+        iExpired++;
+    }
 
-        if ( m_bTimeSyncEnabled )
+    if ( iExpired > 0 )
+    {
         {
-            if ( syncTimeDiff.GetTotalSeconds() > fTimeSyncInterval )
+            FScopeLock Lock( &m_StatsCriticalSection );
+            for ( int32 i = 0; i < iExpired; i++ )
             {
-                FTimespan toSecond = dtNow - dtNowOnTheSecond;
-                double dTimeDiffMS = toSecond.GetTotalMilliseconds();
-                if ( dTimeDiffMS < 2.0 )
-                {
-                    // should send on the second
-                    RequestTimeSync();
-                }
-                else
-                {
-                    UE_LOG( LogTemp, Warning, TEXT( "time out of sync by %f milliseconds, skipping sync" ), dTimeDiffMS );
-                }
-                m_LastSyncTimeRequestTime = dtNowOnTheSecond;
+                m_aCommandStats[ (int32)m_aPendingRequests[ i ].m_Command ].m_uiTimedOut++;
             }
         }
+        m_aPendingRequests.RemoveAt( 0, iExpired, false );
+    }
+}
 
-        if ( sessionInfoDiff.GetTotalSeconds() > fSessionInfoInterval )
-        {
-            m_LastSessionInfoRequestTime = dtNow;
-            RequestSessionInfo();
-        }
-
-        if ( sessionStatusDiff.GetTotalSeconds() > fSessionStatusInterval )
-        {
-            m_LastSessionStatusRequestTime = dtNow;
-            RequestSessionStatus();
-        }
+void MvnRemoteControlSession::GetCommandStats( eMvnRemoteControlMessageCommand _command, MvnRemoteControlCommandStats& _Stats ) const
+{
+    FScopeLock Lock( &m_StatsCriticalSection );
+    _Stats = m_aCommandStats[ (int32)_command ];
+}
 
-        while ( m_pSocket->HasPendingData( Size ) )
-        {
-            FArrayReaderPtr Reader = MakeShareable( new FArrayReader( true ) );
-            Reader->SetNumUninitialized( FMath::Min( Size, 65507u ) );
-            int32 Read = 0;
-            if ( m_pSocket->RecvFrom( Reader->GetData(), Reader->Num(), Read, *Sender ) )
-            {
-                m_bConnected = true;
-                Reader->RemoveAt( Read, Reader->Num() - Read, false );
-                TArray<uint8_t> RawData;
-                uint32 DataReceivedNum = Reader->Num();
-                RawData.Append( Reader->GetData(), DataReceivedNum );
-                FString strResponse = reinterpret_cast< char* >( RawData.GetData() );
-
-                int iStrLength = strResponse.Len();
-
-                int iDataLength = RawData.Num();
-                /// trim extra characters
-                int iChopCount = iStrLength - iDataLength;
-                if ( iChopCount > 0 )
-                {
-                    strResponse = strResponse.LeftChop( iChopCount );
-                }
-                ProcessResponse(strResponse);
-            }
-        }
+void MvnRemoteControlSession::ResetCommandStats()
+{
+    FScopeLock Lock( &m_StatsCriticalSection );
+    for ( MvnRemoteControlCommandStats& Stats : m_aCommandStats )
+    {
+        Stats = MvnRemoteControlCommandStats();
     }
-    return 0;
 }
 
-void MvnRemoteControlSession::Stop()
+void MvnRemoteControlSession::OnDataReceived( const FArrayReaderPtr& _pData, const FIPv4Endpoint& _Sender )
 {
-    m_bStopping = true;
+    // stamped here, the scheduler may process it later
+    MvnReceivedDatagram Received;
+    Received.m_pData = _pData;
+    Received.m_dReceiveTime = FPlatformTime::Seconds();
+    m_ReceivedQueue.Enqueue( Received );
+    m_pScheduler->Wake();
+}
+
+void MvnRemoteControlSession::ProcessDatagram( const FArrayReaderPtr& _pData, double _dReceiveTime )
+{
+    if ( m_bConnected == false )
+    {
+        // a server started after the session gets its own clock sync exchanges
+        m_UnansweredClockSyncs.Reset();
+    }
+    m_bConnected = true;
+
+    /// the datagram is utf-8 without terminator, or with one or more trailing zeros
+    int32 iLength = _pData->Num();
+    while ( iLength > 0 && ( *_pData )[ iLength - 1 ] == 0 )
+    {
+        iLength--;
+    }
+    if ( MvnRemoteControlSessionUtil::ParseResponse( _pData->GetData(), iLength, m_Response ) )
+    {
+        ProcessResponse( m_Response, _dReceiveTime );
+    }
 }
 
 bool MvnRemoteControlSession::SendCommand( MvnRemoteControlMessage* _pMessage, const FInternetAddr& Destination )
 {
-    const char* pcText = TCHAR_TO_UTF8( *_pMessage->m_strXml );
     if ( !m_pSocket )
     {
         return false;
     }
+    FTCHARToUTF8 Converted( *_pMessage->m_strXml );
     int32 iBytesSentCount = 0;
-    m_pSocket->SendTo( (const uint8*)pcText, strlen( pcText ), iBytesSentCount, Destination );
+    m_pSocket->SendTo( (const uint8*)Converted.Get(), Converted.Length(), iBytesSentCount, Destination );
     if ( iBytesSentCount <= 0 )
     {
         return false;
@@ -309,38 +439,39 @@ FString MvnRemoteControlSession::GetElapsedTime() const
     }
 }
 
-void MvnRemoteControlSession::ProcessResponse( FString& _strResponse )
+void MvnRemoteControlSession::ProcessResponse( const MvnRemoteControlResponse& _Response, double _dReceiveTime )
 {
-    MvnRemoteControlMessage* pResponse = MvnRemoteControlSessionUtil::CreateResponseMessage(_strResponse);
-    if ( pResponse )
-    {
-        // on start recording Ack received
-        if ( pResponse->m_Command == eMvnRemoteControlMessageCommand::CaptureStart )
-        {
-            OnCaptureStartAckReceived(pResponse);
-        }
-        // on stop recording Ack received
-        if ( pResponse->m_Command == eMvnRemoteControlMessageCommand::CaptureStop )
-        {
-            OnCaptureStopAckReceived( pResponse );
-        }
-        // session info ack received
-        if ( pResponse->m_Command == eMvnRemoteControlMessageCommand::SessionInfo )
-        {
-            OnSessionInfoAckReceived( pResponse );
-        }
-        // session status ack received
-        if ( pResponse->m_Command == eMvnRemoteControlMessageCommand::SessionStatus )
-        {
-            OnSessionStatusAckReceived( pResponse );
-        }
-        // Capture name ack received
-        if ( pResponse->m_Command == eMvnRemoteControlMessageCommand::CaptureName )
-        {
-            OnCaptureNameAckReceived( pResponse );
-        }
+    CorrelateResponse( _Response, _dReceiveTime );
 
-        delete pResponse;
+    // on start recording Ack received
+    if ( _Response.m_Command == eMvnRemoteControlMessageCommand::CaptureStart )
+    {
+        OnCaptureStartAckReceived( _Response );
+    }
+    // on stop recording Ack received
+    if ( _Response.m_Command == eMvnRemoteControlMessageCommand::CaptureStop )
+    {
+        OnCaptureStopAckReceived( _Response );
+    }
+    // session info ack received
+    if ( _Response.m_Command == eMvnRemoteControlMessageCommand::SessionInfo )
+    {
+        OnSessionInfoAckReceived( _Response );
+    }
+    // session status ack received
+    if ( _Response.m_Command == eMvnRemoteControlMessageCommand::SessionStatus )
+    {
+        OnSessionStatusAckReceived( _Response );
+    }
+    // Capture name ack received
+    if ( _Response.m_Command == eMvnRemoteControlMessageCommand::CaptureName )
+    {
+        OnCaptureNameAckReceived( _Response );
+    }
+    // clock sync ack received
+    if ( _Response.m_Command == eMvnRemoteControlMessageCommand::ClockSync )
+    {
+        OnClockSyncAckReceived( _Response, _dReceiveTime );
     }
 }
 
@@ -352,12 +483,20 @@ const FIPv4Address& MvnRemoteControlSession::GetDestIPAddress()
 
 void MvnRemoteControlSession::Identify()
 {
-    QueueRequest( MvnRemoteControlSessionUtil::CreateIdentifyRequest() );
+    if ( MvnRemoteControlMessage* pRequest = AcquireRequest( eMvnRemoteControlMessageCommand::Identify ) )
+    {
+        MvnRemoteControlSessionUtil::InitIdentifyRequest( *pRequest );
+        QueueRequest( pRequest );
+    }
 }
 
 void MvnRemoteControlSession::SetCaptureName( FString& _strCaptureName, int _iTakeCount )
 {
-    QueueRequest( MvnRemoteControlSessionUtil::CreateCaptureNameRequest(_strCaptureName, _iTakeCount) );
+    if ( MvnRemoteControlMessage* pRequest = AcquireRequest( eMvnRemoteControlMessageCommand::CaptureName ) )
+    {
+        MvnRemoteControlSessionUtil::InitCaptureNameRequest( *pRequest, _strCaptureName, _iTakeCount );
+        QueueRequest( pRequest );
+    }
 }
 
 bool MvnRemoteControlSession::CaptureStart( double _dTimeOffsetInSeconds )
@@ -367,13 +506,19 @@ bool MvnRemoteControlSession::CaptureStart( double _dTimeOffsetInSeconds )
         return false;
     }
 
+    MvnRemoteControlMessage* pRequest = AcquireRequest( eMvnRemoteControlMessageCommand::CaptureStart );
+    if ( !pRequest )
+    {
+        return false;
+    }
     FString strDescription = "";
-    QueueRequest( MvnRemoteControlSessionUtil::CreateCaptureStartRequest( strDescription, _dTimeOffsetInSeconds ) );
+    MvnRemoteControlSessionUtil::InitCaptureStartRequest( *pRequest, strDescription, _dTimeOffsetInSeconds, m_pClockSync.Get() );
+    QueueRequest( pRequest );
     return true;
 }
-void MvnRemoteControlSession::OnCaptureStartAckReceived( MvnRemoteControlMessage* _pResponse )
+void MvnRemoteControlSession::OnCaptureStartAckReceived( const MvnRemoteControlResponse& _Response )
 {
-    bool bSuccess = _pResponse->m_bResult;
+    bool bSuccess = _Response.m_bResult;
 
     // if success, start timer
     if ( bSuccess )
@@ -384,7 +529,7 @@ void MvnRemoteControlSession::OnCaptureStartAckReceived( MvnRemoteControlMessage
     }
     else
     {
-        m_strLastError = _pResponse->m_strReason;
+        m_strLastError = _Response.m_strReason;
     }
 }
 
@@ -394,13 +539,19 @@ bool MvnRemoteControlSession::CaptureStop( double _dTimeOffsetInSeconds )
     {
         return false;
     }
-    QueueRequest( MvnRemoteControlSessionUtil::CreateCaptureStopRequest( _dTimeOffsetInSeconds ) );
+    MvnRemoteControlMessage* pRequest = AcquireRequest( eMvnRemoteControlMessageCommand::CaptureStop );
+    if ( !pRequest )
+    {
+        return false;
+    }
+    MvnRemoteControlSessionUtil::InitCaptureStopRequest( *pRequest, _dTimeOffsetInSeconds, m_pClockSync.Get() );
+    QueueRequest( pRequest );
     return true;
 }
 
-void MvnRemoteControlSession::OnCaptureStopAckReceived( MvnRemoteControlMessage* _pResponse )
+void MvnRemoteControlSession::OnCaptureStopAckReceived( const MvnRemoteControlResponse& _Response )
 {
-    bool bSuccess = _pResponse->m_bResult;
+    bool bSuccess = _Response.m_bResult;
 
     if ( bSuccess )
     {
@@ -409,7 +560,7 @@ void MvnRemoteControlSession::OnCaptureStopAckReceived( MvnRemoteControlMessage*
     }
     else
     {
-        m_strLastError = _pResponse->m_strReason;
+        m_strLastError = _Response.m_strReason;
     }
 }
 
@@ -435,6 +586,15 @@ bool MvnRemoteControlSession::IsTimeSyncEnabled()
 
 void MvnRemoteControlSession::SetDestinationIPAddress( const FIPv4Address& _destIPAddress )
 {
+    if ( _destIPAddress != m_DestIPAddress )
+    {
+        // another server, another clock
+        FMvnClockSyncRegistry::getInstance().Unregister( m_DestIPAddress, m_pClockSync );
+        m_pClockSync->Reset();
+        FMvnClockSyncRegistry::getInstance().Register( _destIPAddress, m_pClockSync );
+        m_bClockSyncAnswered = false;
+        m_UnansweredClockSyncs.Reset();
+    }
     m_DestIPAddress = _destIPAddress;
 }
 
@@ -456,35 +616,31 @@ int MvnRemoteControlSession::GetDestinationPort()
     return m_iDestPort;
 }
 
-
-
-void MvnRemoteControlSession::OnSessionInfoAckReceived( MvnRemoteControlMessage* _pResponse )
+const FMvnClockSync& MvnRemoteControlSession::GetClockSync() const
 {
-    FString strSessionNameKey = TEXT("SessionName");
+    return *m_pClockSync;
+}
 
-    FString strRecordingTrialKey = TEXT("recordingTrial");
 
-    if ( _pResponse->m_Attributes.Contains( strSessionNameKey ) )
+
+void MvnRemoteControlSession::OnSessionInfoAckReceived( const MvnRemoteControlResponse& _Response )
+{
+    if ( _Response.Has( eMvnRemoteControlResponseField::SessionName ) && !_Response.m_strSessionName.Equals( m_strSessionName, ESearchCase::CaseSensitive ) )
     {
-        m_strSessionName = _pResponse->m_Attributes[strSessionNameKey];
+        m_strSessionName = _Response.m_strSessionName;
     }
 
-    if ( _pResponse->m_Attributes.Contains( strRecordingTrialKey ) )
+    if ( _Response.Has( eMvnRemoteControlResponseField::RecordingTrial ) && !_Response.m_strRecordingTrial.Equals( m_strTake, ESearchCase::CaseSensitive ) )
     {
-        m_strTake = _pResponse->m_Attributes[ strRecordingTrialKey ];
+        m_strTake = _Response.m_strRecordingTrial;
     }
 }
 
-void MvnRemoteControlSession::OnSessionStatusAckReceived( MvnRemoteControlMessage* _pResponse )
+void MvnRemoteControlSession::OnSessionStatusAckReceived( const MvnRemoteControlResponse& _Response )
 {
-    FString strIsRecordingKey = TEXT("isRecording");
-    FString strIsPausedKey = TEXT("isPaused");
-    FString strIsLiveKey = TEXT("isLive");
-
-    if ( _pResponse->m_Attributes.Contains( strIsRecordingKey ) )
+    if ( _Response.Has( eMvnRemoteControlResponseField::IsRecording ) )
     {
-        FString strIsRecording = _pResponse->m_Attributes[ strIsRecordingKey ];
-        if ( strIsRecording.Compare( TEXT("true"), ESearchCase::IgnoreCase ) == 0 )
+        if ( _Response.m_bIsRecording )
         {
             if ( m_bRecording == false )
             {
@@ -498,39 +654,20 @@ void MvnRemoteControlSession::OnSessionStatusAckReceived( MvnRemoteControlMessag
         }
     }
 
-    if ( _pResponse->m_Attributes.Contains( strIsPausedKey ) )
+    if ( _Response.Has( eMvnRemoteControlResponseField::IsPaused ) )
     {
-        FString strIsPaused = _pResponse->m_Attributes[ strIsPausedKey ];
-        if ( strIsPaused.Compare( TEXT( "true" ), ESearchCase::IgnoreCase ) == 0 )
-        {
-            m_bPaused = true;
-        }
-        else
-        {
-            m_bPaused = false;
-        }
+        m_bPaused = _Response.m_bIsPaused;
     }
 
-    if ( _pResponse->m_Attributes.Contains( strIsLiveKey ) )
+    if ( _Response.Has( eMvnRemoteControlResponseField::IsLive ) )
     {
-        FString strIsLive = _pResponse->m_Attributes[ strIsLiveKey ];
-        if ( strIsLiveKey.Compare( TEXT( "true" ), ESearchCase::IgnoreCase ) == 0 )
-        {
-            m_bLive = true;
-        }
-        else
-        {
-            m_bLive = false;
-        }
+        m_bLive = _Response.m_bIsLive;
     }
 }
 
-void MvnRemoteControlSession::OnCaptureNameAckReceived( MvnRemoteControlMessage* _pResponse )
+void MvnRemoteControlSession::OnCaptureNameAckReceived( const MvnRemoteControlResponse& _Response )
 {
-    FString strSuccessKey = TEXT("Success");
-
-    FString strSuccessValue = _pResponse->m_Attributes[ strSuccessKey ];
-    if ( strSuccessValue.Compare( TEXT("true"), ESearchCase::IgnoreCase ) == 0 )
+    if ( _Response.m_bSuccess )
     {
         m_strLastError = TEXT("");
     }
@@ -542,26 +679,64 @@ void MvnRemoteControlSession::OnCaptureNameAckReceived( MvnRemoteControlMessage*
 
 void MvnRemoteControlSession::RequestSessionInfo()
 {
-    QueueRequest( MvnRemoteControlSessionUtil::CreateSessionInfoRequest() );
+    if ( MvnRemoteControlMessage* pRequest = AcquireRequest( eMvnRemoteControlMessageCommand::SessionInfo ) )
+    {
+        MvnRemoteControlSessionUtil::InitSessionInfoRequest( *pRequest );
+        QueueRequest( pRequest );
+    }
 }
 
 void MvnRemoteControlSession::RequestSessionStatus()
 {
-    QueueRequest( MvnRemoteControlSessionUtil::CreateSessionStatusRequest() );
+    if ( MvnRemoteControlMessage* pRequest = AcquireRequest( eMvnRemoteControlMessageCommand::SessionStatus ) )
+    {
+        MvnRemoteControlSessionUtil::InitSessionStatusRequest( *pRequest );
+        QueueRequest( pRequest );
+    }
 }
 
 void MvnRemoteControlSession::RequestTimeSync()
 {
-    QueueRequest( MvnRemoteControlSessionUtil::CreateTimeSyncRequest( false ) );
+    if ( MvnRemoteControlMessage* pRequest = AcquireRequest( eMvnRemoteControlMessageCommand::TimeSync ) )
+    {
+        MvnRemoteControlSessionUtil::InitTimeSyncRequest( *pRequest, false );
+        QueueRequest( pRequest );
+    }
+}
+
+void MvnRemoteControlSession::SendClockSyncRequest()
+{
+    m_pDestination->SetIp( m_DestIPAddress.Value );
+    m_pDestination->SetPort( m_iDestPort );
+
+    if ( MvnRemoteControlMessage* pRequest = AcquireRequest( eMvnRemoteControlMessageCommand::ClockSync ) )
+    {
+        MvnRemoteControlSessionUtil::InitClockSyncRequest( *pRequest, (uint32)m_RequestIdCounter.Increment(), FPlatformTime::Seconds() );
+        SendRequest( pRequest );
+        ReleaseRequest( pRequest );
+        m_UnansweredClockSyncs.Increment();
+    }
+}
+
+void MvnRemoteControlSession::OnClockSyncAckReceived( const MvnRemoteControlResponse& _Response, double _dReceiveTime )
+{
+    // T0 is our send time echoed back, T1 and T2 the server's receive and send time of day
+    if ( _Response.Has( eMvnRemoteControlResponseField::T0 | eMvnRemoteControlResponseField::T1 | eMvnRemoteControlResponseField::T2 ) )
+    {
+        m_pClockSync->AddExchange( _Response.m_dT0, _Response.m_dT1, _Response.m_dT2, _dReceiveTime );
+        m_bClockSyncAnswered = true;
+        m_UnansweredClockSyncs.Reset();
+    }
 }
 
 void MvnRemoteControlSession::QueueRequest( MvnRemoteControlMessage* _pMessage )
 {
     if ( _pMessage )
     {
-        m_CommandsCriticalSection.Lock();
-        m_apCommandsQueue.Add( _pMessage );
-        m_CommandsCriticalSection.Unlock();
+        _pMessage->m_uiRequestId = (uint32)m_RequestIdCounter.Increment();
+        // never full, the queue holds as many requests as the pool
+        verify( m_CommandQueue.Enqueue( _pMessage ) );
+        m_pScheduler->Wake();
     }
 }
 
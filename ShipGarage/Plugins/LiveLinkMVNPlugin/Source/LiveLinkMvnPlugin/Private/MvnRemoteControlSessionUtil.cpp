@@ -2,311 +2,366 @@
 
 #include "MvnRemoteControlSessionUtil.h"
 #include "Misc/App.h"
+#include "MvnClockSync.h"
+#include "MvnXmlPullParser.h"
 
 
-namespace MvnRemoteControlSessionUtil
+namespace
 {
-    static const FName IdentifyAckAckName( TEXT( "IdentifyAck" ) );
-    static const FName CaptureNameAckName( TEXT( "CaptureNameAck" ) );
-    static const FName CaptureStartAckName( TEXT( "CaptureStartAck" ) );
-    static const FName CaptureStopAckName( TEXT( "CaptureStopAck" ) );
-    static const FName StartMeasuringAckName( TEXT( "StartMeasuringAck" ) );
-    static const FName StopMeasuringAckName( TEXT( "StopMeasuringAck" ) );
-    static const FName StartRecordingAckName( TEXT( "StartRecordingAck" ) );
-    static const FName StopRecordingAckName( TEXT( "StopRecordingAck" ) );
-    static const FName PlayPauseAckName( TEXT( "PlayPauseAck" ) );
-    static const FName NavigateToStartAckName( TEXT( "NavigateToStartAck" ) );
-    static const FName NavigateToEndAckName( TEXT( "NavigateToEndAck" ) );
-    static const FName NextFrameAckName( TEXT( "NextFrameAck" ) );
-    static const FName ToggleRepeatAckName( TEXT( "ToggleRepeatAck" ) );
-    static const FName AddMarkerAckName( TEXT( "AddMarkerAck" ) );
-    static const FName AddNetworkStreamingTargetAckName( TEXT( "AddNetworkStreamingTargetAck" ) );
-    static const FName SessionStatusAckName( TEXT( "SessionStatusAck" ) );
-    static const FName MoveCharacterToOriginAckName( TEXT( "MoveCharacterToOriginAck" ) );
-    static const FName SessionInfoAckName( TEXT( "SessionInfoAck" ) );
-    static const FName JumpToFrameAckName( TEXT( "JumpToFrameAck" ) );
-    static const FName SetMediaRecorderAddressAckName( TEXT( "SetMediaRecorderAddressAck" ) );
-    static const FName SetSessionNameAckName( TEXT( "SetSessionNameAck" ) );
-
-};
-
-
-class MvnXmlParserCallback : public  IFastXmlCallback
-{
-public:
-
-    MvnRemoteControlMessage* m_pMessage = nullptr;
-
-    int m_iTreeLevel = 0;
-
-private:
-
-    bool ProcessXmlDeclaration( const TCHAR* ElementData, int32 XmlFileLineNumber )
-    {
-        return true;
+    /** element and attribute names of the responses, interned once; the acks come first, in the order of ResponseCommands */
+    enum eResponseName : int32
+    {
+        IdentifyAckName,
+        CaptureNameAckName,
+        CaptureStartAckName,
+        CaptureStopAckName,
+        StartMeasuringAckName,
+        StopMeasuringAckName,
+        StartRecordingAckName,
+        StopRecordingAckName,
+        PlayPauseAckName,
+        NavigateToStartAckName,
+        NavigateToEndAckName,
+        NextFrameAckName,
+        ToggleRepeatAckName,
+        AddMarkerAckName,
+        AddNetworkStreamingTargetAckName,
+        SessionStatusAckName,
+        MoveCharacterToOriginAckName,
+        SessionInfoAckName,
+        JumpToFrameAckName,
+        SetMediaRecorderAddressAckName,
+        SetSessionNameAckName,
+        ClockSyncAckName,
+        ResultAttributeName,
+        ReasonAttributeName,
+        IdAttributeName,
+        SessionNameAttributeName,
+        RecordingTrialAttributeName,
+        IsRecordingAttributeName,
+        IsPausedAttributeName,
+        IsLiveAttributeName,
+        SuccessAttributeName,
+        T0AttributeName,
+        T1AttributeName,
+        T2AttributeName,
+        ResponseNameCount
+    };
+
+    const ANSICHAR* const ResponseNames[] =
+    {
+        "IdentifyAck",
+        "CaptureNameAck",
+        "CaptureStartAck",
+        "CaptureStopAck",
+        "StartMeasuringAck",
+        "StopMeasuringAck",
+        "StartRecordingAck",
+        "StopRecordingAck",
+        "PlayPauseAck",
+        "NavigateToStartAck",
+        "NavigateToEndAck",
+        "NextFrameAck",
+        "ToggleRepeatAck",
+        "AddMarkerAck",
+        "AddNetworkStreamingTargetAck",
+        "SessionStatusAck",
+        "MoveCharacterToOriginAck",
+        "SessionInfoAck",
+        "JumpToFrameAck",
+        "SetMediaRecorderAddressAck",
+        "SetSessionNameAck",
+        "ClockSyncAck",
+        "Result",
+        "Reason",
+        "Id",
+        "SessionName",
+        "recordingTrial",
+        "isRecording",
+        "isPaused",
+        "isLive",
+        "Success",
+        "T0",
+        "T1",
+        "T2",
+    };
+    static_assert( UE_ARRAY_COUNT( ResponseNames ) == ResponseNameCount, "a name for every id" );
+
+    const eMvnRemoteControlMessageCommand ResponseCommands[] =
+    {
+        eMvnRemoteControlMessageCommand::Identify,
+        eMvnRemoteControlMessageCommand::CaptureName,
+        eMvnRemoteControlMessageCommand::CaptureStart,
+        eMvnRemoteControlMessageCommand::CaptureStop,
+        eMvnRemoteControlMessageCommand::StartMeasuring,
+        eMvnRemoteControlMessageCommand::StopMeasuring,
+        eMvnRemoteControlMessageCommand::StartRecording,
+        eMvnRemoteControlMessageCommand::StopRecording,
+        eMvnRemoteControlMessageCommand::PlayPause,
+        eMvnRemoteControlMessageCommand::NavigateToStart,
+        eMvnRemoteControlMessageCommand::NavigateToEnd,
+        eMvnRemoteControlMessageCommand::NextFrame,
+        eMvnRemoteControlMessageCommand::ToggleRepeat,
+        eMvnRemoteControlMessageCommand::AddMarker,
+        eMvnRemoteControlMessageCommand::AddNetworkStreamingTarget,
+        eMvnRemoteControlMessageCommand::SessionStatus,
+        eMvnRemoteControlMessageCommand::MoveCharacterToOrigin,
+        eMvnRemoteControlMessageCommand::SessionInfo,
+        eMvnRemoteControlMessageCommand::JumpToFrame,
+        eMvnRemoteControlMessageCommand::SetMediaRecorderAddress,
+        eMvnRemoteControlMessageCommand::SetSessionName,
+        eMvnRemoteControlMessageCommand::ClockSync,
+    };
+    static_assert( UE_ARRAY_COUNT( ResponseCommands ) == ClockSyncAckName + 1, "a command for every ack" );
+
+    const FMvnXmlNameTable& GetResponseNameTable()
+    {
+        static const FMvnXmlNameTable NameTable( MakeArrayView( ResponseNames ) );
+        return NameTable;
+    }
+
+    eMvnRemoteControlMessageCommand GetResponseCommand( int32 _iNameId )
+    {
+        return ( _iNameId >= 0 && _iNameId <= ClockSyncAckName ) ? ResponseCommands[ _iNameId ] : eMvnRemoteControlMessageCommand::Undefined;
     }
+}
 
-    bool ProcessElement( const TCHAR* ElementName, const TCHAR* ElementData, int32 XmlFileLineNumber )
-    {
-        m_iTreeLevel++;
-        if ( m_pMessage == nullptr )
-        {
-            eMvnRemoteControlMessageCommand commandResponse = MvnRemoteControlSessionUtil::GetMatchingMesssageCommand( ElementName );
-            if ( commandResponse != eMvnRemoteControlMessageCommand::Undefined )
-            {
-                m_pMessage = new MvnRemoteControlMessage();
-                m_pMessage->m_Type = eMvnRemoteControlMessageType::Response;
-                m_pMessage->m_Command = commandResponse;
-            }
-        }
-        return true;
-    }
+eMvnRemoteControlMessageCommand MvnRemoteControlSessionUtil::GetMatchingMesssageCommand( const TCHAR* AttributeName )
+{
+    FTCHARToUTF8 Converted( AttributeName );
+    return GetResponseCommand( GetResponseNameTable().Find( FAnsiStringView( Converted.Get(), Converted.Length() ) ) );
+}
 
-    bool ProcessAttribute( const TCHAR* AttributeName, const TCHAR* AttributeValue )
+bool MvnRemoteControlSessionUtil::ParseResponse( const uint8* _pData, int32 _iLength, MvnRemoteControlResponse& _Response )
+{
+    FMvnXmlPullParser Parser( _pData, _iLength, GetResponseNameTable() );
+
+    // the first known ack is the response, only the attributes of a root element are used
+    bool bFound = false;
+    bool bRoot = false;
+    for ( FMvnXmlPullParser::EToken Token = Parser.Next(); Token != FMvnXmlPullParser::EToken::End && Token != FMvnXmlPullParser::EToken::Error; Token = Parser.Next() )
     {
-        /// process attributes at level 1
-        if ( ( m_iTreeLevel == 1 ) && m_pMessage )
+        if ( !bFound )
         {
-            FString strKey = AttributeName;
-            FString strValue = AttributeValue;
-
-            // replace escape sequences
-            FString strValueUnescaped = strValue.Replace( TEXT( "&amp;" ), TEXT( "&" ) )
-                .Replace( TEXT( "&quot;" ), TEXT( "\"" ) )
-                .Replace( TEXT( "&apos;" ), TEXT( "'" ) )
-                .Replace( TEXT( "&lt;" ), TEXT( "<" ) )
-                .Replace( TEXT( "&gt;" ), TEXT( ">" ) );
-
-
-            m_pMessage->m_Attributes.Add(strKey, strValueUnescaped);
-
-            if ( strKey == "Result" )
+            if ( Token == FMvnXmlPullParser::EToken::StartElement )
             {
-                if ( strValue.Compare( L"true", ESearchCase::IgnoreCase ) == 0 )
-                {
-                    m_pMessage->m_bResult = true;
-                }
-                else
+                const eMvnRemoteControlMessageCommand Command = GetResponseCommand( Parser.GetNameId() );
+                if ( Command != eMvnRemoteControlMessageCommand::Undefined )
                 {
-                    m_pMessage->m_bResult = false;
+                    _Response.Reset();
+                    _Response.m_Command = Command;
+                    bFound = true;
+                    bRoot = Parser.GetDepth() == 1;
                 }
             }
-            if ( strKey == "Reason" )
-            {
-                m_pMessage->m_strReason = strValueUnescaped;
-            }
+            continue;
         }
-        return true;
-    }
-
-    bool ProcessClose( const TCHAR* Element )
-    {
-        m_iTreeLevel--;
-        return true;
-    }
-
-    bool ProcessComment( const TCHAR* Comment )
-    {
-        return true;
-    }
-};
-
-eMvnRemoteControlMessageCommand MvnRemoteControlSessionUtil::GetMatchingMesssageCommand( const TCHAR* AttributeName )
-{
-    eMvnRemoteControlMessageCommand result = eMvnRemoteControlMessageCommand::Undefined;
-    if ( AttributeName == IdentifyAckAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::Identify;
-    }
-    else if ( AttributeName == CaptureNameAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::CaptureName;
-    }
-    else if ( AttributeName == CaptureStartAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::CaptureStart;
-    }
-    else if ( AttributeName == CaptureStopAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::CaptureStop;
-    }
-    else if ( AttributeName == StartMeasuringAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::StartMeasuring;
-    }
-    else if ( AttributeName == StopMeasuringAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::StopMeasuring;
-    }
-    else if ( AttributeName == StartRecordingAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::StartRecording;
-    }
-    else if ( AttributeName == StopRecordingAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::StopRecording;
-    }
-    else if ( AttributeName == PlayPauseAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::PlayPause;
-    }
-    else if ( AttributeName == NavigateToStartAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::NavigateToStart;
-    }
-    else if ( AttributeName == NavigateToEndAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::NavigateToEnd;
-    }
-    else if ( AttributeName == NextFrameAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::NextFrame;
-    }
-    else if ( AttributeName == ToggleRepeatAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::ToggleRepeat;
-    }
-    else if ( AttributeName == AddMarkerAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::AddMarker;
-    }
-    else if ( AttributeName == AddNetworkStreamingTargetAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::AddNetworkStreamingTarget;
-    }
-    else if ( AttributeName == SessionStatusAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::SessionStatus;
-    }
-    else if ( AttributeName == MoveCharacterToOriginAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::MoveCharacterToOrigin;
-    }
-    else if ( AttributeName == SessionInfoAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::SessionInfo;
-    }
-    else if ( AttributeName == JumpToFrameAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::JumpToFrame;
-    }
-    else if ( AttributeName == SetMediaRecorderAddressAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::SetMediaRecorderAddress;
-    }
-    else if ( AttributeName == SetSessionNameAckName )
-    {
-        result = eMvnRemoteControlMessageCommand::SetSessionName;
-    }
-    return result;
-}
 
+        // the attributes of the response element are all that is needed
+        if ( !bRoot || Token != FMvnXmlPullParser::EToken::Attribute )
+        {
+            break;
+        }
 
-MvnRemoteControlMessage* MvnRemoteControlSessionUtil::CreateResponseMessage( FString& _strXMLResponse )
-{
-    FFastXml xmlParser;
-    FText errorMsg;
-    int iErrorLine = -1;
-    MvnXmlParserCallback callBack;
-    TArray<TCHAR> aChars = _strXMLResponse.GetCharArray();
-    TCHAR* pCharData = aChars.GetData();
-    xmlParser.ParseXmlFile( &callBack, nullptr, pCharData, nullptr, false, false, errorMsg, iErrorLine );
-    if ( callBack.m_pMessage )
-    {
-        callBack.m_pMessage->m_strXml = _strXMLResponse;
+        switch ( Parser.GetNameId() )
+        {
+        case ResultAttributeName:
+            _Response.m_bResult = Parser.ValueEquals( "true" );
+            break;
+        case ReasonAttributeName:
+            Parser.GetValueAsString( _Response.m_strReason );
+            break;
+        case IdAttributeName:
+            _Response.m_uiRequestId = Parser.GetValueAsUInt();
+            _Response.m_Fields |= eMvnRemoteControlResponseField::RequestId;
+            break;
+        case SessionNameAttributeName:
+            Parser.GetValueAsString( _Response.m_strSessionName );
+            _Response.m_Fields |= eMvnRemoteControlResponseField::SessionName;
+            break;
+        case RecordingTrialAttributeName:
+            Parser.GetValueAsString( _Response.m_strRecordingTrial );
+            _Response.m_Fields |= eMvnRemoteControlResponseField::RecordingTrial;
+            break;
+        case IsRecordingAttributeName:
+            _Response.m_bIsRecording = Parser.ValueEquals( "true" );
+            _Response.m_Fields |= eMvnRemoteControlResponseField::IsRecording;
+            break;
+        case IsPausedAttributeName:
+            _Response.m_bIsPaused = Parser.ValueEquals( "true" );
+            _Response.m_Fields |= eMvnRemoteControlResponseField::IsPaused;
+            break;
+        case IsLiveAttributeName:
+            _Response.m_bIsLive = Parser.ValueEquals( "true" );
+            _Response.m_Fields |= eMvnRemoteControlResponseField::IsLive;
+            break;
+        case SuccessAttributeName:
+            _Response.m_bSuccess = Parser.ValueEquals( "true" );
+            _Response.m_Fields |= eMvnRemoteControlResponseField::Success;
+            break;
+        case T0AttributeName:
+            _Response.m_dT0 = Parser.GetValueAsDouble();
+            _Response.m_Fields |= eMvnRemoteControlResponseField::T0;
+            break;
+        case T1AttributeName:
+            _Response.m_dT1 = Parser.GetValueAsDouble();
+            _Response.m_Fields |= eMvnRemoteControlResponseField::T1;
+            break;
+        case T2AttributeName:
+            _Response.m_dT2 = Parser.GetValueAsDouble();
+            _Response.m_Fields |= eMvnRemoteControlResponseField::T2;
+            break;
+        default:
+            break;
+        }
     }
-    return callBack.m_pMessage;
+    return bFound;
 }
 
-MvnRemoteControlMessage* MvnRemoteControlSessionUtil::CreateRequest( eMvnRemoteControlMessageCommand _command )
+void MvnRemoteControlSessionUtil::InitRequest( MvnRemoteControlMessage& _Request, eMvnRemoteControlMessageCommand _command )
 {
-    MvnRemoteControlMessage* pNewCommand = new MvnRemoteControlMessage();
-    pNewCommand->m_Type = eMvnRemoteControlMessageType::Request;
-    pNewCommand->m_Command = _command;
-    return pNewCommand;
+    _Request.Reset();
+    _Request.m_Type = eMvnRemoteControlMessageType::Request;
+    _Request.m_Command = _command;
 }
 
-MvnRemoteControlMessage* MvnRemoteControlSessionUtil::CreateIdentifyRequest()
+void MvnRemoteControlSessionUtil::InitIdentifyRequest( MvnRemoteControlMessage& _Request )
 {
-    MvnRemoteControlMessage* pNewCommand = CreateRequest( eMvnRemoteControlMessageCommand::Identify );
-    pNewCommand->m_strXml = "<IdentifyReq/>";
-    return pNewCommand;
+    InitRequest( _Request, eMvnRemoteControlMessageCommand::Identify );
+    _Request.m_strXml = TEXT( "<IdentifyReq/>" );
 }
 
-MvnRemoteControlMessage* MvnRemoteControlSessionUtil::CreateCaptureNameRequest( FString& _strCaptureName, int _iTakeCount )
+void MvnRemoteControlSessionUtil::InitCaptureNameRequest( MvnRemoteControlMessage& _Request, const FString& _strCaptureName, int _iTakeCount )
 {
-    MvnRemoteControlMessage* pNewCommand = CreateRequest( eMvnRemoteControlMessageCommand::CaptureName );
-    FString strXml;
+    InitRequest( _Request, eMvnRemoteControlMessageCommand::CaptureName );
     if ( _iTakeCount > -1 )
     {
-        strXml = FString::Printf( L"<CaptureName><Name VALUE=\"%s\"/><Take VALUE=\"%03d\"/></CaptureName>", *_strCaptureName, _iTakeCount );
+        _Request.m_strXml = FString::Printf( TEXT( "<CaptureName><Name VALUE=\"%s\"/><Take VALUE=\"%03d\"/></CaptureName>" ), *_strCaptureName, _iTakeCount );
     }
     else
     {
-        strXml = FString::Printf( L"<CaptureName><Name VALUE=\"%s\"/></CaptureName>", *_strCaptureName);
+        _Request.m_strXml = FString::Printf( TEXT( "<CaptureName><Name VALUE=\"%s\"/></CaptureName>" ), *_strCaptureName);
     }
-    pNewCommand->m_strXml = strXml;
-    return pNewCommand;
 }
 
 
-MvnRemoteControlMessage* MvnRemoteControlSessionUtil::CreateCaptureStartRequest( FString& _strNotes, double _dTimeOffsetInSeconds  )
+void MvnRemoteControlSessionUtil::InitCaptureStartRequest( MvnRemoteControlMessage& _Request, const FString& _strNotes, double _dTimeOffsetInSeconds, const FMvnClockSync* _pClockSync )
 {
-    MvnRemoteControlMessage* pNewCommand = CreateRequest( eMvnRemoteControlMessageCommand::CaptureStart );
-    FString strTimeCode = FormulateTimeCodeString( _dTimeOffsetInSeconds );
-    FString strXml;
+    InitRequest( _Request, eMvnRemoteControlMessageCommand::CaptureStart );
+    FString strTimeCode = FormulateTimeCodeString( _dTimeOffsetInSeconds, _pClockSync );
     FString strTimeCodeTag = "";
 
     if ( _dTimeOffsetInSeconds != 0.0 )
     {
-        strTimeCodeTag = FString::Printf( L"<TimeCode VALUE=\"%s\"/>", *strTimeCode );
+        strTimeCodeTag = FString::Printf( TEXT( "<TimeCode VALUE=\"%s\"/>" ), *strTimeCode );
     }
 
     if ( _strNotes.IsEmpty() )
     {
-        strXml = FString::Printf( L"<CaptureStart>%s</CaptureStart>", *strTimeCodeTag );
+        _Request.m_strXml = FString::Printf( TEXT( "<CaptureStart>%s</CaptureStart>" ), *strTimeCodeTag );
     }
     else
     {
-        strXml = FString::Printf( L"<CaptureStart>%s<Notes>%s</Notes></CaptureStart>", *strTimeCodeTag, *_strNotes );
+        _Request.m_strXml = FString::Printf( TEXT( "<CaptureStart>%s<Notes>%s</Notes></CaptureStart>" ), *strTimeCodeTag, *_strNotes );
     }
-    pNewCommand->m_strXml = strXml;
-    return pNewCommand;
 }
 
-MvnRemoteControlMessage* MvnRemoteControlSessionUtil::CreateCaptureStopRequest( double _dTimeOffsetInSeconds )
+void MvnRemoteControlSessionUtil::InitCaptureStopRequest( MvnRemoteControlMessage& _Request, double _dTimeOffsetInSeconds, const FMvnClockSync* _pClockSync )
 {
-    FString strTimeCode = FormulateTimeCodeString( _dTimeOffsetInSeconds );
-    MvnRemoteControlMessage* pNewCommand = CreateRequest( eMvnRemoteControlMessageCommand::StopRecording );
-    pNewCommand->m_strXml = FString::Printf( L"<CaptureStop><TimeCode VALUE=\"%s\"/></CaptureStop>", *strTimeCode );
-    return pNewCommand;
+    FString strTimeCode = FormulateTimeCodeString( _dTimeOffsetInSeconds, _pClockSync );
+    // acknowledged with CaptureStopAck
+    InitRequest( _Request, eMvnRemoteControlMessageCommand::CaptureStop );
+    _Request.m_strXml = FString::Printf( TEXT( "<CaptureStop><TimeCode VALUE=\"%s\"/></CaptureStop>" ), *strTimeCode );
 }
 
-MvnRemoteControlMessage* MvnRemoteControlSessionUtil::CreateTimeSyncRequest( bool _bReset )
+void MvnRemoteControlSessionUtil::InitTimeSyncRequest( MvnRemoteControlMessage& _Request, bool _bReset )
 {
-    MvnRemoteControlMessage* pNewCommand = CreateRequest( eMvnRemoteControlMessageCommand::TimeSync );
+    InitRequest( _Request, eMvnRemoteControlMessageCommand::TimeSync );
     FString strTimeCode = FormulateTimeCodeString( 0 );
     FString strReset = _bReset ? "True" : "False";
-    pNewCommand->m_strXml = FString::Printf( L"<TimeSync TimeCode=\"%s\"/>", *strTimeCode, *strReset );
-    return pNewCommand;
+    _Request.m_strXml = FString::Printf( TEXT( "<TimeSync TimeCode=\"%s\"/>" ), *strTimeCode, *strReset );
+}
+
+void MvnRemoteControlSessionUtil::InitSessionInfoRequest( MvnRemoteControlMessage& _Request )
+{
+    InitRequest( _Request, eMvnRemoteControlMessageCommand::SessionInfo );
+    _Request.m_strXml = TEXT( "<SessionInfoReq/>" );
+}
+
+void MvnRemoteControlSessionUtil::InitSessionStatusRequest( MvnRemoteControlMessage& _Request )
+{
+    InitRequest( _Request, eMvnRemoteControlMessageCommand::SessionStatus );
+    _Request.m_strXml = TEXT( "<SessionStatusReq/>" );
 }
 
-MvnRemoteControlMessage* MvnRemoteControlSessionUtil::CreateSessionInfoRequest()
+void MvnRemoteControlSessionUtil::InitClockSyncRequest( MvnRemoteControlMessage& _Request, uint32 _uiRequestId, double _dLocalSendTime )
 {
-    MvnRemoteControlMessage* pNewCommand = CreateRequest( eMvnRemoteControlMessageCommand::SessionInfo );
-    pNewCommand->m_strXml = "<SessionInfoReq/>";
-    return pNewCommand;
+    InitRequest( _Request, eMvnRemoteControlMessageCommand::ClockSync );
+    _Request.m_uiRequestId = _uiRequestId;
+    _Request.m_strXml = FString::Printf( TEXT( "<ClockSyncReq Id=\"%u\" T0=\"%.9f\"/>" ), _uiRequestId, _dLocalSendTime );
 }
 
-MvnRemoteControlMessage* MvnRemoteControlSessionUtil::CreateSessionStatusRequest()
+const TCHAR* MvnRemoteControlSessionUtil::GetCommandName( eMvnRemoteControlMessageCommand _command )
 {
-    MvnRemoteControlMessage* pNewCommand = CreateRequest( eMvnRemoteControlMessageCommand::SessionStatus );
-    pNewCommand->m_strXml = "<SessionStatusReq/>";
-    return pNewCommand;
+    switch ( _command )
+    {
+    case eMvnRemoteControlMessageCommand::Undefined: return TEXT( "Undefined" );
+    case eMvnRemoteControlMessageCommand::Identify: return TEXT( "Identify" );
+    case eMvnRemoteControlMessageCommand::CaptureName: return TEXT( "CaptureName" );
+    case eMvnRemoteControlMessageCommand::CaptureStart: return TEXT( "CaptureStart" );
+    case eMvnRemoteControlMessageCommand::CaptureStop: return TEXT( "CaptureStop" );
+    case eMvnRemoteControlMessageCommand::TimeSync: return TEXT( "TimeSync" );
+    case eMvnRemoteControlMessageCommand::StartMeasuring: return TEXT( "StartMeasuring" );
+    case eMvnRemoteControlMessageCommand::StopMeasuring: return TEXT( "StopMeasuring" );
+    case eMvnRemoteControlMessageCommand::StartRecording: return TEXT( "StartRecording" );
+    case eMvnRemoteControlMessageCommand::StopRecording: return TEXT( "StopRecording" );
+    case eMvnRemoteControlMessageCommand::PlayPause: return TEXT( "PlayPause" );
+    case eMvnRemoteControlMessageCommand::NavigateToStart: return TEXT( "NavigateToStart" );
+    case eMvnRemoteControlMessageCommand::NavigateToEnd: return TEXT( "NavigateToEnd" );
+    case eMvnRemoteControlMessageCommand::NextFrame: return TEXT( "NextFrame" );
+    case eMvnRemoteControlMessageCommand::ToggleRepeat: return TEXT( "ToggleRepeat" );
+    case eMvnRemoteControlMessageCommand::AddMarker: return TEXT( "AddMarker" );
+    case eMvnRemoteControlMessageCommand::AddNetworkStreamingTarget: return TEXT( "AddNetworkStreamingTarget" );
+    case eMvnRemoteControlMessageCommand::SessionStatus: return TEXT( "SessionStatus" );
+    case eMvnRemoteControlMessageCommand::MoveCharacterToOrigin: return TEXT( "MoveCharacterToOrigin" );
+    case eMvnRemoteControlMessageCommand::SessionInfo: return TEXT( "SessionInfo" );
+    case eMvnRemoteControlMessageCommand::JumpToFrame: return TEXT( "JumpToFrame" );
+    case eMvnRemoteControlMessageCommand::SetMediaRecorderAddress: return TEXT( "SetMediaRecorderAddress" );
+    case eMvnRemoteControlMessageCommand::SetSessionName: return TEXT( "SetSessionName" );
+    case eMvnRemoteControlMessageCommand::ClockSync: return TEXT( "ClockSync" );
+    }
+    return TEXT( "Unknown" );
 }
 
-FString MvnRemoteControlSessionUtil::FormulateTimeCodeString( double _dTimeOffsetInSeconds )
+bool MvnRemoteControlSessionUtil::ExpectsResponse( eMvnRemoteControlMessageCommand _command )
 {
+    // time sync is fire and forget
+    return _command != eMvnRemoteControlMessageCommand::TimeSync && _command != eMvnRemoteControlMessageCommand::Undefined;
+}
+
+FString MvnRemoteControlSessionUtil::FormulateTimeCodeString( double _dTimeOffsetInSeconds, const FMvnClockSync* _pClockSync )
+{
+    /// a synchronized clock gives the server's time of day, so the time code means the same moment on both sides
+    if ( _pClockSync && _pClockSync->IsValid() )
+    {
+        double dServerSeconds = _pClockSync->LocalToServer( FPlatformTime::Seconds() );
+        dServerSeconds = FMath::Fmod( dServerSeconds, FMvnClockSync::SecondsPerDay );
+        if ( dServerSeconds < 0.0 )
+        {
+            dServerSeconds += FMvnClockSync::SecondsPerDay;
+        }
+
+        int iSeconds = FMath::FloorToInt( dServerSeconds );
+        if ( _dTimeOffsetInSeconds > 0.0 )
+        {
+            if ( dServerSeconds - iSeconds > 0.5 )
+            {
+                iSeconds++;
+            }
+        }
+        return FString::Printf( TEXT( "%02d %02d %02d" ), ( iSeconds / 3600 ) % 24, ( iSeconds / 60 ) % 60, iSeconds % 60 );
+    }
+
     FTimespan offsetSpan = FTimespan::FromSeconds( _dTimeOffsetInSeconds );
 
     FDateTime timeWithOffset = FDateTime::Now();
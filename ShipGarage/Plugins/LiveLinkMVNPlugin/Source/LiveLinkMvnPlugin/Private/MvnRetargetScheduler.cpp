@@ -0,0 +1,262 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnRetargetScheduler.h"
+#include "LiveLinkMvnRetargetAsset.h"
+
+#include "Animation/AnimClassInterface.h"
+#include "Animation/AnimInstance.h"
+#include "AnimNode_LiveLinkPose.h"
+#include "Async/ParallelFor.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "Features/IModularFeatures.h"
+#include "HAL/IConsoleManager.h"
+#include "ILiveLinkClient.h"
+#include "Misc/ScopeLock.h"
+#include "Roles/LiveLinkAnimationRole.h"
+#include "Roles/LiveLinkAnimationTypes.h"
+
+static TAutoConsoleVariable<int32> CVarMvnRetargetBatch(
+	TEXT("mvn.Retarget.Batch"),
+	1,
+	TEXT("Retarget all MVN driven characters of a frame in one parallel batch before the actors tick (1) or each on its own during animation evaluation (0)."));
+
+namespace
+{
+	struct FSubjectBatch
+	{
+		const FLiveLinkAnimationFrameData* FrameData = nullptr;
+		TArray<ULiveLinkMvnRetargetAsset*> Assets;
+	};
+}
+
+FMvnRetargetScheduler& FMvnRetargetScheduler::getInstance()
+{
+	static FMvnRetargetScheduler instance;
+	return instance;
+}
+
+FMvnRetargetScheduler::FMvnRetargetScheduler()
+	: PreparedFrameCounter(0)
+	, NumPrepared(0)
+{
+}
+
+void FMvnRetargetScheduler::Initialize()
+{
+	if (!OnWorldPreActorTickHandle.IsValid())
+	{
+		OnWorldPreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddRaw(this, &FMvnRetargetScheduler::OnWorldPreActorTick);
+	}
+}
+
+void FMvnRetargetScheduler::Shutdown()
+{
+	if (OnWorldPreActorTickHandle.IsValid())
+	{
+		FWorldDelegates::OnWorldPreActorTick.Remove(OnWorldPreActorTickHandle);
+		OnWorldPreActorTickHandle.Reset();
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	Entries.Empty();
+	SubjectFrames.Empty();
+}
+
+void FMvnRetargetScheduler::Register(ULiveLinkMvnRetargetAsset* Asset)
+{
+	FEntry NewEntry;
+	NewEntry.Asset = Asset;
+	FindPoseNode(NewEntry);
+
+	FScopeLock ScopeLock(&Lock);
+	Entries.Add(MoveTemp(NewEntry));
+}
+
+void FMvnRetargetScheduler::Register(ULiveLinkMvnRetargetAsset* Asset, const FLiveLinkSubjectName& SubjectName)
+{
+	FEntry NewEntry;
+	NewEntry.Asset = Asset;
+	NewEntry.SubjectName = SubjectName;
+	NewEntry.bHasSubject = !SubjectName.IsNone();
+
+	FScopeLock ScopeLock(&Lock);
+	Entries.Add(MoveTemp(NewEntry));
+}
+
+void FMvnRetargetScheduler::FindPoseNode(FEntry& Entry)
+{
+	// the anim node creates the asset inside the anim instance it evaluates for
+	UAnimInstance* AnimInstance = Entry.Asset->GetTypedOuter<UAnimInstance>();
+	const IAnimClassInterface* AnimClass = AnimInstance != nullptr ? IAnimClassInterface::GetFromClass(AnimInstance->GetClass()) : nullptr;
+	if (AnimClass == nullptr)
+	{
+		return;
+	}
+
+	for (const FStructProperty* NodeProperty : AnimClass->GetAnimNodeProperties())
+	{
+		if (NodeProperty->Struct->IsChildOf(FAnimNode_LiveLinkPose::StaticStruct()))
+		{
+			const FAnimNode_LiveLinkPose* Node = NodeProperty->ContainerPtrToValuePtr<FAnimNode_LiveLinkPose>(AnimInstance);
+			if (Node->CurrentRetargetAsset == Entry.Asset)
+			{
+				Entry.AnimInstance = AnimInstance;
+				Entry.Node = Node;
+				return;
+			}
+		}
+	}
+}
+
+void FMvnRetargetScheduler::Unregister(ULiveLinkMvnRetargetAsset* Asset)
+{
+	FScopeLock ScopeLock(&Lock);
+	for (const FEntry& Entry : Entries)
+	{
+		if (Entry.Asset == Asset && !Entry.PolicySubjectName.IsNone())
+		{
+			FMvnSubjectUpdatePolicy::getInstance().UnregisterComponent(Entry.PolicySubjectName, Entry.PolicyComponent.Get());
+		}
+	}
+	Entries.RemoveAllSwap([Asset](const FEntry& Entry) { return Entry.Asset == Asset; });
+}
+
+void FMvnRetargetScheduler::UpdatePolicyRegistration(FEntry& Entry)
+{
+	const FName SubjectName = Entry.bHasSubject ? Entry.SubjectName.Name : NAME_None;
+	if (SubjectName == Entry.PolicySubjectName)
+	{
+		return;
+	}
+
+	FMvnSubjectUpdatePolicy& Policy = FMvnSubjectUpdatePolicy::getInstance();
+	if (!Entry.PolicySubjectName.IsNone())
+	{
+		Policy.UnregisterComponent(Entry.PolicySubjectName, Entry.PolicyComponent.Get());
+	}
+
+	// the anim node creates the asset inside the anim instance it evaluates for
+	const UAnimInstance* AnimInstance = Entry.Asset->GetTypedOuter<UAnimInstance>();
+	Entry.PolicyComponent = AnimInstance != nullptr ? AnimInstance->GetSkelMeshComponent() : nullptr;
+	Entry.PolicySubjectName = SubjectName;
+	if (!SubjectName.IsNone())
+	{
+		Policy.RegisterComponent(SubjectName, Entry.PolicyComponent.Get());
+	}
+}
+
+void FMvnRetargetScheduler::OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	PrepareFrame();
+}
+
+void FMvnRetargetScheduler::PrepareFrame()
+{
+	// several worlds may tick in one frame, the subjects only change once
+	if (PreparedFrameCounter == GFrameCounter)
+	{
+		return;
+	}
+	PreparedFrameCounter = GFrameCounter;
+	NumPrepared = 0;
+
+	FMvnSubjectUpdatePolicy& Policy = FMvnSubjectUpdatePolicy::getInstance();
+	Policy.Update();
+
+	FScopeLock ScopeLock(&Lock);
+	SubjectFrames.Reset();
+
+	for (FEntry& Entry : Entries)
+	{
+		if (Entry.Node != nullptr)
+		{
+			// the node's subject may be bound to a pin, it is read while no animation evaluates
+			Entry.bHasSubject = Entry.AnimInstance.IsValid() && !Entry.Node->LiveLinkSubjectName.IsNone();
+			Entry.SubjectName = Entry.bHasSubject ? Entry.Node->LiveLinkSubjectName : FLiveLinkSubjectName();
+		}
+		UpdatePolicyRegistration(Entry);
+		Entry.Rate = Entry.bHasSubject ? Policy.GetRate(Entry.SubjectName.Name) : EMvnSubjectUpdateRate::Full;
+		Entry.Asset->SetUpdateRate(Entry.Rate);
+	}
+
+	if (Entries.Num() == 0 || CVarMvnRetargetBatch.GetValueOnGameThread() == 0)
+	{
+		return;
+	}
+
+	IModularFeatures& ModularFeatures = IModularFeatures::Get();
+	if (!ModularFeatures.IsModularFeatureAvailable(ILiveLinkClient::ModularFeatureName))
+	{
+		return;
+	}
+	ILiveLinkClient& Client = ModularFeatures.GetModularFeature<ILiveLinkClient>(ILiveLinkClient::ModularFeatureName);
+
+	// assets without a subject retarget on their own. Throttled subjects are left to their assets, which only
+	// retarget new frames
+	TSet<FLiveLinkSubjectName, DefaultKeyFuncs<FLiveLinkSubjectName>, TInlineSetAllocator<16>> ThrottledSubjects;
+	for (const FEntry& Entry : Entries)
+	{
+		if (!Entry.bHasSubject)
+		{
+			continue;
+		}
+
+		if (Entry.Rate != EMvnSubjectUpdateRate::Full)
+		{
+			ThrottledSubjects.Add(Entry.SubjectName);
+		}
+		else
+		{
+			SubjectFrames.FindOrAdd(Entry.SubjectName);
+		}
+	}
+	if (ThrottledSubjects.Num() > 0)
+	{
+		Policy.AddSkippedEvaluations(ThrottledSubjects.Num());
+	}
+
+	for (auto It = SubjectFrames.CreateIterator(); It; ++It)
+	{
+		if (!Client.EvaluateFrame_AnyThread(It.Key(), ULiveLinkAnimationRole::StaticClass(), It.Value()))
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	// one task per subject, prepares every asset driven by it
+	TArray<FSubjectBatch, TInlineAllocator<16>> Batches;
+	TMap<FLiveLinkSubjectName, int32, TInlineSetAllocator<16>> BatchIndices;
+	for (const FEntry& Entry : Entries)
+	{
+		if (!Entry.bHasSubject)
+		{
+			continue;
+		}
+
+		const FLiveLinkSubjectFrameData* SubjectFrame = SubjectFrames.Find(Entry.SubjectName);
+		const FLiveLinkAnimationFrameData* FrameData = SubjectFrame ? SubjectFrame->FrameData.Cast<FLiveLinkAnimationFrameData>() : nullptr;
+		if (FrameData == nullptr)
+		{
+			continue;
+		}
+
+		int32* BatchIndex = BatchIndices.Find(Entry.SubjectName);
+		if (BatchIndex == nullptr)
+		{
+			BatchIndex = &BatchIndices.Add(Entry.SubjectName, Batches.Num());
+			Batches.AddDefaulted_GetRef().FrameData = FrameData;
+		}
+		Batches[*BatchIndex].Assets.Add(Entry.Asset);
+		++NumPrepared;
+	}
+
+	ParallelFor(Batches.Num(), [&Batches](int32 BatchIndex)
+	{
+		const FSubjectBatch& Batch = Batches[BatchIndex];
+		for (ULiveLinkMvnRetargetAsset* Asset : Batch.Assets)
+		{
+			Asset->PrepareRetarget(*Batch.FrameData);
+		}
+	});
+}
@@ -0,0 +1,225 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnSegmentKernel.h"
+#include "Math/VectorRegister.h"
+
+#if ENGINE_MAJOR_VERSION < 5
+typedef VectorRegister VectorRegister4Float;
+#endif
+
+namespace
+{
+	/** Four quaternions, one component per register */
+	struct FQuatLanes
+	{
+		VectorRegister4Float X;
+		VectorRegister4Float Y;
+		VectorRegister4Float Z;
+		VectorRegister4Float W;
+	};
+
+	FORCEINLINE FQuatLanes LoadQuats(const FMvnSegmentSoA& Soa, int32 Index)
+	{
+		FQuatLanes Lanes;
+		Lanes.X = VectorLoadAligned(&Soa.X[Index]);
+		Lanes.Y = VectorLoadAligned(&Soa.Y[Index]);
+		Lanes.Z = VectorLoadAligned(&Soa.Z[Index]);
+		Lanes.W = VectorLoadAligned(&Soa.W[Index]);
+		return Lanes;
+	}
+
+	FORCEINLINE void StoreQuats(const FQuatLanes& Lanes, FMvnSegmentSoA& Soa, int32 Index)
+	{
+		VectorStoreAligned(Lanes.X, &Soa.X[Index]);
+		VectorStoreAligned(Lanes.Y, &Soa.Y[Index]);
+		VectorStoreAligned(Lanes.Z, &Soa.Z[Index]);
+		VectorStoreAligned(Lanes.W, &Soa.W[Index]);
+	}
+
+	FORCEINLINE FQuatLanes BroadcastQuat(const FQuat& Quat)
+	{
+		FQuatLanes Lanes;
+		Lanes.X = VectorSetFloat1((float)Quat.X);
+		Lanes.Y = VectorSetFloat1((float)Quat.Y);
+		Lanes.Z = VectorSetFloat1((float)Quat.Z);
+		Lanes.W = VectorSetFloat1((float)Quat.W);
+		return Lanes;
+	}
+
+	// Hamilton product A * B, same as FQuat::operator*
+	FORCEINLINE FQuatLanes MultiplyQuats(const FQuatLanes& A, const FQuatLanes& B)
+	{
+		FQuatLanes Result;
+		Result.X = VectorSubtract(VectorMultiplyAdd(A.W, B.X, VectorMultiplyAdd(A.X, B.W, VectorMultiply(A.Y, B.Z))), VectorMultiply(A.Z, B.Y));
+		Result.Y = VectorSubtract(VectorMultiplyAdd(A.W, B.Y, VectorMultiplyAdd(A.Y, B.W, VectorMultiply(A.Z, B.X))), VectorMultiply(A.X, B.Z));
+		Result.Z = VectorSubtract(VectorMultiplyAdd(A.W, B.Z, VectorMultiplyAdd(A.Z, B.W, VectorMultiply(A.X, B.Y))), VectorMultiply(A.Y, B.X));
+		Result.W = VectorSubtract(VectorMultiply(A.W, B.W), VectorMultiplyAdd(A.X, B.X, VectorMultiplyAdd(A.Y, B.Y, VectorMultiply(A.Z, B.Z))));
+		return Result;
+	}
+
+	FORCEINLINE FQuatLanes SelectQuats(const VectorRegister4Float& Mask, const FQuatLanes& A, const FQuatLanes& B)
+	{
+		FQuatLanes Result;
+		Result.X = VectorSelect(Mask, A.X, B.X);
+		Result.Y = VectorSelect(Mask, A.Y, B.Y);
+		Result.Z = VectorSelect(Mask, A.Z, B.Z);
+		Result.W = VectorSelect(Mask, A.W, B.W);
+		return Result;
+	}
+}
+
+void FMvnSegmentSoA::SetNum(int32 InNum)
+{
+	NumElements = InNum;
+
+	const int32 NumPadded = Align(InNum + 1, 4);
+	X.SetNumUninitialized(NumPadded);
+	Y.SetNumUninitialized(NumPadded);
+	Z.SetNumUninitialized(NumPadded);
+	W.SetNumUninitialized(NumPadded);
+	for (int32 Index = InNum; Index < NumPadded; ++Index)
+	{
+		X[Index] = 0.0f;
+		Y[Index] = 0.0f;
+		Z[Index] = 0.0f;
+		W[Index] = 1.0f;
+	}
+}
+
+void FMvnRetargetKernelPlan::Reset(int32 InNum)
+{
+	Tpose.SetNum(InNum);
+	CombinedWorld.SetNumZeroed(Tpose.X.Num());
+	Parent.SetNumUninitialized(InNum);
+	for (int32 Index = 0; Index < InNum; ++Index)
+	{
+		Tpose.SetQuat(Index, FQuat::Identity);
+		Parent[Index] = InNum;
+	}
+	ForwardFix = FQuat::Identity;
+}
+
+void MvnSegmentKernel::ConvertSegments(const QuaternionDatagram::Kinematics* Data, int32 Num, FMvnSegmentSoA& OutPositions, FMvnSegmentSoA& OutRotations)
+{
+	OutPositions.SetNum(Num);
+	OutRotations.SetNum(Num);
+
+	// transpose to lanes, the datagram stores each segment's values together
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		const QuaternionDatagram::Kinematics& Segment = Data[Index];
+		OutPositions.X[Index] = Segment.sensorPos[0];
+		OutPositions.Y[Index] = Segment.sensorPos[1];
+		OutPositions.Z[Index] = Segment.sensorPos[2];
+		OutRotations.X[Index] = Segment.quatRotation[1];
+		OutRotations.Y[Index] = Segment.quatRotation[2];
+		OutRotations.Z[Index] = Segment.quatRotation[3];
+		OutRotations.W[Index] = Segment.quatRotation[0];
+	}
+
+	const VectorRegister4Float Centimeters = VectorSetFloat1(100.0f);
+	const VectorRegister4Float FlippedCentimeters = VectorSetFloat1(-100.0f);
+	const VectorRegister4Float Tolerance = VectorSetFloat1(SMALL_NUMBER);
+	const VectorRegister4Float Zero = VectorSetFloat1(0.0f);
+	const VectorRegister4Float One = VectorSetFloat1(1.0f);
+
+	const int32 NumPadded = OutRotations.X.Num();
+	for (int32 Index = 0; Index < NumPadded; Index += 4)
+	{
+		VectorStoreAligned(VectorMultiply(VectorLoadAligned(&OutPositions.X[Index]), Centimeters), &OutPositions.X[Index]);
+		VectorStoreAligned(VectorMultiply(VectorLoadAligned(&OutPositions.Y[Index]), FlippedCentimeters), &OutPositions.Y[Index]);
+		VectorStoreAligned(VectorMultiply(VectorLoadAligned(&OutPositions.Z[Index]), Centimeters), &OutPositions.Z[Index]);
+
+		FQuatLanes Rot = LoadQuats(OutRotations, Index);
+		Rot.X = VectorNegate(Rot.X);
+		Rot.Z = VectorNegate(Rot.Z);
+
+		// like FQuat::GetNormalized, identity when the length is too small to normalize
+		const VectorRegister4Float SquareSum = VectorMultiplyAdd(Rot.X, Rot.X, VectorMultiplyAdd(Rot.Y, Rot.Y, VectorMultiplyAdd(Rot.Z, Rot.Z, VectorMultiply(Rot.W, Rot.W))));
+		const VectorRegister4Float CanNormalize = VectorCompareGE(SquareSum, Tolerance);
+		const VectorRegister4Float Scale = VectorReciprocalSqrtAccurate(VectorSelect(CanNormalize, SquareSum, One));
+		Rot.X = VectorSelect(CanNormalize, VectorMultiply(Rot.X, Scale), Zero);
+		Rot.Y = VectorSelect(CanNormalize, VectorMultiply(Rot.Y, Scale), Zero);
+		Rot.Z = VectorSelect(CanNormalize, VectorMultiply(Rot.Z, Scale), Zero);
+		Rot.W = VectorSelect(CanNormalize, VectorMultiply(Rot.W, Scale), One);
+		StoreQuats(Rot, OutRotations, Index);
+	}
+}
+
+void MvnSegmentKernel::ConvertSegmentsScalar(const QuaternionDatagram::Kinematics* Data, int32 Num, FMvnSegmentSoA& OutPositions, FMvnSegmentSoA& OutRotations)
+{
+	OutPositions.SetNum(Num);
+	OutRotations.SetNum(Num);
+
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		const QuaternionDatagram::Kinematics& Segment = Data[Index];
+		OutPositions.SetVector(Index, FVector(Segment.sensorPos[0] * 100, -Segment.sensorPos[1] * 100, Segment.sensorPos[2] * 100));
+		OutRotations.SetQuat(Index, FQuat(-Segment.quatRotation[1], Segment.quatRotation[2], -Segment.quatRotation[3], Segment.quatRotation[0]).GetNormalized());
+	}
+}
+
+void MvnSegmentKernel::RetargetSegments(const FMvnSegmentSoA& Rotations, const FMvnRetargetKernelPlan& Plan, FMvnSegmentSoA& OutWorld, FMvnSegmentSoA& OutLocal)
+{
+	const int32 Num = Plan.Num();
+	check(Rotations.Num() >= Num);
+
+	OutWorld.SetNum(Num);
+	OutLocal.SetNum(Num);
+
+	const FQuatLanes ForwardFix = BroadcastQuat(Plan.ForwardFix);
+	const VectorRegister4Float Half = VectorSetFloat1(0.5f);
+	const int32 NumPadded = OutWorld.X.Num();
+
+	// world rotations first, every segment can then be made relative to its parent independently
+	for (int32 Index = 0; Index < NumPadded; Index += 4)
+	{
+		const FQuatLanes Rot = LoadQuats(Rotations, Index);
+		const FQuatLanes Combined = MultiplyQuats(MultiplyQuats(Rot, ForwardFix), LoadQuats(Plan.Tpose, Index));
+		const VectorRegister4Float UseCombined = VectorCompareGT(VectorLoadAligned(&Plan.CombinedWorld[Index]), Half);
+
+		StoreQuats(SelectQuats(UseCombined, Combined, Rot), OutWorld, Index);
+		StoreQuats(Combined, OutLocal, Index);
+	}
+
+	auto ParentOf = [&Plan, Num](int32 Index)
+	{
+		return Index < Num ? Plan.Parent[Index] : Num;
+	};
+
+	for (int32 Index = 0; Index < NumPadded; Index += 4)
+	{
+		const int32 P0 = ParentOf(Index);
+		const int32 P1 = ParentOf(Index + 1);
+		const int32 P2 = ParentOf(Index + 2);
+		const int32 P3 = ParentOf(Index + 3);
+
+		// inverse of the (normalized) parent rotation, the spare element at Num is identity for segments without one
+		FQuatLanes ParentInverse;
+		ParentInverse.X = MakeVectorRegister(-OutWorld.X[P0], -OutWorld.X[P1], -OutWorld.X[P2], -OutWorld.X[P3]);
+		ParentInverse.Y = MakeVectorRegister(-OutWorld.Y[P0], -OutWorld.Y[P1], -OutWorld.Y[P2], -OutWorld.Y[P3]);
+		ParentInverse.Z = MakeVectorRegister(-OutWorld.Z[P0], -OutWorld.Z[P1], -OutWorld.Z[P2], -OutWorld.Z[P3]);
+		ParentInverse.W = MakeVectorRegister(OutWorld.W[P0], OutWorld.W[P1], OutWorld.W[P2], OutWorld.W[P3]);
+
+		StoreQuats(MultiplyQuats(ParentInverse, LoadQuats(OutLocal, Index)), OutLocal, Index);
+	}
+}
+
+void MvnSegmentKernel::RetargetSegmentsScalar(const FMvnSegmentSoA& Rotations, const FMvnRetargetKernelPlan& Plan, FMvnSegmentSoA& OutWorld, FMvnSegmentSoA& OutLocal)
+{
+	const int32 Num = Plan.Num();
+	check(Rotations.Num() >= Num);
+
+	OutWorld.SetNum(Num);
+	OutLocal.SetNum(Num);
+
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		const FQuat Rot = Rotations.GetQuat(Index);
+		const FQuat Combined = Rot * Plan.ForwardFix * Plan.Tpose.GetQuat(Index);
+		OutWorld.SetQuat(Index, Plan.CombinedWorld[Index] > 0.5f ? Combined : Rot);
+
+		const int32 Parent = Plan.Parent[Index];
+		OutLocal.SetQuat(Index, Parent < Num ? OutWorld.GetQuat(Parent).Inverse() * Combined : Combined);
+	}
+}
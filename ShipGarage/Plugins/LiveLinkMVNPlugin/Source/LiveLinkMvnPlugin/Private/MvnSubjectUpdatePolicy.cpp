@@ -0,0 +1,409 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnSubjectUpdatePolicy.h"
+#include "MvnTelemetry.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "Features/IModularFeatures.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+static TAutoConsoleVariable<int32> CVarMvnLodEnable(
+	TEXT("mvn.Lod.Enable"),
+	1,
+	TEXT("Throttle Live Link subjects whose characters are small or off screen (1) or update all of them at full rate (0). Overrides apply either way."));
+
+static TAutoConsoleVariable<float> CVarMvnLodReducedRate(
+	TEXT("mvn.Lod.ReducedRate"),
+	15.f,
+	TEXT("Frames per second pushed for a subject at reduced rate."));
+
+static TAutoConsoleVariable<float> CVarMvnLodPausedRate(
+	TEXT("mvn.Lod.PausedRate"),
+	2.f,
+	TEXT("Frames per second still pushed for a paused subject, so its characters move into view with the performer. At least 0.1."));
+
+static TAutoConsoleVariable<float> CVarMvnLodReducedScreenSize(
+	TEXT("mvn.Lod.ReducedScreenSize"),
+	0.05f,
+	TEXT("Bounds radius over view distance below which a character only needs its subject at reduced rate."));
+
+static TAutoConsoleVariable<float> CVarMvnLodPauseDelay(
+	TEXT("mvn.Lod.PauseDelay"),
+	2.f,
+	TEXT("Seconds a character is off screen before its subject is paused, it runs at reduced rate until then."));
+
+static TAutoConsoleVariable<float> CVarMvnLodMaxBlendTime(
+	TEXT("mvn.Lod.MaxBlendTime"),
+	0.25f,
+	TEXT("Longest a MVN retargeted character blends into a new frame of a throttled subject, in seconds."));
+
+namespace
+{
+	// rate a character needs, from the views of its world in the last frame
+	EMvnSubjectUpdateRate RateComponent(const UPrimitiveComponent& Component)
+	{
+		const UWorld* World = Component.GetWorld();
+		if (World == nullptr)
+		{
+			return EMvnSubjectUpdateRate::Full;
+		}
+		return FMvnSubjectUpdatePolicy::RateView(Component.Bounds, World->TimeSince(Component.GetLastRenderTime()), World->DeltaTimeSeconds,
+			World->ViewLocationsRenderedLastFrame);
+	}
+
+	const TCHAR* GetRateName(EMvnSubjectUpdateRate Rate)
+	{
+		switch (Rate)
+		{
+		case EMvnSubjectUpdateRate::Reduced:
+			return TEXT("Reduced");
+		case EMvnSubjectUpdateRate::Paused:
+			return TEXT("Paused");
+		default:
+			return TEXT("Full");
+		}
+	}
+}
+
+FMvnSubjectUpdatePolicy& FMvnSubjectUpdatePolicy::getInstance()
+{
+	static FMvnSubjectUpdatePolicy instance;
+	return instance;
+}
+
+FMvnSubjectUpdatePolicy::FMvnSubjectUpdatePolicy()
+	: bAnyThrottled(false)
+	, PushesSkipped(0)
+	, EvaluationsSkipped(0)
+	, RetargetsSkipped(0)
+	, UpdatedFrameCounter(0)
+{
+}
+
+void FMvnSubjectUpdatePolicy::Initialize()
+{
+	if (!OnWorldPreActorTickHandle.IsValid())
+	{
+		OnWorldPreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddRaw(this, &FMvnSubjectUpdatePolicy::OnWorldPreActorTick);
+		IModularFeatures::Get().RegisterModularFeature(ILiveLinkSubjectUpdateRate::GetModularFeatureName(), this);
+	}
+}
+
+void FMvnSubjectUpdatePolicy::Shutdown()
+{
+	if (OnWorldPreActorTickHandle.IsValid())
+	{
+		IModularFeatures::Get().UnregisterModularFeature(ILiveLinkSubjectUpdateRate::GetModularFeatureName(), this);
+		FWorldDelegates::OnWorldPreActorTick.Remove(OnWorldPreActorTickHandle);
+		OnWorldPreActorTickHandle.Reset();
+	}
+
+	Registrations.Empty();
+	Overrides.Empty();
+
+	FScopeLock ScopeLock(&Lock);
+	Subjects.Empty();
+	bAnyThrottled = false;
+}
+
+void FMvnSubjectUpdatePolicy::RegisterComponent(FName SubjectName, const UPrimitiveComponent* Component)
+{
+	if (Component == nullptr || SubjectName.IsNone())
+	{
+		return;
+	}
+	const bool bRegistered = Registrations.ContainsByPredicate([SubjectName, Component](const FRegistration& Registration)
+	{
+		return Registration.SubjectName == SubjectName && Registration.Component.Get() == Component;
+	});
+	if (!bRegistered)
+	{
+		Registrations.Add({ SubjectName, Component });
+	}
+}
+
+void FMvnSubjectUpdatePolicy::UnregisterComponent(FName SubjectName, const UPrimitiveComponent* Component)
+{
+	Registrations.RemoveAllSwap([SubjectName, Component](const FRegistration& Registration)
+	{
+		return Registration.SubjectName == SubjectName && Registration.Component.Get() == Component;
+	});
+}
+
+void FMvnSubjectUpdatePolicy::SetOverride(FName SubjectName, EMvnSubjectUpdateRate Rate)
+{
+	Overrides.Add(SubjectName, Rate);
+}
+
+void FMvnSubjectUpdatePolicy::ClearOverride(FName SubjectName)
+{
+	Overrides.Remove(SubjectName);
+}
+
+EMvnSubjectUpdateRate FMvnSubjectUpdatePolicy::GetRate(FName SubjectName) const
+{
+	if (!bAnyThrottled.load(std::memory_order_relaxed))
+	{
+		return EMvnSubjectUpdateRate::Full;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	const FSubjectState* State = Subjects.Find(SubjectName);
+	return State != nullptr ? State->Rate : EMvnSubjectUpdateRate::Full;
+}
+
+bool FMvnSubjectUpdatePolicy::ShouldPush(FName SubjectName, double Now)
+{
+	if (!bAnyThrottled.load(std::memory_order_relaxed))
+	{
+		return true;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	FSubjectState* State = Subjects.Find(SubjectName);
+	if (State == nullptr)
+	{
+		return true;
+	}
+	const double Interval = State->Rate == EMvnSubjectUpdateRate::Reduced ? GetReducedInterval() : GetPausedInterval();
+	if (Now - State->LastPush >= Interval)
+	{
+		State->LastPush = Now;
+		return true;
+	}
+
+	PushesSkipped.fetch_add(1, std::memory_order_relaxed);
+	INC_DWORD_STAT(STAT_MvnLodPushesSkipped);
+	return false;
+}
+
+void FMvnSubjectUpdatePolicy::AddSkippedEvaluations(int32 Count)
+{
+	EvaluationsSkipped.fetch_add(Count, std::memory_order_relaxed);
+	INC_DWORD_STAT_BY(STAT_MvnLodEvaluationsSkipped, Count);
+}
+
+void FMvnSubjectUpdatePolicy::AddSkippedRetargets(int32 Count)
+{
+	RetargetsSkipped.fetch_add(Count, std::memory_order_relaxed);
+	INC_DWORD_STAT_BY(STAT_MvnLodRetargetsSkipped, Count);
+}
+
+double FMvnSubjectUpdatePolicy::GetReducedInterval()
+{
+	return 1.0 / FMath::Max(CVarMvnLodReducedRate.GetValueOnAnyThread(), 1.f);
+}
+
+double FMvnSubjectUpdatePolicy::GetPausedInterval()
+{
+	return 1.0 / FMath::Max(CVarMvnLodPausedRate.GetValueOnAnyThread(), 0.1f);
+}
+
+double FMvnSubjectUpdatePolicy::GetMaxBlendTime()
+{
+	return FMath::Max(CVarMvnLodMaxBlendTime.GetValueOnAnyThread(), 0.f);
+}
+
+EMvnSubjectUpdateRate FMvnSubjectUpdatePolicy::RateView(const FBoxSphereBounds& Bounds, float SecondsSinceRendered, float DeltaSeconds, const TArray<FVector>& ViewLocations)
+{
+	// nothing is rendered without views, there is no telling what is visible
+	if (ViewLocations.Num() == 0)
+	{
+		return EMvnSubjectUpdateRate::Full;
+	}
+
+	// like UPrimitiveComponent::WasRecentlyRendered, a long frame doesn't count as off screen
+	const float PauseDelay = FMath::Max(CVarMvnLodPauseDelay.GetValueOnGameThread(), 0.f);
+	const float RenderedThreshold = DeltaSeconds + KINDA_SMALL_NUMBER;
+	if (SecondsSinceRendered > FMath::Max(PauseDelay, RenderedThreshold))
+	{
+		return EMvnSubjectUpdateRate::Paused;
+	}
+	if (SecondsSinceRendered > RenderedThreshold)
+	{
+		return EMvnSubjectUpdateRate::Reduced;
+	}
+
+	float NearestDistance = TNumericLimits<float>::Max();
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		NearestDistance = FMath::Min(NearestDistance, (float)FVector::Dist(ViewLocation, Bounds.Origin));
+	}
+	const float ScreenSize = Bounds.SphereRadius / FMath::Max(NearestDistance, 1.f);
+	return ScreenSize >= CVarMvnLodReducedScreenSize.GetValueOnGameThread() ? EMvnSubjectUpdateRate::Full : EMvnSubjectUpdateRate::Reduced;
+}
+
+void FMvnSubjectUpdatePolicy::OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	Update();
+}
+
+void FMvnSubjectUpdatePolicy::Update()
+{
+	// several worlds may tick in one frame, the views only change once
+	if (UpdatedFrameCounter == GFrameCounter)
+	{
+		return;
+	}
+	UpdatedFrameCounter = GFrameCounter;
+
+	UpdateRates();
+}
+
+void FMvnSubjectUpdatePolicy::UpdateRates()
+{
+	// close the counts of the frame that ended
+	FStats Stats;
+	Stats.PushesSkipped = PushesSkipped.exchange(0, std::memory_order_relaxed);
+	Stats.EvaluationsSkipped = EvaluationsSkipped.exchange(0, std::memory_order_relaxed);
+	Stats.RetargetsSkipped = RetargetsSkipped.exchange(0, std::memory_order_relaxed);
+
+	// a subject gets the rate of its most visible character
+	TMap<FName, EMvnSubjectUpdateRate> Rates;
+	Registrations.RemoveAllSwap([](const FRegistration& Registration) { return !Registration.Component.IsValid(); });
+	if (CVarMvnLodEnable.GetValueOnGameThread() != 0)
+	{
+		for (const FRegistration& Registration : Registrations)
+		{
+			const EMvnSubjectUpdateRate Rate = RateComponent(*Registration.Component.Get());
+			EMvnSubjectUpdateRate& SubjectRate = Rates.FindOrAdd(Registration.SubjectName, EMvnSubjectUpdateRate::Paused);
+			SubjectRate = FMath::Min(SubjectRate, Rate);
+		}
+	}
+	Rates.Append(Overrides);
+
+	FScopeLock ScopeLock(&Lock);
+
+	// subjects that stay throttled keep their last push time
+	TMap<FName, FSubjectState> NewSubjects;
+	for (const TPair<FName, EMvnSubjectUpdateRate>& Rate : Rates)
+	{
+		if (Rate.Value == EMvnSubjectUpdateRate::Full)
+		{
+			continue;
+		}
+		FSubjectState& State = NewSubjects.Add(Rate.Key);
+		State.Rate = Rate.Value;
+		if (const FSubjectState* OldState = Subjects.Find(Rate.Key))
+		{
+			State.LastPush = OldState->LastPush;
+		}
+		if (Rate.Value == EMvnSubjectUpdateRate::Reduced)
+		{
+			++Stats.Reduced;
+		}
+		else
+		{
+			++Stats.Paused;
+		}
+	}
+	Subjects = MoveTemp(NewSubjects);
+	bAnyThrottled = Subjects.Num() > 0;
+	LastStats = Stats;
+
+	SET_DWORD_STAT(STAT_MvnLodReduced, Stats.Reduced);
+	SET_DWORD_STAT(STAT_MvnLodPaused, Stats.Paused);
+}
+
+FMvnSubjectUpdatePolicy::FStats FMvnSubjectUpdatePolicy::GetStats() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return LastStats;
+}
+
+TMap<FName, EMvnSubjectUpdateRate> FMvnSubjectUpdatePolicy::GetThrottledSubjects() const
+{
+	TMap<FName, EMvnSubjectUpdateRate> Throttled;
+	FScopeLock ScopeLock(&Lock);
+	for (const TPair<FName, FSubjectState>& Subject : Subjects)
+	{
+		Throttled.Add(Subject.Key, Subject.Value.Rate);
+	}
+	return Throttled;
+}
+
+void UMvnSubjectUpdateLibrary::RegisterLiveLinkSubjectComponent( FName SubjectName, UPrimitiveComponent* Component )
+{
+	FMvnSubjectUpdatePolicy::getInstance().RegisterComponent( SubjectName, Component );
+}
+
+void UMvnSubjectUpdateLibrary::UnregisterLiveLinkSubjectComponent( FName SubjectName, UPrimitiveComponent* Component )
+{
+	FMvnSubjectUpdatePolicy::getInstance().UnregisterComponent( SubjectName, Component );
+}
+
+void UMvnSubjectUpdateLibrary::SetLiveLinkSubjectUpdateRate( FName SubjectName, EMvnSubjectUpdateRate Rate, bool bAutomatic )
+{
+	if ( bAutomatic )
+	{
+		FMvnSubjectUpdatePolicy::getInstance().ClearOverride( SubjectName );
+	}
+	else
+	{
+		FMvnSubjectUpdatePolicy::getInstance().SetOverride( SubjectName, Rate );
+	}
+}
+
+EMvnSubjectUpdateRate UMvnSubjectUpdateLibrary::GetLiveLinkSubjectUpdateRate( FName SubjectName )
+{
+	return FMvnSubjectUpdatePolicy::getInstance().GetRate( SubjectName );
+}
+
+namespace MvnSubjectUpdateCommands
+{
+	void LogStats(const TArray<FString>& Args)
+	{
+		const FMvnSubjectUpdatePolicy& Policy = FMvnSubjectUpdatePolicy::getInstance();
+		const FMvnSubjectUpdatePolicy::FStats Stats = Policy.GetStats();
+		UE_LOG(LogTemp, Log, TEXT("MVN update rate: %d subjects reduced, %d paused; last frame skipped %d pushes, %d evaluations, %d retargets"),
+			Stats.Reduced, Stats.Paused, Stats.PushesSkipped, Stats.EvaluationsSkipped, Stats.RetargetsSkipped);
+		for (const TPair<FName, EMvnSubjectUpdateRate>& Subject : Policy.GetThrottledSubjects())
+		{
+			UE_LOG(LogTemp, Log, TEXT("  %s: %s"), *Subject.Key.ToString(), GetRateName(Subject.Value));
+		}
+	}
+
+	void SetRate(const TArray<FString>& Args)
+	{
+		if (Args.Num() < 2)
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Lod.Set: needs a subject and Full, Reduced, Paused or Auto"));
+			return;
+		}
+
+		FMvnSubjectUpdatePolicy& Policy = FMvnSubjectUpdatePolicy::getInstance();
+		const FName SubjectName(*Args[0]);
+		if (Args[1] == TEXT("Auto"))
+		{
+			Policy.ClearOverride(SubjectName);
+		}
+		else if (Args[1] == TEXT("Full"))
+		{
+			Policy.SetOverride(SubjectName, EMvnSubjectUpdateRate::Full);
+		}
+		else if (Args[1] == TEXT("Reduced"))
+		{
+			Policy.SetOverride(SubjectName, EMvnSubjectUpdateRate::Reduced);
+		}
+		else if (Args[1] == TEXT("Paused"))
+		{
+			Policy.SetOverride(SubjectName, EMvnSubjectUpdateRate::Paused);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("mvn.Lod.Set: unknown rate %s"), *Args[1]);
+		}
+	}
+}
+
+static FAutoConsoleCommand MvnLodStatsCommand(
+	TEXT("mvn.Lod.Stats"),
+	TEXT("Log the throttled Live Link subjects and the work skipped for them in the last frame"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&MvnSubjectUpdateCommands::LogStats));
+
+static FAutoConsoleCommand MvnLodSetCommand(
+	TEXT("mvn.Lod.Set"),
+	TEXT("Fix the update rate of a Live Link subject. Args: Subject Full|Reduced|Paused|Auto"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&MvnSubjectUpdateCommands::SetRate));
@@ -0,0 +1,154 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnTelemetry.h"
+
+#if PLATFORM_LINUX
+#include <stdio.h>
+#endif
+
+DEFINE_STAT(STAT_MvnDecode);
+DEFINE_STAT(STAT_MvnPush);
+DEFINE_STAT(STAT_MvnPackets);
+DEFINE_STAT(STAT_MvnBytes);
+DEFINE_STAT(STAT_MvnActors);
+DEFINE_STAT(STAT_MvnLost);
+DEFINE_STAT(STAT_MvnDuplicates);
+DEFINE_STAT(STAT_MvnReordered);
+DEFINE_STAT(STAT_MvnFragmentsOutstanding);
+DEFINE_STAT(STAT_MvnOverflows);
+DEFINE_STAT(STAT_MvnJitterDepth);
+DEFINE_STAT(STAT_MvnLodReduced);
+DEFINE_STAT(STAT_MvnLodPaused);
+DEFINE_STAT(STAT_MvnLodPushesSkipped);
+DEFINE_STAT(STAT_MvnLodEvaluationsSkipped);
+DEFINE_STAT(STAT_MvnLodRetargetsSkipped);
+
+void FMvnLatencyCounter::Add(double Seconds)
+{
+	const int64 Microseconds = (int64)FMath::Max(Seconds * 1.0e6, 0.0);
+	SumMicroseconds.fetch_add(Microseconds, std::memory_order_relaxed);
+	Count.fetch_add(1, std::memory_order_relaxed);
+
+	int64 Max = MaxMicroseconds.load(std::memory_order_relaxed);
+	while (Microseconds > Max && !MaxMicroseconds.compare_exchange_weak(Max, Microseconds, std::memory_order_relaxed))
+	{
+	}
+}
+
+int64 FMvnLatencyCounter::Take(double& OutMean, double& OutMax)
+{
+	// a latency added in between may land in either window, close enough for telemetry
+	const int64 TakenCount = Count.exchange(0, std::memory_order_relaxed);
+	const int64 TakenSum = SumMicroseconds.exchange(0, std::memory_order_relaxed);
+	const int64 TakenMax = MaxMicroseconds.exchange(0, std::memory_order_relaxed);
+
+	OutMean = TakenCount > 0 ? TakenSum * 1.0e-6 / TakenCount : 0.0;
+	OutMax = TakenMax * 1.0e-6;
+	return TakenCount;
+}
+
+FString FMvnSourceTelemetry::ToStatusString() const
+{
+	if (WindowSeconds <= 0.0)
+	{
+		return FString::Printf(TEXT("Waiting for data on port %d"), Port);
+	}
+
+	FString Status = FString::Printf(TEXT("%d actors, %.0f pkt/s, %.0f KB/s, lost %d, dup %d, reordered %d, frag waiting %d, overflows %lld"),
+		Actors.Num(), PacketsPerSecond, BytesPerSecond / 1024.f, Lost, Duplicates, Reordered, FragmentsOutstanding, RingOverflows + FMath::Max<int64>(SocketDrops, 0));
+	Status += FString::Printf(TEXT(", decode p99 %.0f us, latency %.1f ms (max %.1f)"), DecodeP99 * 1.0e6, LatencyMean * 1.0e3, LatencyMax * 1.0e3);
+	if (PredictionError.Count > 0)
+	{
+		Status += FString::Printf(TEXT(", prediction error %.2f cm %.2f deg"), PredictionError.PositionMean, PredictionError.RotationMean);
+	}
+	return Status;
+}
+
+int64 MvnTelemetry::ReadSocketDrops(int32 Port)
+{
+#if PLATFORM_LINUX
+	// sl local_address rem_address st tx_queue:rx_queue tr:tm->when retrnsmt uid timeout inode ref pointer drops
+	int64 Drops = 0;
+	bool bFound = false;
+	for (const char* Path : { "/proc/net/udp", "/proc/net/udp6" })
+	{
+		FILE* File = fopen(Path, "r");
+		if (File == nullptr)
+		{
+			continue;
+		}
+
+		char Line[512];
+		fgets(Line, sizeof(Line), File);
+		while (fgets(Line, sizeof(Line), File) != nullptr)
+		{
+			char LocalAddress[64];
+			unsigned int LocalPort = 0;
+			unsigned long long LineDrops = 0;
+			if (sscanf(Line, " %*d: %63[0-9A-Fa-f]:%x %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %llu", LocalAddress, &LocalPort, &LineDrops) == 3 && (int32)LocalPort == Port)
+			{
+				Drops += (int64)LineDrops;
+				bFound = true;
+			}
+		}
+		fclose(File);
+	}
+	return bFound ? Drops : -1;
+#else
+	return -1;
+#endif
+}
+
+void FMvnTelemetryTraceCounters::Set(const FMvnSourceTelemetry& Telemetry)
+{
+#if COUNTERSTRACE_ENABLED
+	static const TCHAR* const Names[] =
+	{
+		TEXT("Packets per second"),
+		TEXT("KB per second"),
+		TEXT("Samples lost"),
+		TEXT("Samples duplicated"),
+		TEXT("Samples reordered"),
+		TEXT("Samples waiting for fragments"),
+		TEXT("Packets dropped on overflow"),
+		TEXT("Packet ring depth"),
+		TEXT("Jitter buffer depth"),
+		TEXT("Decode p99 (us)"),
+		TEXT("Receive to push latency (us)"),
+		TEXT("Receive to push latency max (us)"),
+	};
+
+	// registered once the port is known, a counter spec is sent again to late trace connections
+	if (CounterIds.Num() == 0 || Port != Telemetry.Port)
+	{
+		Port = Telemetry.Port;
+		CounterIds.Reset();
+		for (const TCHAR* Name : Names)
+		{
+			CounterIds.Add(FCountersTrace::OutputInitCounter(*FString::Printf(TEXT("MVN %d/%s"), Port, Name), TraceCounterType_Int, TraceCounterDisplayHint_None));
+		}
+	}
+
+	const int64 Values[] =
+	{
+		(int64)Telemetry.PacketsPerSecond,
+		(int64)(Telemetry.BytesPerSecond / 1024.f),
+		Telemetry.Lost,
+		Telemetry.Duplicates,
+		Telemetry.Reordered,
+		Telemetry.FragmentsOutstanding,
+		Telemetry.RingOverflows + FMath::Max<int64>(Telemetry.SocketDrops, 0),
+		Telemetry.RingDepthMax,
+		Telemetry.JitterDepth,
+		(int64)(Telemetry.DecodeP99 * 1.0e6),
+		(int64)(Telemetry.LatencyMean * 1.0e6),
+		(int64)(Telemetry.LatencyMax * 1.0e6),
+	};
+	static_assert(UE_ARRAY_COUNT(Names) == UE_ARRAY_COUNT(Values), "a name for every value");
+
+	for (int32 Index = 0; Index < CounterIds.Num(); ++Index)
+	{
+		FCountersTrace::OutputSetValue(CounterIds[Index], Values[Index]);
+	}
+#endif
+}
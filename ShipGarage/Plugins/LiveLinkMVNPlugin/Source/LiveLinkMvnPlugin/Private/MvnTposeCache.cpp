@@ -0,0 +1,113 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnTposeCache.h"
+
+#include "Animation/AnimSequence.h"
+#include "Animation/Skeleton.h"
+#include "Engine/SkeletalMesh.h"
+#include "Misc/ScopeLock.h"
+#include "UObject/UObjectGlobals.h"
+
+FMvnTposeCache& FMvnTposeCache::getInstance()
+{
+	static FMvnTposeCache instance;
+	return instance;
+}
+
+FMvnTposeCache::FMvnTposeCache()
+{
+}
+
+void FMvnTposeCache::Initialize()
+{
+#if WITH_EDITOR
+	if (!OnObjectPropertyChangedHandle.IsValid())
+	{
+		OnObjectPropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddLambda([this](UObject* Object, FPropertyChangedEvent&)
+		{
+			// reimporting or editing a mesh, skeleton or T-pose changes the reference pose
+			if (Object != nullptr && (Object->IsA<UAnimSequence>() || Object->IsA<USkeleton>() || Object->IsA<USkeletalMesh>()))
+			{
+				Invalidate(Object);
+			}
+		});
+	}
+#endif
+}
+
+void FMvnTposeCache::Shutdown()
+{
+#if WITH_EDITOR
+	if (OnObjectPropertyChangedHandle.IsValid())
+	{
+		FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(OnObjectPropertyChangedHandle);
+		OnObjectPropertyChangedHandle.Reset();
+	}
+#endif
+	Reset();
+}
+
+TSharedRef<const FMvnTposeBasis, ESPMode::ThreadSafe> FMvnTposeCache::FindOrAdd(const USkeletalMesh* Mesh, const USkeleton* Skeleton, const UAnimSequence* TPoseAnimation, int32 NumCompactBones,
+	const TArray<int32>& SegmentBoneIndices, TFunctionRef<void(FMvnTposeBasis&)> Build)
+{
+	FKey Key;
+	Key.Mesh = FObjectKey(Mesh);
+	Key.Skeleton = FObjectKey(Skeleton);
+	Key.TPoseAnimation = FObjectKey(TPoseAnimation);
+	Key.NumCompactBones = NumCompactBones;
+	Key.SegmentBoneIndices = SegmentBoneIndices;
+
+	FScopeLock ScopeLock(&Lock);
+
+	if (const TSharedRef<const FMvnTposeBasis, ESPMode::ThreadSafe>* Found = Entries.Find(Key))
+	{
+		return *Found;
+	}
+
+	// forget the bases of assets that were destroyed
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		const FKey& EntryKey = It.Key();
+		if ((EntryKey.Mesh != FObjectKey() && EntryKey.Mesh.ResolveObjectPtr() == nullptr)
+			|| (EntryKey.Skeleton != FObjectKey() && EntryKey.Skeleton.ResolveObjectPtr() == nullptr)
+			|| (EntryKey.TPoseAnimation != FObjectKey() && EntryKey.TPoseAnimation.ResolveObjectPtr() == nullptr))
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	// built under the lock, so instances that miss at the same time don't all sample the T-pose
+	TSharedRef<FMvnTposeBasis, ESPMode::ThreadSafe> Basis = MakeShared<FMvnTposeBasis, ESPMode::ThreadSafe>();
+	Build(*Basis);
+	Entries.Add(MoveTemp(Key), Basis);
+	return Basis;
+}
+
+void FMvnTposeCache::Invalidate(const UObject* Object)
+{
+	const FObjectKey ObjectKey(Object);
+
+	FScopeLock ScopeLock(&Lock);
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		const FKey& EntryKey = It.Key();
+		if (EntryKey.Mesh == ObjectKey || EntryKey.Skeleton == ObjectKey || EntryKey.TPoseAnimation == ObjectKey)
+		{
+			It.RemoveCurrent();
+			Generation.Increment();
+		}
+	}
+}
+
+void FMvnTposeCache::Reset()
+{
+	FScopeLock ScopeLock(&Lock);
+	Entries.Empty();
+	Generation.Increment();
+}
+
+int32 FMvnTposeCache::Num() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Entries.Num();
+}
@@ -0,0 +1,411 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "MvnXmlPullParser.h"
+
+namespace
+{
+	inline bool IsXmlWhitespace(ANSICHAR Char)
+	{
+		return Char == ' ' || Char == '\t' || Char == '\r' || Char == '\n';
+	}
+
+	inline bool IsNameEnd(ANSICHAR Char)
+	{
+		return IsXmlWhitespace(Char) || Char == '=' || Char == '/' || Char == '>';
+	}
+
+	inline ANSICHAR ToLowerAscii(ANSICHAR Char)
+	{
+		return (Char >= 'A' && Char <= 'Z') ? (ANSICHAR)(Char - 'A' + 'a') : Char;
+	}
+
+	bool EqualsIgnoreCase(FAnsiStringView A, FAnsiStringView B)
+	{
+		if (A.Len() != B.Len())
+		{
+			return false;
+		}
+		for (int32 Index = 0; Index < A.Len(); ++Index)
+		{
+			if (ToLowerAscii(A[Index]) != ToLowerAscii(B[Index]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/** Append a code point as UTF-8 */
+	void AppendUtf8(TArray<ANSICHAR, TInlineAllocator<256>>& Out, uint32 CodePoint)
+	{
+		if (CodePoint < 0x80)
+		{
+			Out.Add((ANSICHAR)CodePoint);
+		}
+		else if (CodePoint < 0x800)
+		{
+			Out.Add((ANSICHAR)(0xC0 | (CodePoint >> 6)));
+			Out.Add((ANSICHAR)(0x80 | (CodePoint & 0x3F)));
+		}
+		else if (CodePoint < 0x10000)
+		{
+			Out.Add((ANSICHAR)(0xE0 | (CodePoint >> 12)));
+			Out.Add((ANSICHAR)(0x80 | ((CodePoint >> 6) & 0x3F)));
+			Out.Add((ANSICHAR)(0x80 | (CodePoint & 0x3F)));
+		}
+		else if (CodePoint < 0x110000)
+		{
+			Out.Add((ANSICHAR)(0xF0 | (CodePoint >> 18)));
+			Out.Add((ANSICHAR)(0x80 | ((CodePoint >> 12) & 0x3F)));
+			Out.Add((ANSICHAR)(0x80 | ((CodePoint >> 6) & 0x3F)));
+			Out.Add((ANSICHAR)(0x80 | (CodePoint & 0x3F)));
+		}
+	}
+}
+
+FMvnXmlNameTable::FMvnXmlNameTable(TArrayView<const ANSICHAR* const> InNames)
+{
+	Names.Reserve(InNames.Num());
+	for (const ANSICHAR* Text : InNames)
+	{
+		Names.Add(FAnsiStringView(Text));
+	}
+
+	Slots.SetNum((int32)FMath::RoundUpToPowerOfTwo((uint32)FMath::Max(Names.Num() * 2, 8)));
+	const uint32 Mask = Slots.Num() - 1;
+	for (int32 Id = 0; Id < Names.Num(); ++Id)
+	{
+		const uint32 Hash = HashName(Names[Id]);
+		uint32 Index = Hash & Mask;
+		while (Slots[Index].Id != INDEX_NONE)
+		{
+			Index = (Index + 1) & Mask;
+		}
+		Slots[Index].Hash = Hash;
+		Slots[Index].Id = Id;
+	}
+}
+
+int32 FMvnXmlNameTable::Find(FAnsiStringView Name) const
+{
+	const uint32 Hash = HashName(Name);
+	const uint32 Mask = Slots.Num() - 1;
+	for (uint32 Index = Hash & Mask; Slots[Index].Id != INDEX_NONE; Index = (Index + 1) & Mask)
+	{
+		if (Slots[Index].Hash == Hash && EqualsIgnoreCase(Names[Slots[Index].Id], Name))
+		{
+			return Slots[Index].Id;
+		}
+	}
+	return INDEX_NONE;
+}
+
+uint32 FMvnXmlNameTable::HashName(FAnsiStringView Name)
+{
+	// FNV-1a over the lower case bytes
+	uint32 Hash = 2166136261u;
+	for (ANSICHAR Char : Name)
+	{
+		Hash = (Hash ^ (uint8)ToLowerAscii(Char)) * 16777619u;
+	}
+	return Hash;
+}
+
+FMvnXmlPullParser::FMvnXmlPullParser(const uint8* Data, int32 Length, const FMvnXmlNameTable& InNameTable)
+	: Cursor(reinterpret_cast<const ANSICHAR*>(Data))
+	, End(reinterpret_cast<const ANSICHAR*>(Data) + Length)
+	, NameTable(InNameTable)
+{
+	// a byte order mark is allowed in front of the document
+	if (Length >= 3 && Data[0] == 0xEF && Data[1] == 0xBB && Data[2] == 0xBF)
+	{
+		Cursor += 3;
+	}
+}
+
+FMvnXmlPullParser::EToken FMvnXmlPullParser::Next()
+{
+	if (bFailed)
+	{
+		return EToken::Error;
+	}
+	if (bPopDepth)
+	{
+		bPopDepth = false;
+		--Depth;
+	}
+	Value.Reset();
+
+	if (bInTag)
+	{
+		SkipWhitespace();
+		if (Cursor >= End)
+		{
+			return Fail();
+		}
+
+		if (*Cursor == '/')
+		{
+			if (Cursor + 1 >= End || Cursor[1] != '>')
+			{
+				return Fail();
+			}
+			Cursor += 2;
+			bInTag = false;
+			bPopDepth = true;
+			Name = ElementName;
+			NameId = ElementNameId;
+			return EToken::EndElement;
+		}
+
+		if (*Cursor == '>')
+		{
+			++Cursor;
+			bInTag = false;
+		}
+		else
+		{
+			Name = ReadName();
+			SkipWhitespace();
+			if (Name.IsEmpty() || Cursor >= End || *Cursor != '=')
+			{
+				return Fail();
+			}
+			++Cursor;
+			SkipWhitespace();
+			if (Cursor >= End || (*Cursor != '"' && *Cursor != '\''))
+			{
+				return Fail();
+			}
+
+			const ANSICHAR Quote = *Cursor++;
+			const ANSICHAR* ValueStart = Cursor;
+			while (Cursor < End && *Cursor != Quote)
+			{
+				++Cursor;
+			}
+			if (Cursor >= End)
+			{
+				return Fail();
+			}
+			Value = FAnsiStringView(ValueStart, (int32)(Cursor - ValueStart));
+			++Cursor;
+			NameId = NameTable.Find(Name);
+			return EToken::Attribute;
+		}
+	}
+
+	for (;;)
+	{
+		// text content is skipped
+		while (Cursor < End && *Cursor != '<')
+		{
+			++Cursor;
+		}
+		if (Cursor >= End)
+		{
+			Name.Reset();
+			NameId = INDEX_NONE;
+			return EToken::End;
+		}
+		++Cursor;
+		if (Cursor >= End)
+		{
+			return Fail();
+		}
+
+		if (*Cursor == '?')
+		{
+			if (!SkipPast("?>"))
+			{
+				return Fail();
+			}
+		}
+		else if (*Cursor == '!')
+		{
+			const bool bComment = End - Cursor >= 3 && Cursor[1] == '-' && Cursor[2] == '-';
+			if (!SkipPast(bComment ? "-->" : ">"))
+			{
+				return Fail();
+			}
+		}
+		else if (*Cursor == '/')
+		{
+			++Cursor;
+			Name = ReadName();
+			if (Name.IsEmpty() || !SkipPast(">"))
+			{
+				return Fail();
+			}
+			NameId = NameTable.Find(Name);
+			bPopDepth = true;
+			return EToken::EndElement;
+		}
+		else
+		{
+			Name = ReadName();
+			if (Name.IsEmpty())
+			{
+				return Fail();
+			}
+			NameId = NameTable.Find(Name);
+			ElementName = Name;
+			ElementNameId = NameId;
+			++Depth;
+			bInTag = true;
+			return EToken::StartElement;
+		}
+	}
+}
+
+bool FMvnXmlPullParser::ValueEquals(FAnsiStringView Text) const
+{
+	return EqualsIgnoreCase(Value, Text);
+}
+
+double FMvnXmlPullParser::GetValueAsDouble() const
+{
+	ANSICHAR Buffer[64];
+	const int32 Length = FMath::Min(Value.Len(), (int32)UE_ARRAY_COUNT(Buffer) - 1);
+	FMemory::Memcpy(Buffer, Value.GetData(), Length);
+	Buffer[Length] = 0;
+	return FCStringAnsi::Atod(Buffer);
+}
+
+uint32 FMvnXmlPullParser::GetValueAsUInt() const
+{
+	uint32 Result = 0;
+	for (ANSICHAR Char : Value)
+	{
+		if (Char < '0' || Char > '9')
+		{
+			break;
+		}
+		Result = Result * 10 + (uint32)(Char - '0');
+	}
+	return Result;
+}
+
+void FMvnXmlPullParser::GetValueAsString(FString& Out) const
+{
+	Out.Reset(Value.Len());
+
+	// plain ascii is by far the common case, copy it without any conversion
+	bool bPlain = true;
+	for (ANSICHAR Char : Value)
+	{
+		if (Char == '&' || (uint8)Char >= 0x80)
+		{
+			bPlain = false;
+			break;
+		}
+	}
+	if (bPlain)
+	{
+		for (ANSICHAR Char : Value)
+		{
+			Out.AppendChar((TCHAR)Char);
+		}
+		return;
+	}
+
+	TArray<ANSICHAR, TInlineAllocator<256>> Unescaped;
+	Unescaped.Reserve(Value.Len());
+	for (int32 Index = 0; Index < Value.Len(); ++Index)
+	{
+		const ANSICHAR Char = Value[Index];
+		if (Char != '&')
+		{
+			Unescaped.Add(Char);
+			continue;
+		}
+
+		int32 Semicolon = INDEX_NONE;
+		for (int32 Search = Index + 1; Search < Value.Len() && Search - Index <= 10; ++Search)
+		{
+			if (Value[Search] == ';')
+			{
+				Semicolon = Search;
+				break;
+			}
+		}
+		if (Semicolon == INDEX_NONE)
+		{
+			Unescaped.Add(Char);
+			continue;
+		}
+
+		const FAnsiStringView Entity = Value.Mid(Index + 1, Semicolon - Index - 1);
+		if (EqualsIgnoreCase(Entity, "amp")) { Unescaped.Add('&'); }
+		else if (EqualsIgnoreCase(Entity, "quot")) { Unescaped.Add('"'); }
+		else if (EqualsIgnoreCase(Entity, "apos")) { Unescaped.Add('\''); }
+		else if (EqualsIgnoreCase(Entity, "lt")) { Unescaped.Add('<'); }
+		else if (EqualsIgnoreCase(Entity, "gt")) { Unescaped.Add('>'); }
+		else if (Entity.Len() > 1 && Entity[0] == '#')
+		{
+			const bool bHex = Entity[1] == 'x' || Entity[1] == 'X';
+			uint32 CodePoint = 0;
+			for (ANSICHAR Digit : Entity.Mid(bHex ? 2 : 1))
+			{
+				const int32 DigitValue = FCharAnsi::IsDigit(Digit) ? Digit - '0' : (bHex && FCharAnsi::IsHexDigit(Digit) ? ToLowerAscii(Digit) - 'a' + 10 : -1);
+				if (DigitValue < 0)
+				{
+					CodePoint = 0;
+					break;
+				}
+				CodePoint = CodePoint * (bHex ? 16 : 10) + DigitValue;
+			}
+			AppendUtf8(Unescaped, CodePoint);
+		}
+		else
+		{
+			// unknown entity, keep it as it is
+			Unescaped.Append(Value.GetData() + Index, Semicolon - Index + 1);
+		}
+		Index = Semicolon;
+	}
+
+	FUTF8ToTCHAR Converted(Unescaped.GetData(), Unescaped.Num());
+	Out.AppendChars(Converted.Get(), Converted.Length());
+}
+
+FMvnXmlPullParser::EToken FMvnXmlPullParser::Fail()
+{
+	bFailed = true;
+	Name.Reset();
+	Value.Reset();
+	NameId = INDEX_NONE;
+	return EToken::Error;
+}
+
+void FMvnXmlPullParser::SkipWhitespace()
+{
+	while (Cursor < End && IsXmlWhitespace(*Cursor))
+	{
+		++Cursor;
+	}
+}
+
+bool FMvnXmlPullParser::SkipPast(FAnsiStringView Terminator)
+{
+	for (; Cursor + Terminator.Len() <= End; ++Cursor)
+	{
+		if (FMemory::Memcmp(Cursor, Terminator.GetData(), Terminator.Len()) == 0)
+		{
+			Cursor += Terminator.Len();
+			return true;
+		}
+	}
+	Cursor = End;
+	return false;
+}
+
+FAnsiStringView FMvnXmlPullParser::ReadName()
+{
+	const ANSICHAR* Start = Cursor;
+	while (Cursor < End && !IsNameEnd(*Cursor))
+	{
+		++Cursor;
+	}
+	return FAnsiStringView(Start, (int32)(Cursor - Start));
+}
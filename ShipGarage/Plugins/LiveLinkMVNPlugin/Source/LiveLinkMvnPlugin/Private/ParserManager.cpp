@@ -5,8 +5,23 @@
 #include "QuaternionDatagram.h"
 #include "ScaleDatagram.h"
 #include "MetaDatagram.h"
+#include "TimeCodeDatagram.h"
+#include "JointAnglesDatagram.h"
+#include "LinearSegmentKinematicsDatagram.h"
+#include "AngularSegmentKinematicsDatagram.h"
+#include "TrackerKinematicsDatagram.h"
+#include "CenterOfMassDatagram.h"
 
 ParserManager::ParserManager()
+	: m_quaternionDatagram(new QuaternionDatagram)
+	, m_scaleDatagram(new ScaleDatagram)
+	, m_metaDatagram(new MetaDatagram)
+	, m_timeCodeDatagram(new TimeCodeDatagram)
+	, m_jointAnglesDatagram(new JointAnglesDatagram)
+	, m_linearKinematicsDatagram(new LinearSegmentKinematicsDatagram)
+	, m_angularKinematicsDatagram(new AngularSegmentKinematicsDatagram)
+	, m_trackerKinematicsDatagram(new TrackerKinematicsDatagram)
+	, m_centerOfMassDatagram(new CenterOfMassDatagram)
 { 
 }
 
@@ -15,50 +30,64 @@ ParserManager::~ParserManager()
 {
 }
 
+/*! Return the reusable datagram for \a proto, or nullptr if the protocol is not decoded */
 Datagram* ParserManager::createDgram(StreamingProtocol proto)
 {
 	switch (proto)
 	{
 		case SPPoseQuaternion:
-			return (Datagram *)new QuaternionDatagram;
-//		case SPPoseUnity3D:
-//			return (Datagram *)new Unity3DDatagram;
-//		case SPPoseEuler:
-//			return (Datagram *)new EulerDatagram;
-//		case SPPosePositions:
-//			return (Datagram *)new PositionDatagram;
+			return m_quaternionDatagram.get();
 		case SPMetaScaling:
-			return (Datagram *)new ScaleDatagram;
+			return m_scaleDatagram.get();
 		case SPMetaMoreMeta:
-			return (Datagram *)new MetaDatagram;
-//		case SPJointAngles:
-//			return (Datagram *)new JointAnglesDatagram;
-//		case SPLinearSegmentKinematics:
-//			return (Datagram *)new LinearSegmentKinematicsDatagram;
-//		case SPAngularSegmentKinematics:
-//			return (Datagram *)new AngularSegmentKinematicsDatagram;
-//		case SPTrackerKinematics:
-//			return (Datagram *)new TrackerKinematicsDatagram;
-//		case SPCenterOfMass:
-//			return (Datagram *)new CenterOfMassDatagram;
-//		case SPTimeCode:
-//			return (Datagram *)new TimeCodeDatagram;
+			return m_metaDatagram.get();
+		case SPJointAngles:
+			return m_jointAnglesDatagram.get();
+		case SPLinearSegmentKinematics:
+			return m_linearKinematicsDatagram.get();
+		case SPAngularSegmentKinematics:
+			return m_angularKinematicsDatagram.get();
+		case SPTrackerKinematics:
+			return m_trackerKinematicsDatagram.get();
+		case SPCenterOfMass:
+			return m_centerOfMassDatagram.get();
+		case SPTimeCode:
+			return m_timeCodeDatagram.get();
 		
+		// Euler, positions and Unity3D repeat the quaternion pose, not worth decoding
 		default:
 //			UE_LOG(LogTemp, Error, TEXT("Unknown datagram: %d"), (int)proto);
 			return nullptr;
 	}	
 }
 
-/*! Read single datagram from the incoming stream */
-Datagram* ParserManager::readDatagram(const TArray<uint8_t>& data)
+/*! Read single datagram in place from the incoming buffer, received from \a sender on the port \a portIndex.
+	Fragments are collected per sender and port until their sample is complete, nullptr is returned in the meantime.
+	The returned datagram is owned by the parser and is overwritten by the next call.
+*/
+Datagram* ParserManager::readDatagram(const uint8_t* data, int32 size, const FIPv4Endpoint& sender, int32 portIndex, double receiveTime)
 {
-	StreamingProtocol type = static_cast<StreamingProtocol>(Datagram::messageType(data));
-	Datagram *datagram = createDgram(type);
+	const int type = Datagram::messageType(data, size);
+	if (type < 0)
+	{
+		return nullptr;
+	}
+
+	Datagram *datagram = createDgram(static_cast<StreamingProtocol>(type));
+	if (datagram == nullptr)
+	{
+		return nullptr;
+	}
 
-	if (datagram != nullptr) 
+	const uint8_t* sampleData = nullptr;
+	int32 sampleSize = 0;
+	if (!m_fragmentAssembler.add(data, size, sender, portIndex, receiveTime, sampleData, sampleSize))
+	{
+		return nullptr;
+	}
+
+	if (datagram->deserialize(sampleData, sampleSize))
 	{
-		datagram->deserialize(data);
 		//log to console
 //		datagram->printHeader();
 //		datagram->printData();
@@ -66,3 +95,31 @@ Datagram* ParserManager::readDatagram(const TArray<uint8_t>& data)
 	}
 	return nullptr;
 }
+
+/*! Read single datagram in place from the incoming buffer of a single, unnamed sender */
+Datagram* ParserManager::readDatagram(const uint8_t* data, int32 size, double receiveTime)
+{
+	return readDatagram(data, size, FIPv4Endpoint::Any, 0, receiveTime);
+}
+
+/*! Read single datagram in place from the incoming buffer, using the current time for fragment timeouts */
+Datagram* ParserManager::readDatagram(const uint8_t* data, int32 size)
+{
+	return readDatagram(data, size, FPlatformTime::Seconds());
+}
+
+/*! Read single datagram from the incoming stream */
+Datagram* ParserManager::readDatagram(const TArray<uint8_t>& data)
+{
+	return readDatagram(data.GetData(), data.Num());
+}
+
+FragmentAssembler& ParserManager::fragmentAssembler()
+{
+	return m_fragmentAssembler;
+}
+
+const FragmentAssembler& ParserManager::fragmentAssembler() const
+{
+	return m_fragmentAssembler;
+}
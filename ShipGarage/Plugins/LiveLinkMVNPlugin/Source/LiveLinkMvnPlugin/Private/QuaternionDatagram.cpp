@@ -32,6 +32,9 @@ QuaternionDatagram::QuaternionDatagram()
 	: Datagram()
 {
 	setType(SPPoseQuaternion);
+
+	// the datagram is reused for every packet, so reserve for the largest pose (fingers and props) once
+	m_data.reserve(SEGMENT_CAPACITY);
 }
 
 /*! Destructor */
@@ -39,15 +42,21 @@ QuaternionDatagram::~QuaternionDatagram()
 {}
 
 /*! Deserialize the data from \a arr
+	The previous content is overwritten, the storage reserved in the constructor is kept.
 	\sa serializeData
 */
-void QuaternionDatagram::deserializeData(Streamer &inputStreamer)
+bool QuaternionDatagram::deserializeData(Streamer &inputStreamer)
 {
 	Streamer* streamer = &inputStreamer;
 
+	m_data.clear();
+	if (!streamer->canRead(dataCount() * SEGMENT_SIZE))
+		return false;
+
 	for (int i = 0; i < dataCount(); i++)
 	{
-		Kinematics kin;
+		m_data.emplace_back();
+		Kinematics& kin = m_data.back();
 
 		// 4 byte
 		streamer->read(kin.segmentId);
@@ -60,9 +69,8 @@ void QuaternionDatagram::deserializeData(Streamer &inputStreamer)
 		// Store the Quaternion Rotation in a vector -> 16 byte	(4 x 4 byte) 
 		for (int k = 0; k < 4; k++)
 			streamer->read(kin.quatRotation[k]);
-
-		m_data.push_back(kin);
 	}
+	return true;
 }
 
 /*! Print Data datagram in a formated why
@@ -40,19 +40,45 @@ ScaleDatagram::~ScaleDatagram()
 }
 
 /*! Deserialize the data from \a arr
+	Entries are overwritten in place, so the segment name strings keep their storage between packets.
 	\sa serializeData
 */
-void ScaleDatagram::deserializeData(Streamer &inputStreamer)
+bool ScaleDatagram::deserializeData(Streamer &inputStreamer)
 {
 	Streamer* streamer = &inputStreamer;
 
+	m_segmentCount = 0;
+	if (!streamer->canRead(4))
+	{
+		m_data.clear();
+		return false;
+	}
+
 	streamer->read(m_segmentCount);
+
+	// every entry takes at least 16 bytes (name length and origin), don't trust a count the buffer can't hold
+	m_segmentCount = FMath::Clamp(m_segmentCount, 0, streamer->remaining() / 16);
+	m_data.resize(m_segmentCount);
+
 	for (int i = 0; i < m_segmentCount; i++)
 	{
-		Scaling scale;
+		Scaling& scale = m_data[i];
 
 		// 4 byte
+		if (!streamer->canRead(4))
+		{
+			// truncated datagram, only keep the complete segments
+			m_segmentCount = i;
+			m_data.resize(i);
+			return false;
+		}
 		streamer->read(scale.segmentNameLength);
+		if (scale.segmentNameLength < 0 || !streamer->canRead(scale.segmentNameLength + 12))
+		{
+			m_segmentCount = i;
+			m_data.resize(i);
+			return false;
+		}
 		streamer->read(scale.segmentName, scale.segmentNameLength);
 
 		// Store the Sensor Position in a Vector -> 12 byte	(3 x 4 byte)
@@ -63,15 +89,8 @@ void ScaleDatagram::deserializeData(Streamer &inputStreamer)
 		// Store the Quaternion Rotation in a vector -> 16 byte	(4 x 4 byte) 
 	/*	for (int k = 0; k < 4; k++)
 			streamer->read(kin.quatRotation[k]);*/
-
-		m_data.push_back(scale);
-	}
-	if (!m_data.empty())
-	{
-		FString spook = m_data.at(0).segmentName.c_str();
-		//read points if needed
-		//UE_LOG(LogTemp, Warning, TEXT("SEG[%d]: %s"), m_data.at(0).segmentNameLength, *spook);// m_data.at(0).segmentName);// , m_data.at(0).segmentOriginPos[0].toString()); // Pos:%s   Rot:%s , m_data.at(i).sensorPos.ToString(), m_data.at(i).quatRotation.ToString()
 	}
+	return true;
 }
 
 /*! Print Data datagram in a formated why
@@ -3,144 +3,127 @@
 #include "Streamer.h"
 
 /*!
-	Intel processors use "Little Endian" byte order:
-
-	Base_Address+0 Byte0
-	Base_Address+1 Byte1
-	Base_Address+2 Byte2
-	Base_Address+3 Byte3
-
-	-------------------------
-	"Big Endian" :
+	MVN streams every numeric field in network byte order ("Big Endian"):
 
 	Base_Address+0 Byte3
 	Base_Address+1 Byte2
 	Base_Address+2 Byte1
 	Base_Address+3 Byte0
+
+	The values are assembled directly from the bytes with shifts, which gives the
+	right result on both little and big endian hosts without a temporary copy.
 */
 
+Streamer::Streamer(const uint8_t* data, int32 size)
+	: m_data(data)
+	, m_size(size)
+	, m_offset(0)
+{
+}
+
 Streamer::Streamer(const TArray<uint8_t>& arr)
-	: m_offset(0)
+	: Streamer(arr.GetData(), arr.Num())
 {
-	// reference to the real data
-	m_array = &arr;
-
-	// check Endianess
-	int num = 1;
-	if(*(char *)&num == 1)
-	{
-		m_endianess = Little_Endian;
-	}
-	else
-	{
-		m_endianess = Big_Endian;
-	}
 }
 
 /*! Destructor */
-Streamer::~Streamer() 
+Streamer::~Streamer()
 {
 }
 
-/*! Extract 4 byte from the ByteArray and Store the value into a int32_t (4 byte) variable */
+/*! Extract 4 byte from the buffer and Store the value into a int32_t (4 byte) variable */
 void Streamer::read(int32_t &destination)
 {
-	char byte_array[4];
-
-	// copy part of the original byte array into a temp array 
-	memcpy(byte_array, m_array->GetData()+m_offset, sizeof(destination));
-
-	if (m_endianess == Little_Endian)
-		destination = byte_array[0] << 24 | (byte_array[1] & 0xff) << 16 | (byte_array[2] & 0xff) << 8| (byte_array[3] & 0xff);
-	else
-		destination = byte_array[3] << 24 | (byte_array[2] & 0xff) << 16 | (byte_array[1] & 0xff) << 8| (byte_array[0] & 0xff);
+	const uint8_t* p = m_data + m_offset;
+	destination = (int32_t)((uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3]);
 
 	// increase the index
 	m_offset += 4;
 }
 
-/*! Extract 1 byte from the ByteArray and Store the value into a int8_t (1 byte) variable */
+/*! Extract 1 byte from the buffer and Store the value into a int8_t (1 byte) variable */
 void Streamer::read(int8_t &destination)
 {
-	int8_t res;
-
-	memcpy(&res, m_array->GetData()+m_offset, 1);
-	destination = (int)res & 0xFF;
+	destination = (int8_t)m_data[m_offset];
 
 	// increase the index
 	m_offset++;
 }
 
-/*! Extract 2 byte from the ByteArray and Store the value into a int16_t (2 byte) variable */
+/*! Extract 2 byte from the buffer and Store the value into a int16_t (2 byte) variable */
 void Streamer::read(int16_t &destination)
 {
-	char byte_array[2];
-
-	// copy part of the original byte array into a temp array 
-	memcpy(byte_array, m_array->GetData()+m_offset, 2);
+	const uint8_t* p = m_data + m_offset;
+	destination = (int16_t)((uint16_t)p[0] << 8 | (uint16_t)p[1]);
 
-	if (m_endianess == Little_Endian)
-		destination = 0x00 << 24 | 0x00 << 16 | (byte_array[0] & 0xff) << 8 | (byte_array[1] & 0xff);
-	else
-		destination = 0x00 << 24 | 0x00 << 16 | (byte_array[1] & 0xff) << 8 | (byte_array[0] & 0xff);
-	
 	// increase the index
 	m_offset += 2;
 }
 
-/*! Extract 1 byte from the ByteArray and Store the value into a uint8_t (1 byte) variable */
+/*! Extract 1 byte from the buffer and Store the value into a uint8_t (1 byte) variable */
 void Streamer::read(uint8_t &destination)
 {
-	uint8_t res;
-
-	memcpy(&res, m_array->GetData()+m_offset, 1);
-	destination = (int)res & 0xFF;
+	destination = m_data[m_offset];
 
 	// increase the index
 	m_offset++;
 }
 
-/*! Extract 4 byte from the ByteArray and Store the value into a float (4 byte) variable */
+/*! Extract 4 byte from the buffer and Store the value into a float (4 byte) variable */
 void Streamer::read(float &destination)
 {
-	float output = 0.0;
-
-	unsigned char byte_array[4];
-	// copy part of the original byte array into a temp array 
-	memcpy(&byte_array, m_array->GetData()+m_offset, sizeof(destination));
-
-	if (m_endianess == Little_Endian)
-	{
-		*((unsigned char*)(&output) + 3) = byte_array[0];
-		*((unsigned char*)(&output) + 2) = byte_array[1];
-		*((unsigned char*)(&output) + 1) = byte_array[2];
-		*((unsigned char*)(&output) + 0) = byte_array[3];
-	}
-	else
-	{
-		*((unsigned char*)(&output) + 3) = byte_array[3];
-		*((unsigned char*)(&output) + 2) = byte_array[2];
-		*((unsigned char*)(&output) + 1) = byte_array[1];
-		*((unsigned char*)(&output) + 0) = byte_array[0];
-	}
-
-	destination = output; 
+	const uint8_t* p = m_data + m_offset;
+	const uint32_t bits = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
+
+	// reinterpret the bits, the compiler turns this into a register move
+	FMemory::Memcpy(&destination, &bits, sizeof(destination));
 
 	// increase the index
 	m_offset += 4;
 }
 
-/*! Extract "size" byte from the ByteArray and Store the value into a string variable */
+/*! Extract "size" byte from the buffer and Store the value into a string variable.
+	The string keeps its capacity, so reading into the same string again does not allocate.
+*/
 void Streamer::read(std::string& str, int numChars)
 {
-	char * buffer = new char[numChars + 1];
+	str.assign(reinterpret_cast<const char*>(m_data + m_offset), numChars);
 
-	memcpy(buffer, m_array->GetData()+m_offset, numChars);
-	buffer[numChars] = '\0';
+	// increase the index
+	m_offset += numChars;
+}
 
-	str = buffer;
-	delete[] buffer;
+/*! Return a pointer to the next "numChars" bytes without copying them. The text is not null terminated. */
+const char* Streamer::readChars(int numChars)
+{
+	const char* chars = reinterpret_cast<const char*>(m_data + m_offset);
 
 	// increase the index
 	m_offset += numChars;
+	return chars;
+}
+
+/*! Skip "numBytes" bytes of the buffer */
+void Streamer::skip(int numBytes)
+{
+	m_offset += numBytes;
+}
+
+/*! True if at least "numBytes" bytes are left to read */
+bool Streamer::canRead(int numBytes) const
+{
+	// compared against what is left, m_offset + numBytes overflows for lengths read from a malformed packet
+	return numBytes >= 0 && numBytes <= m_size - m_offset;
+}
+
+/*! Current read position in bytes */
+int Streamer::offset() const
+{
+	return m_offset;
+}
+
+/*! Number of bytes left to read */
+int Streamer::remaining() const
+{
+	return m_size - m_offset;
 }
@@ -0,0 +1,78 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "TimeCodeDatagram.h"
+
+namespace
+{
+	/*! Parse \a count decimal digits, returns -1 if any character is not a digit */
+	int parseDigits(const char* text, int count)
+	{
+		int value = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			if (text[i] < '0' || text[i] > '9')
+				return -1;
+			value = value * 10 + (text[i] - '0');
+		}
+		return value;
+	}
+}
+
+ /*! Constructor */
+TimeCodeDatagram::TimeCodeDatagram()
+	: Datagram()
+	, m_hours(0)
+	, m_minutes(0)
+	, m_seconds(0)
+	, m_milliseconds(0)
+{
+	setType(SPTimeCode);
+}
+
+/*! Destructor */
+TimeCodeDatagram::~TimeCodeDatagram()
+{
+
+}
+
+/*! Deserialize the data from \a arr
+	The string is parsed in place, a malformed time code rejects the datagram.
+	\sa serializeData
+*/
+bool TimeCodeDatagram::deserializeData(Streamer& inputStreamer)
+{
+	static const int TIMECODE_LENGTH = 12;
+
+	if (!inputStreamer.canRead(TIMECODE_LENGTH))
+		return false;
+
+	const char* text = inputStreamer.readChars(TIMECODE_LENGTH);
+	if (text[2] != ':' || text[5] != ':' || text[8] != '.')
+		return false;
+
+	const int hours = parseDigits(text, 2);
+	const int minutes = parseDigits(text + 3, 2);
+	const int seconds = parseDigits(text + 6, 2);
+	const int milliseconds = parseDigits(text + 9, 3);
+	if (hours < 0 || minutes < 0 || seconds < 0 || milliseconds < 0)
+		return false;
+
+	m_hours = hours;
+	m_minutes = minutes;
+	m_seconds = seconds;
+	m_milliseconds = milliseconds;
+	return true;
+}
+
+double TimeCodeDatagram::seconds() const
+{
+	return m_hours * 3600.0 + m_minutes * 60.0 + m_seconds + m_milliseconds / 1000.0;
+}
+
+/*! Print Data datagram in a formated why
+*/
+void TimeCodeDatagram::printData() const
+{
+	std::cout << "*********************** DATA CONTENT ***********************" << std::endl << std::endl;
+	std::cout << "Time code: " << m_hours << ":" << m_minutes << ":" << m_seconds << "." << m_milliseconds << std::endl;
+}
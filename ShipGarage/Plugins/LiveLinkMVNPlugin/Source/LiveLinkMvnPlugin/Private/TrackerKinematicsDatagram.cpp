@@ -0,0 +1,84 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "TrackerKinematicsDatagram.h"
+
+/*! \class TrackerKinematicsDatagram
+  \brief a motion tracker kinematics datagram (type 23)
+
+  Information about each tracker is sent as follows.
+
+  4 bytes ID of the segment the tracker is attached to
+  16 bytes tracker orientation quaternion (re, i, j, k)
+  12 bytes free acceleration in m/s2, gravity removed
+  12 bytes magnetic field in a.u.
+
+  Total: 44 bytes per tracker
+
+  The coordinates use a Z-Up, right-handed coordinate system.
+ */
+
+/*! Constructor */
+TrackerKinematicsDatagram::TrackerKinematicsDatagram()
+	: Datagram()
+{
+	setType(SPTrackerKinematics);
+
+	// the datagram is reused for every packet, so reserve for the largest item count once
+	m_data.reserve(TRACKER_CAPACITY);
+}
+
+/*! Destructor */
+TrackerKinematicsDatagram::~TrackerKinematicsDatagram()
+{}
+
+/*! Deserialize the data from \a arr
+	The previous content is overwritten, the storage reserved in the constructor is kept.
+	\sa serializeData
+*/
+bool TrackerKinematicsDatagram::deserializeData(Streamer &inputStreamer)
+{
+	Streamer* streamer = &inputStreamer;
+
+	m_data.clear();
+	if (!streamer->canRead(dataCount() * TRACKER_SIZE))
+		return false;
+
+	for (int i = 0; i < dataCount(); i++)
+	{
+		m_data.emplace_back();
+		Kinematics& item = m_data.back();
+
+		// 4 bytes ID of the segment the tracker is attached to
+		streamer->read(item.segmentId);
+
+		// 16 bytes tracker orientation quaternion (re, i, j, k)
+		for (int k = 0; k < 4; k++)
+			streamer->read(item.quatRotation[k]);
+
+		// 12 bytes free acceleration in m/s2, gravity removed
+		for (int k = 0; k < 3; k++)
+			streamer->read(item.freeAcceleration[k]);
+
+		// 12 bytes magnetic field in a.u.
+		for (int k = 0; k < 3; k++)
+			streamer->read(item.magneticField[k]);
+	}
+	return true;
+}
+
+/*! Print Data datagram in a formated why
+*/
+void TrackerKinematicsDatagram::printData() const
+{
+	std::cout << "*********************** DATA CONTENT ***********************" <<  std::endl <<  std::endl;
+
+	for (int i = 0; i < (int)m_data.size(); i++)
+	{
+		const Kinematics& item = m_data.at(i);
+		std::cout << "Segment ID: " << item.segmentId << std::endl;
+		std::cout << "Quaternion Rotation: (" << item.quatRotation[0] << ", " << item.quatRotation[1] << ", " << item.quatRotation[2] << ", " << item.quatRotation[3] << ")" << std::endl;
+		std::cout << "Free Acceleration: (" << item.freeAcceleration[0] << ", " << item.freeAcceleration[1] << ", " << item.freeAcceleration[2] << ")" << std::endl;
+		std::cout << "Magnetic Field: (" << item.magneticField[0] << ", " << item.magneticField[1] << ", " << item.magneticField[2] << ")" << std::endl;
+		std::cout << std::endl;
+	}
+}
@@ -0,0 +1,35 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#ifndef ANGULARSEGMENTKINEMATICSDATAGRAM_H
+#define ANGULARSEGMENTKINEMATICSDATAGRAM_H
+
+#include "Datagram.h"
+
+class AngularSegmentKinematicsDatagram : public Datagram 
+{
+public:
+	AngularSegmentKinematicsDatagram();
+	virtual ~AngularSegmentKinematicsDatagram();
+	virtual void printData() const override;
+
+protected:
+	virtual bool deserializeData(Streamer &inputStreamer) override;
+	
+public:
+	struct Kinematics 
+	{
+		int segmentId;
+		float quatRotation[4];
+		float angularVelocity[3];
+		float angularAcceleration[3];
+	};
+	std::vector<Kinematics> m_data;
+
+	/*! Bytes per segment in the data part */
+	static const int SEGMENT_SIZE = 44;
+
+	/*! Number of segments reserved up front, the item count in the header is an 8 bit value */
+	static const int SEGMENT_CAPACITY = 255;
+};
+
+#endif
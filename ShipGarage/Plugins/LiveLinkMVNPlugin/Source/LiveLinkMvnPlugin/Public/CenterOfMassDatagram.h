@@ -0,0 +1,27 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#ifndef CENTEROFMASSDATAGRAM_H
+#define CENTEROFMASSDATAGRAM_H
+
+#include "Datagram.h"
+
+class CenterOfMassDatagram : public Datagram 
+{
+public:
+	CenterOfMassDatagram();
+	virtual ~CenterOfMassDatagram();
+	virtual void printData() const override;
+
+protected:
+	virtual bool deserializeData(Streamer &inputStreamer) override;
+	
+public:
+	float m_position[3];
+	float m_velocity[3];
+	float m_acceleration[3];
+
+	/*! False for older MVN versions that only send the position, velocity and acceleration are zero then */
+	bool m_hasDerivatives;
+};
+
+#endif
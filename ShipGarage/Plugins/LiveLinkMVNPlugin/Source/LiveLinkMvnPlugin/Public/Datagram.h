@@ -39,6 +39,7 @@ public:
 	Datagram();
 	virtual ~Datagram();
 
+	bool deserialize(const uint8_t* data, int32 size);
 	bool deserialize(const TArray<uint8_t>& arr);
 	void setDataCount(uint8_t c);
 	void setType(StreamingProtocol proto);
@@ -52,8 +53,12 @@ public:
 	uint8_t propCount() const;
 	uint8_t fingerTrackingSegmentCount() const;
 
+	static int messageType(const uint8_t* data, int32 size);
 	static int messageType(const TArray<uint8_t>& arr);
-	std::string decode(StreamingProtocol proto) const;
+	static const char* decode(StreamingProtocol proto);
+
+	/*! Size in bytes of the header that precedes the data of every datagram */
+	static const int HEADER_SIZE = 24;
 
 	void convertFromYupToZup(float *vector) const;
 
@@ -61,11 +66,11 @@ public:
 	virtual void printData() const = 0;
 	
 protected:
-	virtual void deserializeData(Streamer &inputStreamer) = 0;
+	virtual bool deserializeData(Streamer &inputStreamer) = 0;
 	static const float EULERPOSITIONSCALE;
 
 private:
-	std::string m_header;
+	StreamingProtocol m_type;
 	int32_t m_sampleCounter;
 	int32_t m_frameTime;
 	uint8_t m_avatarId;
@@ -77,8 +82,6 @@ private:
 	int m_dataSize;
 
 	int getDataSize() const;
-	void initMap(std::map<int, std::string> &map);
-	std::map<int, std::string> m_packetsName;
 };
 
 #endif
@@ -0,0 +1,55 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#ifndef DATAGRAMWRITER_H
+#define DATAGRAMWRITER_H
+
+#include "CoreMinimal.h"
+#include "Datagram.h"
+
+/*! Writes MVN datagrams the way MVN streams them, the counterpart of Streamer and the datagram classes.
+	Used by the mock server and the benchmarks; numeric fields are written big-endian.
+*/
+class DatagramWriter
+{
+public:
+	/*! Appends to \a out */
+	DatagramWriter(TArray<uint8_t>& out);
+
+	void write(int32_t value);
+	void write(uint8_t value);
+	void write(float value);
+	void writeChars(const char* text, int numChars);
+
+	/*! The 24 byte header, see Datagram::deserialize */
+	void writeHeader(StreamingProtocol proto, int32_t sampleCounter, uint8_t datagramCounter, uint8_t itemCount, int32_t frameTime,
+		uint8_t avatarId, uint8_t bodySegmentCount, uint8_t propCount, uint8_t fingerTrackingSegmentCount);
+
+	/*! One segment of a quaternion pose datagram (type 02), position in meters, rotation as w x y z */
+	void writeQuaternionSegment(int32_t segmentId, const float position[3], const float rotation[4]);
+
+	/*! One segment of a scale datagram (type 13), origin in meters */
+	void writeScaleSegment(const char* segmentName, const float origin[3]);
+
+	/*! The data of a meta datagram (type 12), lines of "key:value" */
+	void writeMetaText(const char* text, int numChars);
+
+	/*! The data of a time code datagram (type 25) */
+	void writeTimeCode(int hours, int minutes, int seconds, int milliseconds);
+
+	/*! Overwrite the sample counter of a written datagram */
+	static void patchSampleCounter(uint8_t* datagram, int32_t sampleCounter);
+
+	/*! Split a datagram whose data is a list of \a itemSize byte items into packets of at most \a maxPacketSize bytes,
+		each with a copy of the header, its fragment index in the datagram counter and its number of items.
+		A datagram that fits is returned as one packet. Returns the number of packets, 0 if an item doesn't fit.
+	*/
+	static int fragment(const uint8_t* data, int32 size, int itemSize, int maxPacketSize, TArray<TArray<uint8_t>>& outPackets);
+
+	/*! Size in bytes of a segment of a quaternion pose datagram */
+	static const int QUATERNION_SEGMENT_SIZE = 32;
+
+private:
+	TArray<uint8_t>& m_out;
+};
+
+#endif
@@ -0,0 +1,105 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#ifndef FRAGMENTASSEMBLER_H
+#define FRAGMENTASSEMBLER_H
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+
+/*! Joins MVN datagrams that were split over several UDP packets.
+
+	Fragments of one sample come from the same sender to the same port, share the message type,
+	avatar id and sample counter, and carry their index in the low 7 bits of the datagram counter, the last one having bit 0x80 set.
+	The assembler holds a fixed number of pending samples in preallocated slots, so memory is
+	bounded no matter how many fragments are lost. Samples that are not completed within the
+	timeout, or that are evicted to make room for newer ones, are counted as incomplete.
+
+	add() is called from a single thread, the counters can be read from any thread.
+*/
+class FragmentAssembler
+{
+public:
+	struct Stats
+	{
+		/*! Fragments received, not counting unfragmented datagrams */
+		int32 fragmentsReceived = 0;
+		/*! Samples completed from several fragments */
+		int32 reassembledSamples = 0;
+		/*! Fragments thrown away: duplicates, late arrivals, malformed or too large */
+		int32 droppedFragments = 0;
+		/*! Samples given up on because fragments were missing after the timeout or eviction */
+		int32 incompleteSamples = 0;
+		/*! Samples currently waiting for more fragments */
+		int32 pendingSamples = 0;
+	};
+
+	/*! Highest number of fragments per sample the assembler accepts */
+	static const int MAX_FRAGMENTS = 32;
+
+	FragmentAssembler(int slotCount = 8, int slotCapacity = 16 * 1024, double timeoutSeconds = 0.1);
+	~FragmentAssembler();
+
+	/*! Add a datagram received from \a sender on the source's port \a portIndex.
+		Returns true when a complete datagram is available in \a outData / \a outSize: either the
+		input itself when it was not fragmented, or the reassembled sample, which stays valid until
+		the next call. Returns false while a sample is still waiting for fragments.
+	*/
+	bool add(const uint8_t* data, int32 size, const FIPv4Endpoint& sender, int32 portIndex, double now, const uint8_t*& outData, int32& outSize);
+
+	/*! Give up on samples older than the timeout */
+	void expire(double now);
+
+	/*! Drop all pending samples without counting them */
+	void reset();
+
+	Stats getStats() const;
+
+	void setTimeout(double timeoutSeconds);
+
+private:
+	struct Slot
+	{
+		bool used = false;
+		bool completed = false;
+		FIPv4Endpoint sender;
+		int32 portIndex = 0;
+		uint8_t messageType[2] = { 0, 0 };
+		uint8_t avatarId = 0;
+		int32_t sampleCounter = 0;
+		double firstArrival = 0.0;
+
+		// one bit per fragment index received, and the index of the last fragment once known
+		uint32_t receivedMask = 0;
+		int lastIndex = -1;
+
+		// the header of the first fragment is used for the joined datagram
+		uint8_t header[24];
+		bool hasHeader = false;
+
+		// fragment payloads are stored in arrival order
+		int fragmentOffset[MAX_FRAGMENTS];
+		int fragmentSize[MAX_FRAGMENTS];
+		uint8_t fragmentItems[MAX_FRAGMENTS];
+		int usedBytes = 0;
+		TArray<uint8_t> payload;
+	};
+
+	Slot* findSlot(const uint8_t* data, int32_t sampleCounter, const FIPv4Endpoint& sender, int32 portIndex);
+	Slot* claimSlot(double now);
+	void release(Slot& slot, bool countIncomplete);
+	bool join(Slot& slot);
+
+	TArray<Slot> m_slots;
+	TArray<uint8_t> m_output;
+	int m_slotCapacity;
+	double m_timeout;
+
+	FThreadSafeCounter m_fragmentsReceived;
+	FThreadSafeCounter m_reassembledSamples;
+	FThreadSafeCounter m_droppedFragments;
+	FThreadSafeCounter m_incompleteSamples;
+	FThreadSafeCounter m_pendingSamples;
+};
+
+#endif
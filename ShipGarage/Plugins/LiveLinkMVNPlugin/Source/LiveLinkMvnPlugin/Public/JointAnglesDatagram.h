@@ -0,0 +1,34 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#ifndef JOINTANGLESDATAGRAM_H
+#define JOINTANGLESDATAGRAM_H
+
+#include "Datagram.h"
+
+class JointAnglesDatagram : public Datagram 
+{
+public:
+	JointAnglesDatagram();
+	virtual ~JointAnglesDatagram();
+	virtual void printData() const override;
+
+protected:
+	virtual bool deserializeData(Streamer &inputStreamer) override;
+	
+public:
+	struct Joint 
+	{
+		int parentConnection;
+		int childConnection;
+		float rotation[3];
+	};
+	std::vector<Joint> m_data;
+
+	/*! Bytes per joint in the data part */
+	static const int JOINT_SIZE = 20;
+
+	/*! Number of joints reserved up front, the item count in the header is an 8 bit value */
+	static const int JOINT_CAPACITY = 255;
+};
+
+#endif
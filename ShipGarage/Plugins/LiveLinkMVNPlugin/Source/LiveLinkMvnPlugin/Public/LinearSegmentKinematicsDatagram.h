@@ -0,0 +1,35 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#ifndef LINEARSEGMENTKINEMATICSDATAGRAM_H
+#define LINEARSEGMENTKINEMATICSDATAGRAM_H
+
+#include "Datagram.h"
+
+class LinearSegmentKinematicsDatagram : public Datagram 
+{
+public:
+	LinearSegmentKinematicsDatagram();
+	virtual ~LinearSegmentKinematicsDatagram();
+	virtual void printData() const override;
+
+protected:
+	virtual bool deserializeData(Streamer &inputStreamer) override;
+	
+public:
+	struct Kinematics 
+	{
+		int segmentId;
+		float segmentPos[3];
+		float velocity[3];
+		float acceleration[3];
+	};
+	std::vector<Kinematics> m_data;
+
+	/*! Bytes per segment in the data part */
+	static const int SEGMENT_SIZE = 40;
+
+	/*! Number of segments reserved up front, the item count in the header is an 8 bit value */
+	static const int SEGMENT_CAPACITY = 255;
+};
+
+#endif
@@ -4,7 +4,17 @@
 
 #include "Misc/Guid.h"
 #include "LiveLinkTypes.h"
+#include "HAL/CriticalSection.h"
 
+#include <atomic>
+
+/**
+ * Segment layout of the MVN subjects, written by the receiver threads and read by the game thread and the editor.
+ *
+ * Readers see an immutable snapshot and never lock. Writers only publish a new snapshot when a subject's layout
+ * actually changes; the pose path, which reports the segment count of every pose, normally returns after a lookup.
+ * A replaced snapshot is freed once no reader is inside the service.
+ */
 class LIVELINKMVNPLUGIN_API FLiveLinkMvnMetadataService {
 
 public:
@@ -17,19 +27,63 @@ public:
 
 	static FLiveLinkMvnMetadataService& getInstance();
 
+	~FLiveLinkMvnMetadataService();
+
 	void SetSegmentCount(FGuid SourceId, const FLiveLinkSubjectName& AvatarId, int SegmentsCount);
 	void SetSegmentNames(FGuid SourceId, const FLiveLinkSubjectName& AvatarId, const TArray<FString>& SegmentNames);
 
-	int32 GetSegmentsCount(FGuid SourceId, const FLiveLinkSubjectName& AvatarId);
+	/** Forget a subject that expired or was renamed */
+	void RemoveSubject(FGuid SourceId, const FLiveLinkSubjectName& AvatarId);
+
+	/** Forget the subjects of a source that went away */
+	void RemoveSource(FGuid SourceId);
+
+	int32 GetSegmentsCount(FGuid SourceId, const FLiveLinkSubjectName& AvatarId) const;
 	bool GetSegmentNames(FGuid SourceId, const FLiveLinkSubjectName& AvatarId, TArray<FText>& OutSegmentNames) const;
 	bool HasSegmentNames(FGuid SourceId, const FLiveLinkSubjectName& AvatarId) const;
 
+	/** Changes with every published snapshot, for readers that cache what they read */
+	int32 GetVersion() const;
+
 protected:
 
 	FLiveLinkMvnMetadataService();
 
-	typedef TMap<FLiveLinkSubjectName, FSubjectMetadata> FSourceMetadata;
-	TMap<FGuid, FSourceMetadata> Metadata;
+	typedef TSharedRef<const FSubjectMetadata, ESPMode::ThreadSafe> FSubjectMetadataRef;
+
+	/** Immutable once published, unchanged subjects are shared with the previous snapshot */
+	struct FSnapshot
+	{
+		int32 Version = 0;
+		TMap<FLiveLinkSubjectKey, FSubjectMetadataRef> Subjects;
+	};
+
+	/** Counts a reader in for its lifetime, so the snapshot it loaded stays alive */
+	class FReadScope
+	{
+	public:
+		explicit FReadScope(const FLiveLinkMvnMetadataService& InService);
+		~FReadScope();
+
+		const FSnapshot& Get() const { return *Snapshot; }
+
+	private:
+		const FLiveLinkMvnMetadataService& Service;
+		const FSnapshot* Snapshot;
+	};
+
+	static const FSubjectMetadata* Find(const FSnapshot& Snapshot, FGuid SourceId, const FLiveLinkSubjectName& AvatarId);
+
+	/** Publish a copy of the current snapshot with Subject replaced, under WriteLock */
+	void PublishSubject(const FLiveLinkSubjectKey& Key, FSubjectMetadata&& Subject);
+
+	/** Make NewSnapshot current and free the replaced ones no reader can see anymore, under WriteLock */
+	void Publish(FSnapshot* NewSnapshot);
+
+	std::atomic<FSnapshot*> Current;
+	mutable std::atomic<int32> ActiveReaders;
 
-	void EnsureMetadata(FGuid SourceId, const FLiveLinkSubjectName& AvatarId);
-};
\ No newline at end of file
+	/** Serializes writers, guards Retired */
+	FCriticalSection WriteLock;
+	TArray<FSnapshot*> Retired;
+};
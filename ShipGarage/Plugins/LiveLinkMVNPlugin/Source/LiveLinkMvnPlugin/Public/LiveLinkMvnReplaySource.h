@@ -0,0 +1,61 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "LiveLinkMvnSource.h"
+#include "Engine/EngineTypes.h"
+#include "MvnCaptureFile.h"
+
+#include "LiveLinkMvnReplaySource.generated.h"
+
+/** Settings of a source that replays a capture */
+UCLASS()
+class ULiveLinkMvnReplaySourceSettings : public ULiveLinkMvnSourceSettings
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Capture recorded by an MVN source */
+	UPROPERTY( EditAnywhere, Category = "Replay", meta = ( FilePathFilter = "mvncap" ) )
+	FFilePath CaptureFile;
+
+	/** Replay speed relative to the recording, 0 replays as fast as possible */
+	UPROPERTY( EditAnywhere, Category = "Replay", meta = ( ClampMin = "0" ) )
+	float ReplaySpeed = 1.f;
+
+	/** Start over at the end of the capture */
+	UPROPERTY( EditAnywhere, Category = "Replay" )
+	bool bLoop = true;
+};
+
+/**
+ * Feeds the datagrams of a capture through the decode, jitter buffer and push path of FLiveLinkMvnSource,
+ * at the recorded timing or as fast as possible. Subjects are named after the port the capture was recorded on,
+ * so retarget assets set up for the live source pick them up.
+ */
+class LIVELINKMVNPLUGIN_API FLiveLinkMvnReplaySource : public FLiveLinkMvnSource
+{
+public:
+
+	FLiveLinkMvnReplaySource(const FString& InFilename, float InSpeed, bool bInLoop);
+	virtual ~FLiveLinkMvnReplaySource();
+
+	virtual void InitializeSettings( ULiveLinkSourceSettings* Settings ) override;
+	virtual TSubclassOf<ULiveLinkSourceSettings> GetSettingsClass() const override;
+	virtual bool IsSourceStillValid() const override;
+	virtual FText GetSourceType() const override
+	{
+		return FText::FromString(TEXT("MVN Replay"));
+	}
+
+	virtual uint32 Run() override;
+
+private:
+
+	FString Filename;
+	float Speed;
+	bool bLoop;
+
+	FMvnCaptureReader Reader;
+};
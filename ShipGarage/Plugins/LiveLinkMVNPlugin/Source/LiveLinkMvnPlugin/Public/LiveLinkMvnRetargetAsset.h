@@ -6,10 +6,14 @@
 #include "LiveLinkRemapAsset.h"
 #include "UObject/ObjectMacros.h"
 #include "XsensMappingEnum.h"
+#include "MvnTposeCache.h"
+#include "MvnSegmentKernel.h"
+#include "MvnSubjectUpdatePolicy.h"
 #include "LiveLinkMvnRetargetAsset.generated.h"
 
 class UAnimSequence;
 class USkeletalMesh;
+struct FBoneContainer;
 class USkeleton;
 
 USTRUCT(BlueprintType)
@@ -65,6 +69,18 @@ public:
 
 	FName GetRemappedBoneName(const FName& BoneName) const;
 
+	// Retarget the rotations of InFrameData ahead of the evaluation, called by FMvnRetargetScheduler on a worker thread
+	void PrepareRetarget(const FLiveLinkAnimationFrameData& InFrameData);
+
+	// True if the scheduler prepared InFrameData in this engine frame, without comparing its rotations
+	bool IsPreparedFrame(const FLiveLinkAnimationFrameData& InFrameData) const;
+
+	// Batch the asset with the other characters of SubjectName, for an asset no Live Link pose node evaluates
+	void ScheduleForSubject(const FLiveLinkSubjectName& SubjectName);
+
+	// Update rate of the subject driving the asset, set by FMvnRetargetScheduler before the actors tick
+	void SetUpdateRate(EMvnSubjectUpdateRate Rate) { m_updateRate = Rate; }
+
 	UFUNCTION ( BlueprintCallable, Category = "Live Link Remap" )
 	FName GetRemappedBoneNameByConvention( EXsensMapping Bone, EXsensRetargetNamingConvention Convention ) const;
 
@@ -80,8 +96,11 @@ private:
 
 	TArray<FName> m_skeleton_bone_names;
 
-	//Populate BoneNameMap and return the Transformed Bone names after the remapping
-	TArray<FName> PopulateBoneNames(const FLiveLinkSkeletonStaticData* InSkeletonData);
+	// Rebuild the bone mapping plan if the skeleton, the subject or the remapping changed. Returns true if it was rebuilt
+	bool UpdateBoneMappingPlan(const FLiveLinkSkeletonStaticData& InSkeletonData, const FBoneContainer& BoneContainer);
+
+	// Force the bone mapping plan to be rebuilt on the next frame
+	void InvalidateBoneMappingPlan();
 
 	void FetchSkeletonBoneNames();
 
@@ -89,7 +108,13 @@ private:
 
 	float calculateVectorScale(FVector xsensVec, FVector unrealVec);
 
-	void calculateTposeValues(FCompactPose OutPose, const FLiveLinkSkeletonStaticData& InSkeletonData, const FLiveLinkAnimationFrameData& InFrameData, FBlendedCurve& OutCurve);
+	// Get the T-pose of the current skeleton and mapping from the shared cache, computing it if no one did yet
+	void UpdateTposeBasis(const FCompactPose& InPose);
+
+	void calculateTposeValues(FCompactPose OutPose, FMvnTposeBasis& OutBasis);
+
+	// Run the rotation kernel on the segments of InFrameData
+	void RetargetRotations(const FLiveLinkAnimationFrameData& InFrameData);
 
 	void AddBoneNamesToRemapTable();
 
@@ -126,17 +151,88 @@ private:
 
 	static const std::map<EXsensMapping, FName>& GetNamingConventionBoneMap( EXsensRetargetNamingConvention namingConvention );
 
-	TArray<FTransform> m_tposeWorld;
+	// T-pose the segments are retargeted against, shared with every asset using the same skeleton and mapping
+	TSharedPtr<const FMvnTposeBasis, ESPMode::ThreadSafe> m_tposeBasis;
 
-	TArray<FTransform> m_mvnToUnrealTpose;
+	// Cache generation m_tposeBasis was fetched in
+	int32 m_tposeBasisGeneration = 0;
 
-	// Name mapping between source bone name and transformed bone name
-	// (returned from GetRemappedBoneName)
-	TMap<FName, FName> BoneNameMap;
+	// How a MVN segment is applied to the character
+	enum class ESegmentRetarget : uint8
+	{
+		Root,		// copied as is
+		Pelvis,		// world space, scaled to the character height
+		Prop,		// relative to the closest mapped bone up the character hierarchy
+		Unmapped,	// not in the character, its children use an ancestor instead
+		Ignored,	// mapped to one of the p1..p4 placeholders
+		Bone		// relative to its MVN parent
+	};
+
+	struct FSegmentRetargetPlan
+	{
+		ESegmentRetarget Kind = ESegmentRetarget::Root;
+
+		// Bone index in the reference skeleton, INDEX_NONE if the segment is not mapped
+		int32 RefBoneIndex = INDEX_NONE;
+
+		// Bone index in the compact pose, INDEX_NONE if the bone is not required
+		int32 CompactBoneIndex = INDEX_NONE;
 
-	// Name mapping between source curve name and transformed curve name
-	// (returned from GetRemappedCurveName)
-	TMap<FName, FName> CurveNameMap;
+		// Segment the rotation is made relative to, with unmapped parents already overridden
+		int32 ParentSegment = INDEX_NONE;
+	};
+
+	// Bone lookups of the current subject on the current skeleton, resolved once so the per frame
+	// retarget doesn't touch any names
+	struct FBoneMappingPlan
+	{
+		TArray<FSegmentRetargetPlan> Segments;
+
+		// What the plan was built for
+		TArray<FName> SourceBoneNames;
+		const USkeleton* Skeleton = nullptr;
+		int32 NumCompactBones = 0;
+		uint16 BoneContainerSerial = 0;
+		bool bValid = false;
+	};
+
+	FBoneMappingPlan m_boneMappingPlan;
+
+	// Segment kinds as applied with the current T-pose, segments it doesn't cover fall back to Root
+	TArray<ESegmentRetarget> m_segmentKinds;
+
+	// Per segment constants of the batched rotation retarget
+	FMvnRetargetKernelPlan m_kernelPlan;
+
+	// Per frame streamed, world and parent relative rotations, kept to avoid reallocating them every frame
+	FMvnSegmentSoA m_kernelRotations;
+	FMvnSegmentSoA m_kernelWorld;
+	FMvnSegmentSoA m_kernelLocal;
+
+	// The kernel results are those of m_kernelRotations, and were applied to a pose since they were computed
+	bool m_bKernelValid = false;
+	bool m_bKernelApplied = false;
+
+	// Engine frame, time, size and root of the frame the scheduler's batch computed the kernel results from,
+	// Live Link evaluates a subject to the same frame for the whole engine frame
+	uint64 m_preparedFrameCounter = 0;
+	double m_preparedWorldTime = 0.0;
+	int32 m_preparedNumTransforms = 0;
+	FTransform m_preparedRoot;
+
+	// Update rate of the subject, a throttled one blends from the pose shown to each of its new frames
+	EMvnSubjectUpdateRate m_updateRate = EMvnSubjectUpdateRate::Full;
+	bool m_bThrottledAtLastFrame = false;
+	double m_lastFrameTime = 0.0;
+
+	// Per segment transforms last applied and those the running blend started from
+	TArray<FTransform> m_lastPose;
+	TArray<FTransform> m_blendFrom;
+	double m_blendStart = 0.0;
+	double m_blendDuration = 0.0;
+
+	// Registered with the retarget scheduler
+	bool m_bScheduled = false;
 
 	/** Blueprint.OnCompiled delegate handle */
 	FDelegateHandle OnBlueprintCompiledDelegate;
@@ -147,7 +243,5 @@ private:
 	UPROPERTY( EditAnywhere, DisplayName = "Is Forward Y", Category = "Reference Pose" )
 	bool IsForwardY = false;
 
-	int m_retarget;
-
 	bool m_doLog;
 };
@@ -19,6 +19,17 @@
 #include "MetaDatagram.h"
 #include "QuaternionDatagram.h"
 #include "HAL/CriticalSection.h"
+#include "Containers/TripleBuffer.h"
+#include "MvnPacketRing.h"
+#include "MvnBatchReceiver.h"
+#include "MvnJitterBuffer.h"
+#include "MvnKinematicsProperties.h"
+#include "MvnSegmentKernel.h"
+#include "MvnClockSync.h"
+#include "MvnCaptureFile.h"
+#include "MvnTelemetry.h"
+#include "MvnPosePredictor.h"
+#include "MvnReceiveWorker.h"
 
 #include "LiveLinkMvnSource.generated.h"
 
@@ -30,8 +41,6 @@ struct FLiveLinkHeartbeatMessage;
 struct FLiveLinkClearSubject;
 struct FReferenceSkeleton;
 
-#define XS_MAX_ACTORS_NUM 5
-
 typedef TArray<FVector> MvnTPose;
 
 // basic data for a segment
@@ -86,6 +95,14 @@ struct SegData
 		Transform.SetRotation(rot);
 		Transform.SetScale3D(pelvisPos);
 	}
+
+	// set from a segment already converted by MvnSegmentKernel::ConvertSegments
+	void Set(const FMvnSegmentSoA& positions, const FMvnSegmentSoA& rotations, int index, FVector pelvisPos = FVector::OneVector)
+	{
+		Transform.SetLocation(positions.GetVector(index));
+		Transform.SetRotation(rotations.GetQuat(index));
+		Transform.SetScale3D(pelvisPos);
+	}
 };
 
 // struct holding a model pose data including it's position, orientation and segments data
@@ -94,14 +111,142 @@ struct Pose
 	int AvatarId;
 	int FrameId;
 
+	// MVN sample counter, orders samples in the jitter buffer
+	int32 SampleCounter;
+	// stream time of the sample mapped to FPlatformTime::Seconds()
+	double WorldTime;
+	// FPlatformTime::Seconds() when the datagram completing the sample was received
+	double ReceiveTime;
+	// time code of the sample, valid once MVN sent a time code datagram
+	FQualifiedFrameTime SceneTime;
+	bool bHasSceneTime;
+	// center of mass and segment kinematics from the latest kinematics datagrams
+	FMvnKinematicsProperties Kinematics;
+	// joint angles and tracker kinematics from the latest datagrams, their layout matches the subject's property names
+	FMvnJointTrackerProperties JointTrackers;
+
 	Pose()
 	{
 		AvatarId = -1;
 		FrameId = -1;
+		SampleCounter = 0;
+		WorldTime = 0.0;
+		ReceiveTime = 0.0;
+		bHasSceneTime = false;
+	}
+
+	// refill for a new sample, segments the datagram does not cover stay at identity
+	void Reset(int NumSegments)
+	{
+		Segments.SetNum(NumSegments, false);
+		for (SegData& Segment : Segments)
+		{
+			Segment.Transform = FTransform::Identity;
+		}
 	}
-	std::vector<SegData> Segments;
+
+	// fixed capacity so a pose is refilled without allocating
+	TArray<SegData, TFixedAllocator<SegData::XS_SEG_NUM_FINGERS>> Segments;
+};
+
+// all state of one avatar streamed by one MVN instance
+struct FMvnActor
+{
+	FMvnActor(int32 InAvatarId, int32 InSenderIndex, int32 InPortIndex)
+		: AvatarId(InAvatarId)
+		, SenderIndex(InSenderIndex)
+		, PortIndex(InPortIndex)
+		, CurrentSkeletonSegmentCount(0)
+		, TimecodeSeconds(0.0)
+		, TimecodeFrameTime(0)
+		, bHasTimecode(false)
+	{
+	}
+
+	int32 AvatarId;
+	// index of the MVN instance in FLiveLinkMvnSource::m_senders
+	int32 SenderIndex;
+	// port the avatar streams to, see FLiveLinkMvnSource::GetListenPort
+	int32 PortIndex;
+
+	// when the last datagram of the avatar arrived, receiver thread only
+	double LastReceiveTime = 0.0;
+
+	// name MVN gave the avatar, empty until a meta datagram arrives
+	FString Name;
+	FName SubjectName;
+
+	// bones of the skeleton the subject was set up with, 0 until it is or must be set up again
+	int32 CurrentSkeletonSegmentCount;
+	MvnTPose TPose;
+
+	// Latest pose. The receiver thread fills the write buffer and publishes it with a swap,
+	// the reader swaps in the newest published pose, neither side locks or allocates.
+	TTripleBuffer<Pose> LastPose;
+	// set once the first pose was published
+	FThreadSafeBool bHasPose;
+
+	// Decoded samples waiting to be published in sample counter order
+	TMvnJitterBuffer<Pose> JitterBuffer;
+
+	// Last time code and the stream time (ms) of the sample it belongs to
+	double TimecodeSeconds;
+	int32 TimecodeFrameTime;
+	bool bHasTimecode;
+
+	// Latest kinematics, copied into every decoded pose
+	FMvnKinematicsProperties Kinematics;
+	// Latest joint angles and tracker kinematics, copied into every decoded pose, receiver thread only
+	FMvnJointTrackerProperties JointTrackers;
+	// Segment names of the last scale datagram by segment ID - 1, names the joint and tracker properties
+	TArray<FName> SegmentNames;
+
+	// Telemetry: poses decoded in the current window, arrivals older than the newest one seen and that newest
+	// sample counter, receiver thread only
+	int32 WindowSamples = 0;
+	int32 Reordered = 0;
+	int32 NewestSampleCounter = 0;
+	bool bHasSampleCounter = false;
+
+	// Receive to push latency of the frames pushed to Live Link, from whichever thread pushes
+	FMvnLatencyCounter PushLatency;
+
+	// Carries released poses ahead to hide the latency, receiver thread only
+	FMvnPosePredictor Predictor;
+};
+
+// one MVN instance streaming to the port
+struct FMvnSender
+{
+	// where the instance sends from now, a restarted instance takes over its slot from a new port
+	FIPv4Endpoint Endpoint;
+	double LastReceiveTime = 0.0;
+
+	// which of the instances sending at once from the address, 0 for the first
+	int32 AddressSlot = 0;
+
+	// Offset from the sender's stream time to FPlatformTime::Seconds(), from the fastest arrival of the last few seconds
+	// so drift between the clocks doesn't build up. Kept as the fastest arrival of each of StreamClockBuckets intervals
+	static constexpr int32 StreamClockBuckets = 8;
+	static constexpr double StreamClockBucketSeconds = 0.5;
+	double StreamClockBucketOffsets[StreamClockBuckets];
+	int64 StreamClockBucket = 0;
+	double StreamClockOffset = 0.0;
+	bool bHasStreamClock = false;
+
+	// Clock estimate of the remote control session to the sender's address, if any, and the registry generation it was looked up at
+	FMvnClockSyncRegistry::FClockSyncPtr ClockSync;
+	int32 ClockSyncGeneration = -1;
 };
 
+/** How decoded MVN frames are handed to Live Link */
+UENUM()
+enum class EMvnFramePushMode : uint8 {
+	// Push every pose from the receiver thread as soon as it is decoded
+	Immediate = 0		UMETA( DisplayName = "Immediate" ),
+	// Push only the newest pose of each subject once per engine tick
+	CoalescePerTick		UMETA( DisplayName = "Coalesce Per Tick" )
+};
 
 /** VirtualSubjectSource Settings to be able to differentiate from live sources and keep a name associated to the source */
 UCLASS()
@@ -113,6 +258,78 @@ public:
 
 	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Settings" )
 	int PortNumber;
+
+	/** Size in bytes of the socket receive buffer */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Settings", meta = ( ClampMin = "65536" ) )
+	int ReceiveBufferSize = 1024 * 1024;
+
+	/** More ports to listen on besides PortNumber, subjects are named after the port their data arrives on */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Settings" )
+	TArray<int32> AdditionalPorts;
+
+	/** Local addresses to listen on, every interface when empty */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Settings" )
+	TArray<FString> ListenAddresses;
+
+	/**
+	 * Threads receiving from the sockets while the source's thread decodes, only used with more than one socket.
+	 * Every socket gets a thread of its own. On Linux a port gets a socket per worker while there are fewer sockets than workers,
+	 * the kernel spreads the senders over them
+	 */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Settings", meta = ( ClampMin = "1", ClampMax = "16" ) )
+	int ReceiveWorkers = 1;
+
+	/** Highest number of datagrams fetched from the socket per receive call */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Settings", meta = ( ClampMin = "1", ClampMax = "256" ) )
+	int ReceiveBatchSize = 16;
+
+	/** Number of preallocated packet slots between the socket and the decoder, rounded up to a power of two */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Settings", meta = ( ClampMin = "1", ClampMax = "1024" ) )
+	int ReceiveRingDepth = 32;
+
+	/** Stamp datagrams with the time the kernel received them rather than when the receiver thread read them, where the platform supports it */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Settings" )
+	bool bKernelReceiveTimestamps = true;
+
+	/** Push poses from the receiver thread as they arrive, or only the newest one per tick */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Settings" )
+	EMvnFramePushMode PushMode = EMvnFramePushMode::Immediate;
+
+	/** Time samples are held back to absorb network jitter, 0 disables the time based release */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Settings", meta = ( ClampMin = "0", ClampMax = "500", Units = "ms" ) )
+	float JitterBufferLatencyMs = 0.f;
+
+	/** Number of samples held back to absorb network jitter, 0 disables the count based release */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Settings", meta = ( ClampMin = "0", ClampMax = "31" ) )
+	int JitterBufferFrames = 0;
+
+	/** Seconds an avatar may go without a datagram before it and its subject are removed, 0 keeps them for good */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Settings", meta = ( ClampMin = "0", Units = "s" ) )
+	float SubjectTimeout = 30.f;
+
+	/** Frame rate of the time code MVN streams, used to fill in the scene time of each frame */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Settings" )
+	FFrameRate TimecodeFrameRate = FFrameRate( 60, 1 );
+
+	/** Expose the center of mass, segment linear and angular kinematics, joint angles and motion tracker kinematics MVN streams as subject properties */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Settings" )
+	bool bStreamKinematics = false;
+
+	/** Carry every pose this far ahead to hide network and engine latency, 0 disables prediction */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Prediction", meta = ( ClampMin = "0", ClampMax = "100", Units = "ms" ) )
+	float PredictionHorizonMs = 0.f;
+
+	/** Prediction horizon of single subjects, by subject name, in place of PredictionHorizonMs */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Prediction" )
+	TMap<FName, float> SubjectPredictionHorizonsMs;
+
+	/** Predict from the segment kinematics MVN streams when they are enabled in its network streamer, rather than from the last two poses */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Prediction" )
+	bool bPredictFromKinematics = true;
+
+	/** Record every received datagram to Saved/MvnCaptures, for replay with mvn.Replay.Start */
+	UPROPERTY( EditAnywhere, AdvancedDisplay, Category = "Capture" )
+	bool bCaptureDatagrams = false;
 };
 
 
@@ -128,6 +345,7 @@ public:
 	virtual void ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid) override;
 
 	virtual bool IsSourceStillValid() const override;
+	virtual void Update() override;
 
 	virtual bool RequestSourceShutdown() override;
 
@@ -144,11 +362,45 @@ public:
 	virtual void Stop() override;
 	virtual void Exit() override { }
 	void Recv(const FArrayReaderPtr& ArrayReaderPtr, const FIPv4Endpoint& EndPt);
-	void Send(int avatarId);
+	void Recv(const uint8* Data, int32 Size, const FIPv4Endpoint& EndPt, double ReceiveTime, int32 PortIndex = 0);
+	void Send(FMvnActor& Actor);
+
+	/** Subject name of an avatar, the port and avatar name, followed by the sender's address for any but the first MVN instance */
+	FName GetSubjectName(const FMvnActor& Actor) const;
+
+	/** Number of avatars streaming, over all senders */
+	int32 GetActorCount() const;
 
-	FName GetSubjectName(int AvatarId, int PortNum) const;
+	/** Counters of the fragment reassembly stage, safe to call from any thread */
+	FragmentAssembler::Stats GetFragmentStats() const;
 
-private:
+	/** Counters of the jitter buffers of all avatars */
+	FMvnJitterBufferStats GetJitterStats() const;
+
+	/** Telemetry of the last full second, safe to call from any thread */
+	FMvnSourceTelemetry GetTelemetry() const;
+
+	/** Record received datagrams to Filename, or to a new file in Saved/MvnCaptures if it is empty. Takes effect on the receiver thread */
+	void StartCapture(const FString& Filename = FString());
+	void StopCapture();
+	bool IsCapturing() const { return bCapturing; }
+
+	/** Port the source receives on, or the capture of a replay source was recorded on */
+	int GetPort() const { return port; }
+
+	/** Port of a port index datagrams are stamped with, 0 is GetPort() and the rest the additional ports */
+	int GetListenPort(int32 PortIndex) const { return PortIndex > 0 && AdditionalPorts.IsValidIndex(PortIndex - 1) ? AdditionalPorts[PortIndex - 1] : port; }
+
+	/** Prediction of the source's subjects. Takes effect on the receiver thread */
+	void SetPrediction(const FMvnPredictionSettings& NewPrediction);
+
+	/** True if the source receives from a socket */
+	bool IsListening() const { return Socket != nullptr; }
+
+	/** Every MVN source alive, for console commands; call under the returned lock */
+	static const TArray<FLiveLinkMvnSource*>& GetSources(FCriticalSection*& OutLock);
+
+protected:
 
 	ILiveLinkClient* Client;
 
@@ -167,6 +419,16 @@ private:
 	/** Holds the network socket. */
 	FSocket* Socket;
 
+	/** Ports besides port the source listens on, at most MaxPorts in all */
+	TArray<int32> AdditionalPorts;
+	static constexpr int32 MaxPorts = 256;
+
+	/** Local addresses the source listens on, every interface when empty */
+	TArray<FIPv4Address> ListenAddresses;
+
+	/** Every socket, one per port and address or more with workers on Linux. Socket is the first */
+	TArray<FSocket*> Sockets;
+
 	/** Holds a pointer to the socket sub-system. */
 	ISocketSubsystem* SocketSubsystem;
 
@@ -182,23 +444,133 @@ private:
 	/** Holds the amount of time to wait for inbound packets. */
 	FTimespan WaitTime;
 
+	/** Largest datagram accepted from the socket */
+	static constexpr int32 MaxPacketSize = 65507;
+
+	/** Receive settings, applied when the socket is created */
+	int32 ReceiveBufferSize;
+	int32 ReceiveBatchSize;
+	int32 ReceiveRingDepth;
+	bool bKernelReceiveTimestamps;
+	EMvnFramePushMode PushMode;
+	FFrameRate TimecodeFrameRate;
+	bool bStreamKinematics;
+
+	/** Preallocated slots the receiver thread drains the socket into */
+	TUniquePtr<FMvnPacketRing> PacketRing;
+	TUniquePtr<FMvnBatchReceiver> BatchReceiver;
+
+	/** With more than one socket a worker per socket receives and the receiver thread only decodes their rings, woken by DataEvent */
+	int32 ReceiveWorkers;
+	TArray<TUniquePtr<FMvnReceiveWorker>> Workers;
+	FEvent* DataEvent;
+
+	// Open the sockets and the workers or the batch receiver, from the receive settings
+	void CreateSockets();
+
+	// Receive and decode what arrived within WaitTime, false if nothing did
+	bool ReceiveFromSocket();
+	bool ReceiveFromWorkers();
+
+	// Decode every datagram queued in Ring, false if it was empty
+	bool DecodeRing(FMvnPacketRing& Ring);
+
+	/** Segments of the pose being decoded, converted to Unreal axes in one batch */
+	FMvnSegmentSoA ConvertedPositions;
+	FMvnSegmentSoA ConvertedRotations;
+
 	// frame counter for data
 	int FrameCounter;
 
-	// A copy of each xsens avatar's pose from the last frame, for easy and safe access
-	TArray<TSharedPtr<Pose, ESPMode::ThreadSafe>> m_lastPoses;
-	FCriticalSection m_critical;
+	// Jitter buffer settings, applied to every new actor
+	int32 JitterBufferFrames;
+	double JitterBufferLatency;
+
+	// Seconds without a datagram after which an actor is removed, 0 never
+	double ActorTimeout;
+
+	// Every avatar of every sender, created on the receiver thread when its first datagram arrives and removed
+	// there by ExpireActors. m_actorsLock guards adding and removing against other threads walking the array.
+	TArray<TUniquePtr<FMvnActor>> m_actors;
+	mutable FCriticalSection m_actorsLock;
+
+	// Index into m_actors by sender, listen port and avatar id, only used on the receiver thread
+	TMap<uint64, int32> m_actorIndex;
+
+	// Every MVN instance seen and an index of them by the endpoint they send from, receiver thread only.
+	// Slots are reused rather than removed, so sender indices stay valid
+	TArray<FMvnSender> m_senders;
+	TMap<uint64, int32> m_senderIndex;
+
+	// Silence after which a new port on a sender's address is taken for the sender restarting
+	static constexpr double SenderIdleTime = 1.0;
 
 	std::unique_ptr<ParserManager> Parser;
 
+	// Capture of the received datagrams, opened and written on the receiver thread only.
+	// StartCapture/StopCapture leave the file name under m_captureLock and raise bCaptureChanged.
+	FMvnCaptureWriter CaptureWriter;
+	FString PendingCaptureFilename;
+	FCriticalSection m_captureLock;
+	FThreadSafeBool bCaptureChanged;
+	FThreadSafeBool bCapturing;
+
+	// Apply a pending capture start or stop, called on the receiver thread
+	void UpdateCapture();
+
+	// Counters of the current telemetry window, receiver thread only
+	double TelemetryWindowStart;
+	int32 WindowPackets;
+	int64 WindowBytes;
+	int32 WindowRingDepthMax;
+	FMvnLatencyHistogram WindowDecodeTime;
+	FMvnSourceTelemetry LastTelemetry;
+	FMvnTelemetryTraceCounters TraceCounters;
+
+	// Latest published telemetry and its status line, under m_telemetryLock
+	FMvnSourceTelemetry Telemetry;
+	FString TelemetryStatus;
+	mutable FCriticalSection m_telemetryLock;
+	FThreadSafeBool bTelemetryChanged;
+
+	// Close the telemetry window once a second and publish it, called on the receiver thread
+	void UpdateTelemetry(double Now);
+
+	// Prediction of every actor, receiver thread only. SetPrediction leaves new settings
+	// in PendingPrediction under m_predictionLock and raises bPredictionChanged.
+	FMvnPredictionSettings Prediction;
+	FMvnPredictionSettings PendingPrediction;
+	FCriticalSection m_predictionLock;
+	FThreadSafeBool bPredictionChanged;
+
+	// Apply pending prediction settings to every actor, called on the receiver thread
+	void UpdatePrediction();
+
+	// Subject lifecycle runs on the receiver thread apart from the pose path: a subject is set up when
+	// its first pose or a new segment layout arrives, replaced on a meta rename and checked for having
+	// gone missing from the client every SubjectCheckInterval, when pending deletions are retried too
+	static constexpr double SubjectCheckInterval = 0.25;
+	double NextSubjectCheck;
+
+	void UpdateSubjects(double Now);
+	void RenameSubject(FMvnActor& Actor, const FString& NewName);
+
+	// Decode one datagram and publish the poses it completes
+	void Decode(const uint8* Data, int32 Size, const FIPv4Endpoint& EndPt, double ReceiveTime, int32 PortIndex);
+
+	// Settings shared by live and replay sources, everything but the socket
+	void ApplySettings(ULiveLinkMvnSourceSettings* Settings);
+
 	// Clear all subjects created by this source
 	void ClearSubject();
-	void updateRefSkeleton(int avatarId, int numOfSegments);
+	void updateRefSkeleton(FMvnActor& Actor, int numOfSegments);
 	void DeleteDelayedSubjects();
+	void ReleaseDuePoses(FMvnActor& Actor, double Now);
+	double StreamToWorldTime(FMvnSender& Sender, int32 frameTime, double ReceiveTime);
+	const FMvnClockSync* FindClockSync(FMvnSender& Sender);
+	int32 FindOrAddSender(const FIPv4Endpoint& EndPt, double ReceiveTime);
+	FMvnActor& FindOrAddActor(int32 SenderIndex, int32 PortIndex, int32 avatarId);
+	void ExpireActors(double Now);
 
-	int32 CurrentSkeletonSegmentCount[XS_MAX_ACTORS_NUM];
-	MvnTPose m_atposesPos[XS_MAX_ACTORS_NUM];
-
-	TMap<int32, FString> m_AvatarNames;
 	TArray<FLiveLinkSubjectKey> m_SubjectsToDelete;
 };
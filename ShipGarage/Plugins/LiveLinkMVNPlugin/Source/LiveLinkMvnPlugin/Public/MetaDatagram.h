@@ -12,7 +12,7 @@ public:
 	virtual void printData() const override;
 
 protected:
-	virtual void deserializeData(Streamer& inputStreamer) override;
+	virtual bool deserializeData(Streamer& inputStreamer) override;
 
 public:
 
@@ -0,0 +1,39 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Counts the heap allocations the calling thread makes while the counter lives, for the benchmarks.
+ *
+ * Counting goes through an allocator wrapping GMalloc, installed at module startup with -MvnCountAllocations and kept
+ * for the rest of the process: GMalloc can't be swapped back and forth while other threads allocate. It forwards
+ * everything and only counts on threads with a live counter, other threads pay a thread local load per allocation.
+ */
+class LIVELINKMVNPLUGIN_API FMvnAllocationCounter
+{
+public:
+
+	/** Wrap GMalloc if the command line asks for it, at module startup */
+	static void InstallIfRequested();
+
+	/** True if allocations are counted */
+	static bool IsInstalled();
+
+	FMvnAllocationCounter();
+	~FMvnAllocationCounter();
+
+	FMvnAllocationCounter(const FMvnAllocationCounter&) = delete;
+	FMvnAllocationCounter& operator=(const FMvnAllocationCounter&) = delete;
+
+	/** Allocations and reallocations of the thread since the counter was made, -1 if they are not counted */
+	int64 GetAllocations() const { return IsInstalled() ? Allocations : -1; }
+
+private:
+
+	int64 Allocations;
+
+	/** Counter of the enclosing scope, counts again once this one goes */
+	int64* Outer;
+};
@@ -0,0 +1,61 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "SocketTypes.h"
+
+class FMvnPacketRing;
+class FRecvMulti;
+
+/**
+ * Drains all datagrams queued on a UDP socket into a packet ring in one go.
+ * Uses the socket subsystem's multi receive (recvmmsg on Linux) when it is supported,
+ * and otherwise keeps calling RecvFrom on the non blocking socket until it runs dry.
+ *
+ * Each datagram is stamped with the time the kernel received it when the socket was set up to retrieve
+ * timestamps (SO_TIMESTAMPNS on Linux) and multi receive is used, and with FPlatformTime::Seconds()
+ * right after it was read otherwise.
+ */
+class LIVELINKMVNPLUGIN_API FMvnBatchReceiver
+{
+public:
+
+	/**
+	 * bInKernelTimestamps: InSocket retrieves receive timestamps, see FSocket::SetRetrieveTimestamp
+	 * InPortIndex: stamped on every datagram, tells the sockets of a source listening on several ports apart
+	 */
+	FMvnBatchReceiver(FSocket* InSocket, ISocketSubsystem* InSocketSubsystem, int32 InBatchSize, int32 InMaxPacketSize, bool bInKernelTimestamps = false, int32 InPortIndex = 0);
+	~FMvnBatchReceiver();
+
+	/** Receive up to the batch size datagrams into free slots of Ring, returns the number received */
+	int32 ReceiveBatch(FMvnPacketRing& Ring);
+
+	/** True if datagrams are fetched with a single system call per batch */
+	bool UsesRecvMulti() const { return RecvMulti.IsValid(); }
+
+	/** True if datagrams are stamped with the kernel's receive time */
+	bool UsesKernelTimestamps() const { return bKernelTimestamps; }
+
+	int32 GetBatchSize() const { return BatchSize; }
+
+	/** Datagrams fetched from the socket but lost because the ring was full, read on the receiving thread */
+	int64 GetRingOverflows() const { return RingOverflows; }
+
+private:
+
+	int32 ReceiveMulti(FMvnPacketRing& Ring);
+	int32 ReceiveSingle(FMvnPacketRing& Ring);
+
+	FSocket* Socket;
+	ISocketSubsystem* SocketSubsystem;
+	int32 BatchSize;
+	int32 PortIndex;
+	int64 RingOverflows = 0;
+	bool bKernelTimestamps = false;
+
+	TUniquePtr<FRecvMulti> RecvMulti;
+	TSharedRef<FInternetAddr> SenderAddr;
+};
@@ -0,0 +1,116 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <atomic>
+
+/**
+ * Bounded lock free queue, any number of producers and consumers.
+ *
+ * Every cell carries a sequence number that tells whose turn it is: a producer may fill the cell when the sequence
+ * equals its position, a consumer may empty it when the sequence is one past its position. Enqueue fails instead of
+ * blocking or allocating when the queue is full. Capacity has to be a power of two.
+ */
+template<typename T, uint32 Capacity>
+class TMvnBoundedQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity has to be a power of two");
+
+public:
+
+	TMvnBoundedQueue()
+		: EnqueuePosition(0)
+		, DequeuePosition(0)
+	{
+		for (uint32 Index = 0; Index < Capacity; ++Index)
+		{
+			Cells[Index].Sequence.store(Index, std::memory_order_relaxed);
+		}
+	}
+
+	/** Add Value, false if the queue is full */
+	bool Enqueue(const T& Value)
+	{
+		FCell* Cell;
+		uint32 Position = EnqueuePosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell = &Cells[Position & (Capacity - 1)];
+			const int32 Difference = (int32)(Cell->Sequence.load(std::memory_order_acquire) - Position);
+			if (Difference == 0)
+			{
+				if (EnqueuePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (Difference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				Position = EnqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		Cell->Value = Value;
+		Cell->Sequence.store(Position + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** Take the oldest value, false if the queue is empty */
+	bool Dequeue(T& OutValue)
+	{
+		FCell* Cell;
+		uint32 Position = DequeuePosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell = &Cells[Position & (Capacity - 1)];
+			const int32 Difference = (int32)(Cell->Sequence.load(std::memory_order_acquire) - (Position + 1));
+			if (Difference == 0)
+			{
+				if (DequeuePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (Difference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				Position = DequeuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		OutValue = Cell->Value;
+		Cell->Sequence.store(Position + Capacity, std::memory_order_release);
+		return true;
+	}
+
+	/** Approximate number of queued values, exact when no other thread uses the queue */
+	int32 Num() const
+	{
+		return (int32)(EnqueuePosition.load(std::memory_order_relaxed) - DequeuePosition.load(std::memory_order_relaxed));
+	}
+
+	static constexpr uint32 GetCapacity() { return Capacity; }
+
+private:
+
+	struct FCell
+	{
+		std::atomic<uint32> Sequence;
+		T Value;
+	};
+
+	FCell Cells[Capacity];
+
+	// on their own cache lines, producers and the consumer don't share one
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> EnqueuePosition;
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> DequeuePosition;
+};
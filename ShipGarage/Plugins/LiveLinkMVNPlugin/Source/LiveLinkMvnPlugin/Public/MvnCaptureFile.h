@@ -0,0 +1,117 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+
+class IFileHandle;
+
+/** One datagram of a capture */
+struct FMvnCaptureRecord
+{
+	/** Seconds since the first datagram of the capture */
+	double Time = 0.0;
+
+	/** Who sent the datagram */
+	FIPv4Endpoint Sender;
+
+	/** Port it was received on, 0 is the capture's local port and the rest its additional ports */
+	int32 PortIndex = 0;
+
+	/** The datagram as received */
+	TArray<uint8> Data;
+};
+
+/**
+ * Capture files hold raw MVN datagrams with their receive time, appended as they arrive.
+ *
+ * The file starts with the magic "MVNC", a version, the port the datagrams were received on and the number of
+ * additional ports followed by those ports. Every record is a little endian header (time as double, sender address,
+ * sender port, size and port index) followed by the datagram bytes. A capture cut short by a crash is readable
+ * up to its last complete record.
+ *
+ * Version 1 files have no additional ports and no port index, and were written with two different file headers.
+ * They are not read.
+ */
+namespace MvnCaptureFile
+{
+	static constexpr uint32 Magic = 0x434E564D; // "MVNC"
+	static constexpr uint32 Version = 2;
+	/** Fixed part of the file header, the additional ports follow it */
+	static constexpr int32 FileHeaderSize = 16;
+	static constexpr int32 RecordHeaderSize = 18;
+	static constexpr int32 MaxDatagramSize = 65535;
+	static constexpr int32 MaxAdditionalPorts = 255;
+}
+
+/** Appends datagrams to a capture file, buffered; used from one thread */
+class LIVELINKMVNPLUGIN_API FMvnCaptureWriter
+{
+public:
+
+	FMvnCaptureWriter();
+	~FMvnCaptureWriter();
+
+	/**
+	 * Create or truncate the file, false if it can't be opened. LocalPort is the port the datagrams are received on,
+	 * AdditionalPorts those port indices past 0 refer to
+	 */
+	bool Open(const FString& Filename, int32 LocalPort = 0, const TArray<int32>& AdditionalPorts = TArray<int32>());
+
+	void Close();
+
+	bool IsOpen() const { return File != nullptr; }
+
+	/** Append a datagram received on the port PortIndex, ReceiveTime in FPlatformTime::Seconds() */
+	void Write(const uint8* Data, int32 Size, const FIPv4Endpoint& Sender, double ReceiveTime, int32 PortIndex = 0);
+
+	/** Write out the buffered records */
+	void Flush();
+
+	int64 GetNumRecords() const { return NumRecords; }
+	int64 GetNumBytes() const { return NumBytes; }
+
+private:
+
+	IFileHandle* File = nullptr;
+	TArray<uint8> Buffer;
+	double FirstTime = -1.0;
+	int64 NumRecords = 0;
+	int64 NumBytes = 0;
+};
+
+/** Reads a capture file record by record */
+class LIVELINKMVNPLUGIN_API FMvnCaptureReader
+{
+public:
+
+	FMvnCaptureReader();
+	~FMvnCaptureReader();
+
+	/** Open the file and check its header, files of another version are refused */
+	bool Open(const FString& Filename);
+
+	void Close();
+
+	/** Read the next record into Record, reusing its memory; false at the end or at a damaged record */
+	bool ReadNext(FMvnCaptureRecord& Record);
+
+	/** Continue with the first record */
+	void Rewind();
+
+	/** Port the datagrams were received on, 0 if unknown */
+	int32 GetLocalPort() const { return LocalPort; }
+
+	/** Ports besides the local port, a record's port index past 0 refers to them */
+	const TArray<int32>& GetAdditionalPorts() const { return AdditionalPorts; }
+
+private:
+
+	IFileHandle* File = nullptr;
+	int32 LocalPort = 0;
+	TArray<int32> AdditionalPorts;
+
+	/** Where the first record starts */
+	int64 RecordsOffset = 0;
+};
@@ -0,0 +1,106 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Interfaces/IPv4/IPv4Address.h"
+
+/**
+ * Estimates the clock of an MVN instance from NTP style exchanges over the remote control channel.
+ *
+ * Every exchange gives four timestamps: the local send and receive time in FPlatformTime::Seconds() and the time
+ * the server received and answered in its own clock, seconds since midnight like the time code datagram. The offset
+ * of an exchange is exact up to the asymmetry of its network delay, so only the exchanges with the shortest round
+ * trips of a sliding window are used. A line through their offsets gives the offset and the drift between the clocks.
+ */
+class LIVELINKMVNPLUGIN_API FMvnClockSync
+{
+public:
+
+	static constexpr double SecondsPerDay = 86400.0;
+
+	FMvnClockSync();
+
+	/** Add one exchange, LocalSend and LocalReceive in FPlatformTime::Seconds(), ServerReceive and ServerSend in the server clock */
+	void AddExchange(double LocalSend, double ServerReceive, double ServerSend, double LocalReceive);
+
+	/** Forget all exchanges, e.g. when the server changes */
+	void Reset();
+
+	/** True once enough exchanges were added to estimate the offset */
+	bool IsValid() const;
+
+	/** Server clock at the given local time */
+	double LocalToServer(double LocalTime) const;
+
+	/** Local time of the given server time of day, on the day closest to LocalHint */
+	double ServerToLocal(double ServerTime, double LocalHint) const;
+
+	/** Server minus local clock at the given local time */
+	double GetOffset(double LocalTime) const;
+
+	/** Seconds the server clock gains per local second */
+	double GetDrift() const;
+
+	/** Shortest round trip in the window, without the server's processing time */
+	double GetRoundTrip() const;
+
+	int32 GetNumExchanges() const;
+
+private:
+
+	struct FExchange
+	{
+		double LocalTime;
+		double Offset;
+		double RoundTrip;
+	};
+
+	/** Fit the offset line through the exchanges with the shortest round trips */
+	void Refit();
+
+	/** Offset(t) = FitOffset + FitDrift * (t - FitTime) */
+	double OffsetAt(double LocalTime) const { return FitOffset + FitDrift * (LocalTime - FitTime); }
+
+	static constexpr int32 MaxExchanges = 64;
+	static constexpr int32 MinExchanges = 4;
+
+	mutable FCriticalSection Lock;
+	TArray<FExchange> Exchanges;
+	int32 NextExchange;
+	int32 NumAdded;
+
+	double FitTime;
+	double FitOffset;
+	double FitDrift;
+	double MinRoundTrip;
+	bool bValid;
+};
+
+/** Clock estimates of the MVN instances that have a remote control session, found by the address they stream from */
+class LIVELINKMVNPLUGIN_API FMvnClockSyncRegistry
+{
+public:
+
+	typedef TSharedPtr<FMvnClockSync, ESPMode::ThreadSafe> FClockSyncPtr;
+
+	static FMvnClockSyncRegistry& getInstance();
+
+	void Register(const FIPv4Address& Address, const FClockSyncPtr& ClockSync);
+	void Unregister(const FIPv4Address& Address, const FClockSyncPtr& ClockSync);
+
+	FClockSyncPtr Find(const FIPv4Address& Address) const;
+
+	/** Changes with every registration, for callers that cache the result of Find */
+	int32 GetGeneration() const { return Generation.GetValue(); }
+
+protected:
+
+	FMvnClockSyncRegistry();
+
+	mutable FCriticalSection Lock;
+	TMap<FIPv4Address, FClockSyncPtr> Entries;
+	FThreadSafeCounter Generation;
+};
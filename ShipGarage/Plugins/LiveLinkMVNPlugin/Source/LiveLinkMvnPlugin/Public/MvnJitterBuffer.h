@@ -0,0 +1,211 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+
+/** Counters of a jitter buffer, safe to read from any thread */
+struct FMvnJitterBufferStats
+{
+	/** Samples accepted into the buffer */
+	int32 Received = 0;
+	/** Samples handed out in sample counter order */
+	int32 Released = 0;
+	/** Samples that were already buffered */
+	int32 Duplicates = 0;
+	/** Samples that arrived after a newer one was already released */
+	int32 Late = 0;
+	/** Gaps in the sample counter of released samples */
+	int32 Lost = 0;
+	/** Samples currently waiting in the buffer */
+	int32 Buffered = 0;
+
+	FMvnJitterBufferStats& operator+=(const FMvnJitterBufferStats& Other)
+	{
+		Received += Other.Received;
+		Released += Other.Released;
+		Duplicates += Other.Duplicates;
+		Late += Other.Late;
+		Lost += Other.Lost;
+		Buffered += Other.Buffered;
+		return *this;
+	}
+};
+
+/**
+ * Reorders the samples of one MVN avatar by sample counter and holds them back for a target latency,
+ * so samples that arrive out of order or in bursts are handed out evenly and in order.
+ *
+ * Samples are decoded straight into preallocated slots: Insert returns the slot to fill, PeekDue returns
+ * the oldest sample once it is due and Pop frees it. A sample is due when it waited for the target latency,
+ * when more than the target number of frames is buffered, or when the buffer is full. With no latency and
+ * no frames configured samples are due immediately and the buffer only filters duplicates and late samples.
+ *
+ * Insert, PeekDue and Pop are called from a single thread, GetStats from any thread.
+ */
+template<typename SampleType>
+class TMvnJitterBuffer
+{
+public:
+
+	explicit TMvnJitterBuffer(int32 InCapacity = 32)
+		: NumBuffered(0)
+		, DepthFrames(0)
+		, LatencySeconds(0.0)
+		, LastReleased(INDEX_NONE)
+	{
+		Slots.SetNum(FMath::Max(1, InCapacity));
+	}
+
+	/** Hold samples back for LatencySeconds, or until more than InDepthFrames are buffered. Zero disables either */
+	void Configure(int32 InDepthFrames, double InLatencySeconds)
+	{
+		DepthFrames = FMath::Clamp(InDepthFrames, 0, Slots.Num() - 1);
+		LatencySeconds = FMath::Max(0.0, InLatencySeconds);
+	}
+
+	bool IsEnabled() const { return DepthFrames > 0 || LatencySeconds > 0.0; }
+	bool IsFull() const { return NumBuffered == Slots.Num(); }
+	int32 GetCapacity() const { return Slots.Num(); }
+
+	/** Slot to decode a new sample into, nullptr if the sample is a duplicate, arrived too late or the buffer is full */
+	SampleType* Insert(int32 SampleCounter, double ArrivalTime)
+	{
+		if (LastReleased != INDEX_NONE && SampleCounter <= LastReleased)
+		{
+			// a counter far behind the last released one means MVN restarted the stream
+			if (LastReleased - SampleCounter < RestartThreshold)
+			{
+				LateCounter.Increment();
+				return nullptr;
+			}
+			Reset();
+		}
+
+		FSlot* FreeSlot = nullptr;
+		for (FSlot& Slot : Slots)
+		{
+			if (!Slot.bUsed)
+			{
+				FreeSlot = FreeSlot ? FreeSlot : &Slot;
+			}
+			else if (Slot.SampleCounter == SampleCounter)
+			{
+				DuplicateCounter.Increment();
+				return nullptr;
+			}
+		}
+		if (FreeSlot == nullptr)
+		{
+			return nullptr;
+		}
+
+		FreeSlot->bUsed = true;
+		FreeSlot->SampleCounter = SampleCounter;
+		FreeSlot->ArrivalTime = ArrivalTime;
+		++NumBuffered;
+		ReceivedCounter.Increment();
+		BufferedCounter.Set(NumBuffered);
+		return &FreeSlot->Sample;
+	}
+
+	/** Oldest buffered sample if it is due at Now, nullptr otherwise */
+	const SampleType* PeekDue(double Now)
+	{
+		FSlot* Oldest = FindOldest();
+		if (Oldest == nullptr)
+		{
+			return nullptr;
+		}
+
+		const bool bDue = IsFull()
+			|| (DepthFrames > 0 && NumBuffered > DepthFrames)
+			|| (Now - Oldest->ArrivalTime >= LatencySeconds && (LatencySeconds > 0.0 || DepthFrames == 0));
+		return bDue ? &Oldest->Sample : nullptr;
+	}
+
+	/** Release the sample returned by PeekDue */
+	void Pop()
+	{
+		FSlot* Oldest = FindOldest();
+		if (Oldest == nullptr)
+		{
+			return;
+		}
+
+		if (LastReleased != INDEX_NONE && Oldest->SampleCounter > LastReleased + 1)
+		{
+			LostCounter.Add(Oldest->SampleCounter - LastReleased - 1);
+		}
+		LastReleased = Oldest->SampleCounter;
+		Oldest->bUsed = false;
+		--NumBuffered;
+		ReleasedCounter.Increment();
+		BufferedCounter.Set(NumBuffered);
+	}
+
+	/** Drop all buffered samples and forget the last released counter */
+	void Reset()
+	{
+		for (FSlot& Slot : Slots)
+		{
+			Slot.bUsed = false;
+		}
+		NumBuffered = 0;
+		LastReleased = INDEX_NONE;
+		BufferedCounter.Set(0);
+	}
+
+	FMvnJitterBufferStats GetStats() const
+	{
+		FMvnJitterBufferStats Stats;
+		Stats.Received = ReceivedCounter.GetValue();
+		Stats.Released = ReleasedCounter.GetValue();
+		Stats.Duplicates = DuplicateCounter.GetValue();
+		Stats.Late = LateCounter.GetValue();
+		Stats.Lost = LostCounter.GetValue();
+		Stats.Buffered = BufferedCounter.GetValue();
+		return Stats;
+	}
+
+private:
+
+	struct FSlot
+	{
+		SampleType Sample;
+		int32 SampleCounter = 0;
+		double ArrivalTime = 0.0;
+		bool bUsed = false;
+	};
+
+	// the buffer is small, a linear scan is cheaper than keeping it sorted
+	FSlot* FindOldest()
+	{
+		FSlot* Oldest = nullptr;
+		for (FSlot& Slot : Slots)
+		{
+			if (Slot.bUsed && (Oldest == nullptr || Slot.SampleCounter < Oldest->SampleCounter))
+			{
+				Oldest = &Slot;
+			}
+		}
+		return Oldest;
+	}
+
+	/** Samples further behind the last released one than this are taken as a restarted stream */
+	static constexpr int32 RestartThreshold = 1000;
+
+	TArray<FSlot> Slots;
+	int32 NumBuffered;
+	int32 DepthFrames;
+	double LatencySeconds;
+	int32 LastReleased;
+
+	FThreadSafeCounter ReceivedCounter;
+	FThreadSafeCounter ReleasedCounter;
+	FThreadSafeCounter DuplicateCounter;
+	FThreadSafeCounter LateCounter;
+	FThreadSafeCounter LostCounter;
+	FThreadSafeCounter BufferedCounter;
+};
@@ -0,0 +1,95 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class CenterOfMassDatagram;
+class LinearSegmentKinematicsDatagram;
+class AngularSegmentKinematicsDatagram;
+class JointAnglesDatagram;
+class TrackerKinematicsDatagram;
+
+/**
+ * Center of mass and body segment velocities and accelerations of one avatar, flattened into the
+ * property values of a Live Link subject. Positions are in cm, angles in degrees, converted to the
+ * Unreal coordinate system the same way as the pose.
+ */
+struct LIVELINKMVNPLUGIN_API FMvnKinematicsProperties
+{
+	/** Pelvis up to LeftToe, props and fingers carry no kinematics */
+	static constexpr int32 NumBodySegments = 23;
+
+	/** Position, velocity and acceleration of the center of mass */
+	static constexpr int32 CenterOfMassOffset = 0;
+	/** Linear velocity and acceleration of each body segment */
+	static constexpr int32 LinearOffset = CenterOfMassOffset + 9;
+	/** Angular velocity and acceleration of each body segment */
+	static constexpr int32 AngularOffset = LinearOffset + NumBodySegments * 6;
+	static constexpr int32 Count = AngularOffset + NumBodySegments * 6;
+
+	float Values[Count];
+
+	/** Set once the segment linear or angular kinematics arrived, MVN only streams them when enabled in its network streamer */
+	bool bHasLinear;
+	bool bHasAngular;
+
+	FMvnKinematicsProperties() { Reset(); }
+
+	void Reset();
+	void SetCenterOfMass(const CenterOfMassDatagram& Datagram);
+	void SetLinear(const LinearSegmentKinematicsDatagram& Datagram);
+	void SetAngular(const AngularSegmentKinematicsDatagram& Datagram);
+
+	/** Property names matching Values, built once */
+	static const TArray<FName>& GetNames();
+};
+
+/**
+ * Joint angles and motion tracker kinematics of one avatar, pushed as Live Link properties after the segment
+ * kinematics. Which joints and trackers MVN streams depends on its setup, so the joints and trackers are kept
+ * with their values and the property names are built from them, named after the segments like the skeleton's bones.
+ * Joint angles are in degrees in the ISB convention of each joint, tracker orientations and vectors are converted
+ * to the Unreal coordinate system like the pose, accelerations in cm/s2.
+ */
+struct LIVELINKMVNPLUGIN_API FMvnJointTrackerProperties
+{
+	/** Fixed capacity so a pose copies them without allocating, MVN streams fewer even with fingers */
+	static constexpr int32 MaxJoints = 48;
+	static constexpr int32 MaxTrackers = 24;
+
+	/** Rotation around X, Y and Z */
+	static constexpr int32 ValuesPerJoint = 3;
+	/** Orientation, free acceleration and magnetic field */
+	static constexpr int32 ValuesPerTracker = 10;
+
+	/** Parent and child connection of each joint, 256 * segment ID + point ID */
+	int32 JointConnections[MaxJoints][2];
+	/** Segment ID each tracker is attached to */
+	int32 TrackerSegments[MaxTrackers];
+	int32 NumJoints;
+	int32 NumTrackers;
+
+	float JointValues[MaxJoints * ValuesPerJoint];
+	float TrackerValues[MaxTrackers * ValuesPerTracker];
+
+	FMvnJointTrackerProperties() { Reset(); }
+
+	void Reset();
+
+	/** Take the joints of Datagram, true if they are not the joints the property names were built for */
+	bool SetJointAngles(const JointAnglesDatagram& Datagram);
+	/** Take the trackers of Datagram, true if they are not the trackers the property names were built for */
+	bool SetTrackers(const TrackerKinematicsDatagram& Datagram);
+
+	int32 Num() const { return NumJoints * ValuesPerJoint + NumTrackers * ValuesPerTracker; }
+
+	/** Append the values, joints first */
+	void AppendValues(TArray<float>& Out) const;
+
+	/**
+	 * Append the property names matching AppendValues. Segments are named after SegmentNames, the names MVN gave
+	 * the segments in its scale datagram by segment ID - 1, or after the skeleton's bones where it gave none
+	 */
+	void AppendNames(TArray<FName>& Out, const TArray<FName>& SegmentNames) const;
+};
@@ -0,0 +1,31 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Latencies in power of two buckets of microseconds, bucket i counts [2^i, 2^(i+1)) us and bucket 0 everything below 2 us */
+struct LIVELINKMVNPLUGIN_API FMvnLatencyHistogram
+{
+	static constexpr int32 NumBuckets = 24;
+
+	uint32 Buckets[NumBuckets];
+	uint32 Count;
+	double Sum;
+	double Max;
+
+	FMvnLatencyHistogram() { Reset(); }
+
+	void Reset();
+
+	void Add(double Seconds);
+
+	/** Mean latency in seconds */
+	double GetMean() const { return Count > 0 ? Sum / Count : 0.0; }
+
+	/** Upper bound in seconds of the bucket that holds the given fraction (0..1) of the latencies */
+	double GetPercentile(double Fraction) const;
+
+	/** Seconds the given bucket ends at */
+	static double GetBucketLimit(int32 Bucket) { return FMath::Pow(2.0, (double)(Bucket + 1)) * 1.0e-6; }
+};
@@ -0,0 +1,173 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Common/UdpSocketReceiver.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Math/RandomStream.h"
+
+class FSocket;
+class FRunnableThread;
+class FInternetAddr;
+
+/** What the mock server sends and how it mistreats it */
+struct LIVELINKMVNPLUGIN_API FMvnMockServerSettings
+{
+	/** Where the pose stream goes, an FLiveLinkMvnSource listens there; port 0 disables the pose stream */
+	FIPv4Endpoint PoseTarget = FIPv4Endpoint(FIPv4Address(127, 0, 0, 1), 9763);
+
+	/** Samples per second per actor */
+	float Rate = 60.0f;
+
+	int32 NumActors = 1;
+
+	/** Body segments, props and finger segments per actor, like MVN 23 + 0..4 + 0 or 40 */
+	int32 NumBodySegments = 23;
+	int32 NumProps = 0;
+	int32 NumFingerSegments = 0;
+
+	/** Pose datagrams larger than this are split into fragments */
+	int32 MaxPacketSize = 1400;
+
+	/** Send a time code datagram with every sample */
+	bool bSendTimeCode = true;
+
+	/** Replay this capture file instead of synthetic motion */
+	FString ReplayFile;
+
+	/** Replay speed, 0 sends as fast as possible */
+	float ReplaySpeed = 1.0f;
+
+	/** Fraction of packets dropped */
+	float LossRate = 0.0f;
+
+	/** Fraction of packets held back until after the packets of the next sample */
+	float ReorderRate = 0.0f;
+
+	/** Every packet is delayed by up to this many seconds */
+	float Jitter = 0.0f;
+
+	/** Port the remote control listens on, 0 disables the remote control */
+	int32 RemoteControlPort = 0;
+
+	/** Delay of every remote control response, half on the way in and half on the way out, and its jitter per direction */
+	float ResponseDelay = 0.0f;
+	float ResponseJitter = 0.0f;
+
+	/** Server clock: seconds since midnight, offset from FPlatformTime::Seconds() and running faster by Drift */
+	double ClockOffset = 0.0;
+	double ClockDrift = 0.0;
+
+	/** Seed of the motion and of the impairments, the same seed sends the same stream */
+	int32 Seed = 1;
+
+	FMvnMockServerSettings();
+
+	/** Read settings from "Key=Value" pairs: Target, Rate, Actors, Segments, Props, Fingers, MaxPacket, TimeCode, Replay, Speed, Loss, Reorder, JitterMs, RemoteControlPort, DelayMs, ResponseJitterMs, Seed */
+	void Parse(const TCHAR* Params);
+};
+
+/**
+ * Stands in for MVN Analyze/Animate on loopback or the network, for load tests and to reproduce stage problems
+ * without a Windows machine and a suit.
+ *
+ * The pose stream sends quaternion, scale, meta and time code datagrams of synthetic motion, or the datagrams of
+ * a capture file, splitting large poses into fragments. Loss, reordering and jitter are injected before sending.
+ * The remote control answers the XML requests of MvnRemoteControlSession, including the clock sync extension.
+ */
+class LIVELINKMVNPLUGIN_API FMvnMockServer : public FRunnable
+{
+public:
+
+	struct FStats
+	{
+		int64 SamplesSent = 0;
+		int64 PacketsSent = 0;
+		int64 BytesSent = 0;
+		int64 PacketsDropped = 0;
+		int64 PacketsReordered = 0;
+		int64 RequestsAnswered = 0;
+	};
+
+	/** Start the pose stream and the remote control */
+	explicit FMvnMockServer(const FMvnMockServerSettings& InSettings);
+
+	/** Stop and wait for the threads */
+	virtual ~FMvnMockServer();
+
+	/** False if a socket could not be opened or the replay file not read */
+	bool IsRunning() const { return bRunning; }
+
+	FStats GetStats() const;
+
+	/** Server time of day at the given local FPlatformTime::Seconds() */
+	double ServerTime(double LocalTime) const;
+
+	const FMvnMockServerSettings& GetSettings() const { return Settings; }
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+
+	/** A packet waiting for its impaired send time */
+	struct FPendingPacket
+	{
+		double SendTime;
+		TArray<uint8> Data;
+	};
+
+	/** Pose and time code of one actor, meta and scale once a second */
+	void SendSyntheticSample(int32 Actor, int32 SampleCounter, double SampleTime, bool bSendMeta);
+	/** Apply loss, reordering and jitter, then queue */
+	void QueuePacket(const uint8* Data, int32 Size, double Now);
+
+	/** Send queued packets that are due, returns the time of the next one */
+	double SendDuePackets(double Now);
+
+	void OnRemoteControlRequest(const FArrayReaderPtr& Data, const FIPv4Endpoint& Sender);
+
+	FMvnMockServerSettings Settings;
+	double Period;
+
+	FSocket* PoseSocket = nullptr;
+	TSharedPtr<FInternetAddr> PoseTargetAddr;
+	FRunnableThread* Thread = nullptr;
+	volatile bool bStopping = false;
+	bool bRunning = false;
+
+	FSocket* RemoteControlSocket = nullptr;
+	FUdpSocketReceiver* RemoteControlReceiver = nullptr;
+
+	/** Replay datagrams, loaded up front */
+	TArray<double> ReplayTimes;
+	TArray<TArray<uint8>> ReplayData;
+
+	FRandomStream Random;
+	FRandomStream ResponseRandom;
+
+	/** Names of the segments for the scale datagram */
+	TArray<FString> SegmentNames;
+
+	/** Packets waiting for their send time, and their buffers once sent */
+	TArray<FPendingPacket> Pending;
+	TArray<TArray<uint8>> FreeBuffers;
+	TArray<uint8> Scratch;
+	TArray<TArray<uint8>> Fragments;
+
+	/** Remote control state */
+	FString SessionName;
+	int32 Take = 1;
+	bool bRecording = false;
+
+	FThreadSafeCounter64 SamplesSent;
+	FThreadSafeCounter64 PacketsSent;
+	FThreadSafeCounter64 BytesSent;
+	FThreadSafeCounter64 PacketsDropped;
+	FThreadSafeCounter64 PacketsReordered;
+	FThreadSafeCounter64 RequestsAnswered;
+};
@@ -0,0 +1,67 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+
+#include <atomic>
+
+/** One received datagram, the buffer is allocated once with the ring */
+struct FMvnPacketSlot
+{
+	/** Storage for the datagram, sized to the largest accepted packet */
+	TArray<uint8> Buffer;
+
+	/** Number of valid bytes in Buffer */
+	int32 Size = 0;
+
+	/** Who sent the datagram */
+	FIPv4Endpoint Sender;
+
+	/** FPlatformTime::Seconds() when the datagram was received, by the kernel where the receiver can tell */
+	double ReceiveTime = 0.0;
+
+	/** Which of the source's ports the datagram arrived on */
+	int32 PortIndex = 0;
+
+	const uint8* GetData() const { return Buffer.GetData(); }
+};
+
+/**
+ * Fixed size ring of preallocated packet slots.
+ * Single producer, single consumer: one thread fills slots, one thread consumes them.
+ */
+class LIVELINKMVNPLUGIN_API FMvnPacketRing
+{
+public:
+
+	FMvnPacketRing(int32 InDepth, int32 InMaxPacketSize);
+
+	/** Next free slot to write into, nullptr if the ring is full */
+	FMvnPacketSlot* AcquireWrite();
+
+	/** Publish the slot returned by AcquireWrite */
+	void CommitWrite();
+
+	/** Oldest received slot, nullptr if the ring is empty */
+	FMvnPacketSlot* PeekRead();
+
+	/** Release the slot returned by PeekRead */
+	void ReleaseRead();
+
+	/** Number of slots waiting to be consumed */
+	int32 Num() const;
+
+	int32 GetDepth() const { return Slots.Num(); }
+	int32 GetMaxPacketSize() const { return MaxPacketSize; }
+
+private:
+
+	TArray<FMvnPacketSlot> Slots;
+	int32 MaxPacketSize;
+
+	// monotonically increasing positions, the slot index is position modulo depth
+	std::atomic<uint32> WritePosition;
+	std::atomic<uint32> ReadPosition;
+};
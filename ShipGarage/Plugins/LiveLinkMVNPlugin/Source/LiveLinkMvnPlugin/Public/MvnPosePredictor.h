@@ -0,0 +1,116 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MvnKinematicsProperties.h"
+
+struct Pose;
+
+/** How a source carries its poses ahead in time, the horizon can be set per subject */
+struct FMvnPredictionSettings
+{
+	/** Seconds a pose is carried ahead, 0 disables prediction */
+	double Horizon = 0.0;
+
+	/** Horizon of single subjects, by subject name, in place of Horizon */
+	TMap<FName, double> SubjectHorizons;
+
+	/** Extrapolate with the segment velocities and accelerations MVN streams when it does, rather than from the last two samples */
+	bool bUseKinematics = true;
+
+	double GetHorizon(FName SubjectName) const
+	{
+		const double* SubjectHorizon = SubjectHorizons.Find(SubjectName);
+		return SubjectHorizon != nullptr ? *SubjectHorizon : Horizon;
+	}
+};
+
+/** Error of predicted poses against the samples that arrived for their time, over the body segments */
+struct LIVELINKMVNPLUGIN_API FMvnPredictionError
+{
+	/** Predictions checked */
+	int32 Count = 0;
+
+	/** Segment position error in cm */
+	double PositionMean = 0.0;
+	double PositionMax = 0.0;
+
+	/** Segment rotation error in degrees */
+	double RotationMean = 0.0;
+	double RotationMax = 0.0;
+
+	/** Fold in the error of other predictions */
+	void Append(const FMvnPredictionError& Other);
+};
+
+/**
+ * Short horizon extrapolation of the poses of one avatar, to hide network and engine latency.
+ *
+ * Body segments are carried ahead with the linear and angular kinematics MVN streams (protocols 0x21 and 0x22)
+ * when they are enabled in MVN, every other segment, or all of them without kinematics, with finite differences
+ * of the last two samples. Every prediction is kept until a sample for its time arrives, and measured against it.
+ *
+ * Used by the receiver thread only. Nothing is allocated per pose once prediction is configured.
+ */
+class LIVELINKMVNPLUGIN_API FMvnPosePredictor
+{
+public:
+
+	/** Predictions waiting for the sample of their time, the oldest is dropped beyond this */
+	static constexpr int32 MaxPending = 32;
+
+	/** Samples further apart than this are not differenced, the motion between them is unknown */
+	static constexpr double MaxDifferenceInterval = 0.1;
+
+	/** Horizon in seconds, 0 turns prediction off and frees the history */
+	void Configure(double InHorizon, bool bInUseKinematics);
+
+	bool IsEnabled() const { return Horizon > 0.0; }
+	double GetHorizon() const { return Horizon; }
+
+	/**
+	 * Carry InOutPose Horizon ahead in place, its segments and its world time. The pose as it came
+	 * is kept for the next finite differences and to measure the predictions made for its time.
+	 */
+	void Predict(Pose& InOutPose);
+
+	/** Error of the predictions measured since the last call */
+	FMvnPredictionError TakeError();
+
+private:
+
+	/** Body segments of a predicted pose, checked once a sample at or after TargetTime arrives */
+	struct FPrediction
+	{
+		double TargetTime = 0.0;
+		int32 NumSegments = 0;
+		FVector Positions[FMvnKinematicsProperties::NumBodySegments];
+		FQuat Rotations[FMvnKinematicsProperties::NumBodySegments];
+	};
+
+	/** Check the pending predictions due by the sample Actual taken at SampleTime */
+	void Measure(const Pose& Actual, double SampleTime);
+
+	void Reset();
+
+	double Horizon = 0.0;
+	bool bUseKinematics = true;
+
+	/** Previous sample as it came */
+	TArray<FTransform> PreviousTransforms;
+	double PreviousTime = 0.0;
+	bool bHasPrevious = false;
+
+	/** Ring of pending predictions */
+	TArray<FPrediction> Pending;
+	int32 PendingStart = 0;
+	int32 PendingNum = 0;
+
+	/** Error sums since the last TakeError */
+	int32 ErrorCount = 0;
+	double PositionErrorSum = 0.0;
+	double PositionErrorMax = 0.0;
+	double RotationErrorSum = 0.0;
+	double RotationErrorMax = 0.0;
+};
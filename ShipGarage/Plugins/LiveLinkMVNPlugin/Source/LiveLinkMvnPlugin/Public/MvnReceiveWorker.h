@@ -0,0 +1,65 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Misc/Timespan.h"
+#include "MvnBatchReceiver.h"
+#include "MvnPacketRing.h"
+
+#include <atomic>
+
+class FEvent;
+class FRunnableThread;
+
+/**
+ * Receive thread of one socket of a source that listens on several. Drains its socket into its own packet ring
+ * and raises the source's data event, the source's thread then decodes the rings of all its workers.
+ *
+ * The worker blocks on its socket, an idle one costs no CPU. A worker whose ring is full sleeps until the source's
+ * thread has decoded it, or for at most the wait time.
+ */
+class LIVELINKMVNPLUGIN_API FMvnReceiveWorker : public FRunnable
+{
+public:
+
+	/** Receive from Socket, stamping its datagrams with PortIndex. The socket stays owned by the caller */
+	FMvnReceiveWorker(FSocket* InSocket, ISocketSubsystem* SocketSubsystem, int32 BatchSize, int32 PortIndex, bool bKernelTimestamps,
+		int32 InRingDepth, int32 InMaxPacketSize, FEvent* InDataEvent, FTimespan InWaitTime);
+	virtual ~FMvnReceiveWorker();
+
+	void Start(const FString& ThreadName);
+
+	/** Ring the source's thread consumes, the worker is its only producer */
+	FMvnPacketRing& GetRing() { return Ring; }
+
+	/** Wake the worker after slots of its ring were released, called by the ring's consumer */
+	void NotifyRingDrained();
+
+	/** Datagrams lost because the ring was full, safe to call from any thread */
+	int64 GetRingOverflows() const { return RingOverflows.load(std::memory_order_relaxed); }
+
+	// FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+
+	/** Move everything queued on the socket into the ring, true if anything was received */
+	bool Drain();
+
+	FMvnPacketRing Ring;
+	FSocket* Socket;
+	FMvnBatchReceiver Receiver;
+
+	FEvent* DataEvent;
+	FTimespan WaitTime;
+
+	/** Raised by the consumer when it released slots, the worker waits on it while the ring is full */
+	FEvent* SpaceEvent;
+
+	FRunnableThread* Thread;
+	std::atomic<bool> bStopping;
+	std::atomic<int64> RingOverflows;
+};
@@ -8,6 +8,7 @@
 #include "HAL/CriticalSection.h"
 
 class MvnRemoteControlSession;
+class MvnRemoteControlScheduler;
 struct FIPv4Address;
 
 #include "MvnRemoteControlManager.generated.h"
@@ -75,12 +76,20 @@ public:
 	/** return true if any session is live capturing */
     bool IsAnyRecording();
 
+    /** log the request counters and response latencies of all sessions, optionally start counting again */
+    void LogCommandStats( bool _bReset );
+
+    /** scheduler thread shared by all sessions */
+    MvnRemoteControlScheduler* GetScheduler();
 
 private:
 
     /** sessions */
     TArray< MvnRemoteControlSession* > Sessions;
 
+    /** one thread sends and receives for all sessions */
+    MvnRemoteControlScheduler* m_pScheduler = nullptr;
+
     /** track reserved ports here */
     TArray< int32 > m_aReservedPorts;
 
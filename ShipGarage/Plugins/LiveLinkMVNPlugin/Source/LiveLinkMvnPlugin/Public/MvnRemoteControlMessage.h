@@ -5,7 +5,6 @@
 #include "MessageEndpoint.h"
 #include "IMessageContext.h"
 #include "HAL/ThreadSafeBool.h"
-#include <XmlParser/Public/FastXml.h>
 
 /** enum for all Mvn Remote control messages */
 enum class eMvnRemoteControlMessageCommand
@@ -32,7 +31,8 @@ enum class eMvnRemoteControlMessageCommand
     SessionInfo,
     JumpToFrame,
     SetMediaRecorderAddress,
-    SetSessionName
+    SetSessionName,
+    ClockSync
 };
 
 /** enum for all Mvn Remote control messages type ( Request or Response (ack) )*/
@@ -64,7 +64,101 @@ struct MvnRemoteControlMessage
     /** xml string */
     FString m_strXml;
 
+    /** id given when queued, ClockSync echoes it, the other acks are matched to the oldest request of their command */
+    uint32 m_uiRequestId = 0;
 
+    /** clear for reuse, keeps the allocated memory */
+    void Reset()
+    {
+        m_Command = eMvnRemoteControlMessageCommand::Undefined;
+        m_Type = eMvnRemoteControlMessageType::Undefined;
+        m_bResult = false;
+        m_strReason.Reset();
+        m_Attributes.Reset();
+        m_strXml.Reset();
+        m_uiRequestId = 0;
+    }
 };
 
+/** fields a response carried */
+enum class eMvnRemoteControlResponseField : uint32
+{
+    None = 0,
+    RequestId = 1 << 0,
+    SessionName = 1 << 1,
+    RecordingTrial = 1 << 2,
+    IsRecording = 1 << 3,
+    IsPaused = 1 << 4,
+    IsLive = 1 << 5,
+    Success = 1 << 6,
+    T0 = 1 << 7,
+    T1 = 1 << 8,
+    T2 = 1 << 9
+};
+ENUM_CLASS_FLAGS( eMvnRemoteControlResponseField )
+
+/** an Mvn Remote control response, decoded into the fields the session uses; reused for every response */
+struct MvnRemoteControlResponse
+{
+    /** Command this response acknowledges */
+    eMvnRemoteControlMessageCommand m_Command = eMvnRemoteControlMessageCommand::Undefined;
+
+    /** which of the fields below the response carried */
+    eMvnRemoteControlResponseField m_Fields = eMvnRemoteControlResponseField::None;
+
+    /** result of a command ( true = success, false = fail )*/
+    bool m_bResult = false;
+
+    /** reason */
+    FString m_strReason;
+
+    /** id of the request, only echoed by ClockSyncAck */
+    uint32 m_uiRequestId = 0;
+
+    /** SessionInfoAck */
+    FString m_strSessionName;
+    FString m_strRecordingTrial;
+
+    /** SessionStatusAck */
+    bool m_bIsRecording = false;
+    bool m_bIsPaused = false;
+    bool m_bIsLive = false;
+
+    /** CaptureNameAck */
+    bool m_bSuccess = false;
+
+    /** ClockSyncAck: our send time echoed, the server's receive and send time */
+    double m_dT0 = 0.0;
+    double m_dT1 = 0.0;
+    double m_dT2 = 0.0;
+
+    /** true if the response carried all the given fields */
+    bool Has( eMvnRemoteControlResponseField _Fields ) const
+    {
+        return EnumHasAllFlags( m_Fields, _Fields );
+    }
+
+    /** clear for reuse, keeps the allocated memory */
+    void Reset()
+    {
+        m_Command = eMvnRemoteControlMessageCommand::Undefined;
+        m_Fields = eMvnRemoteControlResponseField::None;
+        m_bResult = false;
+        m_strReason.Reset();
+        m_uiRequestId = 0;
+        m_strSessionName.Reset();
+        m_strRecordingTrial.Reset();
+        m_bIsRecording = false;
+        m_bIsPaused = false;
+        m_bIsLive = false;
+        m_bSuccess = false;
+        m_dT0 = 0.0;
+        m_dT1 = 0.0;
+        m_dT2 = 0.0;
+    }
+};
+
+/** number of commands, for tables indexed by command */
+static constexpr int32 MvnRemoteControlMessageCommandCount = (int32)eMvnRemoteControlMessageCommand::ClockSync + 1;
+
 
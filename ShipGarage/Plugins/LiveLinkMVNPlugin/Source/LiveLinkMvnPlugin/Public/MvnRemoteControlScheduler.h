@@ -0,0 +1,84 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/CriticalSection.h"
+
+class MvnRemoteControlSession;
+class FRunnableThread;
+class FEvent;
+
+/**
+ * One thread that serves all remote control sessions of a manager.
+ *
+ * The thread sleeps on an event until the earliest poll or time sync deadline of any session. Queued commands and
+ * received responses trigger the event, so idle sessions cost no CPU. Time sync requests have to leave exactly on
+ * the second, the thread wakes shortly before those and yields until the second starts.
+ */
+class LIVELINKMVNPLUGIN_API MvnRemoteControlScheduler : public FRunnable
+{
+public:
+
+    /** constructor, starts the thread */
+    MvnRemoteControlScheduler();
+
+    /** destructor, stops the thread */
+    virtual ~MvnRemoteControlScheduler();
+
+    /** serve a session from the next wake up on */
+    void AddSession( MvnRemoteControlSession* _pSession );
+
+    /** stop serving a session, returns once the thread no longer uses it */
+    void RemoveSession( MvnRemoteControlSession* _pSession );
+
+    /** wake the thread, called when a command is queued or a response received */
+    void Wake();
+
+    /** number of times the thread woke up, to verify it sleeps when idle */
+    uint64 GetWakeCount() const;
+
+    /**
+     * Holds the scheduler back while commands are queued to several sessions, so they all leave in the same pass.
+     * Used for capture start and stop of all sessions.
+     */
+    class ScopedBatch
+    {
+    public:
+        explicit ScopedBatch( MvnRemoteControlScheduler& _Scheduler );
+        ~ScopedBatch();
+
+    private:
+        MvnRemoteControlScheduler& m_Scheduler;
+    };
+
+    /** scheduling loop */
+    virtual uint32 Run() override;
+
+    /** stop the loop */
+    virtual void Stop() override;
+
+private:
+
+    /** Holds the thread object. */
+    FRunnableThread* m_pThread = nullptr;
+
+    /** id of the scheduler thread, to not wake it from itself */
+    uint32 m_uiThreadId = 0;
+
+    /** triggered for queued commands, received responses and stop */
+    FEvent* m_pWakeEvent = nullptr;
+
+    /** Holds a flag indicating that the thread is stopping. */
+    volatile bool m_bStopping = false;
+
+    /** sessions served */
+    TArray< MvnRemoteControlSession* > m_apSessions;
+
+    /** protects sessions, held while the thread updates them */
+    FCriticalSection m_SessionsCriticalSection;
+
+    /** times the thread woke up */
+    volatile uint64 m_uiWakeCount = 0;
+};
@@ -10,27 +10,52 @@
 #include "Sockets.h"
 #include "SocketSubsystem.h"
 #include "HAL/CriticalSection.h"
+#include "Containers/Queue.h"
 #include "MvnRemoteControlMessage.h"
+#include "MvnClockSync.h"
+#include "MvnBoundedQueue.h"
+#include "MvnLatencyHistogram.h"
+#include "HAL/ThreadSafeCounter.h"
 
+class MvnRemoteControlScheduler;
 
-class LIVELINKMVNPLUGIN_API MvnRemoteControlSession : public FRunnable
+/** counters and response latencies of one command of a session */
+struct MvnRemoteControlCommandStats
+{
+    /** requests sent */
+    uint32 m_uiSent = 0;
+
+    /** responses matched to a request */
+    uint32 m_uiAnswered = 0;
+
+    /** requests without a response in time */
+    uint32 m_uiTimedOut = 0;
+
+    /** requests not queued because the queue was full */
+    uint32 m_uiDropped = 0;
+
+    /** time from sending a request to receiving its response */
+    FMvnLatencyHistogram m_Latency;
+};
+
+class LIVELINKMVNPLUGIN_API MvnRemoteControlSession
 {
 public:
 
-    /** constructor */
-    MvnRemoteControlSession( const FIPv4Address& _ipAddress, const int _iPort );
+    /** constructor, the session is served by the given scheduler */
+    MvnRemoteControlSession( const FIPv4Address& _ipAddress, const int _iPort, MvnRemoteControlScheduler* _pScheduler );
 
     /** destructor */
     virtual ~MvnRemoteControlSession();
-    
-    /** Starts the thread */
-    void Start();
 
-    /**  send/receives loop happens here */
-    virtual uint32 Run() override;
+    /** processes received responses, sends due requests and queued commands; called by the scheduler thread */
+    void Update( const FDateTime& _dtNow );
+
+    /** when the next session info or status request is due */
+    FDateTime GetNextPollTime() const;
 
-    /** stop the loop */
-    virtual void Stop() override;
+    /** when the next time sync request is due, FDateTime::MaxValue() if time sync is disabled */
+    FDateTime GetNextTimeSyncTime() const;
 
     /** getter for session name */
     FString GetSessionName() const;
@@ -83,13 +108,44 @@ public:
     /** getter for destination port */
     int GetDestinationPort();
 
+    /** estimate of the server clock, from clock sync exchanges */
+    const FMvnClockSync& GetClockSync() const;
+
+    /** send all queued commands; called by the scheduler thread, before it updates any session */
+    void SendQueuedCommands();
+
+    /** copy of the counters and latencies of a command */
+    void GetCommandStats( eMvnRemoteControlMessageCommand _command, MvnRemoteControlCommandStats& _Stats ) const;
+
+    /** start counting again */
+    void ResetCommandStats();
+
+    /** most commands that can wait to be sent */
+    static constexpr uint32 CommandQueueCapacity = 64;
+
 private:
 
-    /** Holds the thread object. */
-    FRunnableThread* m_pThread = nullptr;
+    /** scheduler serving this session */
+    MvnRemoteControlScheduler* m_pScheduler = nullptr;
+
+    /** blocks on the socket and hands responses to the scheduler */
+    FUdpSocketReceiver* m_pReceiver = nullptr;
+
+    /** a datagram and when it arrived */
+    struct MvnReceivedDatagram
+    {
+        FArrayReaderPtr m_pData;
+        double m_dReceiveTime = 0.0;
+    };
 
-    /** The receiver thread's name. */
-    FString m_strThreadName;
+    /** responses received but not processed yet, filled by the receiver thread */
+    TQueue< MvnReceivedDatagram, EQueueMode::Spsc > m_ReceivedQueue;
+
+    /** server clock estimate, registered by destination address so the pose stream of the server can use it */
+    TSharedPtr< FMvnClockSync, ESPMode::ThreadSafe > m_pClockSync;
+
+    /** address commands are sent to */
+    TSharedPtr< FInternetAddr > m_pDestination;
 
     /** Holds the amount of time to wait for inbound packets. */
     FTimespan m_WaitTime;
@@ -106,9 +162,6 @@ private:
     /** holds the destination ip address */
     FIPv4Address m_DestIPAddress;
 
-    /** Holds a flag indicating that the thread is stopping. */
-    bool m_bStopping = false;
-
     /** an id */
     uint32 m_uiID = 0;
 
@@ -142,44 +195,101 @@ private:
     /** time when recording started */
     FDateTime  m_StartRecordTime;
 
-    /** last time session info was requested */
-    FDateTime  m_LastSessionInfoRequestTime;
+    /** next time session info is requested */
+    FDateTime  m_NextSessionInfoRequestTime;
+
+    /** next time session status is requested */
+    FDateTime  m_NextSessionStatusRequestTime;
 
-    /** last time session status was requested */
-    FDateTime  m_LastSessionStatusRequestTime;
+    /** next time a sync time is requested, always on the second */
+    FDateTime  m_NextSyncTimeRequestTime;
 
-    /** last time a sync time was requested */
-    FDateTime  m_LastSyncTimeRequestTime;
+    /** next time a clock sync exchange is started */
+    FDateTime  m_NextClockSyncRequestTime;
 
-    /** Queue for commands, one is sent at a time */
-    TArray< MvnRemoteControlMessage* > m_apCommandsQueue;
+    /** clock sync requests sent since the last answer, and whether the server ever answered one */
+    FThreadSafeCounter m_UnansweredClockSyncs;
+    FThreadSafeBool m_bClockSyncAnswered;
 
-    /** critical section to protect commands queue */
-    FCriticalSection m_CommandsCriticalSection;
+    /** preallocated requests, a request is either free, queued or being sent */
+    MvnRemoteControlMessage m_aRequestPool[ CommandQueueCapacity ];
+
+    /** requests of the pool that are not in use */
+    TMvnBoundedQueue< MvnRemoteControlMessage*, CommandQueueCapacity > m_FreeRequests;
+
+    /** commands waiting to be sent, any thread queues, the scheduler sends */
+    TMvnBoundedQueue< MvnRemoteControlMessage*, CommandQueueCapacity > m_CommandQueue;
+
+    /** source of request ids */
+    FThreadSafeCounter m_RequestIdCounter;
+
+    /** a request sent and waiting for its response */
+    struct MvnPendingRequest
+    {
+        uint32 m_uiRequestId;
+        eMvnRemoteControlMessageCommand m_Command;
+        double m_dSendTime;
+    };
+
+    /** sent requests waiting for a response, in send order; only used by the thread that sends */
+    TArray< MvnPendingRequest > m_aPendingRequests;
+
+    /** counters and latencies by command */
+    MvnRemoteControlCommandStats m_aCommandStats[ MvnRemoteControlMessageCommandCount ];
+
+    /** protects command stats */
+    mutable FCriticalSection m_StatsCriticalSection;
+
+    /** response being processed, reused */
+    MvnRemoteControlResponse m_Response;
 
     /**send a command/request array */
     bool SendCommand( MvnRemoteControlMessage* _pMessage, const FInternetAddr& Destination );
 
+    /** send a request and wait for its response if it has one */
+    void SendRequest( MvnRemoteControlMessage* _pRequest );
+
+    /** take a request from the pool, nullptr (and counted as dropped) if all are in use */
+    MvnRemoteControlMessage* AcquireRequest( eMvnRemoteControlMessageCommand _command );
+
+    /** give a request back to the pool */
+    void ReleaseRequest( MvnRemoteControlMessage* _pRequest );
+
+    /** find the request a response answers and record its latency */
+    void CorrelateResponse( const MvnRemoteControlResponse& _Response, double _dReceiveTime );
+
+    /** give up on requests without a response in time */
+    void ExpirePendingRequests( double _dNow );
+
+    /** called on the receiver thread */
+    void OnDataReceived( const FArrayReaderPtr& _pData, const FIPv4Endpoint& _Sender );
+
+    /** Process a received datagram */
+    void ProcessDatagram( const FArrayReaderPtr& _pData, double _dReceiveTime );
+
     /** Process a response */
-    void ProcessResponse( FString& _strResponse );
+    void ProcessResponse( const MvnRemoteControlResponse& _Response, double _dReceiveTime );
 
     /** Queue a new remote control request message */
     void QueueRequest( MvnRemoteControlMessage* _pMessage );
 
     /** when CaptureNameAck is received */
-    void OnCaptureNameAckReceived( MvnRemoteControlMessage* _pResponse );
+    void OnCaptureNameAckReceived( const MvnRemoteControlResponse& _Response );
 
     /** when CaptureStartAck is received */
-    void OnCaptureStartAckReceived( MvnRemoteControlMessage* _pResponse );
+    void OnCaptureStartAckReceived( const MvnRemoteControlResponse& _Response );
 
     /** when CaptureStopAck is received */
-    void OnCaptureStopAckReceived( MvnRemoteControlMessage* _pResponse );
+    void OnCaptureStopAckReceived( const MvnRemoteControlResponse& _Response );
 
     /** when SessionInfoAck is received */
-    void OnSessionInfoAckReceived( MvnRemoteControlMessage* _pResponse );
+    void OnSessionInfoAckReceived( const MvnRemoteControlResponse& _Response );
 
     /** when SessionStatusAck is received */
-    void OnSessionStatusAckReceived( MvnRemoteControlMessage* _pResponse );
+    void OnSessionStatusAckReceived( const MvnRemoteControlResponse& _Response );
+
+    /** when ClockSyncAck is received */
+    void OnClockSyncAckReceived( const MvnRemoteControlResponse& _Response, double _dReceiveTime );
 
     /** request session info*/
     void RequestSessionInfo();
@@ -190,6 +300,12 @@ private:
     /** Request time sync */
     void RequestTimeSync();
 
+    /** sends a clock sync request right away, its send time is part of the exchange */
+    void SendClockSyncRequest();
+
+    /** false once a server that never answered was sent enough clock sync requests */
+    bool IsClockSyncActive() const;
+
     /** holds a serial id that is ever incrementing */
     static uint32 s_uiID;
 
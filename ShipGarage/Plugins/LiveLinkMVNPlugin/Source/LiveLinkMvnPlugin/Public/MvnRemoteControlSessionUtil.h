@@ -11,45 +11,53 @@
 #include "SocketSubsystem.h"
 #include <memory>
 #include "HAL/CriticalSection.h"
-#include <TraceInsights/Private/Insights/Common/Stopwatch.h>
-#include <XmlParser/Public/XmlParser.h>
-#include <XmlParser/Public/FastXml.h>
 #include "MvnRemoteControlMessage.h"
 
+class FMvnClockSync;
+
 /** Helper namespace for creating and processing Mvn Remote control messages */
 namespace MvnRemoteControlSessionUtil
 {
-    /** Get matching message from text */
+    /** Get the command a response element acknowledges */
     eMvnRemoteControlMessageCommand GetMatchingMesssageCommand( const TCHAR* AttributeName );
 
-    /** Create a response message using the xml string coming from mvn side */
-    MvnRemoteControlMessage* CreateResponseMessage( FString& _strXMLResponse );
+    /** Decode the utf-8 xml of a datagram coming from mvn side into a response, false if it is no known response */
+    bool ParseResponse( const uint8* _pData, int32 _iLength, MvnRemoteControlResponse& _Response );
+
+    /** Reset a (pooled) message to a new request */
+    void InitRequest( MvnRemoteControlMessage& _Request, eMvnRemoteControlMessageCommand _command );
+
+    /** Make an identify request message*/
+    void InitIdentifyRequest( MvnRemoteControlMessage& _Request );
+
+    /** Make a capture name request message*/
+    void InitCaptureNameRequest( MvnRemoteControlMessage& _Request, const FString& _strCaptureName, int _iTakeCount = -1 );
 
-    /** Create a new request message*/
-    MvnRemoteControlMessage* CreateRequest( eMvnRemoteControlMessageCommand _command );
+    /** Make a capture start request message, the time code is in the server's clock when it is synchronized */
+    void InitCaptureStartRequest( MvnRemoteControlMessage& _Request, const FString& _strNotes, double _dTimeOffsetInSeconds, const FMvnClockSync* _pClockSync = nullptr );
 
-    /** Create a new identify request message*/
-    MvnRemoteControlMessage* CreateIdentifyRequest();
+    /** Make a capture stop request message, the time code is in the server's clock when it is synchronized */
+    void InitCaptureStopRequest( MvnRemoteControlMessage& _Request, double _dTimeOffsetInSeconds, const FMvnClockSync* _pClockSync = nullptr );
 
-    /** Create a new capture name request message*/
-    MvnRemoteControlMessage* CreateCaptureNameRequest( FString& _strCaptureName, int _iTakeCount = -1 );
+    /** Make a time sync request message*/
+    void InitTimeSyncRequest( MvnRemoteControlMessage& _Request, bool _bReset );
 
-    /** Create a new capture start request message*/
-    MvnRemoteControlMessage* CreateCaptureStartRequest( FString& _strNotes, double _dTimeOffsetInSeconds );
+    /** Make a session info request message*/
+    void InitSessionInfoRequest( MvnRemoteControlMessage& _Request );
 
-    /** Create a new capture stop request message*/
-    MvnRemoteControlMessage* CreateCaptureStopRequest( double _dTimeOffsetInSeconds );
+    /** Make a session status request message*/
+    void InitSessionStatusRequest( MvnRemoteControlMessage& _Request );
 
-    /** Create a new time sync request message*/
-    MvnRemoteControlMessage* CreateTimeSyncRequest( bool _bReset );
+    /** Make a clock sync request message, the server answers with the id, the local send time and its receive and send time */
+    void InitClockSyncRequest( MvnRemoteControlMessage& _Request, uint32 _uiRequestId, double _dLocalSendTime );
 
-    /** Create a new session info request message*/
-    MvnRemoteControlMessage* CreateSessionInfoRequest();
+    /** readable command name, for logs */
+    const TCHAR* GetCommandName( eMvnRemoteControlMessageCommand _command );
 
-    /** Create a new session status request message*/
-    MvnRemoteControlMessage* CreateSessionStatusRequest();
+    /** true for commands MVN acknowledges */
+    bool ExpectsResponse( eMvnRemoteControlMessageCommand _command );
 
-    /** formulate time code string from offset of current time in seconds*/
-    FString FormulateTimeCodeString( double _dTimeOffsetInSeconds );
+    /** formulate time code string from offset of current time in seconds, in the server's clock when it is synchronized */
+    FString FormulateTimeCodeString( double _dTimeOffsetInSeconds, const FMvnClockSync* _pClockSync = nullptr );
 }
 
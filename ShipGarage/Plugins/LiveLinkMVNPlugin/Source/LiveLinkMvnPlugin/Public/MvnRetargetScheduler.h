@@ -0,0 +1,89 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LiveLinkTypes.h"
+#include "Engine/EngineBaseTypes.h"
+#include "MvnSubjectUpdatePolicy.h"
+
+class ULiveLinkMvnRetargetAsset;
+class UAnimInstance;
+class UWorld;
+struct FAnimNode_LiveLinkPose;
+struct FLiveLinkAnimationFrameData;
+
+/**
+ * Retargets the rotations of all MVN driven characters of a frame as one batch, before the actors tick.
+ *
+ * Retarget assets register on their first evaluation. The subject of an asset is read from the Live Link pose node
+ * that evaluates it. An asset used some other way is only batched if it was registered under the subject it is given,
+ * otherwise it retargets on its own at the full rate. At the start of every world tick all subjects with registered assets are evaluated once and
+ * the assets of each subject are prepared in one ParallelFor task per subject. During animation evaluation an asset only uses its prepared rotations
+ * if its input frame is the one they were computed from, and otherwise retargets on its own, so the result is always
+ * the same as without the scheduler.
+ *
+ * The character of each asset is registered with FMvnSubjectUpdatePolicy under the asset's subject. Subjects
+ * it throttles are left out of the batch, their assets retarget on their own when a new frame came in.
+ */
+class LIVELINKMVNPLUGIN_API FMvnRetargetScheduler
+{
+public:
+
+	static FMvnRetargetScheduler& getInstance();
+
+	void Initialize();
+	void Shutdown();
+
+	void Register(ULiveLinkMvnRetargetAsset* Asset);
+
+	/** Register an asset no pose node evaluates under the subject whose frames it is given */
+	void Register(ULiveLinkMvnRetargetAsset* Asset, const FLiveLinkSubjectName& SubjectName);
+	void Unregister(ULiveLinkMvnRetargetAsset* Asset);
+
+	/** Evaluate the subjects of all registered assets and prepare their retarget, once per engine frame */
+	void PrepareFrame();
+
+	/** Assets prepared in the last frame */
+	int32 GetNumPrepared() const { return NumPrepared; }
+
+protected:
+
+	FMvnRetargetScheduler();
+
+	void OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	struct FEntry
+	{
+		ULiveLinkMvnRetargetAsset* Asset = nullptr;
+		FLiveLinkSubjectName SubjectName;
+		bool bHasSubject = false;
+
+		// Pose node evaluating the asset, inside AnimInstance, whose subject the asset follows. Without one the
+		// asset only has the subject it was registered under
+		TWeakObjectPtr<UAnimInstance> AnimInstance;
+		const FAnimNode_LiveLinkPose* Node = nullptr;
+
+		// Subject the asset's character is registered with the update policy under, and its rate this frame
+		FName PolicySubjectName;
+		TWeakObjectPtr<const UPrimitiveComponent> PolicyComponent;
+		EMvnSubjectUpdateRate Rate = EMvnSubjectUpdateRate::Full;
+	};
+
+	/** Find the pose node in the anim instance of Entry's asset that evaluates it */
+	static void FindPoseNode(FEntry& Entry);
+
+	/** Register the character of Entry with the update policy under its current subject */
+	void UpdatePolicyRegistration(FEntry& Entry);
+
+	mutable FCriticalSection Lock;
+	TArray<FEntry> Entries;
+
+	/** Subject frames evaluated for the current engine frame, kept to reuse their memory */
+	TMap<FLiveLinkSubjectName, FLiveLinkSubjectFrameData> SubjectFrames;
+
+	uint64 PreparedFrameCounter;
+	int32 NumPrepared;
+
+	FDelegateHandle OnWorldPreActorTickHandle;
+};
@@ -0,0 +1,92 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "QuaternionDatagram.h"
+
+/** Quaternions or vectors of all segments of a pose in structure of arrays layout, four segments per vector register */
+struct LIVELINKMVNPLUGIN_API FMvnSegmentSoA
+{
+	typedef TArray<float, TAlignedHeapAllocator<16>> FLane;
+
+	FLane X;
+	FLane Y;
+	FLane Z;
+	FLane W;
+
+	/** Resize to InNum elements, padded with identity to whole registers plus one spare identity element at index InNum */
+	void SetNum(int32 InNum);
+
+	int32 Num() const { return NumElements; }
+
+	void SetQuat(int32 Index, const FQuat& Quat)
+	{
+		X[Index] = (float)Quat.X;
+		Y[Index] = (float)Quat.Y;
+		Z[Index] = (float)Quat.Z;
+		W[Index] = (float)Quat.W;
+	}
+
+	FQuat GetQuat(int32 Index) const
+	{
+		return FQuat(X[Index], Y[Index], Z[Index], W[Index]);
+	}
+
+	void SetVector(int32 Index, const FVector& Vector)
+	{
+		X[Index] = (float)Vector.X;
+		Y[Index] = (float)Vector.Y;
+		Z[Index] = (float)Vector.Z;
+	}
+
+	FVector GetVector(int32 Index) const
+	{
+		return FVector(X[Index], Y[Index], Z[Index]);
+	}
+
+private:
+
+	int32 NumElements = 0;
+};
+
+/** Per segment constants of the retarget kernel, derived from the retarget asset's bone mapping plan and T-pose */
+struct LIVELINKMVNPLUGIN_API FMvnRetargetKernelPlan
+{
+	/** T-pose rotation the segment is combined with, identity where none is applied */
+	FMvnSegmentSoA Tpose;
+
+	/** 1 where the world rotation of the segment is the combined one, 0 where it stays the streamed one */
+	FMvnSegmentSoA::FLane CombinedWorld;
+
+	/** Segment the output rotation is made relative to, Num() for none */
+	TArray<int32> Parent;
+
+	/** Applied to every streamed rotation before the T-pose, turns characters that face Y */
+	FQuat ForwardFix = FQuat::Identity;
+
+	/** Start over with InNum segments that pass the streamed rotation through */
+	void Reset(int32 InNum);
+
+	int32 Num() const { return Parent.Num(); }
+};
+
+/**
+ * Batch math for the segments of one MVN pose, using the engine vector intrinsics on four segments at a time.
+ * The scalar versions are the per segment reference the batch versions are checked against.
+ */
+namespace MvnSegmentKernel
+{
+	/** Convert the segments of a quaternion datagram to Unreal axes: positions in cm with Y flipped, rotations (-x, y, -z, w) normalized */
+	LIVELINKMVNPLUGIN_API void ConvertSegments(const QuaternionDatagram::Kinematics* Data, int32 Num, FMvnSegmentSoA& OutPositions, FMvnSegmentSoA& OutRotations);
+	LIVELINKMVNPLUGIN_API void ConvertSegmentsScalar(const QuaternionDatagram::Kinematics* Data, int32 Num, FMvnSegmentSoA& OutPositions, FMvnSegmentSoA& OutRotations);
+
+	/**
+	 * Retarget the streamed world rotations of a pose:
+	 *   Combined = Rotation * ForwardFix * Tpose
+	 *   World    = CombinedWorld ? Combined : Rotation
+	 *   Local    = World[Parent]^-1 * Combined
+	 */
+	LIVELINKMVNPLUGIN_API void RetargetSegments(const FMvnSegmentSoA& Rotations, const FMvnRetargetKernelPlan& Plan, FMvnSegmentSoA& OutWorld, FMvnSegmentSoA& OutLocal);
+	LIVELINKMVNPLUGIN_API void RetargetSegmentsScalar(const FMvnSegmentSoA& Rotations, const FMvnRetargetKernelPlan& Plan, FMvnSegmentSoA& OutWorld, FMvnSegmentSoA& OutLocal);
+}
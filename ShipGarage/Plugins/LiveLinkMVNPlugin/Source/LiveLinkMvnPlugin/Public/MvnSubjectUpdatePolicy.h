@@ -0,0 +1,166 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "ILiveLinkSubjectUpdateRate.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "UObject/WeakObjectPtr.h"
+
+#include <atomic>
+
+#include "MvnSubjectUpdatePolicy.generated.h"
+
+class UPrimitiveComponent;
+class UWorld;
+
+/** How often a Live Link subject is pushed and its characters retargeted */
+UENUM( BlueprintType )
+enum class EMvnSubjectUpdateRate : uint8
+{
+	// every frame the source receives
+	Full = 0		UMETA( DisplayName = "Full" ),
+	// at mvn.Lod.ReducedRate, MVN retargeted characters blend between the updates
+	Reduced			UMETA( DisplayName = "Reduced" ),
+	// at mvn.Lod.PausedRate, just enough for the characters to follow the performer back into view
+	Paused			UMETA( DisplayName = "Paused" )
+};
+
+/**
+ * Update rate of every Live Link subject, from how visible the characters it drives are.
+ *
+ * Characters are registered by the component showing them, MVN retarget assets register theirs through the
+ * retarget scheduler. Once per engine frame, before the actors tick, a subject gets the rate of its most visible
+ * character: Full while one was rendered last frame at least mvn.Lod.ReducedScreenSize big, Reduced while one is
+ * smaller or went off screen less than mvn.Lod.PauseDelay ago, Paused otherwise. Subjects without characters stay
+ * at full rate and overrides win over all of it.
+ *
+ * A paused subject is still pushed now and then: the bounds of its characters follow its pose, a subject that
+ * stopped entirely would never be seen walking back into view.
+ *
+ * Sources ask ShouldPush from any thread before pushing a frame, which costs an atomic load while no subject
+ * is throttled. Sources of other plugins reach it as the ILiveLinkSubjectUpdateRate modular feature.
+ */
+class LIVELINKMVNPLUGIN_API FMvnSubjectUpdatePolicy : public ILiveLinkSubjectUpdateRate
+{
+public:
+
+	static FMvnSubjectUpdatePolicy& getInstance();
+
+	void Initialize();
+	void Shutdown();
+
+	/** Let Component decide the rate of SubjectName, until it is unregistered or destroyed. Game thread */
+	void RegisterComponent(FName SubjectName, const UPrimitiveComponent* Component);
+	void UnregisterComponent(FName SubjectName, const UPrimitiveComponent* Component);
+
+	/** Give SubjectName a fixed rate whatever its characters, or hand it back to them */
+	void SetOverride(FName SubjectName, EMvnSubjectUpdateRate Rate);
+	void ClearOverride(FName SubjectName);
+
+	/** Rate of SubjectName in the current frame. Any thread */
+	EMvnSubjectUpdateRate GetRate(FName SubjectName) const;
+
+	/** True if a source should push the frame of SubjectName it has at Now, FPlatformTime::Seconds(). Any thread */
+	virtual bool ShouldPush(FName SubjectName, double Now) override;
+
+	/** Count subject evaluations and retargets skipped for a throttled subject. Any thread */
+	void AddSkippedEvaluations(int32 Count);
+	void AddSkippedRetargets(int32 Count);
+
+	/** Rate the subjects for this engine frame, once however many worlds tick. Game thread */
+	void Update();
+
+	/** Rate the subjects now, whether or not they were this frame. Game thread, for checks */
+	void UpdateRates();
+
+	/**
+	 * Rate a character with Bounds that was last rendered SecondsSinceRendered ago, seen from ViewLocations
+	 * in a frame of DeltaSeconds. Game thread
+	 */
+	static EMvnSubjectUpdateRate RateView(const FBoxSphereBounds& Bounds, float SecondsSinceRendered, float DeltaSeconds, const TArray<FVector>& ViewLocations);
+
+	/** Seconds between the pushes of a subject at reduced rate */
+	static double GetReducedInterval();
+
+	/** Seconds between the pushes of a paused subject */
+	static double GetPausedInterval();
+
+	/** Longest a retargeted character blends into a new frame of a throttled subject */
+	static double GetMaxBlendTime();
+
+	/** Subjects at each rate and the work skipped in the last engine frame */
+	struct FStats
+	{
+		int32 Reduced = 0;
+		int32 Paused = 0;
+		int32 PushesSkipped = 0;
+		int32 EvaluationsSkipped = 0;
+		int32 RetargetsSkipped = 0;
+	};
+	FStats GetStats() const;
+
+	/** Every throttled subject and its rate, for console commands */
+	TMap<FName, EMvnSubjectUpdateRate> GetThrottledSubjects() const;
+
+protected:
+
+	FMvnSubjectUpdatePolicy();
+
+	void OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	struct FRegistration
+	{
+		FName SubjectName;
+		TWeakObjectPtr<const UPrimitiveComponent> Component;
+	};
+
+	struct FSubjectState
+	{
+		EMvnSubjectUpdateRate Rate = EMvnSubjectUpdateRate::Full;
+		double LastPush = 0.0;
+	};
+
+	/** Registrations and overrides, game thread only */
+	TArray<FRegistration> Registrations;
+	TMap<FName, EMvnSubjectUpdateRate> Overrides;
+
+	/** Throttled subjects, subjects missing are at full rate. Under Lock, read from the source threads */
+	mutable FCriticalSection Lock;
+	TMap<FName, FSubjectState> Subjects;
+	std::atomic<bool> bAnyThrottled;
+
+	/** Skipped work of the current frame, and the totals of the last one */
+	std::atomic<int32> PushesSkipped;
+	std::atomic<int32> EvaluationsSkipped;
+	std::atomic<int32> RetargetsSkipped;
+	FStats LastStats;
+
+	uint64 UpdatedFrameCounter;
+
+	FDelegateHandle OnWorldPreActorTickHandle;
+};
+
+/** Blueprint access to the subject update policy, for characters not driven through a MVN retarget asset */
+UCLASS()
+class LIVELINKMVNPLUGIN_API UMvnSubjectUpdateLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Throttle SubjectName by how visible Component is, together with any other component registered for it */
+	UFUNCTION( BlueprintCallable, Category = "Live Link Update Rate" )
+	static void RegisterLiveLinkSubjectComponent( FName SubjectName, UPrimitiveComponent* Component );
+
+	UFUNCTION( BlueprintCallable, Category = "Live Link Update Rate" )
+	static void UnregisterLiveLinkSubjectComponent( FName SubjectName, UPrimitiveComponent* Component );
+
+	/** Fix the update rate of SubjectName, or hand it back to its components with bAutomatic */
+	UFUNCTION( BlueprintCallable, Category = "Live Link Update Rate" )
+	static void SetLiveLinkSubjectUpdateRate( FName SubjectName, EMvnSubjectUpdateRate Rate, bool bAutomatic );
+
+	UFUNCTION( BlueprintPure, Category = "Live Link Update Rate" )
+	static EMvnSubjectUpdateRate GetLiveLinkSubjectUpdateRate( FName SubjectName );
+};
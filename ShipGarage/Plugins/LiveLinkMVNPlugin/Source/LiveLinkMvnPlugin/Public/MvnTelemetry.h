@@ -0,0 +1,138 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "MvnLatencyHistogram.h"
+#include "MvnPosePredictor.h"
+
+#include <atomic>
+
+DECLARE_STATS_GROUP(TEXT("MVN Live Link"), STATGROUP_MvnLiveLink, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Decode datagram"), STAT_MvnDecode, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Push frame"), STAT_MvnPush, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Packets received"), STAT_MvnPackets, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Bytes received"), STAT_MvnBytes, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Actors"), STAT_MvnActors, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Samples lost"), STAT_MvnLost, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Samples duplicated"), STAT_MvnDuplicates, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Samples reordered"), STAT_MvnReordered, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Samples outstanding fragments"), STAT_MvnFragmentsOutstanding, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Packets dropped on overflow"), STAT_MvnOverflows, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Samples in jitter buffers"), STAT_MvnJitterDepth, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Subjects at reduced rate"), STAT_MvnLodReduced, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Subjects paused"), STAT_MvnLodPaused, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Subject pushes skipped"), STAT_MvnLodPushesSkipped, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Subject evaluations skipped"), STAT_MvnLodEvaluationsSkipped, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Retargets skipped"), STAT_MvnLodRetargetsSkipped, STATGROUP_MvnLiveLink, LIVELINKMVNPLUGIN_API);
+
+/** Receive to push latency, added from whichever thread pushes and taken by the receiver thread once per telemetry window */
+struct LIVELINKMVNPLUGIN_API FMvnLatencyCounter
+{
+	void Add(double Seconds);
+
+	/** Mean and largest latency in seconds since the last call, and the number of latencies added */
+	int64 Take(double& OutMean, double& OutMax);
+
+private:
+	std::atomic<int64> SumMicroseconds{ 0 };
+	std::atomic<int64> MaxMicroseconds{ 0 };
+	std::atomic<int64> Count{ 0 };
+};
+
+/** One second of one avatar */
+struct FMvnActorTelemetry
+{
+	FName SubjectName;
+
+	/** Poses decoded and pushed per second */
+	float SamplesPerSecond = 0.f;
+	float PushesPerSecond = 0.f;
+
+	/** Totals since the actor appeared: gaps in the sample counter, duplicates, samples that came after a newer one, samples too late to use */
+	int32 Lost = 0;
+	int32 Duplicates = 0;
+	int32 Reordered = 0;
+	int32 Late = 0;
+
+	/** Samples waiting in the jitter buffer */
+	int32 Buffered = 0;
+
+	/** Receive to push latency in seconds */
+	double LatencyMean = 0.0;
+	double LatencyMax = 0.0;
+
+	/** Seconds poses are carried ahead, 0 without prediction, and the error of the predictions checked in the window */
+	double PredictionHorizon = 0.0;
+	FMvnPredictionError PredictionError;
+};
+
+/** One second of one source, published by its receiver thread */
+struct LIVELINKMVNPLUGIN_API FMvnSourceTelemetry
+{
+	int32 Port = 0;
+
+	/** Length of the window the rates are over, 0 before the first one */
+	double WindowSeconds = 0.0;
+
+	float PacketsPerSecond = 0.f;
+	float BytesPerSecond = 0.f;
+
+	/** Totals since the source started, over all actors */
+	int32 Lost = 0;
+	int32 Duplicates = 0;
+	int32 Reordered = 0;
+
+	/** Samples waiting for fragments now, and given up on in total */
+	int32 FragmentsOutstanding = 0;
+	int32 IncompleteSamples = 0;
+
+	/** Datagrams lost because the packet ring was full, and the kernel's drop count of the socket, -1 where the platform doesn't report it */
+	int64 RingOverflows = 0;
+	int64 SocketDrops = -1;
+
+	/** Packet ring and jitter buffer occupancy, the largest seen in the window */
+	int32 RingDepthMax = 0;
+	int32 JitterDepth = 0;
+
+	/** Time to decode and publish one datagram, in seconds */
+	double DecodeMean = 0.0;
+	double DecodeP99 = 0.0;
+	double DecodeMax = 0.0;
+
+	/** Receive to push latency over all actors, in seconds */
+	double LatencyMean = 0.0;
+	double LatencyMax = 0.0;
+
+	/** Error of the predictions over all actors, Count is 0 without prediction */
+	FMvnPredictionError PredictionError;
+
+	TArray<FMvnActorTelemetry> Actors;
+
+	/** One line for the Live Link source status */
+	FString ToStatusString() const;
+};
+
+namespace MvnTelemetry
+{
+	/** Datagrams the kernel dropped for UDP sockets bound to Port, -1 if the platform doesn't tell */
+	LIVELINKMVNPLUGIN_API int64 ReadSocketDrops(int32 Port);
+}
+
+/**
+ * Insights counters of one source, named after its port. Compiled out without counters trace.
+ */
+class FMvnTelemetryTraceCounters
+{
+public:
+	void Set(const FMvnSourceTelemetry& Telemetry);
+
+private:
+#if COUNTERSTRACE_ENABLED
+	int32 Port = 0;
+	TArray<uint16> CounterIds;
+#endif
+};
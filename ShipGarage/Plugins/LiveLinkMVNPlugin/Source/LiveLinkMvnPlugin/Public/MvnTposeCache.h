@@ -0,0 +1,94 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Templates/Function.h"
+#include "UObject/ObjectKey.h"
+
+class UAnimSequence;
+class USkeletalMesh;
+class USkeleton;
+
+/** T-pose a MVN subject is retargeted against, the same for every character sharing skeleton, T-pose animation and bone mapping */
+struct FMvnTposeBasis
+{
+	/** T-pose of every reference skeleton bone in component space */
+	TArray<FTransform> World;
+
+	/** Per MVN segment, the component space T-pose rotation of its bone and the translation the bone is placed at */
+	TArray<FTransform> MvnToUnreal;
+};
+
+/**
+ * Process wide cache of T-pose bases, so retarget assets only compute one when something it depends on changed
+ * and all anim instances driven by the same subject and retarget settings share it.
+ * Safe to use from the animation worker threads.
+ */
+class LIVELINKMVNPLUGIN_API FMvnTposeCache
+{
+public:
+
+	static FMvnTposeCache& getInstance();
+
+	/** Start dropping entries whose source assets are edited or reimported */
+	void Initialize();
+	void Shutdown();
+
+	/**
+	 * Basis for the given skeleton, T-pose animation and segment to reference bone mapping.
+	 * Build is called to fill in a new basis if there is none yet.
+	 */
+	TSharedRef<const FMvnTposeBasis, ESPMode::ThreadSafe> FindOrAdd(const USkeletalMesh* Mesh, const USkeleton* Skeleton, const UAnimSequence* TPoseAnimation, int32 NumCompactBones,
+		const TArray<int32>& SegmentBoneIndices, TFunctionRef<void(FMvnTposeBasis&)> Build);
+
+	/** Drop every entry built from Object */
+	void Invalidate(const UObject* Object);
+
+	/** Drop all entries */
+	void Reset();
+
+	int32 Num() const;
+
+	/** Changes whenever entries are dropped, bases fetched before that may be stale */
+	int32 GetGeneration() const { return Generation.GetValue(); }
+
+protected:
+
+	FMvnTposeCache();
+
+	struct FKey
+	{
+		FObjectKey Mesh;
+		FObjectKey Skeleton;
+		FObjectKey TPoseAnimation;
+		int32 NumCompactBones = 0;
+		TArray<int32> SegmentBoneIndices;
+
+		bool operator==(const FKey& Other) const
+		{
+			return Mesh == Other.Mesh && Skeleton == Other.Skeleton && TPoseAnimation == Other.TPoseAnimation
+				&& NumCompactBones == Other.NumCompactBones && SegmentBoneIndices == Other.SegmentBoneIndices;
+		}
+
+		friend uint32 GetTypeHash(const FKey& Key)
+		{
+			uint32 Hash = HashCombine(HashCombine(GetTypeHash(Key.Mesh), GetTypeHash(Key.Skeleton)), GetTypeHash(Key.TPoseAnimation));
+			Hash = HashCombine(Hash, GetTypeHash(Key.NumCompactBones));
+			for (int32 BoneIndex : Key.SegmentBoneIndices)
+			{
+				Hash = HashCombine(Hash, GetTypeHash(BoneIndex));
+			}
+			return Hash;
+		}
+	};
+
+	// entries are rarely added, a lock keeps it simple
+	mutable FCriticalSection Lock;
+	TMap<FKey, TSharedRef<const FMvnTposeBasis, ESPMode::ThreadSafe>> Entries;
+
+	FThreadSafeCounter Generation;
+
+	FDelegateHandle OnObjectPropertyChangedHandle;
+};
@@ -0,0 +1,123 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+/**
+ * Names known up front, interned once so the parser hands out indices instead of strings.
+ *
+ * Lookups hash the UTF-8 bytes of a name case insensitively, like the FName compare the remote control used before.
+ */
+class LIVELINKMVNPLUGIN_API FMvnXmlNameTable
+{
+public:
+
+	/** Intern the given names, index i of the array is id i */
+	explicit FMvnXmlNameTable(TArrayView<const ANSICHAR* const> Names);
+
+	/** Id of the name, INDEX_NONE if it is not in the table */
+	int32 Find(FAnsiStringView Name) const;
+
+	int32 Num() const { return Names.Num(); }
+
+private:
+
+	struct FSlot
+	{
+		uint32 Hash = 0;
+		int32 Id = INDEX_NONE;
+	};
+
+	static uint32 HashName(FAnsiStringView Name);
+
+	TArray<FAnsiStringView> Names;
+
+	/** Open addressing, a power of two at least twice the number of names */
+	TArray<FSlot> Slots;
+};
+
+/**
+ * Pull parser for the small XML documents of the MVN remote control.
+ *
+ * Works in place on the UTF-8 bytes of a datagram: names and values are views into the buffer and only the values
+ * the caller asks for are unescaped and converted. Declarations, comments and text content are skipped. It does not
+ * validate, a closing tag is not checked against its opening tag.
+ */
+class LIVELINKMVNPLUGIN_API FMvnXmlPullParser
+{
+public:
+
+	enum class EToken : uint8
+	{
+		/** An element starts, its attributes follow */
+		StartElement,
+		/** An attribute of the element that started last */
+		Attribute,
+		/** An element ends, also reported for <Element/> */
+		EndElement,
+		/** No more data */
+		End,
+		/** Malformed input, the parser stays in this state */
+		Error
+	};
+
+	FMvnXmlPullParser(const uint8* Data, int32 Length, const FMvnXmlNameTable& InNameTable);
+
+	/** Advance to the next token */
+	EToken Next();
+
+	/** Element or attribute name of the current token */
+	FAnsiStringView GetName() const { return Name; }
+
+	/** Id of the name in the name table, INDEX_NONE if it is not known */
+	int32 GetNameId() const { return NameId; }
+
+	/** Depth of the current element, 1 for the root */
+	int32 GetDepth() const { return Depth; }
+
+	/** Raw attribute value, still escaped */
+	FAnsiStringView GetValue() const { return Value; }
+
+	/** Case insensitive compare of the raw attribute value, for true/false and other plain words */
+	bool ValueEquals(FAnsiStringView Text) const;
+
+	/** Attribute value as a number */
+	double GetValueAsDouble() const;
+	uint32 GetValueAsUInt() const;
+
+	/** Unescaped attribute value, reuses the memory of Out */
+	void GetValueAsString(FString& Out) const;
+
+private:
+
+	EToken Fail();
+
+	void SkipWhitespace();
+
+	bool SkipPast(FAnsiStringView Terminator);
+
+	FAnsiStringView ReadName();
+
+	const ANSICHAR* Cursor;
+	const ANSICHAR* const End;
+	const FMvnXmlNameTable& NameTable;
+
+	FAnsiStringView Name;
+	FAnsiStringView Value;
+	int32 NameId = INDEX_NONE;
+	int32 Depth = 0;
+
+	/** Name of the element whose tag is being read, for the EndElement of <Element/> */
+	FAnsiStringView ElementName;
+	int32 ElementNameId = INDEX_NONE;
+
+	/** Inside a start tag, reading attributes */
+	bool bInTag = false;
+
+	/** The previous token was an EndElement, leave its depth on the next call */
+	bool bPopDepth = false;
+
+	bool bFailed = false;
+};
@@ -4,7 +4,26 @@
 #define PARSERMANAGER_H
 
 #include "Datagram.h"
+#include "FragmentAssembler.h"
 
+class QuaternionDatagram;
+class ScaleDatagram;
+class MetaDatagram;
+class TimeCodeDatagram;
+class JointAnglesDatagram;
+class LinearSegmentKinematicsDatagram;
+class AngularSegmentKinematicsDatagram;
+class TrackerKinematicsDatagram;
+class CenterOfMassDatagram;
+
+/*! Decodes raw MVN datagrams.
+	The parser keeps one datagram object per protocol and decodes every packet in place into it,
+	so in steady state no memory is allocated. A returned datagram stays valid until the next call.
+	Samples that MVN splits over several datagrams are joined before decoding, so a returned
+	datagram always holds the complete sample. A parser is meant to be used from a single thread.
+	The alternative pose encodings repeat the quaternion pose, they are not parsed and their datagrams
+	are dropped before reassembly.
+*/
 class ParserManager
 {
 public:
@@ -12,10 +31,29 @@ public:
 	
 	ParserManager();
 	~ParserManager();
+	Datagram* readDatagram(const uint8_t* data, int32 size, const FIPv4Endpoint& sender, int32 portIndex, double receiveTime);
+	Datagram* readDatagram(const uint8_t* data, int32 size, double receiveTime);
+	Datagram* readDatagram(const uint8_t* data, int32 size);
 	Datagram* readDatagram(const TArray<uint8_t>& data);
 
+	/*! Reassembly of samples split over several datagrams, exposes the fragment counters */
+	FragmentAssembler& fragmentAssembler();
+	const FragmentAssembler& fragmentAssembler() const;
+
 private:
 	Datagram* createDgram(StreamingProtocol proto);
+
+	std::unique_ptr<QuaternionDatagram> m_quaternionDatagram;
+	std::unique_ptr<ScaleDatagram> m_scaleDatagram;
+	std::unique_ptr<MetaDatagram> m_metaDatagram;
+	std::unique_ptr<TimeCodeDatagram> m_timeCodeDatagram;
+	std::unique_ptr<JointAnglesDatagram> m_jointAnglesDatagram;
+	std::unique_ptr<LinearSegmentKinematicsDatagram> m_linearKinematicsDatagram;
+	std::unique_ptr<AngularSegmentKinematicsDatagram> m_angularKinematicsDatagram;
+	std::unique_ptr<TrackerKinematicsDatagram> m_trackerKinematicsDatagram;
+	std::unique_ptr<CenterOfMassDatagram> m_centerOfMassDatagram;
+
+	FragmentAssembler m_fragmentAssembler;
 };
 
 #endif
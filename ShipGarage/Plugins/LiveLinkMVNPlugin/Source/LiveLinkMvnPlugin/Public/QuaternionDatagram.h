@@ -13,7 +13,7 @@ public:
 	virtual void printData() const override;
 
 protected:
-	virtual void deserializeData(Streamer &inputStreamer) override;
+	virtual bool deserializeData(Streamer &inputStreamer) override;
 	
 public:
 	struct Kinematics 
@@ -23,6 +23,12 @@ public:
 		float quatRotation[4];
 	};
 	std::vector<Kinematics> m_data;
+
+	/*! Bytes per segment in the data part */
+	static const int SEGMENT_SIZE = 32;
+
+	/*! Number of segments reserved up front, the item count in the header is an 8 bit value */
+	static const int SEGMENT_CAPACITY = 255;
 };
 
 #endif
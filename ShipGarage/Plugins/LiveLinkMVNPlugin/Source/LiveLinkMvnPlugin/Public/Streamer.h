@@ -9,9 +9,13 @@
 #include <iostream>
 #include <sstream>
 
+/*! Reads big-endian MVN fields in place from a received datagram.
+	The streamer never copies or owns the underlying bytes, so the buffer must outlive it.
+*/
 class Streamer
 {
 public:
+	Streamer(const uint8_t* data, int32 size);
 	Streamer(const TArray<uint8_t>& arr);
 	~Streamer();
 
@@ -22,16 +26,18 @@ public:
 	void read(float &destination);
 	void read(std::string& str, int numChars);
 
-private:
+	const char* readChars(int numChars);
+	void skip(int numBytes);
+
+	bool canRead(int numBytes) const;
+	int offset() const;
+	int remaining() const;
 
-	enum Endianess  {
-		Little_Endian,
-		Big_Endian
-	};
+private:
 
-	const TArray<uint8_t>* m_array;
+	const uint8_t* m_data;
+	int m_size;
 	int m_offset;
-	Endianess m_endianess;
 };
 
 #endif
@@ -0,0 +1,27 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Datagram.h"
+
+/*! Time code of a sample, sent by MVN as a 12 character string "HH:MM:SS.mmm" */
+class TimeCodeDatagram : public Datagram
+{
+public:
+	TimeCodeDatagram();
+	virtual ~TimeCodeDatagram();
+	virtual void printData() const override;
+
+	/*! Time code as seconds since midnight */
+	double seconds() const;
+
+protected:
+	virtual bool deserializeData(Streamer& inputStreamer) override;
+
+public:
+
+	int m_hours;
+	int m_minutes;
+	int m_seconds;
+	int m_milliseconds;
+};
@@ -0,0 +1,35 @@
+// Copyright 2018 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#ifndef TRACKERKINEMATICSDATAGRAM_H
+#define TRACKERKINEMATICSDATAGRAM_H
+
+#include "Datagram.h"
+
+class TrackerKinematicsDatagram : public Datagram 
+{
+public:
+	TrackerKinematicsDatagram();
+	virtual ~TrackerKinematicsDatagram();
+	virtual void printData() const override;
+
+protected:
+	virtual bool deserializeData(Streamer &inputStreamer) override;
+	
+public:
+	struct Kinematics 
+	{
+		int segmentId;
+		float quatRotation[4];
+		float freeAcceleration[3];
+		float magneticField[3];
+	};
+	std::vector<Kinematics> m_data;
+
+	/*! Bytes per tracker in the data part */
+	static const int TRACKER_SIZE = 44;
+
+	/*! Number of trackers reserved up front, the item count in the header is an 8 bit value */
+	static const int TRACKER_CAPACITY = 255;
+};
+
+#endif
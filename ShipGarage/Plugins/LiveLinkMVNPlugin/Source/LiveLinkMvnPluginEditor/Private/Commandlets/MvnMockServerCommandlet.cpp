@@ -0,0 +1,45 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#include "Commandlets/MvnMockServerCommandlet.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Parse.h"
+#include "MvnMockServer.h"
+
+UMvnMockServerCommandlet::UMvnMockServerCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UMvnMockServerCommandlet::Main(const FString& Params)
+{
+	FMvnMockServerSettings Settings;
+	Settings.Parse(*Params);
+
+	float Seconds = 0.0f;
+	FParse::Value(*Params, TEXT("Seconds="), Seconds);
+
+	FMvnMockServer Server(Settings);
+	if (!Server.IsRunning())
+	{
+		return 1;
+	}
+	UE_LOG(LogTemp, Display, TEXT("MvnMockServer: %d actors at %.0f Hz to %s"), Settings.NumActors, Settings.Rate, *Settings.PoseTarget.ToString());
+
+	const double StartTime = FPlatformTime::Seconds();
+	FMvnMockServer::FStats Last;
+	while (!IsEngineExitRequested() && (Seconds <= 0.0f || FPlatformTime::Seconds() - StartTime < Seconds))
+	{
+		FPlatformProcess::Sleep(1.0f);
+
+		const FMvnMockServer::FStats Stats = Server.GetStats();
+		UE_LOG(LogTemp, Display, TEXT("MvnMockServer: %lld samples/s, %lld packets/s, %.1f KB/s, %lld dropped, %lld reordered, %lld requests"),
+			Stats.SamplesSent - Last.SamplesSent, Stats.PacketsSent - Last.PacketsSent, (Stats.BytesSent - Last.BytesSent) / 1024.0,
+			Stats.PacketsDropped - Last.PacketsDropped, Stats.PacketsReordered - Last.PacketsReordered, Stats.RequestsAnswered - Last.RequestsAnswered);
+		Last = Stats;
+	}
+	return 0;
+}
@@ -0,0 +1,21 @@
+// Copyright 2021 Xsens Technologies B.V., Inc. All Rights Reserved.
+
+#pragma once
+#include "Commandlets/Commandlet.h"
+#include "MvnMockServerCommandlet.generated.h"
+
+/**
+ * Runs an FMvnMockServer headless, for load generation from a build machine or a second box:
+ * UnrealEditor-Cmd <Project> -run=MvnMockServer [-Seconds=N] [Target=host:port Rate=60 Actors=1 ...]
+ * Settings are those of FMvnMockServerSettings::Parse; without -Seconds it runs until the process is stopped.
+ */
+UCLASS()
+class UMvnMockServerCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMvnMockServerCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -211,7 +211,7 @@ public:
 			const int32 SegmentsCount = FLiveLinkMvnMetadataService::getInstance().GetSegmentsCount(EntryPtr->SourceSubjectRole.Source, EntryPtr->SourceSubjectRole.Subject);
 			for (int32 SegmentIdx = 0; SegmentIdx < SegmentsCount; ++SegmentIdx)
 			{
-				FString SegmentLable = FString::Printf(L"Segment #%d", SegmentIdx);
+				FString SegmentLable = FString::Printf(TEXT("Segment #%d"), SegmentIdx);
 				MenuBuilder.AddMenuEntry(
 					FText::FromString(SegmentLable),
 					LOCTEXT("SegmentTooltip", "SegmentTooltip"),
@@ -904,7 +904,7 @@ FMvnRemoteControlSessionUIEntryPtr SMvnRemoteControlClientPanel::GetSelectedEntr
 
 FText SMvnRemoteControlClientPanel::GetStartStopDelay() const
 {
-    return FText::FromString( FString::Printf( L"%f", m_dDefaultCaptureStartStopDelay ) );
+    return FText::FromString( FString::Printf( TEXT( "%f" ), m_dDefaultCaptureStartStopDelay ) );
 }
 
 void SMvnRemoteControlClientPanel::GetStartStopDelayFromInput( const FText& Text )
@@ -0,0 +1,26 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Features/IModularFeature.h"
+
+/**
+ * Modular feature of a plugin that throttles Live Link subjects, for sources of other plugins to ask
+ * before they build and push a frame. Without an implementation registered every frame is pushed.
+ */
+class ILiveLinkSubjectUpdateRate : public IModularFeature
+{
+public:
+
+	static FName GetModularFeatureName()
+	{
+		static const FName FeatureName(TEXT("LiveLinkSubjectUpdateRate"));
+		return FeatureName;
+	}
+
+	virtual ~ILiveLinkSubjectUpdateRate() {}
+
+	/** True if a source should push the frame of SubjectName it has at Now, FPlatformTime::Seconds(). Any thread */
+	virtual bool ShouldPush(FName SubjectName, double Now) = 0;
+};
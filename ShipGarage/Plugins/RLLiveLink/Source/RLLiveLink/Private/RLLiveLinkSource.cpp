@@ -5,6 +5,8 @@
 #include "ILiveLinkClient.h"
 #include "Interfaces/IPluginManager.h"
 #include "Runtime/Core/Public/Async/ParallelFor.h"
+#include "Features/IModularFeatures.h"
+#include "ILiveLinkSubjectUpdateRate.h"
 
 #if ENGINE_MINOR_VERSION > 22 || ENGINE_MAJOR_VERSION >= 5
 #include "Roles/LiveLinkAnimationRole.h"
@@ -304,6 +306,14 @@ void FRLLiveLinkSource::HandleReceivedData( TSharedPtr<TArray<uint8>, ESPMode::T
 {
     ProcessStickyData( spReceivedData );
 
+    // Nothing to parse yet, or every subject the message would update is an avatar held back by the update rate:
+    // leave the subjects as they are, RemoveUnusedSubjects would drop them. A disconnect is parsed regardless,
+    // its subjects are dropped on purpose
+    if ( m_kCompleteData.Num() == 0 || ( !CollectHeldBackSubjects() && !IsDisconnectMessage() ) )
+    {
+        return;
+    }
+
     FString strJsonString;
     strJsonString.Empty( m_kCompleteData.Num() );
     for ( uint8& Byte : m_kCompleteData )
@@ -448,6 +458,14 @@ void FRLLiveLinkSource::ProcessAvatarData( const TSharedPtr<FJsonObject>& spData
 
     bool bCreateSubject = !m_kEncounteredSubjects.Contains( kSubjectName );
 
+    // A character that is small or off screen is pushed at a reduced rate, skip building its frame.
+    // The subject stays encountered, so RemoveUnusedSubjects keeps it
+    if ( !bCreateSubject && m_kHeldBackSubjects.Contains( kSubjectName ) )
+    {
+        m_kEncounteredSubjects.Add( kSubjectName, true );
+        return;
+    }
+
     // 檢查骨架個數是否與當前 Subject 數量相符，若不符則需重新建立 Subject 的骨架名稱和關係
 #if ENGINE_MINOR_VERSION >= 23 || ENGINE_MAJOR_VERSION >= 5
     auto kAllSubjects = m_pClient->GetSubjects( true,  false );
@@ -544,6 +562,7 @@ void FRLLiveLinkSource::ProcessAvatarData( const TSharedPtr<FJsonObject>& spData
         m_pClient->PushSubjectSkeleton( m_kSourceGuid, kSubjectName, kSubjectRefSkeleton );
     }
     m_kEncounteredSubjects.Add( kSubjectName, true );
+    m_kAvatarSubjects.Add( kSubjectName );
 
     FLiveLinkFrameData kSubjectFrame;
     TArray<FLiveLinkCurveElement>& kCurveElements = kSubjectFrame.CurveElements;
@@ -1396,6 +1415,49 @@ void FRLLiveLinkSource::ProcessLightData( const TSharedPtr<FJsonObject>& spDataR
     }
 }
 
+bool FRLLiveLinkSource::CollectHeldBackSubjects()
+{
+    m_kHeldBackSubjects.Reset();
+
+    // Only avatars are throttled, and only when a plugin provides the update rate
+    IModularFeatures& kModularFeatures = IModularFeatures::Get();
+    const FName kFeatureName = ILiveLinkSubjectUpdateRate::GetModularFeatureName();
+    kModularFeatures.LockModularFeatureList();
+    if ( kModularFeatures.IsModularFeatureAvailable( kFeatureName ) )
+    {
+        ILiveLinkSubjectUpdateRate& kUpdateRate = kModularFeatures.GetModularFeature<ILiveLinkSubjectUpdateRate>( kFeatureName );
+        const double dNow = FPlatformTime::Seconds();
+        for ( const FName& kSubjectName : m_kAvatarSubjects )
+        {
+            if ( !kUpdateRate.ShouldPush( kSubjectName, dNow ) )
+            {
+                m_kHeldBackSubjects.Add( kSubjectName );
+            }
+        }
+    }
+    kModularFeatures.UnlockModularFeatureList();
+
+    // Lights, cameras and props always need the message. An avatar new to a stream of held back ones
+    // waits for the next message one of them is due in
+    const bool bOnlyAvatars = m_kAvatarSubjects.Num() == m_kEncounteredSubjects.Num();
+    return m_kAvatarSubjects.Num() == 0 || !bOnlyAvatars || m_kHeldBackSubjects.Num() < m_kAvatarSubjects.Num();
+}
+
+bool FRLLiveLinkSource::IsDisconnectMessage() const
+{
+    // searched in the raw bytes, the message is only parsed when it is due
+    static const uint8 kDisconnectKey[] = { '"', 'D', 'i', 's', 'c', 'o', 'n', 'n', 'e', 'c', 't', '"' };
+    const int32 nKeyLength = UE_ARRAY_COUNT( kDisconnectKey );
+    for ( int32 i = 0; i + nKeyLength <= m_kCompleteData.Num(); ++i )
+    {
+        if ( FMemory::Memcmp( m_kCompleteData.GetData() + i, kDisconnectKey, nKeyLength ) == 0 )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 void FRLLiveLinkSource::ResetEncounteredSubjectsMap()
 {
     for ( auto& kSubject : m_kEncounteredSubjects )
@@ -1422,6 +1484,7 @@ void FRLLiveLinkSource::RemoveUnusedSubjects()
         {
             m_kEncounteredSubjects.Remove( kSubjectName );
         }
+        m_kAvatarSubjects.Remove( kSubjectName );
     }
 }
 
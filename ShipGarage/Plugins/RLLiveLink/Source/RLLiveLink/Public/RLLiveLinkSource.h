@@ -75,6 +75,11 @@ private:
     void ProcessCameraData( const TSharedPtr<FJsonObject>& spDataRoot );
     void ProcessLightData( const TSharedPtr<FJsonObject>& spDataRoot );
 
+    // Ask the update rate which avatars to skip this message, false if that is every subject the message updates
+    bool CollectHeldBackSubjects();
+    // True if the complete message is iClone's disconnect, which has to reach RemoveUnusedSubjects
+    bool IsDisconnectMessage() const;
+
     void ResetEncounteredSubjectsMap();
     void RemoveUnusedSubjects();
     void ClearAllSubjects();
@@ -115,6 +120,10 @@ private:
     // List of subjects we've already encountered
     TMap<FName, bool> m_kEncounteredSubjects;
 
+    // Encountered subjects that are avatars, and those held back by the update rate in the current message
+    TSet<FName> m_kAvatarSubjects;
+    TSet<FName> m_kHeldBackSubjects;
+
     // Buffer to receive socket data into
     TArray<uint8> m_kRecvBuffer;
 
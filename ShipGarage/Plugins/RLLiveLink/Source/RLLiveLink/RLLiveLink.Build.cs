@@ -41,7 +41,8 @@ public class RLLiveLink : ModuleRules
                 "RawMesh",
                 "BlueprintGraph",
                 "ApplicationCore",
-                "CinematicCamera"
+                "CinematicCamera",
+                "LiveLinkSubjectUpdateRate"
             }
             );
 